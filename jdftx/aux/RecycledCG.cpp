@@ -0,0 +1,93 @@
+/*-------------------------------------------------------------------
+Copyright 2026 agent
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+
+#include <core/Minimize.h>
+#include <core/Util.h>
+#include <core/Random.h>
+#include <vector>
+
+//Model problem for Krylov subspace recycling in LinearSolvable::solve (MinimizeParams::nRecycle):
+//a sequence of slowly-changing linear solves (as in fluid solves across SCF / ionic steps),
+//whose hessian has a few near-zero eigenvalues that stall unpreconditioned CG.
+
+//Minimal vector type satisfying the requirements of LinearSolvable:
+struct Vec : public std::vector<double>
+{	Vec& operator*=(double s) { for(double& x: *this) x *= s; return *this; }
+};
+void axpy(double alpha, const Vec& x, Vec& y) { for(size_t i=0; i<x.size(); i++) y[i] += alpha*x[i]; }
+double dot(const Vec& x, const Vec& y) { double ret=0.; for(size_t i=0; i<x.size(); i++) ret += x[i]*y[i]; return ret; }
+Vec clone(const Vec& x) { return x; }
+void randomize(Vec& x) { for(double& xi: x) xi = Random::uniform(-0.5, 0.5); }
+
+//Tridiagonal hessian with 5 small eigenvalues in an otherwise well-separated spectrum, shifted slightly between solves
+struct ModelProblem : public LinearSolvable<Vec>
+{	int N;
+	double shift;
+	
+	ModelProblem(int N) : N(N), shift(0.) {}
+	
+	Vec hessian(const Vec& x) const
+	{	Vec y = x;
+		for(int i=0; i<N; i++)
+		{	double lambda = (i<5 ? 1e-3*(i+1) : 1.+i) + shift;
+			y[i] = lambda*x[i] + (i ? 0.01*x[i-1] : 0.) + (i<N-1 ? 0.01*x[i+1] : 0.);
+		}
+		return y;
+	}
+	
+	Vec precondition(const Vec& x) const { return x; }
+};
+
+int main(int argc, char** argv)
+{	initSystem(argc, argv);
+	const int N = 400;
+	const int nSolves = 6;
+	
+	MinimizeParams p;
+	p.nIterations = 2000;
+	p.knormThreshold = 1e-10;
+	p.nDim = N;
+	p.fpLog = nullLog;
+	
+	logPrintf("\nCG iterations for a sequence of %d solves (N = %d):\n", nSolves, N);
+	logPrintf("%8s %12s %12s\n", "solve", "nRecycle=0", "nRecycle=8");
+	std::vector<int> nIter[2];
+	for(int iCase=0; iCase<2; iCase++)
+	{	p.nRecycle = iCase ? 8 : 0;
+		ModelProblem mp(N);
+		Random::seed(0);
+		for(int iSolve=0; iSolve<nSolves; iSolve++)
+		{	mp.shift = 1e-5*iSolve;
+			Vec rhs; rhs.resize(N); randomize(rhs);
+			mp.state.assign(N, 0.);
+			nIter[iCase].push_back(mp.solve(rhs, p));
+		}
+	}
+	int nTot[2] = {0, 0};
+	for(int iSolve=0; iSolve<nSolves; iSolve++)
+	{	logPrintf("%8d %12d %12d\n", iSolve, nIter[0][iSolve], nIter[1][iSolve]);
+		nTot[0] += nIter[0][iSolve];
+		nTot[1] += nIter[1][iSolve];
+	}
+	logPrintf("%8s %12d %12d\n", "total", nTot[0], nTot[1]);
+	
+	finalizeSystem();
+	return 0;
+}
@@ -0,0 +1,81 @@
+/*-------------------------------------------------------------------
+Copyright 2026 agent
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+
+#include <core/Thread.h>
+#include <core/Util.h>
+#include <vector>
+
+//Microbenchmark of the overhead of threadLaunch per launch, compared to spawning threads per launch
+
+//Trivial kernel: a few operations per job, so that the launch overhead dominates
+void kernel_sub(size_t iStart, size_t iStop, double* data)
+{	for(size_t i=iStart; i<iStop; i++) data[i] = data[i]*0.5 + 1.;
+}
+
+//Kernel that launches a nested parallel section from each task
+void nested_sub(size_t iStart, size_t iStop, double* data, size_t nInner)
+{	for(size_t i=iStart; i<iStop; i++)
+		threadLaunch(kernel_sub, nInner, data+i*nInner);
+}
+
+//Reference: the previous implementation of threadLaunch, which created and joined threads per call
+template<typename Callable,typename ... Args>
+void spawnLaunch(int nThreads, Callable* func, size_t nJobs, Args... args)
+{	std::vector<std::thread> threads;
+	for(int t=0; t<nThreads; t++)
+	{	size_t i1 = (t*nJobs)/nThreads;
+		size_t i2 = ((t+1)*nJobs)/nThreads;
+		if(t<nThreads-1) threads.push_back(std::thread(func, i1, i2, args...));
+		else (*func)(i1, i2, args...);
+	}
+	for(std::thread& thread: threads) thread.join();
+}
+
+int main(int argc, char** argv)
+{	initSystem(argc, argv);
+	const size_t nJobs = 1024;
+	const int nRepeats = 10000;
+	std::vector<double> data(nJobs*nJobs, 1.);
+	
+	logPrintf("\nOverhead per launch of %lu trivial jobs (%d repetitions):\n", nJobs, nRepeats);
+	logPrintf("%8s %16s %16s\n", "nThreads", "spawn [us]", "pool [us]");
+	for(int nThreads=1; nThreads<=nProcsAvailable; nThreads++)
+	{	double tSpawn = clock_us();
+		for(int iRep=0; iRep<nRepeats; iRep++)
+			spawnLaunch(nThreads, kernel_sub, nJobs, data.data());
+		tSpawn = (clock_us() - tSpawn)/nRepeats;
+		double tPool = clock_us();
+		for(int iRep=0; iRep<nRepeats; iRep++)
+			threadLaunch(nThreads, kernel_sub, nJobs, data.data());
+		tPool = (clock_us() - tPool)/nRepeats;
+		logPrintf("%8d %16.2lf %16.2lf\n", nThreads, tSpawn, tPool);
+	}
+	
+	//Nested launches (previously serialized by suspendOperatorThreading):
+	const size_t nOuter = 4;
+	double tNested = clock_us();
+	for(int iRep=0; iRep<nRepeats/10; iRep++)
+		threadLaunch(std::min(int(nOuter), nProcsAvailable), nested_sub, nOuter, data.data(), nJobs);
+	tNested = (clock_us() - tNested)/(nRepeats/10);
+	logPrintf("\nNested launch of %lu x %lu trivial jobs: %.2lf us per outer launch\n", nOuter, nJobs, tNested);
+	
+	finalizeSystem();
+	return 0;
+}
@@ -0,0 +1,103 @@
+/*-------------------------------------------------------------------
+Copyright 2026 agent
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#include <fluid/TranslationOperator.h>
+#include <fluid/Euler.h>
+#include <core/ScalarFieldArray.h>
+#include <core/Operators.h>
+#include <core/Random.h>
+#include <core/Util.h>
+
+//Benchmark of the batched TranslationOperator::taxpy (as used in the orientation loops of IdealGasPomega / IdealGasPsiAlpha)
+//against the previous path with one taxpy per orientation, site and position
+
+int main(int argc, char** argv)
+{	initSystem(argc, argv);
+	
+	GridInfo gInfo;
+	gInfo.S = vector3<int>(96, 96, 96);
+	gInfo.R = Diag(0.25 * gInfo.S); //24 bohr^3 box
+	gInfo.initialize();
+	
+	//Water-like geometry (site 0: O, site 1: two H's):
+	std::vector< std::vector< vector3<> > > positions(2);
+	positions[0].push_back(vector3<>(0., 0., 0.));
+	positions[1].push_back(vector3<>(+1.43, 0., 1.11));
+	positions[1].push_back(vector3<>(-1.43, 0., 1.11));
+	const int nSites = positions.size();
+	const int oBatchSize = 4, nOrientations = 32, nRepeats = 3;
+	std::vector< matrix3<> > rot(nOrientations);
+	for(matrix3<>& r: rot)
+		r = matrixFromEuler(vector3<>(Random::uniform(0., 2*M_PI), acos(Random::uniform(-1., 1.)), Random::uniform(0., 2*M_PI)));
+	
+	ScalarFieldArray psi(nSites);
+	for(ScalarField& x: psi) { x = ScalarFieldData::alloc(gInfo); initRandom(x); }
+	
+	logPrintf("\nTranslations for %d orientations of %d sites on a %dx%dx%d grid (%d repetitions):\n",
+		nOrientations, nSites, gInfo.S[0], gInfo.S[1], gInfo.S[2], nRepeats);
+	logPrintf("%8s %16s %16s %16s %16s\n", "spline", "gather [ms]", "batched [ms]", "scatter [ms]", "batched [ms]");
+	for(int iSpline=0; iSpline<2; iSpline++)
+	{	TranslationOperatorSpline::SplineType splineType = iSpline ? TranslationOperatorSpline::Linear : TranslationOperatorSpline::Constant;
+		TranslationOperatorSpline trans(gInfo, splineType);
+		//Gather to orientations (as in getDensities_o) followed by scatter to sites (as in convertGradients_o):
+		double t[4]; double errGather=0., errScatter=0.;
+		ScalarFieldArray logPomegaRef, Phi_psiRef; //results of the unbatched path
+		for(int batched=0; batched<2; batched++)
+		{	double tGather=0., tScatter=0.;
+			ScalarFieldArray logPomega(nOrientations), Phi_psi(nSites);
+			for(int iRep=0; iRep<nRepeats; iRep++)
+			{	for(ScalarField& x: logPomega) x = 0;
+				for(ScalarField& y: Phi_psi) y = 0;
+				for(int oBatchStart=0; oBatchStart<nOrientations; oBatchStart+=oBatchSize)
+				{	int oBatchStop = std::min(oBatchStart+oBatchSize, nOrientations);
+					std::vector<TranslationOperator::Term> gatherTerms, scatterTerms;
+					for(int o=oBatchStart; o<oBatchStop; o++)
+						for(int i=0; i<nSites; i++)
+							for(const vector3<>& pos: positions[i])
+							{	gatherTerms.push_back(TranslationOperator::Term(-rot[o]*pos, 1., psi[i], logPomega[o]));
+								scatterTerms.push_back(TranslationOperator::Term(rot[o]*pos, 1., logPomega[o], Phi_psi[i]));
+							}
+					//Gather the sites to the orientation fields of this batch:
+					double tStart = clock_us();
+					if(batched) trans.taxpy(gatherTerms);
+					else for(const TranslationOperator::Term& term: gatherTerms) trans.taxpy(term.t, term.alpha, *term.x, *term.y);
+					tGather += clock_us() - tStart;
+					//Scatter the orientation fields of this batch back to the sites:
+					tStart = clock_us();
+					if(batched) trans.taxpy(scatterTerms);
+					else for(const TranslationOperator::Term& term: scatterTerms) trans.taxpy(term.t, term.alpha, *term.x, *term.y);
+					tScatter += clock_us() - tStart;
+				}
+			}
+			t[2*batched] = 1e-3*tGather/nRepeats;
+			t[2*batched+1] = 1e-3*tScatter/nRepeats;
+			//Compare batched results against the reference:
+			if(!batched) { logPomegaRef = clone(logPomega); Phi_psiRef = clone(Phi_psi); }
+			else
+			{	for(int o=0; o<nOrientations; o++) errGather = std::max(errGather, nrm2(logPomega[o]-logPomegaRef[o])/nrm2(logPomegaRef[o]));
+				for(int i=0; i<nSites; i++) errScatter = std::max(errScatter, nrm2(Phi_psi[i]-Phi_psiRef[i])/nrm2(Phi_psiRef[i]));
+			}
+		}
+		logPrintf("%8s %16.2lf %16.2lf %16.2lf %16.2lf\n", iSpline ? "Linear" : "Constant", t[0], t[2], t[1], t[3]);
+		logPrintf("%8s relative errors: gather %le, scatter %le (should be 0 within roundoff)\n", "", errGather, errScatter);
+	}
+	
+	finalizeSystem();
+	return 0;
+}
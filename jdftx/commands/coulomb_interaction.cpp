@@ -76,7 +76,11 @@ struct CommandCoulombInteraction : public Command
 			"maximum separation of L/2 in each truncated direction, where L is the\n"
 			"length of the unit cell in that direction or 2 Rc for Spherical and\n"
 			"Cylindrical modes. The center of the charge density is not important\n"
-			"and may cross unit cell boundaries.";
+			"and may cross unit cell boundaries.\n"
+			"\n"
+			"The numerical kernels of the Wire and Isolated modes (and of Wigner-Seitz\n"
+			"truncated exact exchange) are reused between runs if the environment variable\n"
+			"JDFTX_KERNEL_CACHE specifies a directory to cache them in.";
 		hasDefault = true;
 	}
 
@@ -181,6 +185,37 @@ struct CommandCoulombTruncationIonMargin : public Command
 commandCoulombTruncationIonMargin;
 
 
+EnumStringMap<CoulombParams::EwaldMethod> ewaldMethodMap
+(	CoulombParams::EwaldAuto,   "Auto",
+	CoulombParams::EwaldDirect, "Direct",
+	CoulombParams::EwaldMesh,   "Mesh"
+);
+
+struct CommandEwaldMethod : public Command
+{
+	CommandEwaldMethod() : Command("ewald-method", "jdftx/Coulomb interactions")
+	{
+		format = "<method>=" + ewaldMethodMap.optionList();
+		comments =
+			"Method for the reciprocal-space part of the Ewald sum in fully periodic geometries:\n"
+			"\n+ Auto: choose between Direct and Mesh based on estimated cost (default)\n"
+			"\n+ Direct: sum over reciprocal lattice vectors (cost ~ Natoms^2)\n"
+			"\n+ Mesh: smooth particle-mesh Ewald with B-spline charge assignment (cost ~ Natoms log Natoms)\n"
+			"\nBoth methods agree to near double precision; this is mainly for testing.";
+		hasDefault = true;
+	}
+
+	void process(ParamList& pl, Everything& e)
+	{	pl.get(e.coulombParams.ewaldMethod, CoulombParams::EwaldAuto, ewaldMethodMap, "method");
+	}
+
+	void printStatus(Everything& e, int iRep)
+	{	logPrintf("%s", ewaldMethodMap.getString(e.coulombParams.ewaldMethod));
+	}
+}
+commandEwaldMethod;
+
+
 struct CommandExchangeRegularization : public Command
 {
 	CommandExchangeRegularization() : Command("exchange-regularization", "jdftx/Coulomb interactions")
@@ -29,6 +29,8 @@ enum DebugOptions
 	DebugForces,
 	DebugSymmetries,
 	DebugFluid,
+	DebugStress,
+	DebugStressFD,
 	DebugDelim //delimiter to figure out end of input
 };
 
@@ -39,7 +41,9 @@ EnumStringMap<DebugOptions> debugMap
 	DebugKpointsBasis, "KpointsBasis",
 	DebugForces, "Forces",
 	DebugSymmetries, "Symmetries",
-	DebugFluid, "Fluid"
+	DebugFluid, "Fluid",
+	DebugStress, "Stress",
+	DebugStressFD, "StressFD"
 );
 
 EnumStringMap<DebugOptions> debugDescMap
@@ -49,7 +53,9 @@ EnumStringMap<DebugOptions> debugDescMap
 	DebugKpointsBasis, "List details of each k-point and corresponding basis",
 	DebugForces, "Print each contribution to the force separately (NL, loc etc.)",
 	DebugSymmetries, "Print various symmetry matrices during start up",
-	DebugFluid, "Enable verbose logging of fluid (iterations for Linear, even more for others)"
+	DebugFluid, "Enable verbose logging of fluid (iterations for Linear, even more for others)",
+	DebugStress, "Print each contribution to the analytic stress separately (KE, NL, loc etc.)",
+	DebugStressFD, "Compute stress by finite differences even when the analytic stress is available (for testing)"
 );
 
 struct CommandDebug : public Command
@@ -91,6 +97,12 @@ struct CommandDebug : public Command
 				case DebugFluid:
 					e.eVars.fluidParams.verboseLog = true;
 					break;
+				case DebugStress:
+					e.iInfo.shouldPrintStressComponents = true;
+					break;
+				case DebugStressFD:
+					e.iInfo.shouldUseFiniteDifferenceStress = true;
+					break;
 				case DebugDelim:
 					return; //end of input line
 			}
@@ -107,6 +119,8 @@ struct CommandDebug : public Command
 			if(e.iInfo.shouldPrintForceComponents) logPrintf(" Forces");
 			if(e.symm.shouldPrintMatrices) logPrintf("Symmetries");
 			if(e.eVars.fluidParams.verboseLog) logPrintf(" Fluid");
+			if(e.iInfo.shouldPrintStressComponents) logPrintf(" Stress");
+			if(e.iInfo.shouldUseFiniteDifferenceStress) logPrintf(" StressFD");
 		}
 	}
 }
@@ -25,6 +25,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <electronic/Vibrations.h>
 #include <electronic/Dump_internal.h>
 #include <core/Units.h>
+#include <core/CheckpointWriter.h>
 
 struct CommandDumpOnly : public Command
 {
@@ -259,6 +260,77 @@ struct CommandDumpInterval : public Command
 }
 commandDumpInterval;
 
+//-------------------------------------------------------------------------------------------------
+
+EnumStringMap<WfnsFormat> wfnsFormatMap
+(	WfnsFormatRaw, "Raw",
+	WfnsFormatChunked, "Chunked",
+	WfnsFormatChunkedSingle, "ChunkedSingle"
+);
+
+struct CommandDumpWfnsFormat : public Command
+{
+	CommandDumpWfnsFormat() : Command("dump-wfns-format", "jdftx/Output")
+	{
+		format = "<format>=" + wfnsFormatMap.optionList();
+		comments =
+			"File format for wavefunctions dumped as part of State:\n"
+			"+ Raw: headerless stream of coefficients for each state (default).\n"
+			"   Reading requires the same basis and number of bands, or conversion parameters\n"
+			"   specified in initial-state / wavefunction.\n"
+			"+ Chunked: self-describing format with a header, the G-vectors of each state\n"
+			"   and an index of per-state offsets. Each process writes and reads only its own\n"
+			"   states in parallel, so that restarts may use a different number of processes,\n"
+			"   number of bands or plane-wave cutoff without any conversion parameters.\n"
+			"+ ChunkedSingle: same as Chunked, with coefficients stored in single precision\n"
+			"   (half the size, adequate for restarting calculations).\n"
+			"\n"
+			"The format of wavefunction files is detected automatically while reading.";
+	}
+
+	void process(ParamList& pl, Everything& e)
+	{	pl.get(e.dump.wfnsFormat, WfnsFormatRaw, wfnsFormatMap, "format");
+	}
+
+	void printStatus(Everything& e, int iRep)
+	{	logPrintf("%s", wfnsFormatMap.getString(e.dump.wfnsFormat));
+	}
+}
+commandDumpWfnsFormat;
+
+
+struct CommandDumpAsync : public Command
+{
+	CommandDumpAsync() : Command("dump-async", "jdftx/Output")
+	{
+		format = "<async>=" + boolMap.optionList();
+		comments =
+			"Whether to write wavefunctions dumped as part of State at Electronic,\n"
+			"Fluid, Gummel or Ionic frequencies in the background (default: no).\n"
+			"The wavefunctions are copied to memory and written by a separate I/O thread\n"
+			"on each process, overlapping with the subsequent iterations, at the cost of\n"
+			"up to two additional copies of the wavefunctions in memory. All State files\n"
+			"of a checkpoint (wfns, fillings, eigenvals, fluidState, scfHistory, ionpos and lattice)\n"
+			"are written to <fname>.part and renamed to <fname> together once the wfns are\n"
+			"complete on all processes, so that an interrupted run leaves the State files of\n"
+			"a single complete checkpoint to restart from (unless interrupted during the renames).\n"
+			"The final (End) dump is always written synchronously.";
+		hasDefault = true;
+	}
+
+	void process(ParamList& pl, Everything& e)
+	{	bool async;
+		pl.get(async, false, boolMap, "async");
+		if(async) e.dump.checkpointWriter = std::make_shared<CheckpointWriter>();
+		else e.dump.checkpointWriter.reset();
+	}
+
+	void printStatus(Everything& e, int iRep)
+	{	logPrintf("%s", boolMap.getString(bool(e.dump.checkpointWriter)));
+	}
+}
+commandDumpAsync;
+
 
 struct CommandDumpName : public Command
 {
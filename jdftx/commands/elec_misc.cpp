@@ -122,6 +122,33 @@ commandDavidsonBandRatio;
 
 //-------------------------------------------------------------------------------------------------
 
+struct CommandLobpcgBlockSize : public Command
+{
+	CommandLobpcgBlockSize() : Command("lobpcg-block-size", "jdftx/Electronic/Optimization")
+	{
+		format = "[<size>=0]";
+		comments =
+			"Number of unconverged bands in each Rayleigh-Ritz block of the LOBPCG\n"
+			"eigenvalue algorithm (see elec-eigen-algo). Small blocks reduce the\n"
+			"subspace overhead (projected preconditioned CG), while the default 0\n"
+			"treats all unconverged bands in a single block (standard LOBPCG).";
+		hasDefault = true;
+	}
+
+	void process(ParamList& pl, Everything& e)
+	{	pl.get(e.cntrl.lobpcgBlockSize, 0, "size");
+		if(e.cntrl.lobpcgBlockSize < 0)
+			throw string("<size> must be non-negative");
+	}
+
+	void printStatus(Everything& e, int iRep)
+	{	logPrintf("%d", e.cntrl.lobpcgBlockSize);
+	}
+}
+commandLobpcgBlockSize;
+
+//-------------------------------------------------------------------------------------------------
+
 struct CommandLcaoParams : public Command
 {
 	CommandLcaoParams() : Command("lcao-params", "jdftx/Initialization")
@@ -279,27 +306,124 @@ commandWavefunctionDrag;
 
 //-------------------------------------------------------------------------------------------------
 
+struct CommandWavefunctionExtrapolation : public Command
+{
+	CommandWavefunctionExtrapolation() : Command("wavefunction-extrapolation", "jdftx/Ionic/Optimization")
+	{
+		format = "<nHistory>";
+		comments =
+			"Extrapolate wavefunctions to new ionic positions from the converged wavefunctions\n"
+			"of the last <nHistory> ionic steps (>= 2), or disable extrapolation if <nHistory> = 0 (default).\n"
+			"Previous wavefunctions are aligned to the latest ones by subspace rotations.\n"
+			"Molecular dynamics uses the always-stable predictor (ASPC) of Kolafa, while\n"
+			"relaxations use coefficients from a least-squares fit of the atomic positions.\n"
+			"When active, this replaces wavefunction-drag (which is still used till enough\n"
+			"history is available), typically reducing the electronic iterations per ionic step\n"
+			"substantially, at the cost of storing <nHistory> additional copies of the wavefunctions.\n"
+			"The history is discarded whenever the lattice changes, so this does not help\n"
+			"lattice minimization, in which every step changes the lattice.";
+		hasDefault = true;
+	}
+
+	void process(ParamList& pl, Everything& e)
+	{	pl.get(e.cntrl.wfnsHistory, 0, "nHistory");
+		if(e.cntrl.wfnsHistory<0 || e.cntrl.wfnsHistory==1)
+			throw string("<nHistory> must be 0 (disabled) or >= 2");
+	}
+
+	void printStatus(Everything& e, int iRep)
+	{	logPrintf("%d", e.cntrl.wfnsHistory);
+	}
+}
+commandWavefunctionExtrapolation;
+
+//-------------------------------------------------------------------------------------------------
+
 struct CommandCacheProjectors : public Command
 {
 	CommandCacheProjectors() : Command("cache-projectors", "jdftx/Miscellaneous")
 	{
-		format = "yes|no";
+		format = "yes|no [<maxMB>=0]";
 		comments =
-			"Cache nonlocal-pseudopotential projectors (yes by default); turn off to save memory.";
+			"Cache nonlocal-pseudopotential projectors (yes by default); turn off to save memory.\n"
+			"Only the atom-independent part (radial function times spherical harmonic) is cached,\n"
+			"per species, k-point and basis, and the structure factor of each atom is applied on the fly.\n"
+			"If <maxMB> is non-zero, the cache is limited to that many megabytes per process,\n"
+			"evicting the least-recently-used projectors when full (0 = unlimited, the default).";
 	}
 
 	void process(ParamList& pl, Everything& e)
 	{	pl.get(e.cntrl.cacheProjectors, true, boolMap, "shouldCache", true);
+		pl.get(e.cntrl.projectorCacheMB, 0., "maxMB");
+		if(e.cntrl.projectorCacheMB < 0.) throw string("<maxMB> must be non-negative");
 	}
 
 	void printStatus(Everything& e, int iRep)
-	{	logPrintf("%s", boolMap.getString(e.cntrl.cacheProjectors));
+	{	logPrintf("%s %lg", boolMap.getString(e.cntrl.cacheProjectors), e.cntrl.projectorCacheMB);
 	}
 }
 commandCacheProjectors;
 
 //-------------------------------------------------------------------------------------------------
 
+struct CommandFftPlanWarmup : public Command
+{
+	CommandFftPlanWarmup() : Command("fft-plan-warmup", "jdftx/Miscellaneous")
+	{
+		format = "yes|no";
+		comments =
+			"Create FFT plans for all transform types, expected thread counts and batch sizes\n"
+			"during setup (no by default), instead of on first use of each plan.\n"
+			"Combine with the environment variable JDFTX_FFTW_WISDOM, which specifies a file\n"
+			"that FFTW planning information is loaded from at startup and saved to at exit,\n"
+			"to reduce planning overhead for many short calculations.";
+	}
+
+	void process(ParamList& pl, Everything& e)
+	{	pl.get(e.cntrl.fftPlanWarmup, true, boolMap, "shouldWarmup", true);
+	}
+
+	void printStatus(Everything& e, int iRep)
+	{	logPrintf("%s", boolMap.getString(e.cntrl.fftPlanWarmup));
+	}
+}
+commandFftPlanWarmup;
+
+//-------------------------------------------------------------------------------------------------
+
+struct CommandRealSpaceProjectors : public Command
+{
+	CommandRealSpaceProjectors() : Command("real-space-projectors", "jdftx/Miscellaneous")
+	{
+		format = "yes|no [<tol>=1e-5]";
+		comments =
+			"Apply nonlocal-pseudopotential projectors in real space (no by default).\n"
+			"The projectors are filtered beyond the wavefunction cutoff, which leaves the\n"
+			"projections unchanged, and are then truncated to a sphere around each atom\n"
+			"outside which their relative norm is below <tol>^2. This reduces the cost and\n"
+			"memory of the nonlocal part from quadratic to linear in system size,\n"
+			"and is advantageous for large cells (several hundred atoms or more).\n"
+			"Projections are accurate to approximately <tol> relative to the reciprocal-space\n"
+			"version. Forces and stresses are still computed with the exact reciprocal-space\n"
+			"projectors, so they are derivatives of the energy only to within <tol>: tighten\n"
+			"<tol> for geometry optimization or dynamics. Available only for CPU runs.";
+	}
+
+	void process(ParamList& pl, Everything& e)
+	{	pl.get(e.cntrl.realSpaceProjectors, false, boolMap, "shouldUse", true);
+		pl.get(e.cntrl.realSpaceProjectorTol, 1e-5, "tol");
+		if(e.cntrl.realSpaceProjectorTol <= 0. || e.cntrl.realSpaceProjectorTol >= 1.)
+			throw string("<tol> must be in (0,1)");
+	}
+
+	void printStatus(Everything& e, int iRep)
+	{	logPrintf("%s %lg", boolMap.getString(e.cntrl.realSpaceProjectors), e.cntrl.realSpaceProjectorTol);
+	}
+}
+commandRealSpaceProjectors;
+
+//-------------------------------------------------------------------------------------------------
+
 struct CommandBasis : public Command
 {
 	CommandBasis() : Command("basis", "jdftx/Electronic/Parameters")
@@ -319,10 +443,36 @@ struct CommandBasis : public Command
 }
 commandBasis;
 
+//-------------------------------------------------------------------------------------------------
+
+struct CommandRealWavefunctions : public Command
+{
+	CommandRealWavefunctions() : Command("real-wavefunctions", "jdftx/Electronic/Parameters")
+	{
+		format = "yes|no";
+		comments =
+			"Constrain wavefunctions to be real in real space (no by default).\n"
+			"This is only valid for calculations that sample only the Gamma point,\n"
+			"without noncollinear magnetism or spin-orbit coupling. Local potential\n"
+			"and density FFTs are then performed on pairs of bands at a time, and\n"
+			"subspace overlaps use real matrix multiplies, roughly halving their cost.";
+		hasDefault = true;
+	}
+
+	void process(ParamList& pl, Everything& e)
+	{	pl.get(e.cntrl.realWfns, false, boolMap, "realWfns");
+	}
+
+	void printStatus(Everything& e, int iRep)
+	{	logPrintf("%s", boolMap.getString(e.cntrl.realWfns));
+	}
+}
+commandRealWavefunctions;
+
 
 //-------------------------------------------------------------------------------------------------
 
-static EnumStringMap<ElecEigenAlgo> elecEigenMap(ElecEigenCG, "CG", ElecEigenDavidson, "Davidson");
+static EnumStringMap<ElecEigenAlgo> elecEigenMap(ElecEigenCG, "CG", ElecEigenDavidson, "Davidson", ElecEigenLOBPCG, "LOBPCG");
 
 struct CommandElecEigenAlgo : public Command
 {
@@ -24,7 +24,9 @@ EnumStringMap<MinimizeParams::DirectionUpdateScheme> dirUpdateMap
 	MinimizeParams::FletcherReeves, "FletcherReeves",
 	MinimizeParams::HestenesStiefel, "HestenesStiefel",
 	MinimizeParams::LBFGS, "L-BFGS",
-	MinimizeParams::SteepestDescent, "SteepestDescent"
+	MinimizeParams::SteepestDescent, "SteepestDescent",
+	MinimizeParams::FIRE, "FIRE",
+	MinimizeParams::NewtonCG, "NewtonCG"
 );
 
 EnumStringMap<MinimizeParams::LinminMethod> linminMap
@@ -34,12 +36,18 @@ EnumStringMap<MinimizeParams::LinminMethod> linminMap
 	MinimizeParams::CubicWolfe, "CubicWolfe"
 );
 
+EnumStringMap<MinimizeParams::Preconditioner> preconditionerMap
+(	MinimizeParams::PreconditionerDefault, "Default",
+	MinimizeParams::PreconditionerExp, "Exp"
+);
+
 //An enum entry for each configurable option of MinimizeParams
 enum MinimizeParamsMember
 {	MPM_dirUpdateScheme,
 	MPM_linminMethod,
 	MPM_nIterations,
 	MPM_history,
+	MPM_nRecycle,
 	MPM_knormThreshold,
 	MPM_energyDiffThreshold,
 	MPM_nEnergyDiff,
@@ -52,6 +60,7 @@ enum MinimizeParamsMember
 	MPM_wolfeEnergy,
 	MPM_wolfeGradient,
 	MPM_fdTest,
+	MPM_preconditioner,
 	MPM_Delim //!< delimiter to detect end of input
 };
 
@@ -60,6 +69,7 @@ EnumStringMap<MinimizeParamsMember> mpmMap
 	MPM_linminMethod, "linminMethod",
 	MPM_nIterations, "nIterations",
 	MPM_history, "history",
+	MPM_nRecycle, "nRecycle",
 	MPM_knormThreshold, "knormThreshold",
 	MPM_energyDiffThreshold, "energyDiffThreshold",
 	MPM_nEnergyDiff, "nEnergyDiff",
@@ -71,13 +81,15 @@ EnumStringMap<MinimizeParamsMember> mpmMap
 	MPM_nAlphaAdjustMax, "nAlphaAdjustMax",
 	MPM_wolfeEnergy, "wolfeEnergy",
 	MPM_wolfeGradient, "wolfeGradient",
-	MPM_fdTest, "fdTest"
+	MPM_fdTest, "fdTest",
+	MPM_preconditioner, "preconditioner"
 );
 EnumStringMap<MinimizeParamsMember> mpmDescMap
 (	MPM_dirUpdateScheme, dirUpdateMap.optionList() + " (search direction method)",
 	MPM_linminMethod, linminMap.optionList() + " (line minimization method)",
 	MPM_nIterations, "maximum iterations (single point calculation if 0)",
 	MPM_history, "number of past states and gradients retained for L-BFGS",
+	MPM_nRecycle, "number of Krylov subspace vectors recycled between successive linear solves (eg. LinearPCM and SaLSA fluids; 0 to disable)",
 	MPM_knormThreshold, "convergence threshold for gradient (preconditioned) norm",
 	MPM_energyDiffThreshold, "convergence threshold for energy difference between successive iterations",
 	MPM_nEnergyDiff, "number of iteration pairs that must satisfy energyDiffThreshold",
@@ -89,7 +101,8 @@ EnumStringMap<MinimizeParamsMember> mpmDescMap
 	MPM_nAlphaAdjustMax, "maximum step-size adjustments per linmin",
 	MPM_wolfeEnergy, "dimensionless energy threshold for Wolfe linmin stopping criterion",
 	MPM_wolfeGradient, "dimensionless gradient threshold for Wolfe linmin stopping criterion",
-	MPM_fdTest, boolMap.optionList() + ", whether to perform a finite difference test"
+	MPM_fdTest, boolMap.optionList() + ", whether to perform a finite difference test",
+	MPM_preconditioner, preconditionerMap.optionList() + " (Exp: connectivity-based preconditioner from atom positions, ionic minimization only)"
 );
 
 
@@ -112,6 +125,7 @@ void CommandMinimize::process(ParamList& pl, Everything& e)
 			case MPM_linminMethod: pl.get(mp.linminMethod, MinimizeParams::Quad, linminMap, "linminMethod", true); break;
 			case MPM_nIterations: pl.get(mp.nIterations, 0, "nIterations", true); break;
 			case MPM_history: pl.get(mp.history, 0, "history", true); break;
+			case MPM_nRecycle: pl.get(mp.nRecycle, 0, "nRecycle", true); break;
 			case MPM_knormThreshold: pl.get(mp.knormThreshold, 0., "knormThreshold", true); break;
 			case MPM_energyDiffThreshold: pl.get(mp.energyDiffThreshold, 0., "energyDiffThreshold", true); break;
 			case MPM_nEnergyDiff: pl.get(mp.nEnergyDiff, 0, "nEnergyDiff", true); break;
@@ -124,6 +138,7 @@ void CommandMinimize::process(ParamList& pl, Everything& e)
 			case MPM_wolfeEnergy: pl.get(mp.wolfeEnergy, 0., "wolfeEnergy", true); break;
 			case MPM_wolfeGradient: pl.get(mp.wolfeGradient, 0., "wolfeGradient", true); break;
 			case MPM_fdTest: pl.get(mp.fdTest, false, boolMap, "fdTest", true); break;
+			case MPM_preconditioner: pl.get(mp.preconditioner, MinimizeParams::PreconditionerDefault, preconditionerMap, "preconditioner", true); break;
 			case MPM_Delim: return; //end of input
 		}
 	}
@@ -135,6 +150,7 @@ void CommandMinimize::printStatus(Everything& e, int iRep)
 	logPrintf(" \\\n\tlinminMethod         %s", linminMap.getString(mp.linminMethod));
 	logPrintf(" \\\n\tnIterations          %d", mp.nIterations);
 	logPrintf(" \\\n\thistory              %d", mp.history);
+	logPrintf(" \\\n\tnRecycle             %d", mp.nRecycle);
 	logPrintf(" \\\n\tknormThreshold       %lg", mp.knormThreshold);
 	logPrintf(" \\\n\tenergyDiffThreshold  %lg", mp.energyDiffThreshold);
 	logPrintf(" \\\n\tnEnergyDiff          %d", mp.nEnergyDiff);
@@ -147,6 +163,7 @@ void CommandMinimize::printStatus(Everything& e, int iRep)
 	logPrintf(" \\\n\twolfeEnergy          %lg", mp.wolfeEnergy);
 	logPrintf(" \\\n\twolfeGradient        %lg", mp.wolfeGradient);
 	logPrintf(" \\\n\tfdTest               %s", boolMap.getString(mp.fdTest));
+	logPrintf(" \\\n\tpreconditioner       %s", preconditionerMap.getString(mp.preconditioner));
 }
 
 
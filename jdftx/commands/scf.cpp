@@ -106,7 +106,9 @@ enum SCFparamsMember
 	SCFpm_qKerker,
 	SCFpm_qKappa,
 	SCFpm_verbose,
-	SCFpm_mixFractionMag
+	SCFpm_mixFractionMag,
+	SCFpm_rmmDiisStart,
+	SCFpm_rmmDiisSteps
 };
 
 EnumStringMap<SCFparamsMember> scfParamsMap
@@ -116,7 +118,9 @@ EnumStringMap<SCFparamsMember> scfParamsMap
 	SCFpm_qKerker, "qKerker",
 	SCFpm_qKappa, "qKappa",
 	SCFpm_verbose, "verbose",
-	SCFpm_mixFractionMag, "mixFractionMag"
+	SCFpm_mixFractionMag, "mixFractionMag",
+	SCFpm_rmmDiisStart, "rmmDiisStart",
+	SCFpm_rmmDiisSteps, "rmmDiisSteps"
 );
 EnumStringMap<SCFparamsMember> scfParamsDescMap
 (	SCFpm_nEigSteps, "number of eigenvalue steps per iteration (if 0, limited by electronic-minimize nIterations)",
@@ -125,7 +129,9 @@ EnumStringMap<SCFparamsMember> scfParamsDescMap
 	SCFpm_qKerker, "wavevector controlling Kerker preconditioning (default: 0.8 bohr^-1)",
 	SCFpm_qKappa, "wavevector for long-range damping. If negative (default), set to zero or fluid Debye wavevector as appropriate",
 	SCFpm_verbose, "whether the inner eigenvalue solver will print or not",
-	SCFpm_mixFractionMag, "mix fraction for magnetization density / potential (default 1.5)"
+	SCFpm_mixFractionMag, "mix fraction for magnetization density / potential (default 1.5)",
+	SCFpm_rmmDiisStart, "number of SCF iterations after which bands are refined by RMM-DIIS instead of elec-eigen-algo (default 0: never)",
+	SCFpm_rmmDiisSteps, "number of RMM-DIIS residual-minimization steps per band in each iteration (default 3)"
 );
 
 EnumStringMap<SCFparams::MixedVariable> scfMixing
@@ -168,6 +174,8 @@ struct CommandElectronicScf: public CommandPulay
 				case SCFpm_qKappa: pl.get(sp.qKappa, -1., "qKappa", true); break;
 				case SCFpm_verbose: pl.get(sp.verbose, false, boolMap, "verbose", true); break;
 				case SCFpm_mixFractionMag: pl.get(sp.mixFractionMag, 1.5, "mixFractionMag", true); break;
+				case SCFpm_rmmDiisStart: pl.get(sp.rmmDiisStart, 0, "rmmDiisStart", true); if(sp.rmmDiisStart<0) throw string("<rmmDiisStart> must be >= 0"); break;
+				case SCFpm_rmmDiisSteps: pl.get(sp.rmmDiisSteps, 3, "rmmDiisSteps", true); if(sp.rmmDiisSteps<1) throw string("<rmmDiisSteps> must be >= 1"); break;
 			}
 		}
 		else throw string("Parameter <key> must be one of " + pulayParamsMap.optionList() + "|" + scfParamsMap.optionList());
@@ -184,6 +192,8 @@ struct CommandElectronicScf: public CommandPulay
 		PRINT(qKappa, %lg)
 		logPrintf(" \\\n\tverbose\t%s", boolMap.getString(sp.verbose));
 		PRINT(mixFractionMag, %lg)
+		PRINT(rmmDiisStart, %i)
+		PRINT(rmmDiisSteps, %i)
 		#undef PRINT
 	}
 }
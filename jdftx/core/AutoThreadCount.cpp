@@ -42,6 +42,10 @@ int nProcsAvailable = getPhysicalCores();
 bool threadOperators = true;
 
 bool shouldThreadOperators()
+{	return threadOperators && !ThreadPool::inParallelSection();
+}
+
+bool threadLaunchEnabled()
 {	return threadOperators;
 }
 
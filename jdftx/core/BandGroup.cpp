@@ -0,0 +1,407 @@
+/*-------------------------------------------------------------------
+Copyright 2026 agent
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#include <core/BandGroup.h>
+#include <core/BlasExtra.h>
+#include <core/ManagedMemory.h>
+#include <core/Thread.h>
+#include <core/Util.h>
+#include <memory>
+#include <algorithm>
+#include <mutex>
+#include <list>
+#include <map>
+
+BandGroup::BandGroup(const GridInfo& gInfo, size_t nbasis, const int* index, const int* indexMinus)
+: gInfo(gInfo), nbasis(nbasis), index(index), indexMinus(indexMinus)
+{
+}
+
+int BandGroup::nGridsBatch()
+{	return std::max(1, std::min(nGridsMax, nGridsScratchMax/nProcsAvailable));
+}
+
+bool BandGroup::active()
+{	return mpiGroup && mpiGroup->nProcesses()>1;
+}
+
+int BandGroup::colStart(int iProc, int nProcs, int nCols) const
+{	if(indexMinus) return std::min(nCols, 2*((iProc*ceildiv(nCols,2))/nProcs)); //keep pairs together
+	else return (iProc*nCols)/nProcs;
+}
+
+//---------------- Batched transforms ------------------
+
+void BandGroup::transformInPlace(GridInfo::PlanType planType, int howMany, complex* buf) const
+{	if(howMany == nGridsBatch())
+		fftw_execute_dft(gInfo.getPlan(planType, 1, howMany), (fftw_complex*)buf, (fftw_complex*)buf);
+	else //partial batch: transform grids individually (avoids planning for every batch size)
+	{	fftw_plan plan = gInfo.getPlan(planType, 1);
+		for(int iGrid=0; iGrid<howMany; iGrid++)
+		{	fftw_complex* data = (fftw_complex*)(buf + size_t(gInfo.nr)*iGrid);
+			fftw_execute_dft(plan, data, data);
+		}
+	}
+}
+
+void BandGroup::toRealSpace(int nCols, const complex* C, complex* buf) const
+{	int howMany = nGrids(nCols);
+	eblas_zero(size_t(gInfo.nr)*howMany, buf);
+	for(int col=0; col<nCols; col++)
+	{	complex alpha = (indexMinus && col%2) ? complex(0,1) : complex(1,0); //second column of a real pair goes into the imaginary part
+		int iGrid = indexMinus ? col/2 : col;
+		eblas_scatter_zaxpy(nbasis, alpha, index, C+col*nbasis, buf+size_t(gInfo.nr)*iGrid);
+	}
+	transformInPlace(GridInfo::PlanInverseInPlace, howMany, buf);
+}
+
+void BandGroup::accumFromRealSpace(int nCols, complex* buf, double alpha, complex* Y) const
+{	int howMany = nGrids(nCols);
+	transformInPlace(GridInfo::PlanForwardInPlace, howMany, buf);
+	if(indexMinus)
+	{	//Separate the transforms of the real and imaginary parts using W(-G) = W*(G) for each:
+		for(int col=0; col<nCols; col+=2)
+		{	const complex* W = buf + size_t(gInfo.nr)*(col/2);
+			complex* Ya = Y + col*nbasis;
+			complex* Yb = (col+1<nCols) ? Ya+nbasis : 0;
+			for(size_t n=0; n<nbasis; n++)
+			{	complex Wp = W[index[n]], WmConj = W[index[indexMinus[n]]].conj();
+				Ya[n] += (0.5*alpha) * (Wp + WmConj);
+				if(Yb) Yb[n] += (0.5*alpha) * complex(0,-1) * (Wp - WmConj);
+			}
+		}
+	}
+	else
+	{	for(int col=0; col<nCols; col++)
+			eblas_gather_zdaxpy(nbasis, alpha, index, buf+size_t(gInfo.nr)*col, Y+col*nbasis);
+	}
+}
+
+//---------------- Thread-level division ------------------
+
+void BandGroup::Idag_DiagV_I_sub(size_t iStart, size_t iStop, const BandGroup* bg, int nCols, const complex* C, const double* V, double alpha, complex* Y)
+{	//Convert job range (pairs of columns if packed) to column range:
+	int unit = bg->indexMinus ? 2 : 1;
+	int colStart = iStart*unit;
+	int colStop = std::min(nCols, int(iStop*unit));
+	//Scatter, transform, multiply and transform back in batches of columns, reusing one scratch buffer:
+	int nr = bg->gInfo.nr;
+	int batchSize = bg->batchSize();
+	ManagedArray<complex> buf; buf.init(size_t(nr) * bg->nGrids(std::min(colStop-colStart, batchSize)));
+	for(int batchStart=colStart; batchStart<colStop; batchStart+=batchSize)
+	{	int batchCols = std::min(batchSize, colStop-batchStart);
+		bg->toRealSpace(batchCols, C+batchStart*bg->nbasis, buf.data());
+		for(int iGrid=0; iGrid<bg->nGrids(batchCols); iGrid++)
+			eblas_zmuld(nr, V, 1, buf.data()+size_t(nr)*iGrid, 1);
+		bg->accumFromRealSpace(batchCols, buf.data(), alpha, Y+batchStart*bg->nbasis);
+	}
+}
+
+void BandGroup::diagouterI_sub(int iThread, int nThreads, const BandGroup* bg, int nCols, const complex* C, const double* F, std::vector<double>* nSub)
+{	//Determine column range:
+	int colStart = bg->colStart(iThread, nThreads, nCols);
+	int colStop = bg->colStart(iThread+1, nThreads, nCols);
+	double* nData = nSub[iThread].data();
+	//Transform batches of columns to real space together, reusing one scratch buffer:
+	int nr = bg->gInfo.nr;
+	int batchSize = bg->batchSize();
+	ManagedArray<complex> buf; buf.init(size_t(nr) * bg->nGrids(std::min(colStop-colStart, batchSize)));
+	for(int batchStart=colStart; batchStart<colStop; batchStart+=batchSize)
+	{	int batchCols = std::min(batchSize, colStop-batchStart);
+		bg->toRealSpace(batchCols, C+batchStart*bg->nbasis, buf.data());
+		if(bg->indexMinus) //pairs of real columns packed as real and imaginary parts:
+		{	for(int i=0; i<batchCols; i+=2)
+			{	const complex* psi = buf.data() + size_t(nr)*(i/2);
+				double Fa = F[batchStart+i], Fb = (i+1<batchCols) ? F[batchStart+i+1] : 0.;
+				for(int r=0; r<nr; r++)
+					nData[r] += Fa*std::pow(psi[r].real(),2) + Fb*std::pow(psi[r].imag(),2);
+			}
+		}
+		else
+		{	for(int i=0; i<batchCols; i++)
+				eblas_accumNorm(nr, F[batchStart+i], buf.data()+size_t(nr)*i, nData);
+		}
+	}
+}
+
+void BandGroup::Idag_DiagV_I_local(int nCols, const complex* C, const double* V, double alpha, complex* Y) const
+{	if(!nCols) return;
+	threadLaunch(Idag_DiagV_I_sub, indexMinus ? ceildiv(nCols,2) : nCols, this, nCols, C, V, alpha, Y);
+}
+
+void BandGroup::diagouterI_local(int nCols, const complex* C, const double* F, double* n) const
+{	if(!nCols) return;
+	//Collect the contributions for different sets of columns in separate arrays (one per thread):
+	int nThreads = std::max(1, std::min(nProcsAvailable, nGrids(nCols)));
+	std::vector<std::vector<double>> nSub(nThreads, std::vector<double>(gInfo.nr, 0.));
+	threadLaunch(nThreads, diagouterI_sub, 0, this, nCols, C, F, nSub.data());
+	for(const std::vector<double>& nSubThread: nSub)
+		eblas_daxpy(gInfo.nr, 1., nSubThread.data(), 1, n, 1);
+}
+
+//---------------- Process-level division ------------------
+
+#ifdef MPI_ENABLED
+//Request types and message tags used between the group head and the other processes of mpiGroup:
+enum BandGroupOp { BandGroupQuit, BandGroupIdagDiagVI, BandGroupDiagouterI };
+static const int tagHeader=1, tagInput=2, tagOutput=3;
+static const int nHeader = 6; //op, nCols, basis id, basis data length (0 if cached), potential id (-1 if unused), whether potential is sent
+static const size_t basisCacheSize = size_t(1)<<24; //ints of basis data (64 MB) cached on each process
+static const size_t nVcache = 4; //number of potentials cached on each process
+
+//Least-recently-used set of ids (with sizes) of data cached on a process of the group.
+//The head keeps a mirror of this set for each other process, updated identically on
+//both sides for each request, so that it knows which data needs to be resent.
+class BandGroupLRU
+{	std::list<std::pair<int,size_t>> entries; //id and size, most recently used first
+	size_t capacity, sizeTot;
+public:
+	BandGroupLRU(size_t capacity=0) : capacity(capacity), sizeTot(0) {}
+	
+	//Mark id as used and return whether it was already present; evicted lists ids dropped to make room
+	bool use(int id, size_t size, std::vector<int>& evicted)
+	{	evicted.clear();
+		bool found = false;
+		for(auto iter=entries.begin(); iter!=entries.end(); iter++)
+			if(iter->first == id)
+			{	entries.splice(entries.begin(), entries, iter); //move to front
+				found = true;
+				break;
+			}
+		if(!found)
+		{	entries.push_front(std::make_pair(id, size));
+			sizeTot += size;
+			while(sizeTot > capacity && entries.size() > 1)
+			{	evicted.push_back(entries.back().first);
+				sizeTot -= entries.back().second;
+				entries.pop_back();
+			}
+		}
+		return found;
+	}
+};
+
+//Generation ids of data on the group head: a new id is assigned whenever the contents at a given location change
+template<typename T> class BandGroupGenerations
+{	struct Entry { const void* key; std::vector<T> data; int id; };
+	std::list<Entry> entries; //most recently used first
+	size_t capacity;
+	int nextId;
+public:
+	BandGroupGenerations(size_t capacity) : capacity(capacity), nextId(0) {}
+	
+	int get(const void* key, const T* data, size_t n)
+	{	for(auto iter=entries.begin(); iter!=entries.end(); iter++)
+			if(iter->key == key)
+			{	if(iter->data.size()==n && std::equal(data, data+n, iter->data.begin()))
+				{	entries.splice(entries.begin(), entries, iter); //unchanged: move to front
+					return entries.front().id;
+				}
+				entries.erase(iter); //contents changed
+				break;
+			}
+		entries.push_front(Entry{key, std::vector<T>(data, data+n), nextId++});
+		if(entries.size() > capacity) entries.pop_back();
+		return entries.front().id;
+	}
+};
+
+//State of the group head for communicating with the other processes:
+struct BandGroupHead
+{	std::mutex lock; //serializes requests, since head threads may issue them concurrently (MPI is not initialized for multi-threaded use)
+	BandGroupGenerations<int> basisGenerations;
+	BandGroupGenerations<double> Vgenerations;
+	std::vector<BandGroupLRU> basisCached, Vcached; //mirrors of the caches on each process of the group
+	
+	BandGroupHead()
+	: basisGenerations(nVcache*16), Vgenerations(nVcache),
+		basisCached(mpiGroup->nProcesses(), BandGroupLRU(basisCacheSize)),
+		Vcached(mpiGroup->nProcesses(), BandGroupLRU(nVcache))
+	{
+	}
+	
+	//Send the header for a request to process jProc, along with the basis data and potential unless already cached there:
+	void sendHeader(BandGroupOp op, int nCols, int basisId, const std::vector<int>& basisData, int Vid, const double* V, int nr, int jProc)
+	{	std::vector<int> evicted;
+		bool basisSent = !basisCached[jProc].use(basisId, basisData.size(), evicted);
+		bool Vsent = (Vid >= 0) && !Vcached[jProc].use(Vid, 1, evicted);
+		int header[nHeader] = { op, nCols, basisId, basisSent ? int(basisData.size()) : 0, Vid, Vsent ? 1 : 0 };
+		mpiGroup->send(header, nHeader, jProc, tagHeader);
+		if(basisSent) mpiGroup->send(basisData.data(), basisData.size(), jProc, tagInput);
+		if(Vsent) mpiGroup->send(V, nr, jProc, tagInput);
+	}
+};
+
+inline BandGroupHead& getBandGroupHead()
+{	static BandGroupHead head;
+	return head;
+}
+
+//Basis description sent to the other processes: S[0..2], whether paired, nbasis, index and indexMinus (if paired)
+std::vector<int> BandGroup::basisData() const
+{	std::vector<int> data = { gInfo.S[0], gInfo.S[1], gInfo.S[2], indexMinus ? 1 : 0, int(nbasis) };
+	data.insert(data.end(), index, index+nbasis);
+	if(indexMinus) data.insert(data.end(), indexMinus, indexMinus+nbasis);
+	return data;
+}
+#endif
+
+void BandGroup::Idag_DiagV_I(int nCols, const complex* C, const double* V, double alpha, complex* Y) const
+{	if(!active()) { Idag_DiagV_I_local(nCols, C, V, alpha, Y); return; }
+	#ifdef MPI_ENABLED
+	BandGroupHead& head = getBandGroupHead();
+	std::lock_guard<std::mutex> lock(head.lock);
+	std::vector<int> basisData = this->basisData();
+	int basisId = head.basisGenerations.get(index, basisData.data(), basisData.size());
+	int Vid = head.Vgenerations.get(V, V, gInfo.nr);
+	int nProcs = mpiGroup->nProcesses();
+	//Send column subsets to the other processes of the group:
+	for(int jProc=1; jProc<nProcs; jProc++)
+	{	int jStart = colStart(jProc, nProcs, nCols), jCols = colStart(jProc+1, nProcs, nCols) - jStart;
+		if(!jCols) continue;
+		head.sendHeader(BandGroupIdagDiagVI, jCols, basisId, basisData, Vid, V, gInfo.nr, jProc);
+		mpiGroup->send(C+jStart*nbasis, jCols*nbasis, jProc, tagInput);
+		mpiGroup->send(alpha, jProc, tagInput);
+	}
+	//Process own subset:
+	Idag_DiagV_I_local(colStart(1, nProcs, nCols), C, V, alpha, Y);
+	//Collect results from the other processes:
+	std::vector<complex> Yj;
+	for(int jProc=1; jProc<nProcs; jProc++)
+	{	int jStart = colStart(jProc, nProcs, nCols), jCols = colStart(jProc+1, nProcs, nCols) - jStart;
+		if(!jCols) continue;
+		Yj.resize(jCols*nbasis);
+		mpiGroup->recv(Yj.data(), Yj.size(), jProc, tagOutput);
+		eblas_zaxpy(Yj.size(), 1., Yj.data(), 1, Y+jStart*nbasis, 1);
+	}
+	#endif
+}
+
+void BandGroup::diagouterI(int nCols, const complex* C, const double* F, double* n) const
+{	if(!active()) { diagouterI_local(nCols, C, F, n); return; }
+	#ifdef MPI_ENABLED
+	BandGroupHead& head = getBandGroupHead();
+	std::lock_guard<std::mutex> lock(head.lock);
+	std::vector<int> basisData = this->basisData();
+	int basisId = head.basisGenerations.get(index, basisData.data(), basisData.size());
+	int nProcs = mpiGroup->nProcesses();
+	//Send column subsets to the other processes of the group:
+	for(int jProc=1; jProc<nProcs; jProc++)
+	{	int jStart = colStart(jProc, nProcs, nCols), jCols = colStart(jProc+1, nProcs, nCols) - jStart;
+		if(!jCols) continue;
+		head.sendHeader(BandGroupDiagouterI, jCols, basisId, basisData, -1, 0, gInfo.nr, jProc);
+		mpiGroup->send(C+jStart*nbasis, jCols*nbasis, jProc, tagInput);
+		mpiGroup->send(F+jStart, jCols, jProc, tagInput);
+	}
+	//Process own subset:
+	diagouterI_local(colStart(1, nProcs, nCols), C, F, n);
+	//Collect results from the other processes:
+	std::vector<double> nj(gInfo.nr);
+	for(int jProc=1; jProc<nProcs; jProc++)
+	{	int jStart = colStart(jProc, nProcs, nCols), jCols = colStart(jProc+1, nProcs, nCols) - jStart;
+		if(!jCols) continue;
+		mpiGroup->recv(nj.data(), nj.size(), jProc, tagOutput);
+		eblas_daxpy(nj.size(), 1., nj.data(), 1, n, 1);
+	}
+	#endif
+}
+
+void BandGroup::serve()
+{
+	#ifdef MPI_ENABLED
+	std::map<std::tuple<int,int,int>, std::shared_ptr<GridInfo>> gInfoMap; //grids (used only for their FFT plans) by sample count
+	std::map<int, std::vector<int>> basisMap; //cached basis data by id (see basisData())
+	std::map<int, std::vector<double>> Vmap; //cached potentials by id
+	BandGroupLRU basisCached(basisCacheSize), Vcached(nVcache); //mirrored on the group head
+	std::vector<int> evicted;
+	while(true)
+	{	int header[nHeader];
+		mpiGroup->recv(header, nHeader, 0, tagHeader);
+		BandGroupOp op = BandGroupOp(header[0]);
+		if(op == BandGroupQuit) break;
+		int nCols = header[1];
+		//Get basis (received only if not already cached):
+		int basisId = header[2], nBasisData = header[3];
+		bool basisFound = basisCached.use(basisId, nBasisData ? nBasisData : basisMap[basisId].size(), evicted);
+		for(int id: evicted) basisMap.erase(id);
+		std::vector<int>& basisData = basisMap[basisId];
+		if(nBasisData)
+		{	basisData.resize(nBasisData);
+			mpiGroup->recv(basisData.data(), nBasisData, 0, tagInput);
+		}
+		else if(!basisFound) die_alone("Band-group basis %d not cached on process %d.\n", basisId, mpiGroup->iProcess());
+		std::shared_ptr<GridInfo>& gInfo = gInfoMap[std::make_tuple(basisData[0], basisData[1], basisData[2])];
+		if(!gInfo)
+		{	gInfo = std::make_shared<GridInfo>();
+			for(int k=0; k<3; k++) gInfo->S[k] = basisData[k];
+			gInfo->nr = gInfo->S[0] * gInfo->S[1] * gInfo->S[2];
+		}
+		bool paired = basisData[3];
+		size_t nbasis = basisData[4];
+		const int* index = basisData.data() + 5;
+		BandGroup bg(*gInfo, nbasis, index, paired ? index+nbasis : 0);
+		//Get columns:
+		std::vector<complex> C(nCols*nbasis);
+		mpiGroup->recv(C.data(), C.size(), 0, tagInput);
+		//Perform requested operation and return result:
+		switch(op)
+		{	case BandGroupIdagDiagVI:
+			{	//Get potential (received only if not already cached):
+				int Vid = header[4]; bool Vsent = header[5];
+				bool Vfound = Vcached.use(Vid, 1, evicted);
+				for(int id: evicted) Vmap.erase(id);
+				std::vector<double>& V = Vmap[Vid];
+				if(Vsent)
+				{	V.resize(gInfo->nr);
+					mpiGroup->recv(V.data(), V.size(), 0, tagInput);
+				}
+				else if(!Vfound) die_alone("Band-group potential %d not cached on process %d.\n", Vid, mpiGroup->iProcess());
+				double alpha;
+				mpiGroup->recv(alpha, 0, tagInput);
+				std::vector<complex> Y(C.size(), 0.);
+				bg.Idag_DiagV_I_local(nCols, C.data(), V.data(), alpha, Y.data());
+				mpiGroup->send(Y.data(), Y.size(), 0, tagOutput);
+				break;
+			}
+			case BandGroupDiagouterI:
+			{	std::vector<double> F(nCols), n(gInfo->nr, 0.);
+				mpiGroup->recv(F.data(), nCols, 0, tagInput);
+				bg.diagouterI_local(nCols, C.data(), F.data(), n.data());
+				mpiGroup->send(n.data(), n.size(), 0, tagOutput);
+				break;
+			}
+			default:
+				die_alone("Unknown band-group request %d received from group head.\n", int(op));
+		}
+	}
+	//Synchronize with quit() on the group head (so that the group communicator is freed collectively):
+	int done = 1; mpiGroup->allReduce(done, MPIUtil::ReduceSum);
+	#endif
+}
+
+void BandGroup::quit()
+{	if(!active()) return;
+	#ifdef MPI_ENABLED
+	int header[nHeader] = { BandGroupQuit, 0, 0, 0, -1, 0 };
+	for(int jProc=1; jProc<mpiGroup->nProcesses(); jProc++)
+		mpiGroup->send(header, nHeader, jProc, tagHeader);
+	//Synchronize with the return of serve() on the other processes:
+	int done = 1; mpiGroup->allReduce(done, MPIUtil::ReduceSum);
+	#endif
+}
@@ -0,0 +1,82 @@
+/*-------------------------------------------------------------------
+Copyright 2026 agent
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#ifndef JDFTX_CORE_BANDGROUP_H
+#define JDFTX_CORE_BANDGROUP_H
+
+#include <core/GridInfo.h>
+
+//! @addtogroup Utilities
+//! @{
+
+//! @file BandGroup.h Band-level parallelization of wavefunction transforms within a group of processes
+
+/** @brief Batched real-space transforms of wavefunction columns (CPU only)
+
+The columns are vectors on a subset (the basis) of the full G-space grid, stored contiguously.
+The columns are divided between the processes of #mpiGroup: the group head (which runs the
+calculation as a process of #mpiUtil) sends the columns to the remaining processes of its group,
+which wait in serve() and return their contribution to the result (see command-line option -G).
+The basis and potential are cached on those processes (keyed by generation ids assigned by the head
+whenever their contents change), so that typically only the columns are sent with each request.
+Requests from concurrent threads of the head are serialized, since MPI is not initialized for threaded use.
+Within each process, the columns are divided between threads and transformed in batches.
+*/
+class BandGroup
+{
+public:
+	//! Describe the basis of the columns: index is the full-grid index of each of the nbasis G-vectors.
+	//! If indexMinus (the basis location of -G for each G) is non-null, the columns are assumed
+	//! real in real space, and pairs of columns are packed as real and imaginary parts of each transform.
+	BandGroup(const GridInfo& gInfo, size_t nbasis, const int* index, const int* indexMinus=0);
+
+	void Idag_DiagV_I(int nCols, const complex* C, const double* V, double alpha, complex* Y) const; //!< Y += alpha Idag(V I(C)) for nCols columns C, Y and real-space potential V
+	void diagouterI(int nCols, const complex* C, const double* F, double* n) const; //!< n += sum_i F_i |I(C_i)|^2 for nCols columns C, with F_i the i^th entry of F
+
+	static int nGridsBatch(); //!< number of grids transformed together in each batch (fixed for the run, so that only one batched plan is needed per direction)
+	static bool active(); //!< whether mpiGroup has processes other than the head to share the work
+	static void serve(); //!< serve transform requests from the group head (called on all other processes of mpiGroup, returns once the head calls quit())
+	static void quit(); //!< release the other processes of mpiGroup from serve() (called by the group head at exit; returns once all have left serve())
+
+private:
+	const GridInfo& gInfo;
+	size_t nbasis;
+	const int* index;
+	const int* indexMinus;
+
+	static const int nGridsMax = 8; //!< maximum number of grids transformed together
+	static const int nGridsScratchMax = 16; //!< maximum number of scratch grids summed over threads (unless fewer than the number of threads)
+	int batchSize() const { return indexMinus ? 2*nGridsBatch() : nGridsBatch(); } //!< number of columns per batch
+	int nGrids(int nCols) const { return indexMinus ? ceildiv(nCols,2) : nCols; } //!< number of grids needed for nCols columns
+	int colStart(int iProc, int nProcs, int nCols) const; //!< start of column range of a process (aligned to pairs if required)
+
+	void transformInPlace(GridInfo::PlanType planType, int howMany, complex* buf) const; //!< transform howMany contiguous grids in buf in place
+	void toRealSpace(int nCols, const complex* C, complex* buf) const; //!< scatter nCols columns into buf and transform in place to real space
+	void accumFromRealSpace(int nCols, complex* buf, double alpha, complex* Y) const; //!< transform buf in place to G-space and gather-accumulate alpha times into Y
+
+	//Thread and process level divisions of the column work:
+	static void Idag_DiagV_I_sub(size_t iStart, size_t iStop, const BandGroup* bg, int nCols, const complex* C, const double* V, double alpha, complex* Y);
+	static void diagouterI_sub(int iThread, int nThreads, const BandGroup* bg, int nCols, const complex* C, const double* F, std::vector<double>* nSub);
+	void Idag_DiagV_I_local(int nCols, const complex* C, const double* V, double alpha, complex* Y) const;
+	void diagouterI_local(int nCols, const complex* C, const double* F, double* n) const;
+	std::vector<int> basisData() const; //!< basis description sent to the other processes of the group
+};
+
+//! @}
+#endif // JDFTX_CORE_BANDGROUP_H
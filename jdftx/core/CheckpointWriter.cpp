@@ -0,0 +1,146 @@
+/*-------------------------------------------------------------------
+Copyright 2026 agent
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+
+#include <core/CheckpointWriter.h>
+#include <core/MPIUtil.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstring>
+#include <cerrno>
+
+CheckpointWriter::CheckpointWriter() : busy(false), quit(false)
+{	ioThread = std::thread(&CheckpointWriter::ioLoop, this);
+}
+
+CheckpointWriter::~CheckpointWriter()
+{	{	std::unique_lock<std::mutex> ulock(lock);
+		quit = true;
+	}
+	cv.notify_all();
+	ioThread.join(); //completes checkpoint in flight first
+	//Remove temporary files of a checkpoint that was never flushed (not known to be complete on all processes):
+	for(const auto& entry: inFlight.fileSize)
+		unlink(tmpName(entry.first).c_str());
+	for(const string& fname: inFlight.external)
+		unlink(tmpName(fname).c_str());
+	for(const string& fname: pending.external)
+		unlink(tmpName(fname).c_str());
+}
+
+void CheckpointWriter::setFileSize(const string& fname, size_t nBytes)
+{	pending.fileSize[fname] = nBytes;
+}
+
+void CheckpointWriter::add(const string& fname, size_t offset, const void* ptr, size_t size, size_t nmemb)
+{	static StopWatch watch("CheckpointWriter::add"); watch.start();
+	assert(pending.fileSize.count(fname));
+	Piece piece;
+	piece.fname = fname;
+	piece.offset = offset;
+	piece.data.assign((const char*)ptr, ((const char*)ptr) + size*nmemb);
+	convertToLE(piece.data.data(), size, nmemb);
+	pending.pieces.push_back(std::move(piece));
+	watch.stop();
+}
+
+string CheckpointWriter::addExternal(const string& fname)
+{	assert(inFlight.fileSize.empty() && inFlight.external.empty()); //temporary files of previous checkpoint must have been renamed (by flush)
+	pending.external.insert(fname);
+	return tmpName(fname);
+}
+
+void CheckpointWriter::commit()
+{	flush();
+	{	std::unique_lock<std::mutex> ulock(lock);
+		std::swap(inFlight, pending);
+		busy = true;
+	}
+	cv.notify_all();
+	pending = Job();
+}
+
+void CheckpointWriter::flush()
+{	static StopWatch watch("CheckpointWriter::flush"); watch.start();
+	ostringstream oss;
+	{	std::unique_lock<std::mutex> ulock(lock);
+		cv.wait(ulock, [this]{ return !busy; });
+		oss << errMsg;
+		errMsg.clear();
+	}
+	mpiUtil->checkErrors(oss); //also ensures that all processes have completed their pieces
+	//Replace previous files by completed ones:
+	if(mpiUtil->isHead())
+	{	std::set<string> fnames = inFlight.external;
+		for(const auto& entry: inFlight.fileSize) fnames.insert(entry.first);
+		for(const string& fname: fnames)
+			if(rename(tmpName(fname).c_str(), fname.c_str()) != 0)
+				die("Error renaming '%s' to '%s': %s\n", tmpName(fname).c_str(), fname.c_str(), strerror(errno));
+	}
+	inFlight = Job();
+	watch.stop();
+}
+
+void CheckpointWriter::ioLoop()
+{	while(true)
+	{	std::unique_lock<std::mutex> ulock(lock);
+		cv.wait(ulock, [this]{ return busy || quit; });
+		if(busy)
+		{	ulock.unlock();
+			writeJob(inFlight); //inFlight is not modified by the main thread while busy
+			ulock.lock();
+			busy = false;
+			cv.notify_all();
+		}
+		else if(quit) return;
+	}
+}
+
+void CheckpointWriter::writeJob(const Job& job)
+{	std::map<string,int> fds;
+	//Open (and size, on head) all files:
+	for(const auto& entry: job.fileSize)
+	{	string fname = tmpName(entry.first);
+		int fd = open(fname.c_str(), O_WRONLY|O_CREAT, 0644);
+		if(fd < 0) { errMsg += "Error opening '" + fname + "' for writing: " + strerror(errno) + "\n"; continue; }
+		//Note: size set by head only, and never reduced below the extent written by any process
+		if(mpiUtil->isHead() && ftruncate(fd, entry.second) != 0)
+			errMsg += "Error resizing '" + fname + "': " + strerror(errno) + "\n";
+		fds[entry.first] = fd;
+	}
+	//Write pieces:
+	for(const Piece& piece: job.pieces)
+	{	auto iter = fds.find(piece.fname);
+		if(iter == fds.end()) continue; //error already reported above
+		const char* ptr = piece.data.data();
+		size_t nLeft = piece.data.size();
+		off_t offset = piece.offset;
+		while(nLeft)
+		{	ssize_t nWritten = pwrite(iter->second, ptr, nLeft, offset);
+			if(nWritten <= 0)
+			{	errMsg += "Error writing to '" + tmpName(piece.fname) + "': " + strerror(errno) + "\n";
+				break;
+			}
+			ptr += nWritten; offset += nWritten; nLeft -= nWritten;
+		}
+	}
+	for(const auto& entry: fds)
+		if(close(entry.second) != 0)
+			errMsg += "Error closing '" + tmpName(entry.first) + "': " + strerror(errno) + "\n";
+}
@@ -0,0 +1,84 @@
+/*-------------------------------------------------------------------
+Copyright 2026 agent
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+
+#ifndef JDFTX_CORE_CHECKPOINTWRITER_H
+#define JDFTX_CORE_CHECKPOINTWRITER_H
+
+//! @addtogroup Output
+//! @{
+//! @file CheckpointWriter.h Asynchronous (background) writing of checkpoint files
+
+#include <core/Util.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <map>
+#include <set>
+
+/** @brief Writes checkpoint files from a background I/O thread on each process
+
+Data is copied (converted to little-endian) into a pending snapshot by add(), and commit()
+hands that snapshot to the I/O thread, after waiting for the previous checkpoint to complete
+on all processes, so that at most one checkpoint is in flight while the next one is being assembled.
+Each process writes its own pieces at fixed byte offsets using plain positional writes,
+so that no MPI calls are made from the I/O thread. Files are written under a temporary name
+and renamed by the head process once complete on all processes, so that each file on disk
+is never partially written. Small files of the same checkpoint that are written directly by the caller
+can be registered with addExternal(), which returns the temporary name to write them to, so that all
+files of a checkpoint are renamed together (and an interrupted run never mixes files of different checkpoints).
+Up to two snapshots are held in memory: the one being written and the next one being assembled.
+Call flush() (collectively) to complete the checkpoint in flight; otherwise, its temporary
+files are removed on destruction.
+*/
+class CheckpointWriter
+{
+public:
+	CheckpointWriter();
+	~CheckpointWriter(); //!< waits for the I/O thread and removes temporary files of an unflushed checkpoint (call flush() before exit to keep it)
+	
+	void setFileSize(const string& fname, size_t nBytes); //!< specify total size of a file in the pending checkpoint (same on all processes)
+	void add(const string& fname, size_t offset, const void* ptr, size_t size, size_t nmemb); //!< snapshot nmemb elements of specified size to be written at offset into fname
+	string addExternal(const string& fname); //!< register fname, written synchronously by the caller to the returned temporary name, in the pending checkpoint (call flush() first)
+	void commit(); //!< (collective) complete previous checkpoint and start writing pending one in the background
+	void flush(); //!< (collective) complete checkpoint in flight, if any
+	
+private:
+	struct Piece { string fname; size_t offset; std::vector<char> data; };
+	struct Job
+	{	std::map<string,size_t> fileSize; //!< total size of each file
+		std::vector<Piece> pieces;
+		std::set<string> external; //!< files written by the caller (only renamed with the rest)
+	};
+	Job pending; //!< checkpoint being assembled
+	Job inFlight; //!< checkpoint being written
+	bool busy; //!< whether inFlight is being written
+	bool quit; //!< signal I/O thread to exit
+	string errMsg; //!< error message from I/O thread (reported collectively and cleared by flush)
+	std::mutex lock;
+	std::condition_variable cv;
+	std::thread ioThread;
+	
+	void ioLoop(); //!< main loop of I/O thread
+	void writeJob(const Job& job); //!< write all pieces of a job (called from I/O thread)
+	static string tmpName(const string& fname) { return fname + ".part"; }
+};
+
+//! @}
+#endif // JDFTX_CORE_CHECKPOINTWRITER_H
@@ -29,7 +29,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <core/Operators.h>
 #include "LatticeUtils.h"
 
-CoulombParams::CoulombParams() : ionMargin(5.), embed(false), embedFluidMode(false)
+CoulombParams::CoulombParams() : ionMargin(5.), embed(false), embedFluidMode(false), ewaldMethod(EwaldAuto)
 {
 }
 
@@ -174,11 +174,12 @@ complexScalarFieldTilde Coulomb::operator()(const complexScalarFieldTilde& in, v
 	return (*this)((complexScalarFieldTilde&&)out, kDiff, omega);
 }
 
-double Coulomb::energyAndGrad(std::vector<Atom>& atoms) const
+double Coulomb::energyAndGrad(std::vector<Atom>& atoms, matrix3<>* E_RRT) const
 {	if(!ewald) ((Coulomb*)this)->ewald = createEwald(gInfo.R, atoms.size());
 	double Eewald = 0.;
 	if(params.embed)
-	{	matrix3<> embedScaleMat = Diag(embedScale);
+	{	if(E_RRT) die("Lattice derivatives are not supported with embedded Coulomb truncation.\n");
+		matrix3<> embedScaleMat = Diag(embedScale);
 		matrix3<> invEmbedScaleMat = inv(embedScaleMat);
 		//Convert atom positions to embedding grid's lattice coordinates:
 		for(unsigned i=0; i<atoms.size(); i++)
@@ -219,10 +220,11 @@ double Coulomb::energyAndGrad(std::vector<Atom>& atoms) const
 			a.force = embedScaleMat * a.force;
 		}
 	}
-	else Eewald = ewald->energyAndGrad(atoms);
+	else Eewald = ewald->energyAndGrad(atoms, E_RRT);
 	//Electric field contributions if any:
 	if(params.Efield.length_squared())
-	{	vector3<> RT_Efield_ramp, RT_Efield_wave;
+	{	if(E_RRT) die("Lattice derivatives are not supported in the presence of an electric field.\n");
+		vector3<> RT_Efield_ramp, RT_Efield_wave;
 		params.splitEfield(gInfoOrig.R, RT_Efield_ramp, RT_Efield_wave);
 		for(unsigned i=0; i<atoms.size(); i++)
 		{	Atom& a = atoms[i];
@@ -237,6 +239,11 @@ double Coulomb::energyAndGrad(std::vector<Atom>& atoms) const
 	return Eewald;
 }
 
+matrix3<> Coulomb::latticeGradient(const ScalarFieldTilde& X, const ScalarFieldTilde& Y) const
+{	die("Lattice derivatives of the Coulomb interaction are only implemented for periodic geometry.\n");
+	return matrix3<>();
+}
+
 void getEfieldPotential_sub(size_t iStart, size_t iStop, const vector3<int>& S, const WignerSeitz* ws,
 	const vector3<>& xCenter, const vector3<>& RT_Efield_ramp, const vector3<>& RT_Efield_wave, double* V)
 {	matrix3<> invS = inv(Diag(vector3<>(S)));
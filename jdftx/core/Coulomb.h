@@ -53,6 +53,14 @@ struct CoulombParams
 	
 	vector3<> Efield; //!< electric field (in Cartesian coordinates, atomic units [Eh/e/a0])
 	
+	//! Method for the reciprocal-space part of fully periodic Ewald sums
+	enum EwaldMethod
+	{	EwaldAuto, //!< Choose based on estimated cost (default)
+		EwaldDirect, //!< Direct sum over reciprocal lattice vectors
+		EwaldMesh //!< Smooth particle-mesh Ewald (SPME)
+	};
+	EwaldMethod ewaldMethod; //!< reciprocal-space Ewald sum method (periodic geometry only)
+	
 	//Parameters for computing exchange integrals:
 	//! Regularization method for G=0 singularities in exchange
 	enum ExchangeRegularization
@@ -102,7 +110,8 @@ public:
 	//!Get the energy of a point charge configurtaion, and accumulate corresponding forces
 	//!The implementation will shift each Atom::pos by lattice vectors to bring it to
 	//!the fundamental zone (or Wigner-Seitz cell as appropriate)
-	virtual double energyAndGrad(std::vector<Atom>& atoms) const=0;
+	//!If E_RRT is non-null, accumulate the lattice derivative (dE/dR.R^T) in it (not supported by all geometries)
+	virtual double energyAndGrad(std::vector<Atom>& atoms, matrix3<>* E_RRT=0) const=0;
 };
 
 
@@ -127,7 +136,13 @@ public:
 	
 	//! Create the appropriate Ewald class, if required, and call Ewald::energyAndGrad
 	//! Includes interaction with Efield, if present (Requires embedded truncation)
-	double energyAndGrad(std::vector<Atom>& atoms) const; 
+	//! Optionally accumulate the lattice derivative (dE/dR.R^T) in E_RRT (periodic geometry only)
+	double energyAndGrad(std::vector<Atom>& atoms, matrix3<>* E_RRT=0) const; 
+
+	//! Return the lattice derivative (dE/dR.R^T) of the interaction energy E = dot(X, O(K(Y))),
+	//! for charge densities X and Y that are fixed in lattice coordinates (scale inversely with volume).
+	//! Only implemented for periodic geometry (without embedding); others will die().
+	virtual matrix3<> latticeGradient(const ScalarFieldTilde& X, const ScalarFieldTilde& Y) const;
 
 	//! Generate the potential due to the Efield (if any) (Requires embedded truncation)
 	ScalarField getEfieldPotential() const;
@@ -140,6 +155,10 @@ public:
 	//! and optionally screened with range parameter omega (destructible input)
 	complexScalarFieldTilde operator()(const complexScalarFieldTilde&, vector3<> kDiff, double omega) const;
 
+	//! Return an Ewald evaluator for lattice vectors R, which may be a supercell of gInfo.R along the periodic directions
+	//! (used for pair-potential evaluations in supercells, such as the ionic contribution to phonon force matrices)
+	std::shared_ptr<Ewald> getEwald(matrix3<> R, size_t nAtoms) const { return createEwald(R, nAtoms); }
+
 private:
 	const GridInfo& gInfoOrig; //!< original grid
 protected:
@@ -24,6 +24,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <core/ManagedMemory.h>
 #include <core/Thread.h>
 #include <cfloat>
+#include <unistd.h>
 
 const double CoulombKernel::nSigmasPerWidth = 1.+sqrt(-2.*log(DBL_EPSILON)); //gaussian negligible at double precision (+1 sigma for safety)
 
@@ -34,7 +35,9 @@ CoulombKernel::CoulombKernel(const matrix3<> R, const vector3<int> S, const vect
 
 
 void CoulombKernel::compute(double* data, const WignerSeitz& ws) const
-{	//Count number of truncated directions:
+{	size_t nG = S[0] * (S[1] * size_t(1 + S[2]/2));
+	if(loadCache(data, nG)) return;
+	//Count number of truncated directions:
 	int nTruncated = 0;
 	for(int k=0; k<3; k++) if(isTruncated[k]) nTruncated++;
 	//Call appropriate routine:
@@ -43,6 +46,82 @@ void CoulombKernel::compute(double* data, const WignerSeitz& ws) const
 		case 3: computeIsolated(data, ws); break;
 		default: assert(!"Invalid truncated direction count");
 	}
+	saveCache(data, nG);
+}
+
+//--------- On-disk kernel cache ---------
+
+string CoulombKernel::cacheDir;
+
+void CoulombKernel::setCacheDir(string cacheDir)
+{	CoulombKernel::cacheDir = cacheDir;
+	logPrintf("Coulomb kernel cache: '%s'\n", cacheDir.c_str());
+}
+
+string CoulombKernel::cacheFilename(std::vector<long long>& key) const
+{	//Key (lattice vectors and screening parameter quantized, so that round-off does not prevent reuse):
+	const double quantum = 1e-10;
+	const long long version = 1; //increment when the kernel computation changes to invalidate older caches
+	key.assign(1, version);
+	for(int i=0; i<3; i++)
+		for(int j=0; j<3; j++)
+			key.push_back(llround(R(i,j)/quantum));
+	for(int k=0; k<3; k++) key.push_back(S[k]);
+	for(int k=0; k<3; k++) key.push_back(isTruncated[k]);
+	key.push_back(llround(omega/quantum));
+	//Filename from 64-bit FNV-1a hash of key:
+	uint64_t hash = 14695981039346656037ULL;
+	const unsigned char* keyBytes = (const unsigned char*)key.data();
+	for(size_t i=0; i<key.size()*sizeof(long long); i++)
+	{	hash ^= keyBytes[i];
+		hash *= 1099511628211ULL;
+	}
+	char hashStr[17]; sprintf(hashStr, "%016llx", (unsigned long long)hash);
+	return cacheDir + "/CoulombKernel-" + hashStr + ".bin";
+}
+
+bool CoulombKernel::loadCache(double* data, size_t nG) const
+{	if(!cacheDir.length()) return false;
+	std::vector<long long> key;
+	string filename = cacheFilename(key);
+	bool loaded = false;
+	if(mpiUtil->isHead())
+	{	std::vector<long long> keyFile(key.size());
+		FILE* fp = 0;
+		if(fileSize(filename.c_str()) == off_t(key.size()*sizeof(long long) + nG*sizeof(double)))
+			fp = fopen(filename.c_str(), "rb");
+		if(fp)
+		{	loaded = (freadLE(keyFile.data(), sizeof(long long), key.size(), fp) == key.size())
+				&& (keyFile == key)
+				&& (freadLE(data, sizeof(double), nG, fp) == nG);
+			fclose(fp);
+		}
+	}
+	mpiUtil->bcast(loaded);
+	if(!loaded) return false;
+	mpiUtil->bcast(data, nG);
+	logPrintf("Read Coulomb kernel from cache '%s'.\n", filename.c_str());
+	return true;
+}
+
+void CoulombKernel::saveCache(const double* data, size_t nG) const
+{	if(!cacheDir.length() || !mpiUtil->isHead()) return;
+	std::vector<long long> key;
+	string filename = cacheFilename(key);
+	//Write to a temporary file and rename (atomic replacement with concurrent jobs sharing the cache):
+	ostringstream ossTmp; ossTmp << filename << ".tmp" << getpid();
+	string tmpFilename = ossTmp.str();
+	FILE* fp = fopen(tmpFilename.c_str(), "wb");
+	bool written = fp
+		&& (fwriteLE(key.data(), sizeof(long long), key.size(), fp) == key.size())
+		&& (fwriteLE(data, sizeof(double), nG, fp) == nG);
+	if(fp) written = (fclose(fp)==0) && written;
+	if(written && !rename(tmpFilename.c_str(), filename.c_str()))
+		logPrintf("Saved Coulomb kernel to cache '%s'.\n", filename.c_str());
+	else
+	{	logPrintf("WARNING: could not save Coulomb kernel to cache '%s'.\n", filename.c_str());
+		remove(tmpFilename.c_str());
+	}
 }
 
 //! Compute erfc(omega r)/r - erfc(a r)/r
@@ -57,9 +136,9 @@ inline double screenedPotential(double r, double a, double omega)
 namespace CoulombKernelIsolated
 {
 	//Initialize the long range part of the kernel in real space with the minimum image convention:
-	inline void realSpace_thread(size_t iStart, size_t iStop, vector3<int> Sdense, matrix3<> R,
+	inline void realSpace_thread(size_t iStart, size_t iStop, size_t iOffset, vector3<int> Sdense, matrix3<> R,
 		double* data, const WignerSeitz* ws, double sigma, double omega)
-	{
+	{	iStart += iOffset; iStop += iOffset; //range within the portion of current process
 		vector3<> invSdense; for(int k=0; k<3; k++) invSdense[k] = 1./Sdense[k];
 		double dV = fabs(det(R)) * (invSdense[0]*invSdense[1]*invSdense[2]); //integration factor
 		matrix3<> RTR = (~R)*R; //metric
@@ -123,9 +202,12 @@ void CoulombKernel::computeIsolated(double* data, const WignerSeitz& ws) const
 	fftw_plan fftPlanR2C = fftw_plan_dft_r2c_3d(Sdense[0], Sdense[1], Sdense[2], denseRealArr, (fftw_complex*)denseArr, FFTW_ESTIMATE);
 	logPrintf("Done.\n");
 	
-	//Long-range part in real space
+	//Long-range part in real space (divided over processes):
 	logPrintf("Computing truncated long-range part in real space ... "); logFlush();
-	threadLaunch(CoulombKernelIsolated::realSpace_thread, 2*nGdense, Sdense, R, denseRealArr, &ws, sigma, omega);
+	TaskDivision realDivision(2*nGdense, mpiUtil);
+	if(mpiUtil->nProcesses() > 1) memset(denseRealArr, 0, 2*nGdense*sizeof(double));
+	threadLaunch(CoulombKernelIsolated::realSpace_thread, realDivision.stop()-realDivision.start(), realDivision.start(), Sdense, R, denseRealArr, &ws, sigma, omega);
+	mpiUtil->allReduce(denseRealArr, 2*nGdense, MPIUtil::ReduceSum);
 	logPrintf("Done.\n");
 	
 	//Add short-ranged part in reciprocal space (and down-sample if required):
@@ -216,14 +298,14 @@ struct CoulombKernelWire
 	}
 	
 	static void thread(int iThread, int nThreads, CoulombKernelWire* ckwArr,
-		int nPlanes, int* nPlanesDone, std::mutex* m)
+		int iPlaneStop, int* iPlaneNext, std::mutex* m)
 	{
 		while(true)
 		{	//Get next available job:
 			m->lock();
-			int iPlane = (*nPlanesDone)++;
+			int iPlane = (*iPlaneNext)++;
 			m->unlock();
-			if(iPlane >= nPlanes)
+			if(iPlane >= iPlaneStop)
 				break; //job queue empty
 			//Perform job:
 			ckwArr[iThread].computePlane(iPlane);
@@ -281,8 +363,12 @@ void CoulombKernel::computeWire(double* data, const WignerSeitz& ws) const
 		c.iDir = iDir; c.jDir = jDir; c.kDir = kDir;
 		c.ws = &ws; c.sigma = sigma; c.omega = omega;
 	}
-	std::mutex mJobCount; int nPlanesDone = 0; //for job management
-	threadLaunch(CoulombKernelWire::thread, 0, ckwArr.data(), 1+S[iDir]/2, &nPlanesDone, &mJobCount);
+	//--- planes divided over processes (each plane sets a disjoint subset of data):
+	TaskDivision planeDivision(1+S[iDir]/2, mpiUtil);
+	if(mpiUtil->nProcesses() > 1) memset(data, 0, S[0]*(S[1]*size_t(1+S[2]/2))*sizeof(double));
+	std::mutex mJobCount; int iPlaneNext = planeDivision.start(); //for job management
+	threadLaunch(CoulombKernelWire::thread, 0, ckwArr.data(), int(planeDivision.stop()), &iPlaneNext, &mJobCount);
+	mpiUtil->allReduce(data, S[0]*(S[1]*size_t(1+S[2]/2)), MPIUtil::ReduceSum);
 	fftw_destroy_plan(fftPlanR2C);
 	logPrintf("Done.\n");
 }
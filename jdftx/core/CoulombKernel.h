@@ -42,11 +42,23 @@ struct CoulombKernel
 	//! ws is the Wigner-Seitz cell corresponding to lattice vectors R.
 	//!      Supported modes include fully truncated (Isolated or Wigner-Seitz
 	//! truncated exchange kernel) and one direction periodic (Wire geometry).
+	//! The computation is divided over the processes in mpiUtil (so must be called by all of them),
+	//! and the result is reused from / saved to the on-disk cache, if enabled using setCacheDir.
 	void compute(double* data, const WignerSeitz& ws) const;
 	
 	static const double nSigmasPerWidth; //!< number of sigmas at which gaussian is negligible at working precision
 	
+	//! Enable an on-disk cache of kernels in directory cacheDir (which may be shared between runs),
+	//! with one file per combination of R, S, truncated directions and omega
+	static void setCacheDir(string cacheDir);
+	
 private:
+	static string cacheDir; //!< directory of kernel cache (disabled if empty)
+	string cacheFilename(std::vector<long long>& key) const; //!< get the cache filename and the key identifying this kernel (stored in the file to guard against hash collisions)
+	bool loadCache(double* data, size_t nG) const; //!< load from cache into data, if available (returns whether successful)
+	void saveCache(const double* data, size_t nG) const; //!< save data to the cache
+	
+
 	//Various indiviudally optimized cases of computeKernel:
 	void computeIsolated(double* data, const WignerSeitz& ws) const; //!< Fully truncated
 	void computeWire(double* data, const WignerSeitz& ws) const; //!< 1 periodic direction
@@ -21,17 +21,144 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <core/Coulomb_internal.h>
 #include <core/CoulombKernel.h>
 #include <core/BlasExtra.h>
+#include <core/LoopMacros.h>
+#include <core/Thread.h>
+#include <core/NeighborList.h>
+#include <core/Operators.h>
+
+static const int pmeOrder = 10; //!< order of the B-splines used for charge assignment in smooth particle-mesh Ewald
+
+//! Cardinal B-spline weights M[j] = M_p(w+j) and derivatives dM[j] = M_p'(w+j) for j=0..p-1, given w in [0,1)
+inline void bsplineWeights(double w, double* M, double* dM)
+{	M[0] = w; M[1] = 1.-w;
+	for(int j=2; j<pmeOrder; j++) M[j] = 0.;
+	for(int n=3; n<=pmeOrder; n++)
+	{	if(n==pmeOrder) //derivative from the order n-1 spline
+			for(int j=0; j<n; j++)
+				dM[j] = M[j] - (j ? M[j-1] : 0.);
+		for(int j=n-1; j>=0; j--)
+			M[j] = ((w+j)*M[j] + (n-w-j)*(j ? M[j-1] : 0.)) / (n-1);
+	}
+}
+
+//! B-spline assignment of a charge at lattice coordinates pos to grid points gBase[k]-j (j=0..p-1) along each direction k
+inline void pmeWeights(const vector3<>& pos, const vector3<int>& S, vector3<int>& gBase, double M[3][pmeOrder], double dM[3][pmeOrder])
+{	for(int k=0; k<3; k++)
+	{	double u = S[k] * pos[k];
+		double uFloor = floor(u);
+		gBase[k] = int(uFloor);
+		bsplineWeights(u-uFloor, M[k], dM[k]);
+	}
+}
+
+//! Wrap grid index x into [0,S)
+inline int pmeWrap(int x, int S)
+{	x %= S;
+	return x<0 ? x+S : x;
+}
+
+//! Index of grid point gBase - j (wrapped periodically)
+inline int pmeIndex(const vector3<int>& gBase, int j0, int j1, int j2, const vector3<int>& S)
+{	return pmeWrap(gBase[2]-j2, S[2]) + S[2]*(pmeWrap(gBase[1]-j1, S[1]) + S[1]*pmeWrap(gBase[0]-j0, S[0]));
+}
+
+//Real-space Ewald sum over the neighbors of atoms in [iStart,iStop)
+void ewaldRealSpace_sub(size_t iStart, size_t iStop, std::vector<Atom>* atoms, const NeighborList* neighborList,
+	const matrix3<> R, double eta, double* E, matrix3<>* E_RRT, std::mutex* m)
+{	matrix3<> RTR = (~R)*R;
+	double etaSq = eta*eta;
+	double rMaxSq = pow(neighborList->getCutoff(), 2);
+	double Esub = 0.; matrix3<> E_RRTsub;
+	for(size_t i=iStart; i<iStop; i++)
+	{	Atom& a1 = atoms->at(i);
+		neighborList->forNeighbors(i, [&](int j, const vector3<int>& iR)
+		{	const Atom& a2 = atoms->at(j);
+			vector3<> x = iR + (a1.pos - a2.pos);
+			double rSq = RTR.metric_length_squared(x);
+			if(rSq > rMaxSq) return; //negligible
+			double r = sqrt(rSq);
+			Esub += 0.5 * a1.Z * a2.Z * erfc(eta*r)/r;
+			double prefac = a1.Z * a2.Z * (erfc(eta*r)/r + (2./sqrt(M_PI))*eta*exp(-etaSq*rSq))/rSq;
+			a1.force += (RTR * x) * prefac;
+			if(E_RRT)
+			{	vector3<> rVec = R * x; //cartesian separation
+				E_RRTsub -= (0.5*prefac) * outer(rVec, rVec);
+			}
+		});
+	}
+	m->lock();
+	*E += Esub;
+	if(E_RRT) *E_RRT += E_RRTsub;
+	m->unlock();
+}
+
+//Initialize the SPME kernel: Ewald reciprocal-space kernel including the B-spline structure factors |b(G)|^2 (and a factor of nr)
+void pmeKernel_sub(size_t iStart, size_t iStop, const vector3<int> S, const matrix3<> GGT, double sigma, double detR,
+	const std::vector<double>* Bsq, double* kernel)
+{	double nr = S[0]*S[1]*S[2];
+	THREAD_halfGspaceLoop
+	(	double Gsq = GGT.metric_length_squared(iG);
+		bool isNyquist = false;
+		for(int k=0; k<3; k++) if(2*abs(iG[k])==S[k]) isNyquist = true;
+		kernel[i] = (Gsq && !isNyquist)
+			? nr * 4*M_PI * exp(-0.5*sigma*sigma*Gsq)/(Gsq * detR)
+				* Bsq[0][pmeWrap(iG[0],S[0])] * Bsq[1][pmeWrap(iG[1],S[1])] * Bsq[2][pmeWrap(iG[2],S[2])]
+			: 0.;
+	)
+}
+
+//Accumulate forces on atoms in [iStart,iStop) from the SPME potential phi
+void pmeForces_sub(size_t iStart, size_t iStop, std::vector<Atom>* atoms, const vector3<int> S, const double* phi)
+{	double M[3][pmeOrder], dM[3][pmeOrder];
+	vector3<int> gBase;
+	for(size_t i=iStart; i<iStop; i++)
+	{	Atom& a = atoms->at(i);
+		pmeWeights(a.pos, S, gBase, M, dM);
+		vector3<> E_u; //derivative w.r.t grid coordinates
+		for(int j0=0; j0<pmeOrder; j0++)
+		for(int j1=0; j1<pmeOrder; j1++)
+		for(int j2=0; j2<pmeOrder; j2++)
+		{	double phiCur = phi[pmeIndex(gBase, j0,j1,j2, S)];
+			E_u[0] += phiCur * dM[0][j0] * M[1][j1] * M[2][j2];
+			E_u[1] += phiCur * M[0][j0] * dM[1][j1] * M[2][j2];
+			E_u[2] += phiCur * M[0][j0] * M[1][j1] * dM[2][j2];
+		}
+		for(int k=0; k<3; k++)
+			a.force[k] -= a.Z * S[k] * E_u[k];
+	}
+}
+
+//Lattice derivative of the SPME energy, given the normalized Fourier transform Qtilde of the charge grid
+void pmeLatticeGradient_sub(size_t iStart, size_t iStop, const vector3<int> S, const matrix3<> G, double sigma,
+	const double* kernel, const complex* Qtilde, matrix3<>* E_RRT, std::mutex* m)
+{	double nr = S[0]*S[1]*S[2];
+	matrix3<> E_RRTsub;
+	THREAD_halfGspaceLoop
+	(	if(kernel[i])
+		{	vector3<> Gvec = iG * G; //cartesian G-vector
+			double Gsq = Gvec.length_squared();
+			double weight = (iG[2]==0 || 2*iG[2]==S[2]) ? 1. : 2.; //weight of half G-space point
+			double E_G = 0.5 * weight * kernel[i] * nr * Qtilde[i].norm();
+			E_RRTsub += (E_G * 2*(0.5*sigma*sigma + 1./Gsq)) * outer(Gvec, Gvec);
+			E_RRTsub -= matrix3<>(E_G, E_G, E_G); //volume factor
+		}
+	)
+	m->lock(); *E_RRT += E_RRTsub; m->unlock();
+}
 
 //! Standard 3D Ewald sum
 class EwaldPeriodic : public Ewald
 {
 	matrix3<> R, G, RTR, GGT; //!< Lattice vectors, reciprocal lattice vectors and corresponding metrics
 	double sigma; //!< gaussian width for Ewald sums
-	vector3<int> Nreal; //!< max unit cell indices for real-space sum
+	std::shared_ptr<NeighborList> neighborList; //!< neighbor lists for real-space sum (reused while atoms move within its skin)
 	vector3<int> Nrecip; //!< max unit cell indices for reciprocal-space sum
+	bool usePME; //!< whether to use smooth particle-mesh Ewald (SPME) for the reciprocal-space sum
+	GridInfo gInfoPME; //!< charge-assignment grid for SPME (initialized only if usePME)
+	std::shared_ptr<RealKernel> pmeKernel; //!< reciprocal-space kernel on gInfoPME (including B-spline structure factors)
 
 public:
-	EwaldPeriodic(const matrix3<>& R, int nAtoms)
+	EwaldPeriodic(const matrix3<>& R, int nAtoms, CoulombParams::EwaldMethod method)
 	: R(R), G((2*M_PI)*inv(R)), RTR((~R)*R), GGT(G*(~G))
 	{	logPrintf("\n---------- Setting up ewald sum ----------\n");
 		//Determine optimum gaussian width for Ewald sums:
@@ -47,18 +174,64 @@ public:
 		
 		//Carry real space sums to Rmax = 10 sigma and Gmax = 10/sigma
 		//This leads to relative errors ~ 1e-22 in both sums, well within double precision limits
+		double rMax = CoulombKernel::nSigmasPerWidth * sigma;
+		neighborList = std::make_shared<NeighborList>(rMax, 0.1*rMax);
 		for(int k=0; k<3; k++)
-		{	Nreal[k] = 1+ceil(CoulombKernel::nSigmasPerWidth * G.row(k).length() * sigma / (2*M_PI));
 			Nrecip[k] = 1+ceil(CoulombKernel::nSigmasPerWidth * R.column(k).length() / (2*M_PI*sigma));
+		logPrintf("Real space sum over neighbors within %lg bohrs (using cell lists)\n", rMax);
+		
+		//Choose between direct and SPME reciprocal-space sums based on estimated cost (unless specified):
+		vector3<int> Spme;
+		for(int k=0; k<3; k++)
+		{	//Pick grid for which aliasing errors of the B-splines (weighted by the gaussian) are below 1e-13:
+			double Gk = G.row(k).length();
+			for(Spme[k]=2*Nrecip[k]+2;; Spme[k]+=2)
+			{	if(!fftSuitable(Spme[k])) continue;
+				double errMax = 0.;
+				for(int m=1; m<=Nrecip[k] && 2*m<Spme[k]; m++)
+					errMax = std::max(errMax, exp(-0.5*std::pow(sigma*m*Gk,2)) * 2.*pow(double(m)/(Spme[k]-m), pmeOrder));
+				if(errMax < 1e-13) break;
+			}
+		}
+		double nrPME = Spme[0]*Spme[1]*Spme[2];
+		double costDirect = 2. * nAtoms * (2*Nrecip[0]+1)*(2*Nrecip[1]+1)*(2*Nrecip[2]+1);
+		double costPME = 2. * nAtoms * pow(pmeOrder,3) + 10. * nrPME * log2(nrPME);
+		switch(method)
+		{	case CoulombParams::EwaldDirect: usePME = false; break;
+			case CoulombParams::EwaldMesh: usePME = true; break;
+			default: usePME = (costPME < costDirect);
+		}
+		if(usePME)
+		{	logPrintf("Reciprocal space sum using smooth particle-mesh Ewald with order %d B-splines on grid ", pmeOrder);
+			Spme.print(globalLog, " %d ");
+			Citations::add("Smooth particle-mesh Ewald", "U. Essmann et al., J. Chem. Phys. 103, 8577 (1995)");
+			gInfoPME.R = R;
+			gInfoPME.S = Spme;
+			gInfoPME.initialize(true);
+			//B-spline structure factors along each direction:
+			std::vector<double> Bsq[3];
+			double M[pmeOrder], dM[pmeOrder];
+			bsplineWeights(0., M, dM); //M[j] = M_p(j)
+			for(int k=0; k<3; k++)
+			{	Bsq[k].resize(Spme[k]);
+				for(int m=0; m<Spme[k]; m++)
+				{	complex bInv = 0.;
+					for(int j=0; j<=pmeOrder-2; j++)
+						bInv += M[j+1] * cis((2*M_PI*m*j)/Spme[k]);
+					Bsq[k][m] = 1./bInv.norm();
+				}
+			}
+			pmeKernel = std::make_shared<RealKernel>(gInfoPME);
+			threadLaunch(pmeKernel_sub, gInfoPME.nG, Spme, GGT, sigma, fabs(det(R)), Bsq, pmeKernel->data());
+		}
+		else
+		{	logPrintf("Reciprocal space sum over %d terms with max indices ", (2*Nrecip[0]+1)*(2*Nrecip[1]+1)*(2*Nrecip[2]+1));
+			Nrecip.print(globalLog, " %d ");
 		}
-		logPrintf("Real space sum over %d unit cells with max indices ", (2*Nreal[0]+1)*(2*Nreal[1]+1)*(2*Nreal[2]+1));
-		Nreal.print(globalLog, " %d ");
-		logPrintf("Reciprocal space sum over %d terms with max indices ", (2*Nrecip[0]+1)*(2*Nrecip[1]+1)*(2*Nrecip[2]+1));
-		Nrecip.print(globalLog, " %d ");
 	}
 
-	double energyAndGrad(std::vector<Atom>& atoms) const
-	{	double eta = sqrt(0.5)/sigma, etaSq=eta*eta;
+	double energyAndGrad(std::vector<Atom>& atoms, matrix3<>* E_RRT) const
+	{	double eta = sqrt(0.5)/sigma;
 		double sigmaSq = sigma * sigma;
 		double detR = fabs(det(R)); //cell volume
 		//Position independent terms:
@@ -67,46 +240,73 @@ public:
 		{	Ztot += a.Z;
 			ZsqTot += a.Z * a.Z;
 		}
-		double E
-			= 0.5 * 4*M_PI * Ztot*Ztot * (-0.5*sigmaSq) / detR //G=0 correction
+		double E0 = 0.5 * 4*M_PI * Ztot*Ztot * (-0.5*sigmaSq) / detR; //G=0 correction
+		double E = E0
 			- 0.5 * ZsqTot * eta * (2./sqrt(M_PI)); //Self-energy correction
+		if(E_RRT) *E_RRT -= matrix3<>(E0, E0, E0); //G=0 correction scales inversely with volume
 		//Reduce positions to first centered unit cell:
 		for(Atom& a: atoms)
 			for(int k=0; k<3; k++)
 				a.pos[k] -= floor(0.5 + a.pos[k]);
 		//Real space sum:
-		vector3<int> iR; //integer cell number
-		for(const Atom& a2: atoms)
-			for(Atom& a1: atoms)
-				for(iR[0]=-Nreal[0]; iR[0]<=Nreal[0]; iR[0]++)
-					for(iR[1]=-Nreal[1]; iR[1]<=Nreal[1]; iR[1]++)
-						for(iR[2]=-Nreal[2]; iR[2]<=Nreal[2]; iR[2]++)
-						{	vector3<> x = iR + (a1.pos - a2.pos);
-							double rSq = RTR.metric_length_squared(x);
-							if(!rSq) continue; //exclude self-interaction
-							double r = sqrt(rSq);
-							E += 0.5 * a1.Z * a2.Z * erfc(eta*r)/r;
-							a1.force += (RTR * x) *
-								(a1.Z * a2.Z * (erfc(eta*r)/r + (2./sqrt(M_PI))*eta*exp(-etaSq*rSq))/rSq);
-						}
+		{	std::vector< vector3<> > pos; pos.reserve(atoms.size());
+			for(const Atom& a: atoms) pos.push_back(a.pos);
+			neighborList->update(R, pos);
+			std::mutex m;
+			threadLaunch(ewaldRealSpace_sub, atoms.size(), &atoms, (const NeighborList*)neighborList.get(), R, eta, &E, E_RRT, &m);
+		}
 		//Reciprocal space sum:
-		vector3<int> iG; //integer reciprocal cell number
-		for(iG[0]=-Nrecip[0]; iG[0]<=Nrecip[0]; iG[0]++)
-			for(iG[1]=-Nrecip[1]; iG[1]<=Nrecip[1]; iG[1]++)
-				for(iG[2]=-Nrecip[2]; iG[2]<=Nrecip[2]; iG[2]++)
-				{	double Gsq = GGT.metric_length_squared(iG);
-					if(!Gsq) continue; //skip G=0
-					//Compute structure factor:
-					complex SG = 0.;
-					for(const Atom& a: atoms)
-						SG += a.Z * cis(-2*M_PI*dot(iG,a.pos));
-					//Accumulate energy:
-					double eG = 4*M_PI * exp(-0.5*sigmaSq*Gsq)/(Gsq * detR);
-					E += 0.5 * eG * SG.norm();
-					//Accumulate forces:
-					for(Atom& a: atoms)
-						a.force -= (eG * a.Z * 2*M_PI * (SG.conj() * cis(-2*M_PI*dot(iG,a.pos))).imag()) * iG;
-				}
+		if(usePME)
+		{	const vector3<int>& S = gInfoPME.S;
+			//Assign charges to grid:
+			ScalarField Q; nullToZero(Q, gInfoPME);
+			double* Qdata = Q->data();
+			double M[3][pmeOrder], dM[3][pmeOrder];
+			vector3<int> gBase;
+			for(const Atom& a: atoms)
+			{	pmeWeights(a.pos, S, gBase, M, dM);
+				for(int j0=0; j0<pmeOrder; j0++)
+				for(int j1=0; j1<pmeOrder; j1++)
+				for(int j2=0; j2<pmeOrder; j2++)
+					Qdata[pmeIndex(gBase, j0,j1,j2, S)] += a.Z * M[0][j0] * M[1][j1] * M[2][j2];
+			}
+			//Convolve with kernel to get potential, energy and forces:
+			ScalarFieldTilde Qtilde = J(Q);
+			ScalarField phi = I((*pmeKernel) * Qtilde);
+			E += 0.5 * dot(Q, phi);
+			threadLaunch(pmeForces_sub, atoms.size(), &atoms, S, (const double*)phi->data());
+			//Accumulate lattice derivative:
+			if(E_RRT)
+			{	std::mutex m;
+				threadLaunch(pmeLatticeGradient_sub, gInfoPME.nG, S, G, sigma, (const double*)pmeKernel->data(), (const complex*)Qtilde->data(), E_RRT, &m);
+			}
+		}
+		else
+		{	vector3<int> iG; //integer reciprocal cell number
+			for(iG[0]=-Nrecip[0]; iG[0]<=Nrecip[0]; iG[0]++)
+				for(iG[1]=-Nrecip[1]; iG[1]<=Nrecip[1]; iG[1]++)
+					for(iG[2]=-Nrecip[2]; iG[2]<=Nrecip[2]; iG[2]++)
+					{	double Gsq = GGT.metric_length_squared(iG);
+						if(!Gsq) continue; //skip G=0
+						//Compute structure factor:
+						complex SG = 0.;
+						for(const Atom& a: atoms)
+							SG += a.Z * cis(-2*M_PI*dot(iG,a.pos));
+						//Accumulate energy:
+						double eG = 4*M_PI * exp(-0.5*sigmaSq*Gsq)/(Gsq * detR);
+						E += 0.5 * eG * SG.norm();
+						//Accumulate forces:
+						for(Atom& a: atoms)
+							a.force -= (eG * a.Z * 2*M_PI * (SG.conj() * cis(-2*M_PI*dot(iG,a.pos))).imag()) * iG;
+						//Accumulate lattice derivative:
+						if(E_RRT)
+						{	vector3<> Gvec = iG * G; //cartesian G-vector
+							double E_G = 0.5 * eG * SG.norm();
+							*E_RRT += (E_G * 2*(0.5*sigmaSq + 1./Gsq)) * outer(Gvec, Gvec);
+							*E_RRT -= matrix3<>(E_G, E_G, E_G); //volume factor
+						}
+					}
+		}
 		return E;
 	}
 };
@@ -125,6 +325,28 @@ ScalarFieldTilde CoulombPeriodic::apply(ScalarFieldTilde&& in) const
 	return in;
 }
 
+//Lattice derivative of dot(X, O(K(Y))) with K = 4 pi / G^2
+void coulombPeriodicLatticeGradient_sub(size_t iStart, size_t iStop, const vector3<int> S, const matrix3<> G,
+	const complex* X, const complex* Y, matrix3<>* E_RRT, std::mutex* m)
+{	matrix3<> E_RRTsub;
+	THREAD_halfGspaceLoop
+	(	vector3<> Gvec = iG * G; //cartesian G-vector
+		double Gsq = Gvec.length_squared();
+		if(Gsq)
+		{	double weight = (iG[2]==0 || 2*iG[2]==S[2]) ? 1. : 2.; //weight of half G-space point
+			double E_G = weight * (X[i].conj() * Y[i]).real() * (4*M_PI/Gsq); //energy contribution excluding detR
+			E_RRTsub += (E_G * 2./Gsq) * outer(Gvec, Gvec);
+			E_RRTsub -= matrix3<>(E_G, E_G, E_G);
+		}
+	)
+	m->lock(); *E_RRT += E_RRTsub; m->unlock();
+}
+matrix3<> CoulombPeriodic::latticeGradient(const ScalarFieldTilde& X, const ScalarFieldTilde& Y) const
+{	matrix3<> E_RRT; std::mutex m;
+	threadLaunch(coulombPeriodicLatticeGradient_sub, gInfo.nG, gInfo.S, gInfo.G, X->data(), Y->data(), &E_RRT, &m);
+	return gInfo.detR * E_RRT;
+}
+
 std::shared_ptr<Ewald> CoulombPeriodic::createEwald(matrix3<> R, size_t nAtoms) const
-{	return std::make_shared<EwaldPeriodic>(R, nAtoms);
+{	return std::make_shared<EwaldPeriodic>(R, nAtoms, params.ewaldMethod);
 }
@@ -22,7 +22,10 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <core/Thread.h>
 #include <core/Operators.h>
 #include <core/LatticeUtils.h>
+#include <core/BandGroup.h>
 #include <algorithm>
+#include <sstream>
+#include <unistd.h>
 
 #ifdef MKL_PROVIDES_FFT
 #include <fftw3_mkl.h>
@@ -271,10 +274,11 @@ void GridInfo::initialize(bool skipHeader, const std::vector<SpaceGroupOp> sym)
 }
 
 std::mutex GridInfo::planLock;
+std::string GridInfo::wisdomFilename;
 
-fftw_plan GridInfo::getPlan(GridInfo::PlanType planType, int nThreads) const
+fftw_plan GridInfo::getPlan(GridInfo::PlanType planType, int nThreads, int howMany) const
 {	//Return cached plan if available:
-	auto key = std::make_pair(planType, nThreads);
+	auto key = std::make_tuple(planType, nThreads, howMany);
 	planLock.lock();
 	auto iter = planCache.find(key);
 	if(iter != planCache.end())
@@ -283,7 +287,11 @@ fftw_plan GridInfo::getPlan(GridInfo::PlanType planType, int nThreads) const
 	}
 	//Create plan:
 	//--- import wisdom if available:
-	fftw_import_system_wisdom();
+	static bool systemWisdomImported = false;
+	if(!systemWisdomImported)
+	{	fftw_import_system_wisdom();
+		systemWisdomImported = true;
+	}
 	//--- setup threading:
 	#ifdef MKL_PROVIDES_FFT
 	fftw3_mkl.number_of_user_threads = ceildiv(nProcsAvailable, nThreads); //maximum number of user threads from which plan could be called simultaneously
@@ -292,8 +300,9 @@ fftw_plan GridInfo::getPlan(GridInfo::PlanType planType, int nThreads) const
 	fftw_plan_with_nthreads(nThreads);
 	//--- temp data for planning:
 	bool inPlace = (planType==PlanForwardInPlace) || (planType==PlanInverseInPlace);
+	assert(howMany==1 || inPlace); //batched transforms only supported in place
 	ManagedArray<fftw_complex> testMem, testMem2;
-	testMem.init(nr);
+	testMem.init(size_t(nr)*howMany);
 	fftw_complex* testData = testMem.data();
 	fftw_complex* testData2 = 0;
 	if(!inPlace)
@@ -303,7 +312,11 @@ fftw_plan GridInfo::getPlan(GridInfo::PlanType planType, int nThreads) const
 	//--- plan:
 	#define PLANNER_FLAGS FFTW_MEASURE
 	fftw_plan plan = 0;
-	switch(planType)
+	if(howMany > 1) //batch of contiguous full grids
+	{	int sign = (planType==PlanForwardInPlace) ? FFTW_FORWARD : FFTW_BACKWARD;
+		plan = fftw_plan_many_dft(3, &S[0], howMany, testData, 0, 1, nr, testData, 0, 1, nr, sign, PLANNER_FLAGS);
+	}
+	else switch(planType)
 	{	case PlanInverse:        plan = fftw_plan_dft_3d(S[0], S[1], S[2], testData, testData2, FFTW_BACKWARD, PLANNER_FLAGS); break;
 		case PlanForward:        plan = fftw_plan_dft_3d(S[0], S[1], S[2], testData, testData2, FFTW_FORWARD, PLANNER_FLAGS); break;
 		case PlanInverseInPlace: plan = fftw_plan_dft_3d(S[0], S[1], S[2], testData, testData, FFTW_BACKWARD, PLANNER_FLAGS); break;
@@ -311,9 +324,58 @@ fftw_plan GridInfo::getPlan(GridInfo::PlanType planType, int nThreads) const
 		case PlanRtoC:           plan = fftw_plan_dft_r2c_3d(S[0], S[1], S[2], (double*)testData, testData2, PLANNER_FLAGS); break;
 		case PlanCtoR:           plan = fftw_plan_dft_c2r_3d(S[0], S[1], S[2], testData, (double*)testData2, PLANNER_FLAGS); break;
 	}
-	if(!plan) die("Failed to create FFT plan with %d threads",  nThreads);
+	if(!plan) die("Failed to create FFT plan with %d threads (batch size %d)", nThreads, howMany);
 	//--- cache and return plan:
 	((GridInfo*)this)->planCache.insert(std::make_pair(key, plan));
 	planLock.unlock();
 	return plan;
 }
+
+void GridInfo::warmupPlans() const
+{	assert(initialized);
+	if(isGpuEnabled()) return;
+	//Planned synchronously: concurrent setup work would oversubscribe cores and skew the FFTW_MEASURE timings (and hence the saved wisdom)
+	const PlanType planTypes[] = { PlanForward, PlanInverse, PlanForwardInPlace, PlanInverseInPlace, PlanRtoC, PlanCtoR };
+	//Operators called from the main thread use all threads, while those within threadLaunch use one:
+	std::vector<int> nThreadsList(1, nProcsAvailable);
+	if(nProcsAvailable > 1) nThreadsList.push_back(1);
+	for(int nThreads: nThreadsList)
+		for(PlanType planType: planTypes)
+			getPlan(planType, nThreads);
+	//Batched in-place plans for band-level wavefunction transforms (see BandGroup):
+	int howMany = BandGroup::nGridsBatch();
+	if(howMany > 1)
+	{	getPlan(PlanForwardInPlace, 1, howMany);
+		getPlan(PlanInverseInPlace, 1, howMany);
+	}
+}
+
+void GridInfo::importWisdom(std::string filename)
+{	std::lock_guard<std::mutex> lock(planLock);
+	#ifndef MKL_PROVIDES_FFT
+	bool imported = fftw_import_wisdom_from_filename(filename.c_str());
+	logPrintf("FFTW wisdom: %s '%s'\n", imported ? "imported from" : "will be saved to", filename.c_str());
+	wisdomFilename = filename;
+	#else
+	logPrintf("FFTW wisdom file '%s' ignored (not supported by MKL FFTs).\n", filename.c_str());
+	#endif
+}
+
+void GridInfo::exportWisdom()
+{
+	#ifndef MKL_PROVIDES_FFT
+	std::lock_guard<std::mutex> lock(planLock);
+	if(!wisdomFilename.length() || !mpiWorld->isHead()) return;
+	//Write to a temporary file and rename (atomic replacement with concurrent jobs sharing the file):
+	std::ostringstream ossTmp; ossTmp << wisdomFilename << ".tmp" << getpid();
+	std::string tmpFilename = ossTmp.str();
+	if(!fftw_export_wisdom_to_filename(tmpFilename.c_str()))
+	{	logPrintf("WARNING: could not write FFTW wisdom to '%s'.\n", tmpFilename.c_str());
+		return;
+	}
+	if(rename(tmpFilename.c_str(), wisdomFilename.c_str()))
+	{	logPrintf("WARNING: could not update FFTW wisdom file '%s'.\n", wisdomFilename.c_str());
+		remove(tmpFilename.c_str());
+	}
+	#endif
+}
@@ -30,6 +30,8 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <cstdio>
 #include <mutex>
 #include <map>
+#include <tuple>
+#include <string>
 
 /** @brief Simulation grid descriptor
 
@@ -118,7 +120,10 @@ public:
 		PlanRtoC, //!< Real to complex transform
 		PlanCtoR, //!< Complex to real transform
 	};
-	fftw_plan getPlan(PlanType planType, int nThreads) const; //get an FFTW plan of specified type with specified thread count
+	fftw_plan getPlan(PlanType planType, int nThreads, int howMany=1) const; //get an FFTW plan of specified type with specified thread count (batched over howMany contiguous grids for in-place complex types)
+	void warmupPlans() const; //!< create plans of all types for the expected thread counts and batch sizes (CPU only), so that they are ready by first use
+	static void importWisdom(std::string filename); //!< import FFTW wisdom from filename (if it exists), and arrange for exportWisdom() to update it
+	static void exportWisdom(); //!< export accumulated FFTW wisdom to the file specified in importWisdom(), if any (head process only)
 	#ifdef GPU_ENABLED
 	cufftHandle planZ2Z; //!< CUFFT plan for all the complex transforms
 	cufftHandle planD2Z; //!< CUFFT plan for R -> G
@@ -148,9 +153,10 @@ private:
 	bool initialized; //!< keep track of whether initialize() has been called
 	void updateSdependent();
 	
-	//FFTW plans by thread count and type:
-	std::map<std::pair<PlanType,int>,fftw_plan> planCache;
+	//FFTW plans by type, thread count and batch size:
+	std::map<std::tuple<PlanType,int,int>,fftw_plan> planCache;
 	static std::mutex planLock; //Global lock since planner routines are not thread safe
+	static std::string wisdomFilename; //File to export FFTW wisdom to at exit (if non-empty)
 };
 
 //! @}
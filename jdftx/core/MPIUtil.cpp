@@ -24,13 +24,14 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <climits>
 #include <core/Random.h>
 
-MPIUtil::MPIUtil(int argc, char** argv)
+MPIUtil::MPIUtil(int argc, char** argv) : isSplit(false)
 {
 	#ifdef MPI_ENABLED
 	int rc = MPI_Init(&argc, &argv);
 	if(rc != MPI_SUCCESS) { printf("Error starting MPI program. Terminating.\n"); MPI_Abort(MPI_COMM_WORLD, rc); }
-	MPI_Comm_size(MPI_COMM_WORLD, &nProcs);
-	MPI_Comm_rank(MPI_COMM_WORLD, &iProc);
+	comm = MPI_COMM_WORLD;
+	MPI_Comm_size(comm, &nProcs);
+	MPI_Comm_rank(comm, &iProc);
 	#else
 	//No MPI:
 	nProcs = 1;
@@ -40,10 +41,24 @@ MPIUtil::MPIUtil(int argc, char** argv)
 	Random::seed(iProc);
 }
 
+MPIUtil::MPIUtil(const MPIUtil* parent, int color, int key) : isSplit(true)
+{
+	#ifdef MPI_ENABLED
+	MPI_Comm_split(parent->comm, color, key, &comm);
+	MPI_Comm_size(comm, &nProcs);
+	MPI_Comm_rank(comm, &iProc);
+	#else
+	//No MPI:
+	nProcs = 1;
+	iProc = 0;
+	#endif
+}
+
 MPIUtil::~MPIUtil()
 {
 	#ifdef MPI_ENABLED
-	MPI_Finalize();
+	if(isSplit) MPI_Comm_free(&comm);
+	else MPI_Finalize();
 	#endif
 }
 
@@ -168,7 +183,7 @@ void MPIUtil::fopenRead(File& fp, const char* fname, size_t fsizeExpected, const
 			die("Length of '%s' was %" PRIdPTR " instead of the expected %zu bytes.\n%s\n", fname, fsize, fsizeExpected, fsizeErrMsg ? fsizeErrMsg : "");
 	}
 	#ifdef MPI_ENABLED
-	if(MPI_File_open(MPI_COMM_WORLD, (char*)fname, MPI_MODE_RDONLY, MPI_INFO_NULL, &fp) != MPI_SUCCESS)
+	if(MPI_File_open(comm, (char*)fname, MPI_MODE_RDONLY, MPI_INFO_NULL, &fp) != MPI_SUCCESS)
 	#else
 	fp = ::fopen(fname, "rb");
 	if(!fp)
@@ -179,9 +194,9 @@ void MPIUtil::fopenRead(File& fp, const char* fname, size_t fsizeExpected, const
 void MPIUtil::fopenWrite(File& fp, const char* fname) const
 {
 	#ifdef MPI_ENABLED
-	if(mpiUtil->isHead()) MPI_File_delete((char*)fname, MPI_INFO_NULL); //delete existing file, if any
-	MPI_Barrier(MPI_COMM_WORLD);
-	if(MPI_File_open(MPI_COMM_WORLD, (char*)fname, MPI_MODE_WRONLY|MPI_MODE_CREATE, MPI_INFO_NULL, &fp) != MPI_SUCCESS)
+	if(isHead()) MPI_File_delete((char*)fname, MPI_INFO_NULL); //delete existing file, if any
+	MPI_Barrier(comm);
+	if(MPI_File_open(comm, (char*)fname, MPI_MODE_WRONLY|MPI_MODE_CREATE, MPI_INFO_NULL, &fp) != MPI_SUCCESS)
 	#else
 	fp = ::fopen(fname, "wb");
 	if(!fp)
@@ -192,14 +207,14 @@ void MPIUtil::fopenWrite(File& fp, const char* fname) const
 void MPIUtil::fopenAppend(File& fp, const char* fname) const
 {
 	#ifdef MPI_ENABLED
-	if(MPI_File_open(MPI_COMM_WORLD, (char*)fname, MPI_MODE_APPEND|MPI_MODE_WRONLY|MPI_MODE_CREATE, MPI_INFO_NULL, &fp) != MPI_SUCCESS)
+	if(MPI_File_open(comm, (char*)fname, MPI_MODE_APPEND|MPI_MODE_WRONLY|MPI_MODE_CREATE, MPI_INFO_NULL, &fp) != MPI_SUCCESS)
 	#else
 	fp = ::fopen(fname, "a");
 	if(!fp)
 	#endif
 		 die("Error opening file '%s' for writing.\n", fname);
 	#ifdef MPI_ENABLED
-	MPI_Barrier(MPI_COMM_WORLD);
+	MPI_Barrier(comm);
 	#endif
 }
 
@@ -295,3 +310,42 @@ int TaskDivision::whose(size_t q) const
 	else return 0;
 }
 
+//----------------------- Dynamic task queue ------------------------------
+
+TaskQueue::TaskQueue(size_t nTasks, const MPIUtil* mpiParent, const MPIUtil* mpiGroup)
+: nTasks(nTasks), mpiParent(mpiParent), mpiGroup(mpiGroup)
+{
+	#ifdef MPI_ENABLED
+	MPI_Win_allocate(mpiParent->isHead() ? sizeof(long) : 0, sizeof(long), MPI_INFO_NULL, mpiParent->communicator(), &counter, &win);
+	if(mpiParent->isHead()) *counter = 0;
+	MPI_Barrier(mpiParent->communicator()); //make sure counter is initialized before any group claims a task
+	#else
+	counter = 0;
+	#endif
+}
+
+TaskQueue::~TaskQueue()
+{
+	#ifdef MPI_ENABLED
+	MPI_Win_free(&win);
+	#endif
+}
+
+bool TaskQueue::next(size_t& task)
+{	long taskClaimed = 0;
+	if(mpiGroup->isHead())
+	{
+		#ifdef MPI_ENABLED
+		long one = 1;
+		MPI_Win_lock(MPI_LOCK_SHARED, 0, 0, win);
+		MPI_Fetch_and_op(&one, &taskClaimed, MPI_LONG, 0, 0, MPI_SUM, win); //atomic fetch-and-increment
+		MPI_Win_unlock(0, win);
+		#else
+		taskClaimed = counter++;
+		#endif
+	}
+	mpiGroup->bcast(taskClaimed);
+	task = taskClaimed;
+	return task < nTasks;
+}
+
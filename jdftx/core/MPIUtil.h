@@ -39,12 +39,20 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 class MPIUtil
 {
 	int nProcs, iProc;
+	#ifdef MPI_ENABLED
+	MPI_Comm comm; //!< communicator for all operations (comm unless created by a split)
+	#endif
+	bool isSplit; //!< whether this was created by splitting another MPIUtil
 public:
 	int iProcess() const { return iProc; } //!< rank of current process
 	int nProcesses() const { return nProcs; }  //!< number of processes
 	bool isHead() const { return iProc==0; } //!< whether this is the root process (makes code more readable)
+	#ifdef MPI_ENABLED
+	MPI_Comm communicator() const { return comm; } //!< underlying MPI communicator (for direct use of MPI calls)
+	#endif
 
 	MPIUtil(int argc, char** argv);
+	MPIUtil(const MPIUtil* parent, int color, int key); //!< split parent into sub-communicators by color, ordered by key within each
 	~MPIUtil();
 	void exit(int errCode) const; //!< global exit (kill other MPI processes as well)
 
@@ -111,6 +119,28 @@ private:
 	std::vector<size_t> stopArr; //!< array of sttop values for other processes
 };
 
+//! Helper for dynamically distributing tasks of unequal cost over groups of MPI processes.
+//! Tasks are claimed in order from a shared counter (on the head of the parent communicator)
+//! by the head of each group, so that no process needs to act as a dedicated scheduler.
+class TaskQueue
+{
+public:
+	//! Create a queue for tasks 0 to nTasks-1. Collective over mpiParent; mpiGroup must be a split of mpiParent.
+	TaskQueue(size_t nTasks, const MPIUtil* mpiParent, const MPIUtil* mpiGroup);
+	~TaskQueue(); //!< Collective over mpiParent
+	bool next(size_t& task); //!< Claim the next task for the current group (collective over mpiGroup); returns false when none are left
+private:
+	size_t nTasks;
+	const MPIUtil* mpiParent;
+	const MPIUtil* mpiGroup;
+	#ifdef MPI_ENABLED
+	MPI_Win win; //!< window exposing the counter on the head of mpiParent
+	long* counter; //!< number of tasks claimed so far (allocated on head of mpiParent only)
+	#else
+	size_t counter;
+	#endif
+};
+
 //! @}
 
 //-------------------------- Template implementations ------------------------------------
@@ -172,14 +202,14 @@ namespace MPIUtilPrivate
 template<typename T> void MPIUtil::send(const T* data, size_t nData, int dest, int tag) const
 {	using namespace MPIUtilPrivate;
 	#ifdef MPI_ENABLED
-	if(nProcs>1) MPI_Send((T*)data, nData, DataType<T>::get(), dest, tag, MPI_COMM_WORLD);
+	if(nProcs>1) MPI_Send((T*)data, nData, DataType<T>::get(), dest, tag, comm);
 	#endif
 }
 
 template<typename T> void MPIUtil::recv(T* data, size_t nData, int src, int tag) const
 {	using namespace MPIUtilPrivate;
 	#ifdef MPI_ENABLED
-	if(nProcs>1) MPI_Recv(data, nData, DataType<T>::get(), src, tag, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+	if(nProcs>1) MPI_Recv(data, nData, DataType<T>::get(), src, tag, comm, MPI_STATUS_IGNORE);
 	#endif
 }
 
@@ -194,7 +224,7 @@ template<typename T> void MPIUtil::recv(T& data, int src, int tag) const
 template<typename T> void MPIUtil::bcast(T* data, size_t nData, int root) const
 {	using namespace MPIUtilPrivate;
 	#ifdef MPI_ENABLED
-	if(nProcs>1) MPI_Bcast(data, nData, DataType<T>::get(), root, MPI_COMM_WORLD);
+	if(nProcs>1) MPI_Bcast(data, nData, DataType<T>::get(), root, comm);
 	#endif
 }
 
@@ -207,11 +237,11 @@ template<typename T> void MPIUtil::allReduce(T* data, size_t nData, MPIUtil::Red
 	#ifdef MPI_ENABLED
 	if(nProcs>1)
 	{	if(safeMode) //Reduce to root node and then broadcast result (to ensure identical values)
-		{	MPI_Reduce(isHead()?MPI_IN_PLACE:data, data, nData, DataType<T>::get(), mpiOp(op), 0, MPI_COMM_WORLD);
+		{	MPI_Reduce(isHead()?MPI_IN_PLACE:data, data, nData, DataType<T>::get(), mpiOp(op), 0, comm);
 			bcast(data, nData, 0);
 		}
 		else //standard Allreduce
-			MPI_Allreduce(MPI_IN_PLACE, data, nData, DataType<T>::get(), mpiOp(op), MPI_COMM_WORLD);
+			MPI_Allreduce(MPI_IN_PLACE, data, nData, DataType<T>::get(), mpiOp(op), comm);
 	}
 	#endif
 }
@@ -226,7 +256,7 @@ template<typename T> void MPIUtil::allReduce(T& data, int& index, MPIUtil::Reduc
 	if(nProcs>1)
 	{	struct Pair { T data; int index; } pair;
 		pair.data = data; pair.index = index;
-		MPI_Allreduce(MPI_IN_PLACE, &pair, 1, DataTypeIntPair<T>::get(), mpiLocOp(op), MPI_COMM_WORLD);
+		MPI_Allreduce(MPI_IN_PLACE, &pair, 1, DataTypeIntPair<T>::get(), mpiLocOp(op), comm);
 		data = pair.data; index = pair.index;
 	}
 	#endif
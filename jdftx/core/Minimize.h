@@ -22,6 +22,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <core/MinimizeParams.h>
 #include <core/Util.h>
+#include <core/matrix.h>
 #include <deque>
 #include <cmath>
 #include <cfloat>
@@ -76,6 +77,8 @@ private:
 	typedef bool (*Linmin)(Minimizable<Vector>&, const MinimizeParams&, const Vector&, double, double&, double&, Vector&, Vector&);
 	Linmin getLinmin(const MinimizeParams& params) const; //!< Return function pointer to appropriate linmin method based on MinimizeParams
 	double lBFGS(const MinimizeParams& params); //!< limited memory BFGS implementation (differs sufficiently from CG to be justify a separate implementation)
+	double fire(const MinimizeParams& params); //!< FIRE implementation (damped dynamics without line minimization)
+	double newtonCG(const MinimizeParams& params); //!< inexact Newton implementation (Hessian-free, with CG for each Newton step)
 };
 
 /** Interface (abstract base class) for linear conjugate gradients template which
@@ -96,9 +99,18 @@ template<typename Vector> struct LinearSolvable
 	//! Override to synchronize scalars over MPI processes (if the same minimization is happening in sync over many processes)
 	virtual double sync(double x) const { return x; }
 	
-	//! Solve the linear system hessian * state == rhs using conjugate gradients:
+	//! Solve the linear system hessian * state == rhs using conjugate gradients.
+	//! If params.nRecycle > 0, a subspace of that dimension (approximating the slowest-converging modes)
+	//! is retained between successive calls, and used to deflate the next solve \cite DeflatedCG,
+	//! which is effective when the hessian changes only slightly between solves (eg. across SCF steps).
 	//! @return the number of iterations taken to achieve target tolerance
 	int solve(const Vector& rhs, const MinimizeParams& params);
+	
+	//! Discard the recycled subspace (optional, if the hessian changes substantially)
+	void clearRecycled() { recycled.clear(); }
+	
+private:
+	std::vector<Vector> recycled; //!< subspace recycled from previous solves
 };
 
 
@@ -117,10 +129,14 @@ public:
 
 #include <core/Minimize_linmin.h>
 #include <core/Minimize_lBFGS.h>
+#include <core/Minimize_FIRE.h>
+#include <core/Minimize_NewtonCG.h>
 
 template<typename Vector> double Minimizable<Vector>::minimize(const MinimizeParams& p)
 {	if(p.fdTest) fdTest(p); // finite difference test
 	if(p.dirUpdateScheme == MinimizeParams::LBFGS) return lBFGS(p);
+	if(p.dirUpdateScheme == MinimizeParams::FIRE) return fire(p);
+	if(p.dirUpdateScheme == MinimizeParams::NewtonCG) return newtonCG(p);
 	
 	Vector g, gPrev, Kg; //current, previous and preconditioned gradients
 	double E = sync(compute(&g, &Kg)); //get initial energy and gradient
@@ -181,7 +197,9 @@ template<typename Vector> double Minimizable<Vector>::minimize(const MinimizePar
 				case MinimizeParams::PolakRibiere:    beta = (gKNorm-dotgPrevKg)/gKNormPrev; break;
 				case MinimizeParams::HestenesStiefel: beta = (gKNorm-dotgPrevKg)/(dotgd-sync(dot(d,gPrev))); break;
 				case MinimizeParams::SteepestDescent: beta = 0.0; break;
-				case MinimizeParams::LBFGS: break; //Should never encounter since LBFGS handled separately; just to eliminate compiler warnings
+				case MinimizeParams::LBFGS: //Should never encounter since LBFGS, FIRE and NewtonCG handled separately; just to eliminate compiler warnings
+				case MinimizeParams::FIRE:
+				case MinimizeParams::NewtonCG: break;
 			}
 			if(beta<0.0)
 			{	fprintf(p.fpLog, "\n%sEncountered beta<0, resetting CG.", p.linePrefix);
@@ -292,6 +310,7 @@ template<typename Vector> typename Minimizable<Vector>::Linmin Minimizable<Vecto
 		{	switch(p.dirUpdateScheme)
 			{	case MinimizeParams::SteepestDescent: return linminRelax<Vector>;
 				case MinimizeParams::LBFGS: return linminCubicWolfe<Vector>;
+				case MinimizeParams::NewtonCG: return linminCubicWolfe<Vector>;
 				default: return linminQuad<Vector>; //Default for all nonlinear CG methods
 			}
 		}
@@ -303,10 +322,66 @@ template<typename Vector> typename Minimizable<Vector>::Linmin Minimizable<Vecto
 }
 
 
+//Solve symmetric positive (semi-)definite eigenproblem A y = lambda B y in the subspace where B is non-singular,
+//returning eigenvectors (columns of Y) in ascending order of eigenvalues (used for subspace recycling in LinearSolvable)
+inline matrix recycledSubspace_eig(const matrix& A, const matrix& B, int nMax)
+{	matrix Bevecs; diagMatrix Beigs;
+	dagger_symmetrize(B).diagonalize(Bevecs, Beigs);
+	double BeigMax = Beigs.size() ? Beigs.back() : 0.;
+	std::vector<int> iKeep; //drop (nearly) linearly dependent directions:
+	for(int i=0; i<Beigs.nRows(); i++)
+		if(Beigs[i] > 1e-12*BeigMax) iKeep.push_back(i);
+	matrix U = zeroes(B.nRows(), iKeep.size()); //B^(-1/2) within the non-singular subspace
+	for(unsigned j=0; j<iKeep.size(); j++)
+		for(int i=0; i<B.nRows(); i++)
+			U.set(i,j, Bevecs(i,iKeep[j]) / sqrt(Beigs[iKeep[j]]));
+	matrix Aevecs; diagMatrix Aeigs;
+	matrix AU = dagger(U) * A * U;
+	dagger_symmetrize(AU).diagonalize(Aevecs, Aeigs);
+	int nOut = std::min(nMax, int(iKeep.size()));
+	return U * Aevecs(0,Aevecs.nRows(), 0,nOut);
+}
+
 template<typename Vector> int LinearSolvable<Vector>::solve(const Vector& rhs, const MinimizeParams& p)
-{	//Initialize:
+{	//Recycled subspace W and its hessian AW (recomputed since the hessian may have changed):
+	if(!p.nRecycle) recycled.clear();
+	const std::vector<Vector>& W = recycled;
+	int nW = W.size();
+	std::vector<Vector> AW(nW);
+	matrix WAWinv; //inverse of the subspace hessian
+	if(nW)
+	{	matrix WAW(nW, nW);
+		for(int i=0; i<nW; i++) AW[i] = hessian(W[i]);
+		for(int i=0; i<nW; i++)
+			for(int j=0; j<nW; j++)
+				WAW.set(i,j, sync(dot(W[i], AW[j])));
+		matrix Y = recycledSubspace_eig(WAW, WAW, nW); //= WAW^-1/2 within its non-singular subspace
+		WAWinv = Y * dagger(Y);
+	}
+	//Project out the components along the recycled subspace: v -= W WAW^-1 (AW)^T v
+	auto deflate = [&](Vector& v)
+	{	if(!nW) return;
+		matrix proj(nW, 1);
+		for(int j=0; j<nW; j++) proj.set(j,0, sync(dot(AW[j], v)));
+		proj = WAWinv * proj;
+		for(int i=0; i<nW; i++) axpy(-proj(i,0).real(), W[i], v);
+	};
+	std::vector< std::pair<Vector,Vector> > recent; //initial search directions and their hessians (candidates for recycling)
+	
+	//Initialize:
 	Vector r = clone(rhs); axpy(-1.0, hessian(state), r); //residual r = rhs - A.state;
-	Vector z = precondition(r), d = r; //the preconditioned residual and search direction
+	if(nW)
+	{	//Solve exactly within the recycled subspace:
+		matrix Wr(nW, 1);
+		for(int j=0; j<nW; j++) Wr.set(j,0, sync(dot(W[j], r)));
+		Wr = WAWinv * Wr;
+		for(int i=0; i<nW; i++)
+		{	axpy(Wr(i,0).real(), W[i], state);
+			axpy(-Wr(i,0).real(), AW[i], r);
+		}
+	}
+	Vector z = precondition(r), d = clone(z); //the preconditioned residual and search direction
+	deflate(d); //search direction A-orthogonal to recycled subspace
 	double beta=0.0, rdotzPrev=0.0, rdotz = sync(dot(r, z));
 
 	//Check initial residual
@@ -316,13 +391,14 @@ template<typename Vector> int LinearSolvable<Vector>::solve(const Vector& rhs, c
 
 	//Main loop:
 	int iter;
+	bool converged = false;
 	for(iter=0; iter<p.nIterations && !killFlag; iter++)
 	{	//Update search direction:
 		if(rdotzPrev)
 		{	beta = rdotz/rdotzPrev;
 			d *= beta; axpy(1.0, z, d); // d = z + beta*d
+			deflate(d);
 		}
-		else d = clone(z); //fresh search direction (along gradient)
 		//Step:
 		Vector w = hessian(d);
 		double alpha = rdotz/sync(dot(w,d));
@@ -331,14 +407,39 @@ template<typename Vector> int LinearSolvable<Vector>::solve(const Vector& rhs, c
 		z = precondition(r);
 		rdotzPrev = rdotz;
 		rdotz = sync(dot(r, z));
+		if(int(recent.size()) < 2*p.nRecycle) //candidates for recycling from the initial iterations
+			recent.push_back(std::make_pair(clone(d), w));
 		//Print info:
 		double rzNorm = sqrt(fabs(rdotz)/p.nDim);
 		fprintf(p.fpLog, "%sIter: %3d  sqrt(|r.z|): %12.6le  alpha: %12.6le  beta: %13.6le  t[s]: %9.2lf\n",
 			p.linePrefix, iter, rzNorm, alpha, beta, clock_sec()); fflush(p.fpLog);
 		//Check convergence:
-		if(rzNorm<p.knormThreshold) { fprintf(p.fpLog, "%sConverged sqrt(r.z)<%le\n", p.linePrefix, p.knormThreshold); fflush(p.fpLog); return iter; }
+		if(rzNorm<p.knormThreshold) { fprintf(p.fpLog, "%sConverged sqrt(r.z)<%le\n", p.linePrefix, p.knormThreshold); fflush(p.fpLog); converged = true; break; }
+	}
+	if(!converged) { fprintf(p.fpLog, "%sGradient did not converge within threshold in %d iterations\n", p.linePrefix, iter); fflush(p.fpLog); }
+	
+	//Update recycled subspace with the slowest-converging modes (smallest eigenvalues of the preconditioned hessian)
+	//within the span of the previous subspace and the initial search directions (Rayleigh-Ritz for K A):
+	if(p.nRecycle && recent.size())
+	{	std::vector<Vector> Z = W, AZ = AW;
+		for(const auto& dw: recent) { Z.push_back(dw.first); AZ.push_back(dw.second); }
+		int nZ = Z.size();
+		matrix ZAZ(nZ, nZ), AZKAZ(nZ, nZ);
+		for(int j=0; j<nZ; j++)
+		{	Vector KAZj = precondition(AZ[j]);
+			for(int i=0; i<nZ; i++)
+			{	ZAZ.set(i,j, sync(dot(Z[i], AZ[j])));
+				AZKAZ.set(i,j, sync(dot(AZ[i], KAZj)));
+			}
+		}
+		matrix Y = recycledSubspace_eig(AZKAZ, ZAZ, p.nRecycle);
+		std::vector<Vector> Wnew(Y.nCols());
+		for(int c=0; c<Y.nCols(); c++)
+		{	Wnew[c] = clone(Z[0]); Wnew[c] *= Y(0,c).real();
+			for(int i=1; i<nZ; i++) axpy(Y(i,c).real(), Z[i], Wnew[c]);
+		}
+		recycled = Wnew;
 	}
-	fprintf(p.fpLog, "%sGradient did not converge within threshold in %d iterations\n", p.linePrefix, iter); fflush(p.fpLog);
 	return iter;
 }
 
@@ -34,7 +34,9 @@ struct MinimizeParams
 		FletcherReeves, //!< Fletcher-Reeves (preconditioned) conjugate gradients
 		HestenesStiefel, //!< Hestenes-Stiefel (preconditioned) conjugate gradients
 		LBFGS, //!< Limited memory version of the BFGS algorithm
-		SteepestDescent //!< Steepest Descent (always along negative (preconditioned) gradient)
+		SteepestDescent, //!< Steepest Descent (always along negative (preconditioned) gradient)
+		FIRE, //!< Fast inertial relaxation engine: damped dynamics along the negative (preconditioned) gradient, without line minimization
+		NewtonCG //!< Inexact Newton, with preconditioned linear CG for the Newton step using finite-difference Hessian-vector products
 	} dirUpdateScheme;
 
 	//! Line minimization method
@@ -48,6 +50,7 @@ struct MinimizeParams
 	int nIterations; //!< Maximum number of iterations (default 100)
 	int nDim; //!< Dimension of optimization space; used only for knormThreshold (default 1)
 	int history; //!< Number of past variables and residuals to store (BFGS only)
+	int nRecycle; //!< Number of Krylov subspace vectors recycled between successive linear solves (LinearSolvable only; default 0 => disabled)
 	FILE* fpLog; //!< Stream to log iterations to
 	const char* linePrefix; //!< prefix for each output line of minimizer, useful for nested minimizations (default "CG\t")
 	const char* energyLabel; //!< Label for the minimized quantity (default "E")
@@ -69,16 +72,22 @@ struct MinimizeParams
 	
 	bool fdTest; //!< whether to perform a finite difference test before each minimization (default false)
 	
+	//! Preconditioner (only for minimizations that offer alternatives to their default preconditioner)
+	enum Preconditioner
+	{	PreconditionerDefault, //!< default preconditioner of the minimizable (move-scale factors for ionic minimization)
+		PreconditionerExp //!< connectivity-based Exp preconditioner built from atom positions (ionic minimization only) \cite ExpPreconditioner
+	} preconditioner;
+	
 	//! Set the default values
 	MinimizeParams() 
 	: dirUpdateScheme(PolakRibiere), linminMethod(DirUpdateRecommended),
-		nIterations(100), nDim(1), history(15), fpLog(stdout),
+		nIterations(100), nDim(1), history(15), nRecycle(0), fpLog(stdout),
 		linePrefix("CG\t"), energyLabel("E"), energyFormat("%22.15le"),
 		knormThreshold(0), energyDiffThreshold(0), nEnergyDiff(2),
 		alphaTstart(1.0), alphaTmin(1e-10), updateTestStepSize(true),
 		alphaTreduceFactor(0.1), alphaTincreaseFactor(3.0), nAlphaAdjustMax(3),
 		wolfeEnergy(1e-4), wolfeGradient(0.9),
-		fdTest(false) {}
+		fdTest(false), preconditioner(PreconditionerDefault) {}
 };
 
 //! @}
@@ -0,0 +1,127 @@
+/*-------------------------------------------------------------------
+Copyright 2026 agent
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#ifndef JDFTX_CORE_MINIMIZE_FIRE_H
+#define JDFTX_CORE_MINIMIZE_FIRE_H
+
+//! @addtogroup Algorithms
+//! @{
+
+//! FIRE (fast inertial relaxation engine) following \cite FIRE.
+//! The preconditioned negative gradient plays the role of the force and alphaTstart sets the initial time step.
+template<typename Vector> double Minimizable<Vector>::fire(const MinimizeParams& p)
+{	
+	Vector g, Kg; //gradient and preconditioned gradient
+	double E = sync(compute(&g, &Kg)); //get initial energy and gradient
+	
+	EdiffCheck ediffCheck(p.nEnergyDiff, p.energyDiffThreshold); //list of past energies
+	
+	//Parameters (values recommended in the reference):
+	const int nDelay = 5; //number of steps with positive power before time step may increase
+	const double dtIncrease = 1.1, dtDecrease = 0.5; //time step adjustment factors
+	const double mixStart = 0.1, mixDecay = 0.99; //initial velocity-mixing fraction and its decay factor
+	const double dtMax = 10.*p.alphaTstart; //maximum time step
+	
+	Vector v = clone(Kg); v *= 0.; //velocity
+	double dt = p.alphaTstart; //time step
+	double mix = mixStart; //velocity-mixing fraction
+	int nPositive = 0; //number of successive steps with positive power
+	double alpha = 0.; //actual step size of previous step (may be limited by safeStepSize)
+	
+	//Iterate until convergence, max iteration count or kill signal
+	int iter=0;
+	for(iter=0; !killFlag; iter++)
+	{	
+		if(report(iter)) //optional reporting/processing
+		{	E = sync(compute(&g, &Kg)); //update energy and gradient if state was modified
+			fprintf(p.fpLog, "%s\tState modified externally: resetting velocity.\n", p.linePrefix);
+			fflush(p.fpLog);
+			v *= 0.; mix = mixStart; nPositive = 0;
+		}
+		
+		double gKnorm = sync(dot(g,Kg));
+		fprintf(p.fpLog, "%sIter: %3d  %s: ", p.linePrefix, iter, p.energyLabel);
+		fprintf(p.fpLog, p.energyFormat, E);
+		fprintf(p.fpLog, "  |grad|_K: %10.3le", sqrt(gKnorm/p.nDim));
+		if(alpha) fprintf(p.fpLog, "  alpha: %10.3le  dt: %10.3le", alpha, dt);
+		fprintf(p.fpLog, "  t[s]: %9.2lf", clock_sec());
+		
+		//Check stopping conditions:
+		fprintf(p.fpLog, "\n"); fflush(p.fpLog);
+		if(sqrt(gKnorm/p.nDim) < p.knormThreshold)
+		{	fprintf(p.fpLog, "%sConverged (|grad|_K<%le).\n", p.linePrefix, p.knormThreshold);
+			fflush(p.fpLog); return E;
+		}
+		if(ediffCheck.checkConvergence(E))
+		{	fprintf(p.fpLog, "%sConverged (|Delta %s|<%le for %d iters).\n",
+				p.linePrefix, p.energyLabel, p.energyDiffThreshold, p.nEnergyDiff);
+			fflush(p.fpLog); return E;
+		}
+		if(!std::isfinite(gKnorm))
+		{	fprintf(p.fpLog, "%s|grad|_K=%le. Stopping ...\n", p.linePrefix, gKnorm);
+			fflush(p.fpLog); return E;
+		}
+		if(!std::isfinite(E))
+		{	fprintf(p.fpLog, "%sE=%le. Stopping ...\n", p.linePrefix, E);
+			fflush(p.fpLog); return E;
+		}
+		if(iter>=p.nIterations) break;
+		
+		//Mix velocity towards the force direction while moving downhill, else stop and reduce time step:
+		double power = -sync(dot(g,v));
+		if(power > 0.)
+		{	double vNorm = sqrt(sync(dot(v,v)));
+			double KgNorm = sqrt(sync(dot(Kg,Kg)));
+			v *= (1.-mix); axpy(-mix*vNorm/KgNorm, Kg, v);
+			if(++nPositive > nDelay)
+			{	dt = std::min(dt*dtIncrease, dtMax);
+				mix *= mixDecay;
+			}
+		}
+		else
+		{	v *= 0.; mix = mixStart; nPositive = 0;
+			if(iter) dt *= dtDecrease;
+		}
+		
+		//Semi-implicit Euler step:
+		axpy(-dt, Kg, v);
+		constrain(v); //restrict to allowed subspace
+		alpha = std::min(dt, safeStepSize(v));
+		step(v, alpha);
+		E = sync(compute(&g, &Kg));
+		if(!std::isfinite(E))
+		{	//Undo step and try again with a smaller time step:
+			fprintf(p.fpLog, "%s\tStep failed: undoing step and reducing time step.\n", p.linePrefix);
+			fflush(p.fpLog);
+			step(v, -alpha);
+			E = sync(compute(&g, &Kg));
+			v *= 0.; mix = mixStart; nPositive = 0;
+			dt *= dtDecrease;
+			if(dt < p.alphaTmin)
+			{	fprintf(p.fpLog, "%sTime step below alphaTmin. (Stopping)\n", p.linePrefix);
+				fflush(p.fpLog); return E;
+			}
+		}
+	}
+	fprintf(p.fpLog, "%sNone of the convergence criteria satisfied after %d iterations.\n", p.linePrefix, iter);
+	return E;
+}
+
+//! @}
+#endif //JDFTX_CORE_MINIMIZE_FIRE_H
@@ -0,0 +1,150 @@
+/*-------------------------------------------------------------------
+Copyright 2026 agent
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#ifndef JDFTX_CORE_MINIMIZE_NEWTONCG_H
+#define JDFTX_CORE_MINIMIZE_NEWTONCG_H
+
+//! @addtogroup Algorithms
+//! @{
+
+//! Inexact (truncated) Newton method: each Newton step is solved approximately using preconditioned CG,
+//! with hessian-vector products from finite differences of the gradient, and forcing terms following \cite NewtonCG.
+//! The preconditioner is assumed to be linear and state-independent, so that K.H.d = (Kg(x+h d) - Kg(x))/h.
+template<typename Vector> double Minimizable<Vector>::newtonCG(const MinimizeParams& p)
+{	
+	Vector g, Kg; //gradient and preconditioned gradient
+	double E = sync(compute(&g, &Kg)); //get initial energy and gradient
+	
+	EdiffCheck ediffCheck(p.nEnergyDiff, p.energyDiffThreshold); //list of past energies
+	
+	double alpha = 0.; //step size (full Newton step corresponds to alpha = 1)
+	int nInnerPrev = 0; //number of inner CG iterations in previous Newton step
+	bool forceGradDirection = false; //whether to skip the Newton step and use the preconditioned gradient direction (after failures)
+	const int nInnerMax = 50; //maximum number of inner CG iterations per Newton step
+	
+	//Select the linmin method:
+	Linmin linmin = getLinmin(p);
+	
+	//Iterate until convergence, max iteration count or kill signal
+	int iter=0;
+	for(iter=0; !killFlag; iter++)
+	{	
+		if(report(iter)) //optional reporting/processing
+			E = sync(compute(&g, &Kg)); //update energy and gradient if state was modified
+		
+		double gKnorm = sync(dot(g,Kg));
+		fprintf(p.fpLog, "%sIter: %3d  %s: ", p.linePrefix, iter, p.energyLabel);
+		fprintf(p.fpLog, p.energyFormat, E);
+		fprintf(p.fpLog, "  |grad|_K: %10.3le", sqrt(gKnorm/p.nDim));
+		if(alpha) fprintf(p.fpLog, "  alpha: %10.3le  nInner: %2d", alpha, nInnerPrev);
+		fprintf(p.fpLog, "  t[s]: %9.2lf", clock_sec());
+		
+		//Check stopping conditions:
+		fprintf(p.fpLog, "\n"); fflush(p.fpLog);
+		if(sqrt(gKnorm/p.nDim) < p.knormThreshold)
+		{	fprintf(p.fpLog, "%sConverged (|grad|_K<%le).\n", p.linePrefix, p.knormThreshold);
+			fflush(p.fpLog); return E;
+		}
+		if(ediffCheck.checkConvergence(E))
+		{	fprintf(p.fpLog, "%sConverged (|Delta %s|<%le for %d iters).\n",
+				p.linePrefix, p.energyLabel, p.energyDiffThreshold, p.nEnergyDiff);
+			fflush(p.fpLog); return E;
+		}
+		if(!std::isfinite(gKnorm))
+		{	fprintf(p.fpLog, "%s|grad|_K=%le. Stopping ...\n", p.linePrefix, gKnorm);
+			fflush(p.fpLog); return E;
+		}
+		if(!std::isfinite(E))
+		{	fprintf(p.fpLog, "%sE=%le. Stopping ...\n", p.linePrefix, E);
+			fflush(p.fpLog); return E;
+		}
+		if(iter>=p.nIterations) break;
+		
+		//Solve H.d = -g approximately using preconditioned CG (starting from d = 0):
+		const double eta = std::min(0.5, sqrt(sqrt(gKnorm/p.nDim))); //forcing term: relative tolerance on the residual norm
+		Vector d = clone(Kg); d *= 0.; //Newton step
+		Vector r = clone(g); r *= -1.; //residual -g - H.d
+		Vector z = clone(Kg); z *= -1.; //preconditioned residual
+		Vector u = clone(z); //inner search direction
+		double rdotz = gKnorm, rdotzPrev = 0.;
+		int nInner = 0;
+		if(forceGradDirection) d = clone(u);
+		else for(nInner=0; nInner<nInnerMax && !killFlag; nInner++)
+		{	if(rdotzPrev)
+			{	u *= rdotz/rdotzPrev;
+				axpy(1., z, u);
+			}
+			//Hessian-vector product by forward difference of the gradient:
+			double uNorm = sqrt(sync(dot(u,u)));
+			double h = sqrt(DBL_EPSILON * p.nDim) / uNorm; //finite difference step
+			Vector gh, Kgh;
+			step(u, h);
+			sync(compute(&gh, &Kgh));
+			step(u, -h);
+			axpy(-1., g, gh); gh *= (1./h); //= H.u
+			axpy(-1., Kg, Kgh); Kgh *= (1./h); //= K.H.u
+			double uHu = sync(dot(u, gh));
+			if(!(uHu > 0.))
+			{	//Negative curvature: use preconditioned steepest descent if encountered immediately, else the current step
+				if(!nInner) d = clone(u);
+				break;
+			}
+			double a = rdotz / uHu;
+			axpy(a, u, d);
+			axpy(-a, gh, r);
+			axpy(-a, Kgh, z);
+			rdotzPrev = rdotz;
+			rdotz = sync(dot(r, z));
+			if(fabs(rdotz) < eta*eta*gKnorm) { nInner++; break; }
+		}
+		nInnerPrev = nInner;
+		constrain(d); //restrict step to allowed subspace
+		
+		//Line minimization
+		double alphaT = std::min(p.alphaTstart, safeStepSize(d));
+		if(linmin(*this, p, d, alphaT, alpha, E, g, Kg))
+			forceGradDirection = false; //linmin succeeded
+		else
+		{	//linmin failed:
+			fprintf(p.fpLog, "%s\tUndoing step.\n", p.linePrefix);
+			step(d, -alpha);
+			E = sync(compute(&g, &Kg));
+			if(!forceGradDirection)
+			{	//Failed, but not along the gradient direction:
+				fprintf(p.fpLog, "%s\tStep failed along Newton direction: retrying along gradient.\n", p.linePrefix);
+				fflush(p.fpLog);
+				forceGradDirection = true;
+				alpha = 0.;
+				continue;
+			}
+			else
+			{	//Failed along the gradient direction
+				fprintf(p.fpLog, "%s\tStep failed along negative gradient direction.\n", p.linePrefix);
+				fprintf(p.fpLog, "%sProbably at roundoff error limit. (Stopping)\n", p.linePrefix);
+				fflush(p.fpLog);
+				return E;
+			}
+		}
+	}
+	fprintf(p.fpLog, "%sNone of the convergence criteria satisfied after %d iterations.\n", p.linePrefix, iter);
+	return E;
+}
+
+//! @}
+#endif //JDFTX_CORE_MINIMIZE_NEWTONCG_H
@@ -0,0 +1,103 @@
+/*-------------------------------------------------------------------
+Copyright 2026 agent
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+
+#include <core/NeighborList.h>
+#include <core/Thread.h>
+#include <cmath>
+
+NeighborList::NeighborList(double rCut, double skin, vector3<bool> isPeriodic)
+: rCut(rCut), skin(skin), isPeriodic(isPeriodic)
+{
+}
+
+bool NeighborList::update(const matrix3<>& Rnew, const std::vector< vector3<> >& pos)
+{	//Check whether rebuild is necessary:
+	bool needBuild = (pos.size() != posBuild.size()) || (nrm2(Rnew - R) > 1e-12*nrm2(Rnew));
+	if(!needBuild)
+	{	double dispMaxSq = std::pow(0.5*skin, 2);
+		for(size_t i=0; i<pos.size(); i++)
+			if(Rnew.metric_length_squared(pos[i] - posBuild[i]) > dispMaxSq)
+			{	needBuild = true;
+				break;
+			}
+	}
+	if(!needBuild) return false;
+	R = Rnew;
+	posBuild = pos;
+	build();
+	return true;
+}
+
+void NeighborList::build()
+{	int N = posBuild.size();
+	double rMax = rCut + skin;
+	//Determine cell division (with lattice planes of cells at least rMax apart along periodic directions):
+	matrix3<> invR = inv(R);
+	vector3<int> dMax; //maximum cell offset along each direction that can be within range
+	for(int k=0; k<3; k++)
+	{	if(isPeriodic[k])
+		{	double L = 1./invR.row(k).length(); //spacing between lattice planes normal to invR.row(k)
+			nCells[k] = std::max(1, int(floor(L/rMax)));
+			dMax[k] = int(ceil(nCells[k]*rMax/L));
+		}
+		else
+		{	nCells[k] = 1;
+			dMax[k] = 0;
+		}
+	}
+	//Stencil of cell offsets, pruned using a lower bound on the distance between points in the two cells:
+	matrix3<> Rcell = R * Diag(vector3<>(1./nCells[0], 1./nCells[1], 1./nCells[2])); //lattice vectors of each cell
+	double cellDiag = Rcell.column(0).length() + Rcell.column(1).length() + Rcell.column(2).length();
+	stencil.clear();
+	vector3<int> d;
+	for(d[0]=-dMax[0]; d[0]<=dMax[0]; d[0]++)
+	for(d[1]=-dMax[1]; d[1]<=dMax[1]; d[1]++)
+	for(d[2]=-dMax[2]; d[2]<=dMax[2]; d[2]++)
+		if((Rcell * vector3<>(d[0],d[1],d[2])).length() - cellDiag <= rMax)
+			stencil.push_back(d);
+	//Wrap positions along periodic directions and bin into cells:
+	posWrapped.resize(N);
+	shift.resize(N);
+	cellOf.resize(N);
+	cellMembers.assign(nCells[0]*nCells[1]*nCells[2], std::vector<int>());
+	for(int i=0; i<N; i++)
+	{	for(int k=0; k<3; k++)
+		{	shift[i][k] = isPeriodic[k] ? -int(floor(posBuild[i][k])) : 0;
+			posWrapped[i][k] = posBuild[i][k] + shift[i][k];
+			cellOf[i][k] = isPeriodic[k] ? std::min(nCells[k]-1, std::max(0, int(floor(posWrapped[i][k] * nCells[k])))) : 0;
+		}
+		const vector3<int>& c = cellOf[i];
+		cellMembers[c[2] + nCells[2]*(c[1] + nCells[1]*c[0])].push_back(i);
+	}
+	//Store explicit neighbor lists if memory permits:
+	double nPairsEst = N * (N/fabs(det(R))) * (4*M_PI/3) * pow(rMax,3);
+	neighbors.clear();
+	if(nPairsEst < nPairsMax)
+	{	neighbors.resize(N);
+		threadLaunch(build_sub, N, this);
+	}
+}
+
+void NeighborList::build_sub(size_t iStart, size_t iStop, NeighborList* nl)
+{	for(size_t i=iStart; i<iStop; i++)
+	{	std::vector<Neighbor>& nbrs = nl->neighbors[i];
+		nl->traverse(i, [&](int j, const vector3<int>& iR) { nbrs.push_back(Neighbor{j, iR}); });
+	}
+}
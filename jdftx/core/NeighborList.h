@@ -0,0 +1,112 @@
+/*-------------------------------------------------------------------
+Copyright 2026 agent
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+
+#ifndef JDFTX_CORE_NEIGHBORLIST_H
+#define JDFTX_CORE_NEIGHBORLIST_H
+
+#include <core/matrix3.h>
+#include <vector>
+
+//! @addtogroup LongRange
+//! @{
+
+//! @file NeighborList.h Cell-list construction of pair neighbor lists with a Verlet skin
+
+/** @brief Neighbor lists for pair interactions between point particles in a (partially) periodic cell
+
+Particles are binned into a cell list (with cells no thinner than rCut + skin along each periodic lattice
+direction), and only periodic images in the stencil of neighbouring cells are examined, so that the cost
+is O(N) for cutoffs shorter than the cell dimensions. When their memory is bounded, explicit (Verlet) lists
+of the images within rCut + skin of each particle are also stored; otherwise (e.g. for long cutoffs
+in small cells) the stencil is traversed on the fly. Both are reused by update() for as long as no
+particle has moved by more than half the skin since they were built (e.g. across steps of ionic dynamics).
+*/
+class NeighborList
+{
+public:
+	//! Initialize for pairs within distance rCut, with the lists extended by skin for reuse.
+	//! Periodic images are included only along directions with isPeriodic set.
+	NeighborList(double rCut, double skin, vector3<bool> isPeriodic=vector3<bool>(true,true,true));
+	
+	//! Update for lattice vectors R and particle positions pos (in lattice coordinates).
+	//! The lists are rebuilt only if R or the number of particles changed, or if any particle
+	//! moved by more than half the skin since the last build; returns true if rebuilt.
+	bool update(const matrix3<>& R, const std::vector< vector3<> >& pos);
+	
+	//! Call f(j, iR) for each periodic image of particle j (other than i itself) that could be within rCut of particle i,
+	//! where iR is the lattice vector offset such that their separation is x = iR + (pos_i - pos_j) in lattice coordinates
+	//! for the positions pos passed to update(). Candidates with separations exceeding rCut should be skipped by f.
+	template<typename Func> void forNeighbors(int i, const Func& f) const
+	{	if(neighbors.size()) { for(const Neighbor& nbr: neighbors[i]) f(nbr.j, nbr.iR); }
+		else traverse(i, f);
+	}
+	
+	double getCutoff() const { return rCut; } //!< cutoff distance for pairs
+	
+	static const size_t nPairsMax = 1<<24; //!< maximum number of pairs for which explicit lists are stored
+	
+private:
+	double rCut, skin;
+	vector3<bool> isPeriodic;
+	matrix3<> R; //!< lattice vectors at last build
+	std::vector< vector3<> > posBuild; //!< particle positions at last build
+	
+	//Cell list:
+	vector3<int> nCells; //!< number of cells along each lattice direction
+	std::vector< vector3<int> > stencil; //!< offsets of cells that could contain particles within rCut + skin of a given cell
+	std::vector< vector3<> > posWrapped; //!< positions wrapped into [0,1) along periodic directions
+	std::vector< vector3<int> > shift; //!< lattice vectors added to obtain posWrapped from posBuild
+	std::vector< vector3<int> > cellOf; //!< cell containing each particle
+	std::vector< std::vector<int> > cellMembers; //!< list of particles in each cell
+	
+	//Explicit neighbor lists (if within nPairsMax):
+	struct Neighbor
+	{	int j; //!< index of the other particle
+		vector3<int> iR; //!< lattice vector offset
+	};
+	std::vector< std::vector<Neighbor> > neighbors; //!< neighbors of each particle (empty if not stored)
+	
+	void build();
+	static void build_sub(size_t iStart, size_t iStop, NeighborList* nl);
+	
+	//! Call f(j, iR) for images within rCut + skin of particle i using the cell list
+	template<typename Func> void traverse(int i, const Func& f) const
+	{	const matrix3<> RTR = (~R) * R;
+		double rMaxSq = (rCut + skin) * (rCut + skin);
+		const vector3<>& xi = posWrapped[i];
+		for(const vector3<int>& d: stencil)
+		{	vector3<int> c, s; //neighbouring cell within unit cell, and the lattice vector offset to its image
+			for(int k=0; k<3; k++)
+			{	int ck = cellOf[i][k] + d[k];
+				s[k] = (ck>=0) ? ck/nCells[k] : -((nCells[k]-1-ck)/nCells[k]); //floor division
+				c[k] = ck - s[k]*nCells[k];
+			}
+			for(int j: cellMembers[c[2] + nCells[2]*(c[1] + nCells[1]*c[0])])
+			{	vector3<int> iR = shift[i] - shift[j] - s;
+				if(i==j && !iR.length_squared()) continue; //exclude self-interaction
+				if(RTR.metric_length_squared(xi - (posWrapped[j] + s)) > rMaxSq) continue;
+				f(j, iR);
+			}
+		}
+	}
+};
+
+//! @}
+#endif // JDFTX_CORE_NEIGHBORLIST_H
@@ -64,7 +64,14 @@ struct RadialFunctionG
 		if(Gindex >= nCoeff-5) return 0.;
 		else return QuinticSpline::value(getCoeff(), Gindex);
 	}
-	
+
+	//! Derivative of blip w.r.t G
+	__hostanddev__ double deriv(double G) const
+	{	double Gindex = G * dGinv;
+		if(Gindex >= nCoeff-5) return 0.;
+		else return QuinticSpline::deriv(getCoeff(), Gindex) * dGinv;
+	}
+
 	RadialFunctionR* rFunc; //!< copy of the real-space radial version (if created from one)
 	
 	#ifndef __in_a_cu_file__
@@ -128,6 +128,21 @@ template<int l, int m> __hostanddev__ double Ylm(const vector3<>& qhat)
 {	return Ylm<l*(l+1)+m>(qhat);
 }
 
+//! Cartesian derivative along iDir of the solid harmonic r^l Ylm, evaluated at unit vector qhat
+//! (Since YlmInternal::Ylm are homogeneous polynomials of degree l <= 6, the 7-point central difference is exact)
+template<int l, int m> __hostanddev__ double YlmPrime(const vector3<>& qhat, int iDir)
+{	const double h = 0.5; //step size (arbitrary since the stencil is exact)
+	const double w[3] = { 45./(60.*h), -9./(60.*h), 1./(60.*h) };
+	double result = 0.;
+	for(int s=1; s<=3; s++)
+	{	vector3<> qPlus(qhat), qMinus(qhat);
+		qPlus[iDir] += s*h;
+		qMinus[iDir] -= s*h;
+		result += w[s-1] * (Ylm<l,m>(qPlus) - Ylm<l,m>(qMinus));
+	}
+	return result;
+}
+
 //! Switch a function templated over l,m for all supported l,m with parenthesis enclosed argument list argList
 #define SwitchTemplate_lm(l,m,fTemplate,argList) \
 	switch(l*(l+1)+m) \
@@ -53,6 +53,13 @@ namespace QuinticSpline
 	//! @param E_value Input derivative with respect to value
 	//! @param E_coeff
 	__hostanddev__ void valueGrad(double E_value, double* E_coeff, double x);
+	
+	//! @brief Weights w such that value(coeff, x) = sum_i w[i] coeff[j+i], for reusing the interpolation at fixed x
+	//! for several coefficient arrays (and the corresponding gradient propagation)
+	//! @param x location to evaluate spline in the continuous range [0, nCoeff-1)
+	//! @param w Output weights of the 6 coefficients starting at j
+	//! @return Offset j of first coefficient (= floor(x))
+	__hostanddev__ int getWeights(double x, double (&w)[6]);
 }
 
 //! @}
@@ -109,11 +116,11 @@ namespace QuinticSpline
 	#ifdef __CUDA_ARCH__
 	extern __shared__ double shared_E_coeff[];
 	#endif
-	__hostanddev__ void valueGrad(double E_value, double* E_coeff, double x)
+	__hostanddev__ int getWeights(double x, double (&c)[6])
 	{	int j = (int)x;
 		double tR = x - j; //right weight for interval
 		double tL = 1.-tR; //left weight for interval
-		double b[6], c[6];
+		double b[6];
 		//Backtrace de Casteljau's reduction:
 		b[0]=tL; b[1]=tR; //0->1
 		c[0]=0.; for(int i=0; i<2; i++) { c[i] += tL*b[i]; c[i+1] = tR*b[i]; } //1->2
@@ -127,6 +134,12 @@ namespace QuinticSpline
 		c[3] = (1./33) * (13*b[0] + 18*b[1] + 24*b[2] + 30*b[3] + 33*b[4] + 33*b[5]);
 		c[4] = (1./66) * (b[0] + 2*b[1] + 4*b[2] + 8*b[3] + 16*b[4] + 26*b[5]);
 		c[5] = (1./66) * (b[5]);
+		return j;
+	}
+	
+	__hostanddev__ void valueGrad(double E_value, double* E_coeff, double x)
+	{	double c[6];
+		int j = getWeights(x, c);
 		//Accumulate E_coeff:
 		#ifndef __CUDA_ARCH__
 			for(int i=0; i<6; i++) E_coeff[j+i] += E_value * c[i];
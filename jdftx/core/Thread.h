@@ -28,6 +28,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <core/Util.h>
 #include <thread>
 #include <mutex>
+#include <functional>
 #include <unistd.h>
 
 extern int nProcsAvailable; //!< number of available processors (initialized to number of online processors, can be overriden)
@@ -35,9 +36,12 @@ extern int nProcsAvailable; //!< number of available processors (initialized to
 /**
 Operators should run multithreaded if this returns true,
 and should run in a single thread if this returns false.
-Note that all the thread launching functions in this file
-automatically prevent nested threading, so operator codes
-using those functions need not explicitly check this.
+This returns false within a parallel section (i.e. in any thread
+executing a threadLaunch'd function), so that operators relying
+on externally threaded libraries (eg. FFTW, MKL) do not oversubscribe.
+Note that the thread launching functions in this file run nested
+launches on any idle workers of the ThreadPool instead, so operator
+codes using those functions need not explicitly check this.
 
 This only affects CPU threading, GPU operators should
 only be called from a single thread anyway.
@@ -48,6 +52,22 @@ void suspendOperatorThreading(); //!< call from multi-threaded top-level code to
 void resumeOperatorThreading(); //!< call after a parallel section in top-level code to resume threading within subsequent operator calls
 
 
+/**
+@brief Persistent pool of worker threads behind threadLaunch
+
+The workers are created on first use (and added to whenever a launch requests more threads)
+and then sleep between launches, so that a launch costs a wake-up rather than a thread creation.
+Each launch is a job of nTasks tasks, which are claimed one at a time by the calling thread and
+any idle workers. Nested launches from within a task are therefore safe: they are shared with
+workers that become idle, and run entirely in the calling thread if all workers are busy.
+*/
+namespace ThreadPool
+{
+	void run(int nTasks, const std::function<void(int)>& task); //!< call task(iTask) for 0 <= iTask < nTasks, and return when all have completed
+	bool inParallelSection(); //!< whether the current thread is executing a task of run()
+	void setAffinity(bool pin); //!< pin workers to distinct processors of the process's affinity mask (by default, only if the mask is restricted eg. by mpirun bindings)
+}
+
 /**
 @brief A simple utility for running muliple threads
 
@@ -143,23 +163,20 @@ double threadedAccumulate(Callable* func, size_t nIter, Args... args);
 //##########################
 //! @cond
 
+bool threadLaunchEnabled(); //whether threadLaunch should use multiple threads by default (not suspended by top-level code)
+
 template<typename Callable,typename ... Args>
 void threadLaunch(int nThreads, Callable* func, size_t nJobs, Args... args)
-{	if(nThreads<=0) nThreads = shouldThreadOperators() ? nProcsAvailable : 1;
-	if(nThreads>1) suspendOperatorThreading(); //Prevent func and anything it calls from launching nested threads
-	std::thread** tArr = new std::thread*[nThreads-1];
-	for(int t=0; t<nThreads; t++)
+{	if(nThreads<=0) nThreads = threadLaunchEnabled() ? nProcsAvailable : 1;
+	if(nThreads==1)
+	{	(*func)(0, nJobs>0 ? nJobs : 1, args...); //no need to involve the thread pool
+		return;
+	}
+	ThreadPool::run(nThreads, [&](int t)
 	{	size_t i1 = (nJobs>0 ? (  t   * nJobs)/nThreads : t);
 		size_t i2 = (nJobs>0 ? ((t+1) * nJobs)/nThreads : nThreads);
-		if(t<nThreads-1) tArr[t] = new std::thread(func, i1, i2, args...);
-		else (*func)(i1, i2, args...);
-	}
-	for(int t=0; t<nThreads-1; t++)
-	{	tArr[t]->join();
-		delete tArr[t];
-	}
-	delete[] tArr;
-	if(nThreads>1) resumeOperatorThreading(); //End nested threading guard section
+		(*func)(i1, i2, args...);
+	});
 }
 
 template<typename Callable,typename ... Args>
@@ -170,7 +187,7 @@ void threadLaunch(Callable* func, size_t nJobs, Args... args)
 
 template<typename Callable,typename ... Args>
 void threadLaunch(AutoThreadCount* atc, Callable* func, size_t nJobs, Args... args)
-{	if(!atc)
+{	if(!atc || ThreadPool::inParallelSection()) //nested launches are timed by the enclosing launch instead
 		threadLaunch(func, nJobs, args...);
 	else
 	{	int nThreads = atc->getThreadCount();
@@ -0,0 +1,183 @@
+/*-------------------------------------------------------------------
+Copyright 2026 agent
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+
+#include <core/Thread.h>
+#include <condition_variable>
+#include <atomic>
+#include <list>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#if defined(MKL_PROVIDES_BLAS) || defined(MKL_PROVIDES_FFT)
+#include <mkl.h>
+#endif
+
+namespace ThreadPool
+{
+	//! A single launch: tasks are claimed in order by the caller and idle workers
+	struct Job
+	{	const std::function<void(int)>* task;
+		int nTasks;
+		int nClaimed; //!< number of tasks claimed so far (protected by Pool::m)
+		std::atomic<int> nDone; //!< number of tasks completed so far
+	};
+	
+	//! Shared state of the pool (allocated once and never freed, so that workers never outlive it)
+	struct Pool
+	{	std::mutex m;
+		std::condition_variable cvWork; //!< signalled when new tasks are available
+		std::condition_variable cvDone; //!< signalled when a job completes
+		std::list<Job*> jobs; //!< jobs with unclaimed tasks
+		std::atomic<int> nUnclaimed; //!< total number of unclaimed tasks (for spinning without the lock)
+		int nWorkers;
+		int pinMode; //!< -1: pin only if affinity mask is restricted, 0: never pin, 1: always pin
+		#ifdef __linux__
+		cpu_set_t cpuMask; //!< affinity mask of the process when the pool was created
+		#endif
+		
+		Pool() : nUnclaimed(0), nWorkers(0), pinMode(-1)
+		{
+			#ifdef __linux__
+			CPU_ZERO(&cpuMask);
+			sched_getaffinity(0, sizeof(cpuMask), &cpuMask);
+			#endif
+		}
+		
+		//! Claim a task of job (must be called with m locked, and job must have unclaimed tasks)
+		int claim(Job* job)
+		{	int iTask = job->nClaimed++;
+			if(job->nClaimed == job->nTasks) jobs.remove(job); //job fully claimed
+			nUnclaimed--;
+			return iTask;
+		}
+	};
+	Pool* pool = 0;
+	std::mutex poolLock; //!< protects creation of pool
+	
+	thread_local int parallelDepth = 0; //!< number of nested tasks of run() being executed by current thread
+	const double spinTime_us = 50.; //!< time for which threads spin before sleeping (much less than a typical kernel, much more than a wake-up)
+	
+	bool inParallelSection()
+	{	return parallelDepth > 0;
+	}
+	
+	//Run one task and report its completion
+	inline void execute(Job* job, int iTask)
+	{	parallelDepth++;
+		(*job->task)(iTask);
+		parallelDepth--;
+		int nTasks = job->nTasks; //job may be destroyed by its caller as soon as the last task completes
+		if(++job->nDone == nTasks)
+		{	std::lock_guard<std::mutex> lock(pool->m);
+			pool->cvDone.notify_all();
+		}
+	}
+	
+	//Pin current thread to the iCpu'th processor (cyclically) of the process's affinity mask
+	void pinThread(int iCpu)
+	{
+		#ifdef __linux__
+		int nCpus = CPU_COUNT(&pool->cpuMask);
+		if(!nCpus) return;
+		iCpu = iCpu % nCpus;
+		for(int cpu=0; cpu<CPU_SETSIZE; cpu++)
+			if(CPU_ISSET(cpu, &pool->cpuMask) && !(iCpu--))
+			{	cpu_set_t cpuSet; CPU_ZERO(&cpuSet); CPU_SET(cpu, &cpuSet);
+				pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet);
+				return;
+			}
+		#endif
+	}
+	
+	//Main loop of each worker thread
+	void worker(int iWorker)
+	{	//Pin to a processor distinct from the caller (which is not moved):
+		bool pin = pool->pinMode;
+		#ifdef __linux__
+		if(pool->pinMode < 0) pin = (CPU_COUNT(&pool->cpuMask) < sysconf(_SC_NPROCESSORS_ONLN)); //process has been bound to a subset of processors
+		#endif
+		if(pin) pinThread(iWorker+1);
+		#if defined(MKL_PROVIDES_BLAS) || defined(MKL_PROVIDES_FFT)
+		mkl_set_num_threads_local(1); //MKL calls from within tasks should not spawn threads
+		#endif
+		while(true)
+		{	//Spin briefly before sleeping, to catch the next launch of short kernels in quick succession:
+			double spinStart = clock_us();
+			while(!pool->nUnclaimed && clock_us()-spinStart < spinTime_us)
+				std::this_thread::yield();
+			//Claim a task, waiting for one if necessary:
+			int iTask; Job* job;
+			{	std::unique_lock<std::mutex> lock(pool->m);
+				pool->cvWork.wait(lock, [](){ return pool->jobs.size() > 0; });
+				job = pool->jobs.front(); //oldest job first, since outer launches typically have the coarser tasks
+				iTask = pool->claim(job);
+			}
+			execute(job, iTask);
+		}
+	}
+	
+	void run(int nTasks, const std::function<void(int)>& task)
+	{	{	std::lock_guard<std::mutex> lock(poolLock);
+			if(!pool) pool = new Pool;
+		}
+		Job job; job.task = &task; job.nTasks = nTasks; job.nClaimed = 0; job.nDone = 0;
+		//Queue job, adding workers if required:
+		{	std::lock_guard<std::mutex> lock(pool->m);
+			while(pool->nWorkers < nTasks-1)
+				std::thread(worker, pool->nWorkers++).detach();
+			pool->jobs.push_back(&job);
+			pool->nUnclaimed += nTasks;
+		}
+		pool->cvWork.notify_all();
+		#if defined(MKL_PROVIDES_BLAS) || defined(MKL_PROVIDES_FFT)
+		int mklThreadsPrev = mkl_set_num_threads_local(1); //MKL calls from within tasks should not spawn threads
+		#endif
+		//Participate in the job, until all its tasks are claimed:
+		//(only tasks of this job, since the caller may hold locks that tasks of enclosing launches need)
+		while(true)
+		{	int iTask;
+			{	std::lock_guard<std::mutex> lock(pool->m);
+				if(job.nClaimed == nTasks) break;
+				iTask = pool->claim(&job);
+			}
+			execute(&job, iTask);
+		}
+		//Wait for tasks of other threads to complete:
+		double spinStart = clock_us();
+		while(job.nDone < nTasks && clock_us()-spinStart < spinTime_us)
+			std::this_thread::yield();
+		if(job.nDone < nTasks)
+		{	std::unique_lock<std::mutex> lock(pool->m);
+			pool->cvDone.wait(lock, [&](){ return job.nDone == nTasks; });
+		}
+		#if defined(MKL_PROVIDES_BLAS) || defined(MKL_PROVIDES_FFT)
+		mkl_set_num_threads_local(mklThreadsPrev);
+		#endif
+	}
+	
+	void setAffinity(bool pin)
+	{	std::lock_guard<std::mutex> lock(poolLock);
+		if(!pool) pool = new Pool;
+		pool->pinMode = pin ? 1 : 0; //takes effect for workers created subsequently
+	}
+}
@@ -21,6 +21,9 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <core/Thread.h>
 #include <core/ManagedMemory.h>
 #include <core/GpuUtil.h>
+#include <core/BandGroup.h>
+#include <core/GridInfo.h>
+#include <core/CoulombKernel.h>
 #include <cmath>
 #include <csignal>
 #include <list>
@@ -57,6 +60,8 @@ void printUsage(const char *name, const char* description)
 	logPrintf("\t-n --dry-run            quit after initialization (to verify commands and other input files)\n");
 	logPrintf("\t-c --cores              number of cores to use (ignored when launched using SLURM)\n");
 	logPrintf("\t-s --skip-defaults      skip printing status of default commands issued automatically.\n");
+	logPrintf("\t-G --group-size <n>     number of MPI processes sharing the wavefunction transforms of each process's states (default 1);\n");
+	logPrintf("\t                        only the FFT kernels are distributed: overlaps, subspace matrices, projections and storage remain on the group head\n");
 	logPrintf("\n");
 }
 
@@ -128,7 +133,10 @@ void logResume()
 {	globalLog = globalLogOrig;
 }
 
+MPIUtil* mpiWorld = 0;
 MPIUtil* mpiUtil = 0;
+MPIUtil* mpiGroup = 0;
+static int mpiGroupSize = 1; //number of processes in each band group (set by -G)
 bool mpiDebugLog = false;
 bool manualThreadCount = false;
 size_t mempoolSize = 0;
@@ -139,11 +147,11 @@ void initSystem(int argc, char** argv)
 {
 	argv0 = argv[0]; //remember how the executable was issued (for stack traces)
 	
-	if(!mpiUtil) mpiUtil = new MPIUtil(argc, argv);
+	if(!mpiWorld) mpiWorld = mpiUtil = new MPIUtil(argc, argv);
 	nullLog = fopen("/dev/null", "w");
-	if(!mpiUtil->isHead())
+	if(!mpiWorld->isHead())
 	{	if(mpiDebugLog)
-		{	char fname[256]; sprintf(fname, "jdftx.%d.mpiDebugLog", mpiUtil->iProcess());
+		{	char fname[256]; sprintf(fname, "jdftx.%d.mpiDebugLog", mpiWorld->iProcess());
 			globalLog = fopen(fname, "w");
 		}
 		else globalLog = nullLog;
@@ -156,18 +164,18 @@ void initSystem(int argc, char** argv)
 	startTime_us = clock_us();
 	logPrintf("Start date and time: %s", ctime(&startTime)); //note ctime output has a "\n" at the end
 	//---- hostname information
-	std::vector<string> hostname(mpiUtil->nProcesses()); //list of hostnames by MPI process ID
+	std::vector<string> hostname(mpiWorld->nProcesses()); //list of hostnames by MPI process ID
 	std::map< string, std::vector<int> > hostProcesses, hostGpuProcesses; //list of processes (and GPU-enabled processes) per hostname
 	{	char hostnameTmp[256];
 		gethostname(hostnameTmp, 256);
-		hostname[mpiUtil->iProcess()] = hostnameTmp;
+		hostname[mpiWorld->iProcess()] = hostnameTmp;
 	}
-	for(int jProcess=0; jProcess<mpiUtil->nProcesses(); jProcess++)
-	{	mpiUtil->bcast(hostname[jProcess], jProcess);
+	for(int jProcess=0; jProcess<mpiWorld->nProcesses(); jProcess++)
+	{	mpiWorld->bcast(hostname[jProcess], jProcess);
 		hostProcesses[hostname[jProcess]].push_back(jProcess);
 		//Update GPU-enabled version of list:
 		bool gpuEnabled = isGpuEnabled();
-		mpiUtil->bcast(gpuEnabled, jProcess);
+		mpiWorld->bcast(gpuEnabled, jProcess);
 		if(gpuEnabled)
 			hostGpuProcesses[hostname[jProcess]].push_back(jProcess);
 	}
@@ -191,15 +199,15 @@ void initSystem(int argc, char** argv)
 	
 	double nGPUs = 0.;
 	#ifdef GPU_ENABLED
-	const std::vector<int>& gpuSiblings = hostGpuProcesses[hostname[mpiUtil->iProcess()]];
+	const std::vector<int>& gpuSiblings = hostGpuProcesses[hostname[mpiWorld->iProcess()]];
 	if(!gpuInit(globalLog, &gpuSiblings, &nGPUs)) die_alone("gpuInit() failed\n\n")
 	#endif
 	
 	//Divide up available cores between all MPI processes on a given node:
 	if(!manualThreadCount) //skip if number of cores per process has been set with -c
-	{	const std::vector<int>& siblings = hostProcesses[hostname[mpiUtil->iProcess()]];
+	{	const std::vector<int>& siblings = hostProcesses[hostname[mpiWorld->iProcess()]];
 		int nSiblings = siblings.size();
-		int iSibling = std::find(siblings.begin(), siblings.end(), mpiUtil->iProcess()) - siblings.begin();
+		int iSibling = std::find(siblings.begin(), siblings.end(), mpiWorld->iProcess()) - siblings.begin();
 		nProcsAvailable = std::max(1, (nProcsAvailable * (iSibling+1))/nSiblings - (nProcsAvailable*iSibling)/nSiblings);
 	}
 	
@@ -215,18 +223,18 @@ void initSystem(int argc, char** argv)
 
 	//Print number of threads per process:
 	logPrintf("Maximum cpu threads by process:");
-	for(int jProcess=0; jProcess<mpiUtil->nProcesses(); jProcess++)
+	for(int jProcess=0; jProcess<mpiWorld->nProcesses(); jProcess++)
 	{	int nThreads = nProcsAvailable;
-		mpiUtil->bcast(nThreads, jProcess);
+		mpiWorld->bcast(nThreads, jProcess);
 		logPrintf(" %d", nThreads);
 	}
 	logPrintf("\n");
 	resumeOperatorThreading(); //if necessary, this informs MKL of the thread count
 	
 	//Print total resources used by run:
-	{	int nProcsTot = nProcsAvailable; mpiUtil->allReduce(nProcsTot, MPIUtil::ReduceSum);
-		double nGPUsTot = nGPUs; mpiUtil->allReduce(nGPUsTot, MPIUtil::ReduceSum);
-		logPrintf("Run totals: %d processes, %d threads, %lg GPUs\n", mpiUtil->nProcesses(), nProcsTot, nGPUsTot);
+	{	int nProcsTot = nProcsAvailable; mpiWorld->allReduce(nProcsTot, MPIUtil::ReduceSum);
+		double nGPUsTot = nGPUs; mpiWorld->allReduce(nGPUsTot, MPIUtil::ReduceSum);
+		logPrintf("Run totals: %d processes, %d threads, %lg GPUs\n", mpiWorld->nProcesses(), nProcsTot, nGPUsTot);
 	}
 	
 	//Memory pool size:
@@ -241,6 +249,38 @@ void initSystem(int argc, char** argv)
 			logPrintf("Could not determine memory pool size from JDFTX_MEMPOOL_SIZE=\"%s\".\n", mempoolSizeStr);
 	}
 	
+	//Thread pool affinity:
+	const char* threadAffinity = getenv("JDFTX_THREAD_AFFINITY");
+	if(threadAffinity)
+	{	if(!strcasecmp(threadAffinity, "yes")) ThreadPool::setAffinity(true);
+		else if(!strcasecmp(threadAffinity, "no")) ThreadPool::setAffinity(false);
+		else logPrintf("Could not determine thread affinity from JDFTX_THREAD_AFFINITY=\"%s\" (must be yes or no).\n", threadAffinity);
+	}
+	
+	//FFTW wisdom file (shared between runs):
+	const char* wisdomFilename = getenv("JDFTX_FFTW_WISDOM");
+	if(wisdomFilename && *wisdomFilename) GridInfo::importWisdom(wisdomFilename);
+	
+	//Coulomb kernel cache directory (shared between runs):
+	const char* kernelCacheDir = getenv("JDFTX_KERNEL_CACHE");
+	if(kernelCacheDir && *kernelCacheDir) CoulombKernel::setCacheDir(kernelCacheDir);
+	
+	//Split processes into band groups, if requested:
+	if(mpiGroupSize > 1)
+	{	if(isGpuEnabled()) die_alone("Band groups (-G) are only supported for CPU runs.\n");
+		int nGroups = ceildiv(mpiWorld->nProcesses(), mpiGroupSize);
+		int iGroup = mpiWorld->iProcess() / mpiGroupSize;
+		mpiGroup = new MPIUtil(mpiWorld, iGroup, mpiWorld->iProcess());
+		mpiUtil = new MPIUtil(mpiWorld, mpiGroup->isHead() ? 0 : 1, mpiWorld->iProcess()); //heads of all groups (rest are unused)
+		logPrintf("Divided %d processes into %d band groups of up to %d processes each.\n", mpiWorld->nProcesses(), nGroups, mpiGroupSize);
+		if(!mpiGroup->isHead())
+		{	//Serve band-level requests from the group head until it quits:
+			BandGroup::serve();
+			finalizeSystem();
+			exit(0);
+		}
+	}
+	
 	//Add citations to the code for all calculations:
 	Citations::add("Software package",
 		"R. Sundararaman, K. Letchworth-Weaver, K.A. Schwarz, D. Gunceler, Y. Ozhabes and T.A. Arias, "
@@ -249,7 +289,7 @@ void initSystem(int argc, char** argv)
 
 void initSystemCmdline(int argc, char** argv, const char* description, string& inputFilename, bool& dryRun, bool& printDefaults, class Everything* e)
 {
-	mpiUtil = new MPIUtil(argc, argv);
+	mpiWorld = mpiUtil = new MPIUtil(argc, argv);
 	
 	//Parse command line:
 	string logFilename; bool appendOutput=true;
@@ -266,10 +306,11 @@ void initSystemCmdline(int argc, char** argv, const char* description, string& i
 			{"cores", required_argument, 0, 'c'},
 			{"skip-defaults", no_argument, 0, 's'},
 			{"write-manual", required_argument, 0, 'w'},
+			{"group-size", required_argument, 0, 'G'},
 			{0, 0, 0, 0}
 		};
 	while (1)
-	{	int c = getopt_long(argc, argv, "hvi:o:dtmnc:sw:", long_options, 0);
+	{	int c = getopt_long(argc, argv, "hvi:o:dtmnc:sw:G:", long_options, 0);
 		if (c == -1) break; //end of options
 		#define RUN_HEAD(code) if(mpiUtil->isHead()) { code } delete mpiUtil;
 		switch (c)
@@ -291,6 +332,12 @@ void initSystemCmdline(int argc, char** argv, const char* description, string& i
 			}
 			case 's': printDefaults=false; break;
 			case 'w': RUN_HEAD( if(e) writeCommandManual(*e, optarg); ) exit(0);
+			case 'G':
+			{	if(sscanf(optarg, "%d", &mpiGroupSize)!=1 || mpiGroupSize<1)
+				{	RUN_HEAD( printUsage(argv[0], description); ) exit(1);
+				}
+				break;
+			}
 			default: RUN_HEAD( printUsage(argv[0], description); ) exit(1);
 		}
 		#undef RUN_HEAD
@@ -346,14 +393,21 @@ void finalizeSystem(bool successful)
 	ManagedMemoryBase::reportUsage();
 	#endif
 	
-	if(!mpiUtil->isHead())
+	GridInfo::exportWisdom(); //save FFTW wisdom for subsequent runs, if requested
+	
+	if(!mpiWorld->isHead())
 	{	if(mpiDebugLog) fclose(globalLog);
 		globalLog = 0;
 	}
 	fclose(nullLog);
 	if(globalLog && globalLog != stdout)
 		fclose(globalLog);
-	delete mpiUtil;
+	if(mpiGroup)
+	{	if(mpiGroup->isHead()) BandGroup::quit(); //synchronizes with the end of BandGroup::serve() on the others, so that freeing mpiGroup is collective
+		delete mpiGroup;
+		delete mpiUtil;
+	}
+	delete mpiWorld;
 }
 
 
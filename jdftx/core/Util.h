@@ -39,7 +39,9 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 //------------- Common Initialization -----------------
 
 extern bool killFlag; //!< Flag set by signal handlers - all compute loops should quit cleanly when this is set
-extern MPIUtil* mpiUtil;
+extern MPIUtil* mpiWorld; //!< MPI communicator for all processes
+extern MPIUtil* mpiUtil; //!< MPI communicator for processes that run the calculation (heads of each mpiGroup; same as mpiWorld if no band groups)
+extern MPIUtil* mpiGroup; //!< MPI communicator for processes sharing band-level work with the current head process (0 if no band groups, see BandGroup)
 extern bool mpiDebugLog; //!< If true, all processes output to seperate debug log files, otherwise only head process outputs (set before calling initSystem())
 extern size_t mempoolSize; //!< If non-zero, size of memory pool managed internally by JDFTx
 void printVersionBanner(); //!< Print package name, version, revision etc. to log
@@ -127,7 +129,7 @@ void logResume(); //!< re-enable logging after a logSuspend() call
 		fflush(globalLog); \
 		if(mpiUtil->isHead() && globalLog != stdout) \
 			fprintf(stderr, __VA_ARGS__); \
-		if(mpiUtil->nProcesses() == 1) finalizeSystem(false); /* Safe to call only if no other process */ \
+		if(mpiWorld->nProcesses() == 1) finalizeSystem(false); /* Safe to call only if no other process */ \
 		mpiUtil->exit(1); \
 	}
 
@@ -546,6 +546,8 @@ extern "C"
 {	void zgetrf_(int* M, int* N, complex* A, int* LDA, int* IPIV, int* INFO);
 	void zgetri_(int* N, complex* A, int* LDA, int* IPIV, complex* WORK, int* LWORK, int* INFO);
 	void zposv_(char* UPLO, int* N, int* NRHS, complex* A, int* LDA, complex* B, int* LDB, int* INFO);
+	void zpotrf_(char* UPLO, int* N, complex* A, int* LDA, int* INFO);
+	void ztrtri_(char* UPLO, char* DIAG, int* N, complex* A, int* LDA, int* INFO);
 }
 
 matrix inv(const matrix& A)
@@ -620,6 +622,42 @@ matrix invApply(const matrix& A, const matrix& b)
 	return x;
 }
 
+matrix invCholesky(const matrix& A, bool* success)
+{	static StopWatch watch("invCholesky(matrix)");
+	watch.start();
+	int N = A.nRows();
+	assert(N > 0);
+	assert(N == A.nCols());
+	matrix invU(A); //destructible copy
+	int ldA = N;
+	int info = 0;
+	//Cholesky factorization A = U^ U (in place):
+	char uplo = 'U', diag = 'N';
+	zpotrf_(&uplo, &N, invU.data(), &ldA, &info);
+	if(info<0) { logPrintf("Argument# %d to LAPACK Cholesky decomposition routine ZPOTRF is invalid.\n", -info); stackTraceExit(1); }
+	if(info>0)
+	{	if(success) { *success = false; watch.stop(); return matrix(); }
+		logPrintf("Matrix not positive-definite at leading minor# %d in LAPACK Cholesky decomposition routine ZPOTRF.\n", info);
+		stackTraceExit(1);
+	}
+	//Invert triangular factor (in place):
+	ztrtri_(&uplo, &diag, &N, invU.data(), &ldA, &info);
+	if(info<0) { logPrintf("Argument# %d to LAPACK triangular inversion routine ZTRTRI is invalid.\n", -info); stackTraceExit(1); }
+	if(info>0)
+	{	if(success) { *success = false; watch.stop(); return matrix(); }
+		logPrintf("LAPACK triangular inversion routine ZTRTRI found Cholesky factor to be singular at the %d'th step.\n", info);
+		stackTraceExit(1);
+	}
+	//Zero out the strictly lower triangle (not referenced by LAPACK):
+	complex* invUdata = invU.data();
+	for(int j=0; j<N; j++)
+		for(int i=j+1; i<N; i++)
+			invUdata[invU.index(i,j)] = 0.;
+	if(success) *success = true;
+	watch.stop();
+	return invU;
+}
+
 matrix LU(const matrix& A)
 {	static StopWatch watch("LU(matrix)");
 	watch.start();
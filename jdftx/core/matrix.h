@@ -198,6 +198,11 @@ matrix inv(const matrix& A); //!< inverse of matrix
 diagMatrix inv(const diagMatrix& A); //!< inverse of diagonal matrix
 matrix invApply(const matrix& A, const matrix& b); //!< return inv(A) * b (A must be hermitian, positive-definite)
 
+//! Compute inv(U), where U is the upper-triangular Cholesky factor of A = U^ U (A must be hermitian, positive-definite).
+//! X * invCholesky(X^X) is then an orthonormal basis for the span of X (Cholesky-QR). If success is non-null,
+//! set it to false and return a null matrix when A is not numerically positive-definite, instead of exiting.
+matrix invCholesky(const matrix& A, bool* success=0);
+
 //! Compute the LU decomposition of the matrix
 matrix LU(const matrix& A);
 
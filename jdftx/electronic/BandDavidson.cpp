@@ -41,7 +41,7 @@ void BandDavidson::minimize()
 	diagMatrix I = eye(nBandsOut);
 	Energies ener; //not really used here
 	eVars.applyHamiltonian(q, I, HC, ener, true);
-	Hsub = C^HC;
+	Hsub = realInner(C, HC);
 	Hsub.diagonalize(Hsub_evecs, Hsub_eigs);
 	//--- switch C to subspace eigenbasis:
 	C = C * Hsub_evecs;
@@ -88,9 +88,9 @@ void BandDavidson::minimize()
 		{	ColumnBundle OCexp = O(Cexp, &VdagCexp);
 			matrix rotExisting = eye(Cexp.nCols());
 			e.iInfo.project(Cexp, VdagCexp, &rotExisting);
-			matrix CdagOCexp = C ^ OCexp;
+			matrix CdagOCexp = realInner(C, OCexp);
 			bigOsub.set(0,nBands, 0,nBands, eye(nBands)); //since C's are already orthonormal
-			bigOsub.set(nBands,nBandsBig, nBands,nBandsBig, Cexp ^ OCexp);
+			bigOsub.set(nBands,nBandsBig, nBands,nBandsBig, realInner(Cexp, OCexp));
 			bigOsub.set(0,nBands, nBands,nBandsBig, CdagOCexp);
 			bigOsub.set(nBands,nBandsBig, 0,nBands, dagger(CdagOCexp));
 		}
@@ -106,7 +106,7 @@ void BandDavidson::minimize()
 			SWAP_C_Cexp //Temporarily swap C and Cexp
 			eVars.applyHamiltonian(q, eye(nBandsNew), HCexp, ener, true); //Hamiltonian always operates on C, where we put Cexp 
 			SWAP_C_Cexp  //Restore C and Cexp to correct places
-			matrix CdagHCexp = C  ^ HCexp;
+			matrix CdagHCexp = realInner(C, HCexp);
 			bigHsub.set(0,nBands, 0,nBands, Hsub_eigs);
 			bigHsub.set(nBands,nBandsBig, nBands,nBandsBig, HsubExp);
 			bigHsub.set(0,nBands, nBands,nBandsBig, CdagHCexp);
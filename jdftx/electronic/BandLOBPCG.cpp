@@ -0,0 +1,294 @@
+/*-------------------------------------------------------------------
+Copyright 2026 agent
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#include <electronic/BandLOBPCG.h>
+#include <electronic/Everything.h>
+#include <electronic/ColumnBundle.h>
+
+//Copy an arbitrary subset of columns of Y:
+static ColumnBundle getColumns(const ColumnBundle& Y, const std::vector<int>& cols)
+{	ColumnBundle result = Y.similar(cols.size());
+	for(size_t i=0; i<cols.size(); i++)
+		callPref(eblas_copy)(result.dataPref()+result.index(i,0), Y.dataPref()+Y.index(cols[i],0), Y.colLength());
+	return result;
+}
+
+//Set an arbitrary subset of columns of Y:
+static void setColumns(ColumnBundle& Y, const std::vector<int>& cols, const ColumnBundle& sub)
+{	for(size_t i=0; i<cols.size(); i++)
+		callPref(eblas_copy)(Y.dataPref()+Y.index(cols[i],0), sub.dataPref()+sub.index(i,0), Y.colLength());
+}
+
+//Wavefunctions Y along with HY, OY and the projections VdagY, all of which are updated together by linear combinations
+struct BandLOBPCG::Images
+{	ColumnBundle Y, HY, OY;
+	std::vector<matrix> VdagY;
+
+	explicit operator bool() const { return bool(Y); }
+
+	//Right-multiply all components by a matrix:
+	void rotate(const matrix& U)
+	{	Y = Y * U;
+		HY = HY * U;
+		OY = OY * U;
+		for(matrix& m: VdagY) if(m) m = m * U;
+	}
+
+	//Subtract the components along X given the coefficients XdagOY:
+	void project(const Images& X, const matrix& XdagOY)
+	{	Y -= X.Y * XdagOY;
+		HY -= X.HY * XdagOY;
+		OY -= X.OY * XdagOY;
+		for(size_t sp=0; sp<VdagY.size(); sp++) if(VdagY[sp])
+			VdagY[sp] -= X.VdagY[sp] * XdagOY;
+	}
+
+	//Linear combination A*a + B*b (B may be null):
+	static Images combine(const Images& A, const matrix& a, const Images& B, const matrix& b)
+	{	Images result;
+		result.Y = A.Y * a;
+		result.HY = A.HY * a;
+		result.OY = A.OY * a;
+		result.VdagY.resize(A.VdagY.size());
+		for(size_t sp=0; sp<A.VdagY.size(); sp++) if(A.VdagY[sp])
+			result.VdagY[sp] = A.VdagY[sp] * a;
+		if(B)
+		{	result.Y += B.Y * b;
+			result.HY += B.HY * b;
+			result.OY += B.OY * b;
+			for(size_t sp=0; sp<B.VdagY.size(); sp++) if(B.VdagY[sp])
+				result.VdagY[sp] += B.VdagY[sp] * b;
+		}
+		return result;
+	}
+
+	//Contiguous range of columns:
+	Images getSub(int colStart, int colStop) const
+	{	Images result;
+		result.Y = Y.getSub(colStart, colStop);
+		result.HY = HY.getSub(colStart, colStop);
+		result.OY = OY.getSub(colStart, colStop);
+		result.VdagY.resize(VdagY.size());
+		for(size_t sp=0; sp<VdagY.size(); sp++) if(VdagY[sp])
+			result.VdagY[sp] = VdagY[sp](0,VdagY[sp].nRows(), colStart,colStop);
+		return result;
+	}
+
+	//Arbitrary subset of columns:
+	Images getColumns(const std::vector<int>& cols) const
+	{	Images result;
+		result.Y = ::getColumns(Y, cols);
+		result.HY = ::getColumns(HY, cols);
+		result.OY = ::getColumns(OY, cols);
+		result.VdagY.resize(VdagY.size());
+		for(size_t sp=0; sp<VdagY.size(); sp++) if(VdagY[sp])
+		{	const matrix& M = VdagY[sp];
+			result.VdagY[sp].init(M.nRows(), cols.size());
+			for(size_t i=0; i<cols.size(); i++)
+				result.VdagY[sp].set(0,M.nRows(), i,i+1, M(0,M.nRows(), cols[i],cols[i]+1));
+		}
+		return result;
+	}
+
+	//Set an arbitrary subset of columns:
+	void setColumns(const std::vector<int>& cols, const Images& sub)
+	{	::setColumns(Y, cols, sub.Y);
+		::setColumns(HY, cols, sub.HY);
+		::setColumns(OY, cols, sub.OY);
+		for(size_t sp=0; sp<VdagY.size(); sp++) if(VdagY[sp])
+		{	const matrix& M = sub.VdagY[sp];
+			for(size_t i=0; i<cols.size(); i++)
+				VdagY[sp].set(0,M.nRows(), cols[i],cols[i]+1, M(0,M.nRows(), i,i+1));
+		}
+	}
+};
+
+
+BandLOBPCG::BandLOBPCG(Everything& e, int q): e(e), eVars(e.eVars), eInfo(e.eInfo), q(q)
+{	assert(e.cntrl.fixed_H); // Check whether the electron Hamiltonian is fixed
+}
+
+void BandLOBPCG::applyHamiltonian(Images& Y)
+{	Energies ener; //not really used here
+	std::swap(eVars.C[q], Y.Y); //Hamiltonian always operates on C, where we put Y
+	std::swap(eVars.VdagC[q], Y.VdagY);
+	Y.HY.free();
+	eVars.applyHamiltonian(q, eye(eVars.C[q].nCols()), Y.HY, ener, true);
+	std::swap(eVars.C[q], Y.Y); //Restore C and Y to correct places
+	std::swap(eVars.VdagC[q], Y.VdagY);
+}
+
+void BandLOBPCG::minimize()
+{	//Use the same working set as the CG minimizer:
+	ColumnBundle& C = eVars.C[q];
+	std::vector<matrix>& VdagC = eVars.VdagC[q];
+	matrix& Hsub = eVars.Hsub[q];
+	matrix& Hsub_evecs = eVars.Hsub_evecs[q];
+	diagMatrix& Hsub_eigs = eVars.Hsub_eigs[q];
+	const QuantumNumber& qnum = eInfo.qnums[q];
+	const MinimizeParams& mp = e.elecMinParams;
+	int nBands = eInfo.nBands;
+	
+	//Initial subspace eigenvalue problem:
+	Images X; //current bands, held outside of C during the iterations
+	std::swap(X.Y, C);
+	std::swap(X.VdagY, VdagC);
+	applyHamiltonian(X);
+	X.OY = O(X.Y);
+	diagMatrix eigs;
+	{	matrix evecs;
+		dagger_symmetrize(realInner(X.Y, X.HY)).diagonalize(evecs, eigs);
+		X.rotate(evecs); //switch to subspace eigenbasis
+	}
+	double Eband = qnum.weight * trace(eigs);
+	logPrintf("BandLOBPCG: Iter: %3d  Eband: %+.15lf\n", 0, Eband); fflush(globalLog);
+	
+	Images P; //previous search directions (corresponding to bands in activePrev)
+	std::vector<int> activePrev;
+	int iter=1;
+	for(; iter<=mp.nIterations; iter++)
+	{	//Preconditioned residuals:
+		ColumnBundle R = X.HY; R -= X.OY * eigs;
+		precond_inv_kinetic_band(R, (-0.5) * diagDot(X.Y, L(X.Y)));
+		diagMatrix Rnorm = diagDot(R, R);
+		//Lock converged bands out of the subspace expansion:
+		double RnormCut = std::max(mp.energyDiffThreshold/nBands, 1e-15*R.colLength());
+		std::vector<int> active;
+		for(int b=0; b<nBands; b++)
+			if(Rnorm[b] >= RnormCut)
+				active.push_back(b);
+		int nActive = active.size();
+		if(!nActive)
+		{	logPrintf("BandLOBPCG: Converged (all band residuals below %le)\n", RnormCut);
+			break;
+		}
+		
+		//Expansion directions W orthogonal to current bands (normalized for roundoff only):
+		Images W;
+		{	diagMatrix WnormInv(nActive);
+			for(int j=0; j<nActive; j++) WnormInv[j] = 1./sqrt(Rnorm[active[j]]);
+			W.Y = getColumns(R, active) * WnormInv;
+			R.free();
+		}
+		W.Y -= X.Y * realInner(X.OY, W.Y);
+		W.OY = O(W.Y, &W.VdagY);
+		matrix rotExisting = eye(nActive);
+		e.iInfo.project(W.Y, W.VdagY, &rotExisting); //projections of species without overlap augmentation
+		applyHamiltonian(W);
+		
+		//Carry previous search directions over to current active bands, and project out current bands:
+		if(P)
+		{	matrix align = zeroes(activePrev.size(), nActive);
+			for(size_t i=0; i<activePrev.size(); i++)
+				for(int j=0; j<nActive; j++)
+					if(activePrev[i] == active[j])
+						align.set(i,j, 1.);
+			P.rotate(align);
+			P.project(X, realInner(X.Y, P.OY));
+		}
+		
+		//Rayleigh-Ritz within blocks [X_b, W_b, P_b] of active bands (via Cholesky orthonormalization):
+		Images Xa = X.getColumns(active);
+		matrix Cx = zeroes(nActive, nActive), Cw = zeroes(nActive, nActive), Cp = zeroes(nActive, nActive);
+		int blockSize = e.cntrl.lobpcgBlockSize ? e.cntrl.lobpcgBlockSize : nActive;
+		for(int jStart=0; jStart<nActive; jStart+=blockSize)
+		{	int jStop = std::min(jStart+blockSize, nActive);
+			int n = jStop - jStart;
+			Images Xb = Xa.getSub(jStart, jStop), Wb = W.getSub(jStart, jStop), Pb;
+			if(P) Pb = P.getSub(jStart, jStop);
+			//Block subspace overlap and Hamiltonian (X_b is orthonormal and orthogonal to W_b and P_b by construction):
+			int nSets = P ? 3 : 2;
+			matrix bigOsub = zeroes(nSets*n, nSets*n), bigHsub = zeroes(nSets*n, nSets*n);
+			bigOsub.set(0,n, 0,n, eye(n));
+			bigOsub.set(n,2*n, n,2*n, realInner(Wb.Y, Wb.OY));
+			diagMatrix eigsBlock(n);
+			for(int j=0; j<n; j++) eigsBlock[j] = eigs[active[jStart+j]];
+			matrix XHW = realInner(Xb.Y, Wb.HY);
+			bigHsub.set(0,n, 0,n, eigsBlock);
+			bigHsub.set(n,2*n, n,2*n, realInner(Wb.Y, Wb.HY));
+			bigHsub.set(0,n, n,2*n, XHW);
+			bigHsub.set(n,2*n, 0,n, dagger(XHW));
+			if(P)
+			{	matrix WOP = realInner(Wb.Y, Pb.OY);
+				bigOsub.set(n,2*n, 2*n,3*n, WOP);
+				bigOsub.set(2*n,3*n, n,2*n, dagger(WOP));
+				bigOsub.set(2*n,3*n, 2*n,3*n, realInner(Pb.Y, Pb.OY));
+				matrix XHP = realInner(Xb.Y, Pb.HY);
+				matrix WHP = realInner(Wb.Y, Pb.HY);
+				bigHsub.set(0,n, 2*n,3*n, XHP);
+				bigHsub.set(2*n,3*n, 0,n, dagger(XHP));
+				bigHsub.set(n,2*n, 2*n,3*n, WHP);
+				bigHsub.set(2*n,3*n, n,2*n, dagger(WHP));
+				bigHsub.set(2*n,3*n, 2*n,3*n, realInner(Pb.Y, Pb.HY));
+			}
+			matrix rot;
+			while(true)
+			{	bool ok = false;
+				matrix U = invCholesky(bigOsub(0,nSets*n, 0,nSets*n), &ok);
+				if(!ok)
+				{	if(nSets==3) { nSets = 2; continue; } //previous directions nearly linearly dependent: drop them for this block
+					break; //no usable expansion for this block
+				}
+				matrix bigHsub_evecs; diagMatrix bigHsub_eigs;
+				dagger_symmetrize(dagger(U) * bigHsub(0,nSets*n, 0,nSets*n) * U).diagonalize(bigHsub_evecs, bigHsub_eigs);
+				rot = U * bigHsub_evecs(0,nSets*n, 0,n); //lowest n eigenvectors in the [X_b,W_b,P_b] basis
+				break;
+			}
+			if(!rot) { Cx.set(jStart,jStop, jStart,jStop, eye(n)); continue; }
+			Cx.set(jStart,jStop, jStart,jStop, rot(0,n, 0,n));
+			Cw.set(jStart,jStop, jStart,jStop, rot(n,2*n, 0,n));
+			if(nSets==3) Cp.set(jStart,jStop, jStart,jStop, rot(2*n,3*n, 0,n));
+		}
+		
+		//Update search directions and active bands:
+		P = Images::combine(W, Cw, P, Cp);
+		X.setColumns(active, Images::combine(Xa, Cx, P, eye(nActive)));
+		activePrev = active;
+		
+		//Cholesky-QR orthonormalization and Rayleigh-Ritz within the span of all bands:
+		{	matrix XdagOX = realInner(X.Y, X.OY);
+			bool ok = false;
+			matrix U = invCholesky(XdagOX, &ok);
+			if(!ok) U = invsqrt(XdagOX); //fall back to symmetric orthonormalization if severely ill-conditioned
+			matrix evecs;
+			dagger_symmetrize(dagger(U) * realInner(X.Y, X.HY) * U).diagonalize(evecs, eigs);
+			X.rotate(U * evecs);
+		}
+		
+		//Print and test convergence
+		double EbandPrev = Eband;
+		Eband = qnum.weight * trace(eigs);
+		double dEband = Eband - EbandPrev;
+		logPrintf("BandLOBPCG: Iter: %3d  Eband: %+.15lf  dEband: %le  nActive: %d\n", iter, Eband, dEband, nActive); fflush(globalLog);
+		if(dEband<0 and fabs(dEband)<mp.energyDiffThreshold)
+		{	logPrintf("BandLOBPCG: Converged (dEband<%le)\n", mp.energyDiffThreshold);
+			break;
+		}
+	}
+	if(iter>mp.nIterations)
+		logPrintf("BandLOBPCG: None of the convergence criteria satisfied after %d iterations.\n", mp.nIterations);
+	fflush(globalLog);
+	
+	//Update final quantities:
+	std::swap(C, X.Y);
+	std::swap(VdagC, X.VdagY);
+	Hsub_eigs = eigs;
+	Hsub = Hsub_eigs;
+	Hsub_evecs = eye(nBands);
+}
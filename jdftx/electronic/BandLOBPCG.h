@@ -0,0 +1,53 @@
+/*-------------------------------------------------------------------
+Copyright 2026 agent
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+
+#ifndef JDFTX_ELECTRONIC_BANDLOBPCG_H
+#define JDFTX_ELECTRONIC_BANDLOBPCG_H
+
+#include <core/Minimize.h>
+
+class Everything;
+
+//! @addtogroup ElecSystem
+//! @{
+
+//! Locally-optimal block preconditioned conjugate gradient (LOBPCG) eigensolver.
+//! Converged bands are locked out of the subspace expansion, and the Rayleigh-Ritz steps are
+//! performed independently within blocks of the active bands (projected preconditioned CG, PPCG,
+//! when Control::lobpcgBlockSize is small), followed by a Cholesky-QR orthonormalization and
+//! Rayleigh-Ritz step within the span of all the bands.
+class BandLOBPCG
+{
+public:
+	BandLOBPCG(Everything& e, int q); //!< Construct LOBPCG eigenvalue solver for quantum number q
+	void minimize(); //!< Converge eigenproblem with tolerance set by e.elecMinParams
+
+private:
+	Everything& e;
+	class ElecVars& eVars;
+	const class ElecInfo& eInfo;
+	int q;  //!< Current quantum number
+
+	struct Images; //!< wavefunctions along with their Hamiltonian and overlap images and projections
+	void applyHamiltonian(Images& Y); //!< set Hamiltonian image of Y (which must have its projections set)
+};
+
+//! @}
+#endif // JDFTX_ELECTRONIC_BANDLOBPCG_H
@@ -0,0 +1,239 @@
+/*-------------------------------------------------------------------
+Copyright 2026 agent
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+
+#include <electronic/BandRMMDIIS.h>
+#include <electronic/Everything.h>
+#include <electronic/ColumnBundle.h>
+#include <core/Thread.h>
+
+//Wavefunctions Y along with HY, OY and the projections VdagY, all of which are updated together band by band
+struct BandRMMDIIS::Images
+{	ColumnBundle Y, HY, OY;
+	std::vector<matrix> VdagY;
+	
+	//Scale each band (column) of all components:
+	Images operator*(const diagMatrix& a) const
+	{	Images result;
+		result.Y = Y * a;
+		result.HY = HY * a;
+		result.OY = OY * a;
+		result.VdagY.resize(VdagY.size());
+		for(size_t sp=0; sp<VdagY.size(); sp++) if(VdagY[sp])
+			result.VdagY[sp] = VdagY[sp] * a;
+		return result;
+	}
+	
+	Images& operator+=(const Images& A)
+	{	Y += A.Y;
+		HY += A.HY;
+		OY += A.OY;
+		for(size_t sp=0; sp<VdagY.size(); sp++) if(VdagY[sp])
+			VdagY[sp] += A.VdagY[sp];
+		return *this;
+	}
+	
+	//Rayleigh quotient of each band:
+	diagMatrix eigs() const
+	{	diagMatrix YHY = diagDot(Y, HY), YOY = diagDot(Y, OY);
+		for(int b=0; b<YHY.nRows(); b++) YHY[b] /= YOY[b];
+		return YHY;
+	}
+	
+	//Residual of each band given its Rayleigh quotient:
+	ColumnBundle residual(const diagMatrix& eigs) const
+	{	ColumnBundle R = HY;
+		R -= OY * eigs;
+		return R;
+	}
+};
+
+
+BandRMMDIIS::BandRMMDIIS(Everything& e, int q): e(e), eVars(e.eVars), eInfo(e.eInfo), q(q)
+{	assert(e.cntrl.fixed_H); // Check whether the electron Hamiltonian is fixed
+}
+
+void BandRMMDIIS::applyHamiltonian(Images& Y)
+{	Energies ener; //not really used here
+	std::swap(eVars.C[q], Y.Y); //Hamiltonian always operates on C, where we put Y
+	std::swap(eVars.VdagC[q], Y.VdagY);
+	Y.HY.free();
+	eVars.applyHamiltonian(q, eye(eVars.C[q].nCols()), Y.HY, ener, true);
+	std::swap(eVars.C[q], Y.Y); //Restore C and Y to correct places
+	std::swap(eVars.VdagC[q], Y.VdagY);
+}
+
+//Solve for the DIIS coefficients of bands in [bStart,bStop) that minimize the norm of the combined
+//residual, sum_ij alpha_i alpha_j <R_i|R_j>, subject to sum_i alpha_i = 1 (separately for each band)
+static void diisCoefficients_sub(size_t bStart, size_t bStop, const std::vector<std::vector<diagMatrix>>* RdotR, std::vector<diagMatrix>* alpha)
+{	int nHist = alpha->size();
+	std::vector<double> M(nHist*nHist), a(nHist);
+	for(size_t b=bStart; b<bStop; b++)
+	{	//Normalized residual overlaps (regularized for linear dependence):
+		double Mscale = 0.;
+		for(int i=0; i<nHist; i++) Mscale += (*RdotR)[i][i][b];
+		if(!(Mscale > 0.))
+		{	for(int i=0; i<nHist; i++) (*alpha)[i][b] = (i==nHist-1) ? 1. : 0.; //residual vanishes: keep latest
+			continue;
+		}
+		for(int i=0; i<nHist; i++)
+		{	for(int j=0; j<nHist; j++)
+				M[i*nHist+j] = (*RdotR)[std::max(i,j)][std::min(i,j)][b] / Mscale;
+			M[i*nHist+i] += 1e-12;
+			a[i] = 1.;
+		}
+		//Solve M a = 1 by Gaussian elimination with partial pivoting:
+		for(int k=0; k<nHist; k++)
+		{	int kMax = k;
+			for(int i=k+1; i<nHist; i++)
+				if(fabs(M[i*nHist+k]) > fabs(M[kMax*nHist+k])) kMax = i;
+			if(kMax != k)
+			{	for(int j=0; j<nHist; j++) std::swap(M[k*nHist+j], M[kMax*nHist+j]);
+				std::swap(a[k], a[kMax]);
+			}
+			for(int i=k+1; i<nHist; i++)
+			{	double f = M[i*nHist+k] / M[k*nHist+k];
+				for(int j=k; j<nHist; j++) M[i*nHist+j] -= f * M[k*nHist+j];
+				a[i] -= f * a[k];
+			}
+		}
+		for(int k=nHist-1; k>=0; k--)
+		{	for(int j=k+1; j<nHist; j++) a[k] -= M[k*nHist+j] * a[j];
+			a[k] /= M[k*nHist+k];
+		}
+		//Normalize to satisfy constraint:
+		double aSum = 0.;
+		for(int i=0; i<nHist; i++) aSum += a[i];
+		for(int i=0; i<nHist; i++) (*alpha)[i][b] = a[i] / aSum;
+	}
+}
+
+void BandRMMDIIS::minimize(int nSteps)
+{	//Use the same working set as the CG minimizer:
+	ColumnBundle& C = eVars.C[q];
+	std::vector<matrix>& VdagC = eVars.VdagC[q];
+	matrix& Hsub = eVars.Hsub[q];
+	matrix& Hsub_evecs = eVars.Hsub_evecs[q];
+	diagMatrix& Hsub_eigs = eVars.Hsub_eigs[q];
+	const QuantumNumber& qnum = eInfo.qnums[q];
+	const MinimizeParams& mp = e.elecMinParams;
+	int nBands = eInfo.nBands;
+	
+	//Initial bands and their residuals:
+	std::vector<Images> X(1); //history of iterates of each band
+	std::vector<ColumnBundle> R(1); //corresponding residuals
+	std::vector<std::vector<diagMatrix>> RdotR(1); //band-wise overlaps <R_i|R_j> for j <= i
+	std::swap(X[0].Y, C);
+	std::swap(X[0].VdagY, VdagC);
+	applyHamiltonian(X[0]);
+	X[0].OY = O(X[0].Y);
+	diagMatrix eigs = X[0].eigs();
+	R[0] = X[0].residual(eigs);
+	RdotR[0].push_back(diagDot(R[0], R[0]));
+	double Eband = qnum.weight * trace(eigs);
+	logPrintf("BandRMMDIIS: Iter: %3d  Eband: %+.15lf\n", 0, Eband); fflush(globalLog);
+	double RnormCut = std::max(mp.energyDiffThreshold/nBands, 1e-15*R[0].colLength());
+	
+	int iter=1;
+	for(; iter<=nSteps; iter++)
+	{	//Check residuals of latest iterate:
+		const diagMatrix& Rnorm = RdotR.back().back();
+		double RnormMax = 0.;
+		for(int b=0; b<nBands; b++) RnormMax = std::max(RnormMax, Rnorm[b]);
+		if(RnormMax < RnormCut)
+		{	logPrintf("BandRMMDIIS: Converged (all band residuals below %le)\n", RnormCut);
+			break;
+		}
+		
+		//DIIS extrapolation of each band within its own history (no orthogonalization between bands):
+		int nHist = X.size();
+		Images Xbar; ColumnBundle Rbar;
+		if(nHist == 1)
+		{	Xbar = X[0];
+			Rbar = R[0];
+		}
+		else
+		{	std::vector<diagMatrix> alpha(nHist, diagMatrix(nBands));
+			threadLaunch(diisCoefficients_sub, nBands, &RdotR, &alpha);
+			Xbar = X[0] * alpha[0];
+			Rbar = R[0] * alpha[0];
+			for(int i=1; i<nHist; i++)
+			{	Xbar += X[i] * alpha[i];
+				Rbar += R[i] * alpha[i];
+			}
+		}
+		diagMatrix eigsBar = Xbar.eigs();
+		
+		//Preconditioned residual step:
+		Images K;
+		K.Y = Rbar;
+		precond_inv_kinetic_band(K.Y, (-0.5) * diagDot(Xbar.Y, L(Xbar.Y)));
+		Rbar.free();
+		K.OY = O(K.Y, &K.VdagY);
+		matrix rotExisting = eye(nBands);
+		e.iInfo.project(K.Y, K.VdagY, &rotExisting); //projections of species without overlap augmentation
+		applyHamiltonian(K);
+		
+		//Step size that minimizes the linearized residual of each band:
+		ColumnBundle RK = K.residual(eigsBar);
+		diagMatrix RbarDotRK = diagDot(Xbar.residual(eigsBar), RK), RKnorm = diagDot(RK, RK);
+		RK.free();
+		diagMatrix lambda(nBands);
+		for(int b=0; b<nBands; b++)
+			lambda[b] = (RKnorm[b] > 0.) ? -RbarDotRK[b]/RKnorm[b] : 0.;
+		
+		//Update each band and its residual:
+		Xbar += K * lambda;
+		K = Images();
+		X.push_back(Xbar);
+		eigs = X.back().eigs();
+		R.push_back(X.back().residual(eigs));
+		RdotR.push_back(std::vector<diagMatrix>());
+		for(size_t j=0; j<R.size(); j++)
+			RdotR.back().push_back(diagDot(R.back(), R[j]));
+		
+		//Print progress:
+		double EbandPrev = Eband;
+		Eband = qnum.weight * trace(eigs);
+		logPrintf("BandRMMDIIS: Iter: %3d  Eband: %+.15lf  dEband: %le\n", iter, Eband, Eband-EbandPrev); fflush(globalLog);
+	}
+	
+	//Cholesky-QR orthonormalization and Rayleigh-Ritz within the span of all bands:
+	Images Xfinal; std::swap(Xfinal, X.back());
+	X.clear(); R.clear();
+	{	matrix XdagOX = realInner(Xfinal.Y, Xfinal.OY);
+		bool ok = false;
+		matrix U = invCholesky(XdagOX, &ok);
+		if(!ok) U = invsqrt(XdagOX); //fall back to symmetric orthonormalization if severely ill-conditioned
+		matrix evecs;
+		dagger_symmetrize(dagger(U) * realInner(Xfinal.Y, Xfinal.HY) * U).diagonalize(evecs, eigs);
+		matrix rot = U * evecs;
+		C = Xfinal.Y * rot;
+		VdagC.resize(Xfinal.VdagY.size());
+		for(size_t sp=0; sp<VdagC.size(); sp++)
+			VdagC[sp] = Xfinal.VdagY[sp] ? Xfinal.VdagY[sp] * rot : matrix();
+	}
+	Eband = qnum.weight * trace(eigs);
+	logPrintf("BandRMMDIIS: Subspace rotation  Eband: %+.15lf\n", Eband); fflush(globalLog);
+	
+	//Update final quantities:
+	Hsub_eigs = eigs;
+	Hsub = Hsub_eigs;
+	Hsub_evecs = eye(nBands);
+}
@@ -0,0 +1,54 @@
+/*-------------------------------------------------------------------
+Copyright 2026 agent
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+
+#ifndef JDFTX_ELECTRONIC_BANDRMMDIIS_H
+#define JDFTX_ELECTRONIC_BANDRMMDIIS_H
+
+#include <core/Minimize.h>
+
+class Everything;
+
+//! @addtogroup ElecSystem
+//! @{
+
+//! Residual minimization with direct inversion in the iterative subspace (RMM-DIIS) band refinement.
+//! Each band is improved independently by a few preconditioned residual-minimization steps
+//! without orthogonalization against the other bands, followed by a single Cholesky-QR
+//! orthonormalization and Rayleigh-Ritz step within the span of all the bands at the end.
+//! Since RMM-DIIS converges to the eigenvector nearest to the starting guess, it is only
+//! suitable for refining bands that are already close to convergence (late in SCF).
+class BandRMMDIIS
+{
+public:
+	BandRMMDIIS(Everything& e, int q); //!< Construct RMM-DIIS band refinement for quantum number q
+	void minimize(int nSteps); //!< Refine all bands with (at most) nSteps residual-minimization steps each
+
+private:
+	Everything& e;
+	class ElecVars& eVars;
+	const class ElecInfo& eInfo;
+	int q;  //!< Current quantum number
+
+	struct Images; //!< wavefunctions along with their Hamiltonian and overlap images and projections
+	void applyHamiltonian(Images& Y); //!< set Hamiltonian image of Y (which must have its projections set)
+};
+
+//! @}
+#endif // JDFTX_ELECTRONIC_BANDRMMDIIS_H
@@ -29,6 +29,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 Basis::Basis()
 {	gInfo = 0;
 	nbasis = 0;
+	realWfns = false;
 }
 
 Basis::Basis(const Basis& basis)
@@ -42,6 +43,8 @@ Basis& Basis::operator=(const Basis& basis)
 	iGarr = basis.iGarr;
 	index = basis.index;
 	head = basis.head;
+	realWfns = basis.realWfns;
+	indexMinus = basis.indexMinus;
 	return *this;
 }
 
@@ -91,6 +94,7 @@ void Basis::setup(const GridInfo& gInfo, const IonInfo& iInfo,
 	this->iInfo = &iInfo;
 	
 	nbasis = iGvec.size();
+	realWfns = false;
 	iGarr.init(nbasis);
 	index.init(nbasis);
 	memcpy(iGarr.data(), &iGvec[0], sizeof(vector3<int>)*nbasis);
@@ -103,3 +107,19 @@ void Basis::setup(const GridInfo& gInfo, const IonInfo& iInfo,
 			head.push_back(n);
 }
 
+void Basis::setRealWfns()
+{	//Map full-grid indices to basis locations:
+	std::vector<int> basisIndex(gInfo->nr, -1);
+	for(size_t n=0; n<nbasis; n++)
+		basisIndex[index.data()[n]] = n;
+	//Locate -G for each G:
+	std::vector<int> indexMinusVec(nbasis);
+	for(size_t n=0; n<nbasis; n++)
+	{	int nMinus = basisIndex[gInfo->fullGindex(-iGarr.data()[n])];
+		if(nMinus < 0) die("Wavefunction basis is not inversion symmetric, as required for real wavefunctions.\n");
+		indexMinusVec[n] = nMinus;
+	}
+	indexMinus.init(nbasis);
+	memcpy(indexMinus.data(), indexMinusVec.data(), sizeof(int)*nbasis);
+	realWfns = true;
+}
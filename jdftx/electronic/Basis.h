@@ -40,6 +40,8 @@ public:
 	IndexVecArray iGarr;
 	IndexArray index;
 	std::vector<int> head; //!< short list of low G basis locations (used for phase fixing)
+	bool realWfns; //!< whether wavefunctions in this basis are real in real space (Gamma-point only, see setRealWfns())
+	IndexArray indexMinus; //!< basis location of -G for each basis G (initialized only if realWfns)
 	
 	Basis();
 	Basis(const Basis&); //!< copy by reference
@@ -51,6 +53,9 @@ public:
 	//! Create a custom basis with an arbitrary indexing scheme
 	void setup(const GridInfo& gInfo, const IonInfo& iInfo, const std::vector<int>& indexVec);
 	
+	//! Switch to real-wavefunction mode, where psi(-G) = psi*(G) for all wavefunctions (valid only for a Gamma-point basis)
+	void setRealWfns();
+	
 private:
 	void setup(const GridInfo& gInfo, const IonInfo& iInfo,
 		const std::vector<int>& indexVec,
@@ -24,6 +24,8 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <core/Random.h>
 #include <core/BlasExtra.h>
 #include <core/ScalarFieldIO.h>
+#include <core/LatticeUtils.h>
+#include <core/CheckpointWriter.h>
 #include <fftw3.h>
 
 // Called by other constructors to do the work
@@ -173,6 +175,11 @@ void ColumnBundle::randomize(int colStart, int colStop)
 				thisData[index(i,j+s*basis->nbasis)] = Random::normalComplex(sigma);
 		j++;
 	}
+	if(basis->realWfns) //symmetrize the randomized columns:
+	{	ColumnBundle Ysub = getSub(colStart, colStop);
+		makeReal(Ysub);
+		setSub(colStart, Ysub);
+	}
 	watch.stop();
 }
 void randomize(std::vector<ColumnBundle>& Y, const ElecInfo& eInfo)
@@ -182,7 +189,7 @@ void randomize(std::vector<ColumnBundle>& Y, const ElecInfo& eInfo)
 
 //--------- Read/write an array of ColumnBundles from/to a file --------------
 
-void ElecInfo::write(const std::vector<ColumnBundle>& Y, const char* fname) const
+void ElecInfo::write(const std::vector<ColumnBundle>& Y, const char* fname, CheckpointWriter* writer) const
 {	//Compute output length from each process:
 	std::vector<long> nBytes(mpiUtil->nProcesses(), 0); //total bytes to be written on each process
 	for(int q=qStart; q<qStop; q++)
@@ -197,6 +204,14 @@ void ElecInfo::write(const std::vector<ColumnBundle>& Y, const char* fname) cons
 	{	if(iSrc<mpiUtil->iProcess()) offset += nBytes[iSrc];
 		fsize += nBytes[iSrc];
 	}
+	if(writer) //snapshot for background write:
+	{	writer->setFileSize(fname, fsize);
+		for(int q=qStart; q<qStop; q++)
+		{	writer->add(fname, offset, Y[q].data(), sizeof(complex), Y[q].nData());
+			offset += Y[q].nData()*sizeof(complex);
+		}
+		return;
+	}
 	//Write to file:
 	MPIUtil::File fp; mpiUtil->fopenWrite(fp, fname);
 	mpiUtil->fseek(fp, offset, SEEK_SET);
@@ -211,9 +226,12 @@ ElecInfo::ColumnBundleReadConversion::ColumnBundleReadConversion()
 {
 }
 
-void ElecInfo::read(std::vector<ColumnBundle>& Y, const char *fname, const ColumnBundleReadConversion* conversion) const
-{	if(conversion && conversion->realSpace)
-	{	if(qStop==qStart) return; //no k-point on this process
+int ElecInfo::read(std::vector<ColumnBundle>& Y, const char *fname, const ColumnBundleReadConversion* conversion) const
+{	if(!(conversion && conversion->realSpace) && isChunkedFile(fname))
+		return readChunked(Y, fname); //self-describing: conversions determined from file contents
+	int nBandsRead = (conversion && conversion->nBandsOld) ? std::min(nBands, conversion->nBandsOld) : nBands;
+	if(conversion && conversion->realSpace)
+	{	if(qStop==qStart) return nBandsRead; //no k-point on this process
 		const GridInfo* gInfoWfns = Y[qStart].basis->gInfo;
 		//Create a custom gInfo if necessary:
 		GridInfo gInfoCustom;
@@ -300,4 +318,188 @@ void ElecInfo::read(std::vector<ColumnBundle>& Y, const char *fname, const Colum
 		}
 		mpiUtil->fclose(fp);
 	}
+	return nBandsRead;
+}
+
+//--------- Chunked (self-describing) format for an array of ColumnBundles --------------
+//File layout (all little-endian):
+//  char magic[8]
+//  int32 version, nStates, nSpinor, bytesPerReal (8 or 4), S[3] (wavefunction grid), reserved
+//  double R[9] (lattice vectors)
+//  double k[nStates][3] (k-points in reciprocal lattice coordinates)
+//  int64 index[nStates][4] = {nbasis, nCols, offsetG, offsetC} (byte offsets from start of file)
+//followed by a chunk per state containing int32 iG[nbasis][3] at offsetG,
+//and the coefficients (columns of length nSpinor*nbasis, real and imaginary parts interleaved) at offsetC.
+
+namespace ChunkedFormat
+{	static const char magic[8] = {'J','D','F','T','x','W','F','C'};
+	static const int32_t version = 1;
+	static const int nHeaderInts = 8;
+	static const int nIndexEntries = 4;
+	
+	inline size_t headerBytes(int nStates)
+	{	return sizeof(magic) + nHeaderInts*sizeof(int32_t) + 9*sizeof(double)
+			+ nStates * (3*sizeof(double) + nIndexEntries*sizeof(int64_t));
+	}
+}
+
+bool ElecInfo::isChunkedFile(const char* fname)
+{	FILE* fp = fopen(fname, "rb");
+	if(!fp) return false;
+	char magic[8];
+	bool result = (fread(magic, 1, 8, fp) == 8) && !memcmp(magic, ChunkedFormat::magic, 8);
+	fclose(fp);
+	return result;
+}
+
+void ElecInfo::writeChunked(const std::vector<ColumnBundle>& Y, const char* fname, bool singlePrecision, CheckpointWriter* writer) const
+{	static StopWatch watch("ElecInfo::writeChunked"); watch.start();
+	int nSpinor = spinorLength();
+	int32_t bytesPerReal = singlePrecision ? sizeof(float) : sizeof(double);
+	//Create index (identical on all processes, since all bases are available everywhere):
+	std::vector<double> kArr(nStates*3);
+	std::vector<int64_t> index(nStates*ChunkedFormat::nIndexEntries);
+	int64_t offset = ChunkedFormat::headerBytes(nStates);
+	for(int q=0; q<nStates; q++)
+	{	const Basis& basis = e->basis[q];
+		for(int j=0; j<3; j++) kArr[q*3+j] = qnums[q].k[j];
+		int64_t* indexCur = index.data() + q*ChunkedFormat::nIndexEntries;
+		indexCur[0] = basis.nbasis;
+		indexCur[1] = nBands;
+		indexCur[2] = offset; offset += basis.nbasis * 3*sizeof(int32_t);
+		indexCur[3] = offset; offset += int64_t(nBands) * nSpinor * basis.nbasis * 2*bytesPerReal;
+	}
+	//Write directly, or snapshot to writer for background write:
+	MPIUtil::File fp;
+	if(writer) writer->setFileSize(fname, offset);
+	else mpiUtil->fopenWrite(fp, fname);
+	auto writeAt = [&](int64_t offset, const void* ptr, size_t size, size_t nmemb)
+	{	if(writer) writer->add(fname, offset, ptr, size, nmemb);
+		else
+		{	mpiUtil->fseek(fp, offset, SEEK_SET);
+			mpiUtil->fwrite(ptr, size, nmemb, fp);
+		}
+	};
+	//Header and index from head:
+	if(mpiUtil->isHead())
+	{	const vector3<int>& S = e->basis[0].gInfo->S;
+		int32_t header[ChunkedFormat::nHeaderInts] = { ChunkedFormat::version, nStates, nSpinor, bytesPerReal, S[0], S[1], S[2], 0 };
+		double R[9]; for(int i=0; i<3; i++) for(int j=0; j<3; j++) R[i*3+j] = e->gInfo.R(i,j);
+		int64_t offset = 0;
+		writeAt(offset, ChunkedFormat::magic, 1, 8); offset += 8;
+		writeAt(offset, header, sizeof(int32_t), ChunkedFormat::nHeaderInts); offset += sizeof(header);
+		writeAt(offset, R, sizeof(double), 9); offset += sizeof(R);
+		writeAt(offset, kArr.data(), sizeof(double), kArr.size()); offset += kArr.size()*sizeof(double);
+		writeAt(offset, index.data(), sizeof(int64_t), index.size());
+	}
+	//Chunks of states on each process in parallel:
+	std::vector<float> buf;
+	for(int q=qStart; q<qStop; q++)
+	{	const int64_t* indexCur = index.data() + q*ChunkedFormat::nIndexEntries;
+		assert(Y[q].nCols() == nBands);
+		writeAt(indexCur[2], e->basis[q].iGarr.data(), sizeof(int32_t), 3*e->basis[q].nbasis);
+		size_t nReals = 2*Y[q].nData();
+		const double* data = (const double*)Y[q].data();
+		if(singlePrecision)
+		{	buf.assign(data, data+nReals); //convert to single precision
+			writeAt(indexCur[3], buf.data(), sizeof(float), nReals);
+		}
+		else writeAt(indexCur[3], data, sizeof(double), nReals);
+	}
+	if(!writer) mpiUtil->fclose(fp);
+	watch.stop();
+}
+
+int ElecInfo::readChunked(std::vector<ColumnBundle>& Y, const char* fname) const
+{	static StopWatch watch("ElecInfo::readChunked"); watch.start();
+	MPIUtil::File fp; mpiUtil->fopenRead(fp, fname);
+	//Read and check header:
+	char magic[8]; int32_t header[ChunkedFormat::nHeaderInts]; double R[9];
+	mpiUtil->fread(magic, 1, 8, fp);
+	mpiUtil->fread(header, sizeof(int32_t), ChunkedFormat::nHeaderInts, fp);
+	mpiUtil->fread(R, sizeof(double), 9, fp);
+	int32_t version = header[0], nStatesFile = header[1], nSpinorFile = header[2], bytesPerReal = header[3];
+	if(version > ChunkedFormat::version)
+		die("Wavefunction file '%s' has format version %d, but at most version %d is supported.\n", fname, version, ChunkedFormat::version);
+	if(nStatesFile != nStates)
+		die("Wavefunction file '%s' contains %d states instead of %d.\n%s", fname, nStatesFile, nStates,
+			(e->vibrations and qnums.size()>1)
+			? "Hint: Vibrations requires wavefunctions without symmetries:\n"
+				"either don't read in state, or consider using phonon instead.\n"
+			: "");
+	if(nSpinorFile != spinorLength())
+		die("Wavefunction file '%s' has %d spinor components instead of %d.\n", fname, nSpinorFile, spinorLength());
+	if(bytesPerReal!=sizeof(double) && bytesPerReal!=sizeof(float))
+		die("Wavefunction file '%s' has invalid precision (%d bytes per real number).\n", fname, bytesPerReal);
+	matrix3<> Rfile; for(int i=0; i<3; i++) for(int j=0; j<3; j++) Rfile(i,j) = R[i*3+j];
+	if(nrm2(Rfile - e->gInfo.R) > symmThreshold * nrm2(e->gInfo.R))
+		logPrintf("NOTE: lattice vectors in '%s' differ from the current ones; coefficients of each G-vector\n"
+			"(in reciprocal lattice coordinates) are used as is, which is exact only for the stored lattice.\n", fname);
+	//Read index:
+	std::vector<double> kArr(nStates*3);
+	std::vector<int64_t> index(nStates*ChunkedFormat::nIndexEntries);
+	mpiUtil->fread(kArr.data(), sizeof(double), kArr.size(), fp);
+	mpiUtil->fread(index.data(), sizeof(int64_t), index.size(), fp);
+	//Read chunks of states on each process (independent of the process layout used for writing):
+	int nSpinor = spinorLength();
+	std::vector<vector3<int>> iGfile;
+	std::vector<complex> Cfile;
+	std::vector<float> buf;
+	int nBandsRead = nBands; //minimum over states of the number of bands read
+	for(int q=qStart; q<qStop; q++)
+	{	const int64_t* indexCur = index.data() + q*ChunkedFormat::nIndexEntries;
+		vector3<> kFile(kArr[q*3], kArr[q*3+1], kArr[q*3+2]);
+		if((kFile - qnums[q].k).length_squared() > symmThresholdSq)
+			die("k-point mismatch for state %d in wavefunction file '%s'.\n", q, fname);
+		size_t nbasisFile = indexCur[0];
+		int nColsFile = indexCur[1];
+		//Read G-vectors and coefficients:
+		iGfile.resize(nbasisFile);
+		mpiUtil->fseek(fp, indexCur[2], SEEK_SET);
+		mpiUtil->fread(iGfile.data(), sizeof(int32_t), 3*nbasisFile, fp);
+		size_t colLengthFile = nSpinor * nbasisFile;
+		size_t nReals = 2 * nColsFile * colLengthFile;
+		Cfile.resize(nColsFile * colLengthFile);
+		mpiUtil->fseek(fp, indexCur[3], SEEK_SET);
+		if(bytesPerReal == sizeof(float))
+		{	buf.resize(nReals);
+			mpiUtil->fread(buf.data(), sizeof(float), nReals, fp);
+			std::copy(buf.begin(), buf.end(), (double*)Cfile.data());
+		}
+		else mpiUtil->fread(Cfile.data(), sizeof(double), nReals, fp);
+		//Convert to current basis and number of bands:
+		const Basis& basis = *(Y[q].basis);
+		int nCols = std::min(nColsFile, Y[q].nCols());
+		nBandsRead = std::min(nBandsRead, nCols);
+		complex* Ydata = Y[q].data();
+		if(nbasisFile==basis.nbasis && std::equal(iGfile.begin(), iGfile.end(), basis.iGarr.data()))
+			eblas_copy(Ydata, Cfile.data(), nCols*colLengthFile); //same basis: direct copy
+		else
+		{	//Map stored G-vectors to current basis via the full G-space grid:
+			const GridInfo& gInfo = *(basis.gInfo);
+			std::vector<int> fullToBasis(gInfo.nr, -1);
+			const int* basisIndex = basis.index.data();
+			for(size_t n=0; n<basis.nbasis; n++) fullToBasis[basisIndex[n]] = n;
+			std::vector<int> fileToBasis(nbasisFile, -1);
+			for(size_t n=0; n<nbasisFile; n++)
+			{	const vector3<int>& iG = iGfile[n];
+				bool inBox = true;
+				for(int k=0; k<3; k++) if(2*abs(iG[k]) >= gInfo.S[k]) inBox = false;
+				if(inBox) fileToBasis[n] = fullToBasis[gInfo.fullGindex(iG)];
+			}
+			for(int b=0; b<nCols; b++)
+				for(int s=0; s<nSpinor; s++)
+				{	complex* Ycol = Ydata + Y[q].index(b, s*basis.nbasis);
+					const complex* Cfilecol = Cfile.data() + b*colLengthFile + s*nbasisFile;
+					eblas_zero(basis.nbasis, Ycol);
+					for(size_t n=0; n<nbasisFile; n++)
+						if(fileToBasis[n] >= 0)
+							Ycol[fileToBasis[n]] = Cfilecol[n];
+				}
+		}
+	}
+	mpiUtil->fclose(fp);
+	mpiUtil->allReduce(nBandsRead, MPIUtil::ReduceMin);
+	watch.stop();
+	return nBandsRead;
 }
@@ -28,6 +28,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <core/BlasExtra.h>
 #include <core/GpuUtil.h>
 #include <core/GridInfo.h>
+#include <core/BandGroup.h>
 #include <core/LoopMacros.h>
 #include <core/Operators.h>
 
@@ -191,7 +192,16 @@ ColumnBundle Idag_DiagV_I(const ColumnBundle& C, const ScalarFieldArray& V)
 	assert(Vwfns.size()==1 || Vwfns.size()==2 || Vwfns.size()==4);
 	if(Vwfns.size()==2) assert(!C.isSpinor());
 	if(Vwfns.size()==1 || Vwfns.size()==2)
-	{	threadLaunch(isGpuEnabled()?1:0, Idag_DiagV_I_sub, C.nCols(), &C, &Vwfns, &VC);
+	{
+		#ifdef GPU_ENABLED
+		threadLaunch(1, Idag_DiagV_I_sub, C.nCols(), &C, &Vwfns, &VC);
+		#else
+		//Batched transforms, with columns (spinor components) divided over threads and band-group processes:
+		const ScalarField& Vs = Vwfns[Vwfns.size()==1 ? 0 : C.qnum->index()];
+		const Basis& basis = *(C.basis);
+		BandGroup(gInfoWfns, basis.nbasis, basis.index.data(), basis.realWfns ? basis.indexMinus.data() : 0)
+			.Idag_DiagV_I(C.nCols()*C.spinorLength(), C.data(), Vs->data(false), Vs->scale, VC.data());
+		#endif
 	}
 	else //Vwfns.size()==4
 	{	assert(C.isSpinor());
@@ -406,6 +416,38 @@ ColumnBundle switchBasis(const ColumnBundle& in, const Basis& basisOut)
 	return out;
 }
 
+void makeReal(ColumnBundle& Y, bool optimizePhase)
+{	if(!Y.basis->realWfns) return;
+	assert(!Y.isSpinor());
+	const Basis& basis = *(Y.basis);
+	const int* indexMinus = basis.indexMinus.data();
+	for(int b=0; b<Y.nCols(); b++)
+	{	complex* Ydata = Y.data() + Y.index(b,0);
+		if(optimizePhase)
+		{	//Norms of the real projections of Y and iY, and their overlap:
+			double A = 0., B = 0., X = 0.;
+			for(size_t n=0; n<basis.nbasis; n++)
+			{	const complex& c = Ydata[n];
+				const complex cmConj = Ydata[indexMinus[n]].conj();
+				complex Rc = 0.5*(c + cmConj), RiC = complex(0,0.5)*(c - cmConj);
+				A += Rc.norm();
+				B += RiC.norm();
+				X += (Rc.conj() * RiC).real();
+			}
+			//Phase that maximizes the norm of the real projection of exp(i theta) Y:
+			double theta = 0.5*atan2(2*X, A-B);
+			eblas_zscal(basis.nbasis, cis(theta), Ydata, 1);
+		}
+		//Symmetrize, Y(G) -> (Y(G) + Y*(-G))/2:
+		for(size_t n=0; n<basis.nbasis; n++)
+		{	size_t nMinus = indexMinus[n];
+			if(nMinus < n) continue; //handled with partner
+			Ydata[n] = 0.5*(Ydata[n] + Ydata[nMinus].conj());
+			Ydata[nMinus] = Ydata[n].conj();
+		}
+	}
+}
+
 //------------------------------ ColumnBundle reductions ---------------------------------
 
 // Returns trace(F*X^Y)
@@ -419,6 +461,23 @@ complex traceinner(const diagMatrix &F, const ColumnBundle &X, const ColumnBundl
 	return result;
 }
 
+matrix realInner(const ColumnBundle& Y1, const ColumnBundle& Y2)
+{	if(!Y1.basis->realWfns || isGpuEnabled()) return Y1^Y2;
+	static StopWatch watch("realInner"); watch.start();
+	assert(Y1.colLength() == Y2.colLength());
+	//Re(Y1^Y2) = Y1^T Y2 with the real and imaginary parts treated as separate rows:
+	int colLength = 2*Y1.colLength();
+	std::vector<double> Y1dY2(Y1.nCols() * Y2.nCols());
+	cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, Y1.nCols(), Y2.nCols(), colLength,
+		1., (const double*)Y1.data(), colLength, (const double*)Y2.data(), colLength,
+		0., Y1dY2.data(), Y1.nCols());
+	matrix result(Y1.nCols(), Y2.nCols());
+	complex* resultData = result.data();
+	for(size_t i=0; i<Y1dY2.size(); i++) resultData[i] = Y1dY2[i];
+	watch.stop();
+	return result;
+}
+
 // Compute the density from a subset of columns of a ColumnBundle
 void diagouterI_sub(int iThread, int nThreads, const diagMatrix *F, const ColumnBundle *X, std::vector<ScalarFieldArray>* nSub)
 {
@@ -471,13 +530,31 @@ ScalarFieldArray diagouterI(const diagMatrix &F,const ColumnBundle &X,  int nDen
 	if(nDensities==2) assert(!X.isSpinor());
 	if(nDensities==4) assert(X.isSpinor());
 	
-	//Collect the contributions for different sets of columns in separate scalar fields (one per thread):
-	int nThreads = isGpuEnabled() ? 1: nProcsAvailable;
-	std::vector<ScalarFieldArray> nSub(nThreads, ScalarFieldArray(nDensities==2 ? 1 : nDensities)); //collinear spin-polarized will have only one non-zero output channel
-	threadLaunch(nThreads, diagouterI_sub, 0, &F, &X, &nSub);
+	int nChannels = nDensities==2 ? 1 : nDensities; //collinear spin-polarized will have only one non-zero output channel
+	std::vector<ScalarFieldArray> nSub(1, ScalarFieldArray(nChannels));
+	#ifndef GPU_ENABLED
+	if(nDensities != 4)
+	{	//Batched transforms, with columns (spinor components) divided over threads and band-group processes:
+		const Basis& basis = *(X.basis);
+		int nSpinor = X.spinorLength();
+		std::vector<double> Fcols(X.nCols()*nSpinor);
+		for(int i=0; i<X.nCols(); i++)
+			for(int s=0; s<nSpinor; s++)
+				Fcols[i*nSpinor+s] = F[i];
+		nullToZero(nSub[0], *(basis.gInfo));
+		BandGroup(*(basis.gInfo), basis.nbasis, basis.index.data(), basis.realWfns ? basis.indexMinus.data() : 0)
+			.diagouterI(Fcols.size(), X.data(), Fcols.data(), nSub[0][0]->data());
+	}
+	else
+	#endif
+	{	//Collect the contributions for different sets of columns in separate scalar fields (one per thread):
+		int nThreads = isGpuEnabled() ? 1: nProcsAvailable;
+		nSub.assign(nThreads, ScalarFieldArray(nChannels));
+		threadLaunch(nThreads, diagouterI_sub, 0, &F, &X, &nSub);
 
-	//If more than one thread, accumulate all vectors in nSub into the first:
-	if(nThreads>1) threadLaunch(diagouterI_collect, X.basis->gInfo->nr, &nSub);
+		//If more than one thread, accumulate all vectors in nSub into the first:
+		if(nThreads>1) threadLaunch(diagouterI_collect, X.basis->gInfo->nr, &nSub);
+	}
 	watch.stop();
 	
 	//Change grid if necessary:
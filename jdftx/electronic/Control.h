@@ -32,7 +32,7 @@ enum BasisKdep { BasisKpointDep, BasisKpointIndep } ;
 static EnumStringMap<BasisKdep> kdepMap(BasisKpointDep, "kpoint-dependent", BasisKpointIndep, "single" );
 
 //! Electronic eigenvalue method
-enum ElecEigenAlgo { ElecEigenCG, ElecEigenDavidson };
+enum ElecEigenAlgo { ElecEigenCG, ElecEigenDavidson, ElecEigenLOBPCG };
 
 //! Miscellaneous flags controlling electronic DFT
 class Control
@@ -40,13 +40,20 @@ class Control
 public:
 	bool fixed_H; //!< fixed Hamiltonian (band structure) mode for electronic sector
 	bool cacheProjectors; //!< whether to cache nonlocal projectors
+	double projectorCacheMB; //!< memory budget for cached projectors in MB (0 = unlimited)
+	bool fftPlanWarmup; //!< whether to create all FFT plans during setup
+	bool realSpaceProjectors; //!< whether to apply nonlocal projectors in real space (see RealSpaceProjectors)
+	double realSpaceProjectorTol; //!< relative norm of real-space projectors allowed outside their truncation radius
 	double davidsonBandRatio; //!< ratio of number of Davidson working bands to actual bands in system (>= 1)
+	int lobpcgBlockSize; //!< number of active bands in each LOBPCG Rayleigh-Ritz block (0 => all active bands in one block)
 	
 	ElecEigenAlgo elecEigenAlgo; //!< Eigenvalue algorithm
 	BasisKdep basisKdep; //!< k-dependence of basis
+	bool realWfns; //!< whether to use real wavefunctions (Gamma-point only calculations)
 	double Ecut, EcutRho; //!< energy cutoff for electrons and charge density grid (EcutRho=0 => EcutRho = 4 Ecut)
 	
 	bool dragWavefunctions; //!< whether to drag wavefunctions using atomic orbital projections on ionic steps
+	int wfnsHistory; //!< number of previous ionic steps retained for wavefunction extrapolation (0 => disabled)
 	vector3<> lattMoveScale; //!< preconditioning factor for each lattice vector during lattice minimization
 	
 	int fluidGummel_nIterations; //!< max iterations of the fluid<->electron self-consistency loop
@@ -66,8 +73,8 @@ public:
 	
 	Control()
 	:	fixed_H(false),
-		cacheProjectors(true), davidsonBandRatio(1.1),
-		elecEigenAlgo(ElecEigenDavidson), basisKdep(BasisKpointDep), Ecut(0), EcutRho(0), dragWavefunctions(true),
+		cacheProjectors(true), projectorCacheMB(0.), fftPlanWarmup(false), realSpaceProjectors(false), realSpaceProjectorTol(1e-5), davidsonBandRatio(1.1), lobpcgBlockSize(0),
+		elecEigenAlgo(ElecEigenDavidson), basisKdep(BasisKpointDep), realWfns(false), Ecut(0), EcutRho(0), dragWavefunctions(true), wfnsHistory(0),
 		fluidGummel_nIterations(10), fluidGummel_Atol(1e-5),
 		shouldPrintEigsFillings(false), shouldPrintEcomponents(false), shouldPrintMuSearch(false), shouldPrintKpointsBasis(false),
 		subspaceRotationFactor(1.), subspaceRotationAdjust(true), scf(false), convergeEmptyStates(false), dumpOnly(false)
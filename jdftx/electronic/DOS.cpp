@@ -679,6 +679,34 @@ inline vector3<int> round(const vector3<> v, const double tol)
 	return vInt;
 }
 
+//Pick the tetrahedral tesselation of parallelopiped cells with reciprocal lattice vectors GTsup (in columns):
+//There are 4 distinct tesselations listed by signs of each basis vector (upto an overall sign);
+//pick the one with the shortest common body-diagonal to yield the most suitable aspect ratios
+inline vector3<int> getTesselationSigns(const matrix3<>& GTsup)
+{	vector3<int> sBest;
+	double dMin = DBL_MAX;
+	vector3<int> s;
+	s[0] = 1;
+	for(s[1]=-1; s[1]<=1; s[1]+=2)
+	for(s[2]=-1; s[2]<=1; s[2]+=2)
+	{	double d = (GTsup * s).length();
+		if(d < dMin)
+		{	dMin = d;
+			sBest = s;
+		}
+	}
+	return sBest;
+}
+
+//Parallelopiped vertex indices of the 6 tetrahedra in its tesselation (vertex index = 4*i0 + 2*i1 + i2)
+static const int cellVerts[6][4] = {
+	{0, 2, 3, 7},
+	{0, 3, 1, 7},
+	{0, 1, 5, 7},
+	{0, 5, 4, 7},
+	{0, 4, 6, 7},
+	{0, 6, 2, 7} };
+
 void DOS::dump()
 {
 	const ElecInfo& eInfo = e->eInfo;
@@ -688,21 +716,8 @@ void DOS::dump()
 	
 	//Pick optimum tetrahedral tesselation of each parallelopiped cell in BZ:
 	vector3<> dk[8]; //k-point offsets of basis parallelopiped relative to its first vertex
-	{	//There are 4 distinct tesselations listed by signs of each basis vector (upto an overall sign)
-		//Pick the one with the shortest common body-diagonal to yield the most suitable aspect ratios
-		vector3<int> sBest;
-		double dMin = DBL_MAX;
-		matrix3<> GTsup = ~((2*M_PI) * inv(supercell.Rsuper));
-		vector3<int> s;
-		s[0] = 1;
-		for(s[1]=-1; s[1]<=1; s[1]+=2)
-		for(s[2]=-1; s[2]<=1; s[2]+=2)
-		{	double d = (GTsup * s).length();
-			if(d < dMin)
-			{	dMin = d;
-				sBest = s;
-			}
-		}
+	{	matrix3<> GTsup = ~((2*M_PI) * inv(supercell.Rsuper));
+		vector3<int> sBest = getTesselationSigns(GTsup);
 		//Compute the offsets:
 		matrix3<> invGT_GTsup = inv(e->gInfo.GT) * GTsup;
 		vector3<int> i;
@@ -712,14 +727,6 @@ void DOS::dump()
 		for(i[2]=0; abs(i[2])<2; i[2]+=sBest[2])
 			dk[ik++] = invGT_GTsup * i;
 	}
-	//--- parallelopiped vertex indices of the 6 tetrahedra in its tesselation
-	int cellVerts[6][4] = {
-		{0, 2, 3, 7},
-		{0, 3, 1, 7},
-		{0, 1, 5, 7},
-		{0, 5, 4, 7},
-		{0, 4, 6, 7},
-		{0, 6, 2, 7} };
 	
 	//Construct Brillouin zone triangulation in an EvalDOS object:
 	//--- lookup table of k-points using (integral) reciprocal superlattice coordinates
@@ -1007,3 +1014,56 @@ void DOS::dump()
 	for(int iSpin=0; iSpin<nSpins; iSpin++)
 		eval.printDOS(iSpin*qCount, e->dump.getFilename(nSpins==1 ? "dos" : (iSpin==0 ? "dosUp" : "dosDn")), header);
 }
+
+void DOS::dumpUniform(const matrix3<>& GT, const vector3<int>& kfold, int nBands, const std::vector<double>& eigs,
+	double spinWeight, double Etol, double Esigma, string filename)
+{	int nk = kfold[0]*kfold[1]*kfold[2];
+	assert(int(eigs.size()) == nk*nBands);
+	if(!mpiUtil->isHead()) return;
+	
+	//Pick optimum tesselation (integer offsets of parallelopiped vertices on the mesh):
+	vector3<int> dk[8];
+	{	matrix3<> GTsup = GT * Diag(vector3<>(1./kfold[0], 1./kfold[1], 1./kfold[2]));
+		vector3<int> sBest = getTesselationSigns(GTsup);
+		vector3<int> i;
+		int ik = 0;
+		for(i[0]=0; abs(i[0])<2; i[0]+=sBest[0])
+		for(i[1]=0; abs(i[1])<2; i[1]+=sBest[1])
+		for(i[2]=0; abs(i[2])<2; i[2]+=sBest[2])
+			dk[ik++] = i;
+	}
+	
+	//Construct Brillouin zone triangulation (all tetrahedra have equal volume on a uniform mesh):
+	EvalDOS eval(6*nk, 1, nk, nBands, Etol, Esigma);
+	double V = spinWeight / (6*nk); //normalize volume of tetrahedra to add up to spinWeight
+	vector3<int> i0;
+	int ik = 0;
+	for(i0[0]=0; i0[0]<kfold[0]; i0[0]++)
+	for(i0[1]=0; i0[1]<kfold[1]; i0[1]++)
+	for(i0[2]=0; i0[2]<kfold[2]; i0[2]++)
+	{	//look up mesh indices of the parallelopiped vertices (with periodic wrapping):
+		int iv[8];
+		for(int j=0; j<8; j++)
+		{	vector3<int> i = i0 + dk[j];
+			for(int k=0; k<3; k++) i[k] = (i[k] + kfold[k]) % kfold[k];
+			iv[j] = (i[0]*kfold[1] + i[1])*kfold[2] + i[2];
+		}
+		//add 6 tetrahedra per parallelopiped cell:
+		for(unsigned t=0; t<6; t++)
+		{	EvalDOS::Tetrahedron& tet = eval.tetrahedra[6*ik+t];
+			for(int p=0; p<4; p++)
+				tet.q[p] = iv[cellVerts[t][p]];
+			tet.V = V;
+		}
+		//set eigenvalues and uniform weights:
+		for(int b=0; b<nBands; b++)
+		{	eval.e(ik, b) = eigs[ik*nBands + b];
+			eval.w(0, ik, b) = 1.;
+		}
+		ik++;
+	}
+	
+	//Compute and print density of states:
+	eval.weldEigenvalues();
+	eval.printDOS(0, filename, "\"Energy\"\t\"Total\"");
+}
@@ -21,7 +21,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #define JDFTX_ELECTRONIC_DOS_H
 
 #include <electronic/ElecInfo.h>
-#include <core/vector3.h>
+#include <core/matrix3.h>
 
 //! @addtogroup Output
 //! @{
@@ -88,6 +88,14 @@ public:
 	DOS();
 	void setup(const Everything&); //!< initialize
 	void dump(); //!< dump density of states to file (filename obtained from Dump)
+	
+	//! Dump total density of states, computed with the tetrahedron method, for band energies on a uniform
+	//! Gamma-centered k-mesh of dimensions kfold without any symmetry reduction (such as from Wannier interpolation).
+	//! Energies are ordered as eigs[ik*nBands+b] with ik = (i0*kfold[1] + i1)*kfold[2] + i2, GT contains reciprocal
+	//! lattice vectors in columns, and the output is normalized to spinWeight states per band per unit cell.
+	//! Only the head process writes filename, and therefore requires the full set of eigs.
+	static void dumpUniform(const matrix3<>& GT, const vector3<int>& kfold, int nBands, const std::vector<double>& eigs,
+		double spinWeight, double Etol, double Esigma, string filename);
 private:
 	const Everything* e;
 };
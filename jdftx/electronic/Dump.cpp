@@ -27,13 +27,15 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <electronic/Polarizability.h>
 #include <electronic/ElectronScattering.h>
 #include <electronic/LatticeMinimizer.h>
+#include <electronic/SCF.h>
 #include <fluid/FluidSolver.h>
 #include <core/VectorField.h>
 #include <core/ScalarFieldIO.h>
+#include <core/CheckpointWriter.h>
 #include <ctime>
 
 Dump::Dump()
-: potentialSubtraction(true)
+: potentialSubtraction(true), wfnsFormat(WfnsFormatRaw), scf(0)
 {
 }
 
@@ -66,6 +68,9 @@ void Dump::setup(const Everything& everything)
 
 void Dump::operator()(DumpFrequency freq, int iter)
 {
+	if(freq==DumpFreq_End && checkpointWriter)
+		checkpointWriter->flush(); //complete any background checkpoint before final output
+	
 	if(!checkInterval(freq, iter)) return; // => don't dump this time
 	
 	bool foundVars = false; //whether any variables are to be dumped at this frequency
@@ -126,12 +131,19 @@ void Dump::operator()(DumpFrequency freq, int iter)
 		<< mytm->tm_hour << '-' << mytm->tm_min << '-' << mytm->tm_sec;
 	stamp = stampStream.str();
 	
+	//Background checkpoint of the State files (final output is always synchronous):
+	//The wavefunctions are snapshot for the I/O thread, while the remaining (small) State files are written
+	//directly to temporary names, so that all files of the checkpoint are renamed together once complete.
+	CheckpointWriter* writer = (ShouldDump(State) && freq!=DumpFreq_End) ? checkpointWriter.get() : 0;
+	if(writer) writer->flush(); //complete previous checkpoint, so that its temporary files can be reused
+	auto stateFilename = [&](const string& fname) { return writer ? writer->addExternal(fname) : fname; };
+	
 	if((ShouldDump(State) and eInfo.fillingsUpdate==ElecInfo::FillingsHsub) or ShouldDump(Fillings))
 	{	//Dump fillings
 		double wInv = eInfo.spinType==SpinNone ? 0.5 : 1.0; //normalization factor from external to internal fillings
 		for(int q=eInfo.qStart; q<eInfo.qStop; q++) ((ElecVars&)eVars).F[q] *= (1./wInv);
 		StartDump("fillings")
-		eInfo.write(eVars.F, fname.c_str());
+		eInfo.write(eVars.F, stateFilename(fname).c_str());
 		EndDump
 		for(int q=eInfo.qStart; q<eInfo.qStop; q++) ((ElecVars&)eVars).F[q] *= wInv;
 	}
@@ -140,13 +152,23 @@ void Dump::operator()(DumpFrequency freq, int iter)
 	{
 		//Dump wave functions
 		StartDump("wfns")
-		eInfo.write(eVars.C, fname.c_str());
-		EndDump
+		if(wfnsFormat == WfnsFormatRaw) eInfo.write(eVars.C, fname.c_str(), writer);
+		else eInfo.writeChunked(eVars.C, fname.c_str(), wfnsFormat==WfnsFormatChunkedSingle, writer);
+		if(writer) { logPrintf("queued for background write\n"); logFlush(); }
+		else { EndDump }
 		
 		if(hasFluid)
 		{	//Dump state of fluid:
 			StartDump("fluidState")
-			if(mpiUtil->isHead()) eVars.fluidSolver->saveState(fname.c_str());
+			string fnameState = stateFilename(fname);
+			if(mpiUtil->isHead()) eVars.fluidSolver->saveState(fnameState.c_str());
+			EndDump
+		}
+		
+		if(freq==DumpFreq_Electronic && scf)
+		{	//Dump SCF history:
+			StartDump("scfHistory")
+			scf->saveState(stateFilename(fname).c_str());
 			EndDump
 		}
 	}
@@ -154,8 +176,11 @@ void Dump::operator()(DumpFrequency freq, int iter)
 	if(ShouldDump(IonicPositions) || (ShouldDump(State) && (e->ionicMinParams.nIterations>0 || e->latticeMinParams.nIterations>0)))
 	{	StartDump("ionpos")
 		FILE* fp;
-		if (freq==DumpFreq_Dynamics) fp = mpiUtil->isHead() ? fopen(fname.c_str(), "a") : nullLog;
-		else fp = mpiUtil->isHead() ? fopen(fname.c_str(), "w") : nullLog;
+		if (freq==DumpFreq_Dynamics) fp = mpiUtil->isHead() ? fopen(fname.c_str(), "a") : nullLog; //trajectory (not part of checkpoint)
+		else
+		{	string fnameOut = stateFilename(fname);
+			fp = mpiUtil->isHead() ? fopen(fnameOut.c_str(), "w") : nullLog;
+		}
 		if(!fp) die("Error opening %s for writing.\n", fname.c_str());
 		iInfo.printPositions(fp);  //needs to be called from all processes (for magnetic moment computation)
 		if(mpiUtil->isHead())fclose(fp);
@@ -173,8 +198,9 @@ void Dump::operator()(DumpFrequency freq, int iter)
 	}
 	if(ShouldDump(Lattice) || (ShouldDump(State) && e->latticeMinParams.nIterations>0))
 	{	StartDump("lattice")
+		string fnameOut = stateFilename(fname);
 		if(mpiUtil->isHead()) 
-		{	FILE* fp = fopen(fname.c_str(), "w");
+		{	FILE* fp = fopen(fnameOut.c_str(), "w");
 			if(!fp) die("Error opening %s for writing.\n", fname.c_str());
 			fprintf(fp, "lattice");
 			for(int j=0; j<3; j++)
@@ -259,9 +285,10 @@ void Dump::operator()(DumpFrequency freq, int iter)
 		if (freq == DumpFreq_Dynamics)
 			eInfo.appendWrite(eVars.Hsub_eigs, fname.c_str());
 		else
-			eInfo.write(eVars.Hsub_eigs, fname.c_str());
+			eInfo.write(eVars.Hsub_eigs, stateFilename(fname).c_str());
 		EndDump
 	}
+	if(writer) writer->commit(); //start background write of wavefunctions (all State files renamed together once complete)
 	
 	if(ShouldDump(EigStats))
 	{	StartDump("eigStats")
@@ -55,6 +55,12 @@ enum DumpVariable { DumpNone, DumpState, //None or exactly those required to res
 	DumpDelim, //special value used as a delimiter during command processing
 };
 
+//! File format for wavefunctions in the dumped state
+enum WfnsFormat
+{	WfnsFormatRaw, //!< headerless stream of coefficients (readers must know the basis and number of bands)
+	WfnsFormatChunked, //!< self-describing chunked format with basis metadata and per-state offsets (see ElecInfo::writeChunked)
+	WfnsFormatChunkedSingle //!< chunked format with single-precision coefficients
+};
 
 //! Stores list of what to output and when, and implements functions to do so
 class Dump : public std::set<std::pair<DumpFrequency,DumpVariable> >
@@ -82,6 +88,9 @@ public:
 	std::shared_ptr<struct BulkEpsilon> bulkEpsilon; //!< bulk dielectric constant calculator
 	std::shared_ptr<struct ChargedDefect> chargedDefect; //!< charged defect correction calculator
 	bool potentialSubtraction; //!< whether to subtract neutral-atom potentials in Dvac and Dtot output
+	WfnsFormat wfnsFormat; //!< file format for wavefunctions
+	std::shared_ptr<class CheckpointWriter> checkpointWriter; //!< if set, write wavefunctions in the background during SCF / ionic loops
+	const class SCF* scf; //!< SCF in progress (if any), whose history is dumped along with State at Electronic frequency
 private:
 	const Everything* e;
 	string format; //!< Filename format containing $VAR, $STAMP, $FREQ etc.
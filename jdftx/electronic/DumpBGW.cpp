@@ -52,7 +52,7 @@ void Dump::dumpBGW()
 	
 	//Open file:
 	hid_t plid = H5Pcreate(H5P_FILE_ACCESS);
-    H5Pset_fapl_mpio(plid, MPI_COMM_WORLD, MPI_INFO_NULL);
+    H5Pset_fapl_mpio(plid, mpiUtil->communicator(), MPI_INFO_NULL);
 	hid_t fid = H5Fcreate(fname.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, plid);
 	if(fid<0) die("Could not open/create output HDF5 file '%s'\n", fname.c_str());
 	H5Pclose(plid);
@@ -146,13 +146,24 @@ public:
 		vector3<int> S_old; //!< fftbox size for the input wavefunction in double space
 		ColumnBundleReadConversion();
 	};
-	void read(std::vector<class ColumnBundle>&, const char *fname, const ColumnBundleReadConversion* conversion=0) const; //!< Read array of columnbundles, optionally with conversion
-	void write(const std::vector<class ColumnBundle>&, const char *fname) const; //!< write an array of columnbundles to file
+	int read(std::vector<class ColumnBundle>&, const char *fname, const ColumnBundleReadConversion* conversion=0) const; //!< Read array of columnbundles, optionally with conversion (detects chunked format automatically); returns number of bands read (upper bands, if any, are left uninitialized)
+	void write(const std::vector<class ColumnBundle>&, const char *fname, class CheckpointWriter* writer=0) const; //!< write an array of columnbundles to file (or snapshot to writer, if provided)
+	
+	//! Write an array of columnbundles in the self-describing chunked format (see readChunked),
+	//! optionally converting the coefficients to single precision (or snapshot to writer, if provided)
+	void writeChunked(const std::vector<class ColumnBundle>&, const char *fname, bool singlePrecision=false, class CheckpointWriter* writer=0) const;
+	static bool isChunkedFile(const char* fname); //!< check whether a wavefunction file is in the chunked format
 
 private:
 	const Everything* e;
 	TaskDivision qDivision; //!< MPI division of k-points
 	
+	//! Read an array of columnbundles from the chunked format, which stores a header, an index of per-state offsets,
+	//! and the G-vectors and coefficients of each state. Each process reads only the header and its own states,
+	//! and the stored G-vectors are used to convert to the current basis, so no conversion parameters are needed.
+	//! Returns the number of bands read (minimum over states and processes), if fewer than nBands are stored.
+	int readChunked(std::vector<class ColumnBundle>&, const char *fname) const;
+	
 	//Initial fillings:
 	int nBandsOld; //!<number of bands in file being read
 	double Qinitial, Minitial; //!< net excess electrons and initial magnetization
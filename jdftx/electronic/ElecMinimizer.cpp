@@ -20,6 +20,8 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <electronic/ElecMinimizer.h>
 #include <electronic/BandMinimizer.h>
 #include <electronic/BandDavidson.h>
+#include <electronic/BandLOBPCG.h>
+#include <electronic/BandRMMDIIS.h>
 #include <electronic/ColumnBundle.h>
 #include <electronic/Everything.h>
 #include <electronic/Dump.h>
@@ -270,15 +272,17 @@ double ElecMinimizer::sync(double x) const
 	return x;
 }
 
-void bandMinimize(Everything& e)
+void bandMinimize(Everything& e, int nRMMDIISsteps)
 {	bool fixed_H = true; std::swap(fixed_H, e.cntrl.fixed_H); //remember fixed_H flag and temporarily set it to true
 	logPrintf("Minimization will be done independently for each quantum number.\n");
 	e.ener.Eband = 0.;
 	for(int q=e.eInfo.qStart; q<e.eInfo.qStop; q++)
 	{	logPrintf("\n---- Minimization of quantum number: "); e.eInfo.kpointPrint(globalLog, q, true); logPrintf(" ----\n");
-		switch(e.cntrl.elecEigenAlgo)
+		if(nRMMDIISsteps) BandRMMDIIS(e, q).minimize(nRMMDIISsteps);
+		else switch(e.cntrl.elecEigenAlgo)
 		{	case ElecEigenCG: { BandMinimizer(e, q).minimize(e.elecMinParams); break; }
 			case ElecEigenDavidson: { BandDavidson(e, q).minimize(); break; }
+			case ElecEigenLOBPCG: { BandLOBPCG(e, q).minimize(); break; }
 		}
 		e.ener.Eband += e.eInfo.qnums[q].weight * trace(e.eVars.Hsub_eigs[q]);
 	}
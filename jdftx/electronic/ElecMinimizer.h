@@ -74,7 +74,7 @@ private:
 	std::shared_ptr<struct SubspaceRotationAdjust> sra; //!< Subspace rotation adjustment helper
 };
 
-void bandMinimize(Everything& e); //!< band structure minimization
+void bandMinimize(Everything& e, int nRMMDIISsteps=0); //!< band structure minimization (or band refinement with nRMMDIISsteps of RMM-DIIS per band, if non-zero)
 void elecMinimize(Everything& e); //!< minimize electonic system
 void elecFluidMinimize(Everything& e); //!< minimize electrons and fluid in a gummel loop if necessary
 void convergeEmptyStates(Everything& e); //!< run bandMinimize to converge empty states (usually called from SCF / total energy calculations)
@@ -194,8 +194,7 @@ void ElecVars::setup(const Everything &everything)
 		if(wfnsFilename.length())
 		{	logPrintf("reading from '%s'\n", wfnsFilename.c_str()); logFlush();
 			if(readConversion) readConversion->Ecut = e->cntrl.Ecut;
-			eInfo.read(C, wfnsFilename.c_str(), readConversion.get());
-			nBandsInited = (readConversion && readConversion->nBandsOld) ? readConversion->nBandsOld : eInfo.nBands;
+			nBandsInited = eInfo.read(C, wfnsFilename.c_str(), readConversion.get());
 			isRandom = (nBandsInited<eInfo.nBands);
 		}
 		else if(initLCAO)
@@ -226,7 +225,8 @@ void ElecVars::setup(const Everything &everything)
 		
 		//Orthogonalize initial wavefunctions:
 		for(int q=eInfo.qStart; q<eInfo.qStop; q++)
-		{	C[q] = C[q] * invsqrt(C[q]^O(C[q]));
+		{	makeReal(C[q], true); //in real-wavefunction mode, wavefunctions read in may be real only upto a phase
+			C[q] = C[q] * invsqrt(realInner(C[q], O(C[q])));
 			iInfo.project(C[q], VdagC[q]);
 		}
 	}
@@ -400,7 +400,13 @@ double ElecVars::elecEnergyAndGrad(Energies& ener, ElecGradient* grad, ElecGradi
 	{	double aXX = e->exCorr.exxFactor();
 		double omega = e->exCorr.exxRange();
 		assert(e->exx);
-		ener.E["EXX"] = (*e->exx)(aXX, omega, F, C, need_Hsub ? &HC : 0);
+		//In SCF, the inner band minimization uses the ACE operator, rebuilt here whenever the density changes:
+		bool updateACE = e->cntrl.scf && !e->cntrl.fixed_H;
+		ener.E["EXX"] = (*e->exx)(aXX, omega, F, C, (need_Hsub || updateACE) ? &HC : 0);
+		if(updateACE)
+		{	e->exx->setACE(C, HC);
+			if(!need_Hsub) HC.assign(eInfo.nStates, ColumnBundle()); //exchange gradient no longer needed
+		}
 	}
 	
 	//Do the single-particle contributions one state at a time to save memory (and for better cache warmth):
@@ -496,7 +502,9 @@ void fixPhase(matrix& evecs, const diagMatrix& eigs, const ColumnBundle& C)
 		{	degFound = true;
 			matrix CheadSub = Chead(0,Chead.nRows(), bStart,bStop);
 			matrix degEvecs; diagMatrix degEigs;
-			(dagger(CheadSub) * headH * CheadSub).diagonalize(degEvecs, degEigs);
+			matrix degH = dagger(CheadSub) * headH * CheadSub;
+			if(C.basis->realWfns) degH = 0.5*(degH + conj(degH)); //restrict to real rotations in real-wavefunction mode
+			degH.diagonalize(degEvecs, degEigs);
 			degFix.set(bStart,bStop, bStart,bStop, degEvecs);
 		}
 		bStart = bStop;
@@ -514,6 +522,8 @@ void fixPhase(matrix& evecs, const diagMatrix& eigs, const ColumnBundle& C)
 		{	const complex c = Chead(n,b);
 			if(c.norm() > normPrev)
 			{	phase = c.conj()/c.abs();
+				if(C.basis->realWfns) //only signs allowed in real-wavefunction mode:
+					phase = (fabs(c.real()) > fabs(c.imag()) ? c.real() : c.imag()) < 0. ? -1. : 1.;
 				normPrev = c.norm();
 			}
 		}
@@ -581,7 +591,8 @@ ScalarFieldArray ElecVars::calcDensity() const
 void ElecVars::orthonormalize(int q, matrix* extraRotation)
 {	assert(e->eInfo.isMine(q));
 	VdagC[q].clear();
-	matrix rot = invsqrt(C[q]^O(C[q], &VdagC[q])); //Compute U:
+	makeReal(C[q]); //remove any roundoff drift in real-wavefunction mode
+	matrix rot = invsqrt(realInner(C[q], O(C[q], &VdagC[q]))); //Compute U:
 	if(extraRotation) *extraRotation = (rot = rot * (*extraRotation)); //set rot and extraRotation to the net transformation
 	C[q] = C[q] * rot;
 	e->iInfo.project(C[q], VdagC[q], &rot); //update the atomic projections
@@ -602,6 +613,8 @@ double ElecVars::applyHamiltonian(int q, const diagMatrix& Fq, ColumnBundle& HCq
 		}
 		if(e->eInfo.hasU) //Contribution via atomic density matrix projections (DFT+U)
 			e->iInfo.rhoAtom_grad(C[q], U_rhoAtom, HCq);
+		if(e->cntrl.fixed_H && e->exCorr.exxFactor() && e->exx->hasACE(q)) //Exact exchange via the compressed operator (SCF inner loop)
+			ener.E["EXX"] += qnum.weight * e->exx->applyACE(q, Fq, C[q], HCq);
 	}
 
 	//Kinetic energy:
@@ -618,7 +631,7 @@ double ElecVars::applyHamiltonian(int q, const diagMatrix& Fq, ColumnBundle& HCq
 	
 	//Compute subspace hamiltonian if needed:
 	if(need_Hsub)
-	{	Hsub[q] = C[q] ^ HCq;
+	{	Hsub[q] = realInner(C[q], HCq);
 		Hsub[q].diagonalize(Hsub_evecs[q], Hsub_eigs[q]);
 	}
 	return KEq;
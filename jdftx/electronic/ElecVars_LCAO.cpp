@@ -186,6 +186,7 @@ int ElecVars::LCAO()
 	lcao.nBands = std::max(nAtomic+1, std::max(eInfo.nBands, int(ceil(1+eInfo.nElectrons/eInfo.qWeightSum))));
 	for(int q=eInfo.qStart; q<eInfo.qStop; q++)
 	{	C[q] = iInfo.getAtomicOrbitals(q, false, lcao.nBands-nAtomic);
+		makeReal(C[q], true); //atomic orbitals are real upto a phase at the Gamma point
 		if(nAtomic<lcao.nBands) C[q].randomize(nAtomic, lcao.nBands); //Randomize extra columns if any
 		orthonormalize(q);
 		//Non-interacting Hamiltonian:
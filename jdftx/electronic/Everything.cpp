@@ -50,6 +50,10 @@ void Everything::setup()
 			gInfoWfns = 0;
 		}
 	}
+	if(cntrl.fftPlanWarmup)
+	{	gInfo.warmupPlans();
+		if(gInfoWfns) gInfoWfns->warmupPlans();
+	}
 
 	//Exchange correlation setup
 	logPrintf("\n---------- Exchange Correlation functional ----------\n");
@@ -75,6 +79,19 @@ void Everything::setup()
 	logPrintf("\n----- Setting up reduced wavefunction bases (%s) -----\n",
 		(cntrl.basisKdep==BasisKpointIndep) ? "single at Gamma point" :  "one per k-point");
 	basis.resize(eInfo.nStates);
+	if(cntrl.realWfns)
+	{	//Check that the Hamiltonian and wavefunctions can be chosen real:
+		for(const QuantumNumber& qnum: eInfo.qnums)
+			if(qnum.k.length_squared())
+				die("real-wavefunctions requires Gamma-point-only k-point sampling.\n");
+		if(eInfo.isNoncollinear())
+			die("real-wavefunctions is not supported with noncollinear magnetism or spin-orbit coupling.\n");
+		if(!eInfo.scalarFillings)
+			die("real-wavefunctions is not supported with non-scalar fillings (which require complex subspace rotations).\n");
+		logPrintf("Constraining wavefunctions to be real in real space.\n");
+	}
+	if(cntrl.realSpaceProjectors && isGpuEnabled())
+		die("real-space-projectors is only supported for CPU runs.\n");
 	double avg_nbasis = 0.;
 	const GridInfo& gInfoBasis = gInfoWfns ? *gInfoWfns : gInfo;
 	if(!cntrl.shouldPrintKpointsBasis) logSuspend();
@@ -85,6 +102,8 @@ void Everything::setup()
 		{	if(q==0) basis[q].setup(gInfoBasis, iInfo, cntrl.Ecut, vector3<>(0,0,0));
 			else basis[q] = basis[0];
 		}
+		if(cntrl.realWfns && (q==0 || cntrl.basisKdep==BasisKpointDep))
+			basis[q].setRealWfns();
 		avg_nbasis += eInfo.qnums[q].weight * basis[q].nbasis;
 	}
 	avg_nbasis /= eInfo.qWeightSum;
@@ -92,6 +111,14 @@ void Everything::setup()
 	logPrintf("average nbasis = %7.3lf , ideal nbasis = %7.3lf\n", avg_nbasis,
 		pow(sqrt(2*cntrl.Ecut),3)*(gInfo.detR/(6*M_PI*M_PI)));
 	logFlush();
+	
+	//Real-space projectors:
+	if(cntrl.realSpaceProjectors)
+	{	logPrintf("\n---------- Setting up real-space projectors ----------\n");
+		setupRealSpaceProjectors();
+		logPrintf("NOTE: forces and stresses use the reciprocal-space projectors, and are consistent\n"
+			"with the energy only to within the real-space projector tolerance.\n");
+	}
 
 	//Check if DOS calculator is needed:
 	if(!dump.dos)
@@ -154,6 +181,14 @@ void Everything::setup()
 	ionicMinParams.linePrefix = "IonicMinimize: ";
 	ionicMinParams.energyLabel = relevantFreeEnergyName(*this);
 	ionicMinParams.energyFormat = "%+.15lf";
+	if(ionicMinParams.nIterations > 0)
+	{	if(ionicMinParams.dirUpdateScheme == MinimizeParams::FIRE)
+			Citations::add("FIRE ionic optimization",
+				"E. Bitzek, P. Koskinen, F. Gahler, M. Moseler and P. Gumbsch, Phys. Rev. Lett. 97, 170201 (2006)");
+		if(ionicMinParams.preconditioner == MinimizeParams::PreconditionerExp)
+			Citations::add("Exp preconditioner for ionic optimization",
+				"D. Packwood, J. Kermode, L. Mones, N. Bernstein, J. Woolley, N. Gould, C. Ortner and G. Csanyi, J. Chem. Phys. 144, 164109 (2016)");
+	}
 	
 	//Setup fluid minimization parameters:
 	switch(eVars.fluidParams.fluidType)
@@ -204,3 +239,18 @@ void Everything::updateSupercell(bool force)
 	}
 }
 
+
+void Everything::setupRealSpaceProjectors()
+{	if(!cntrl.realSpaceProjectors) return;
+	//Filter beyond the largest |k+G| in the wavefunction bases (which changes with the lattice vectors):
+	double Gw = 0.;
+	for(int q=eInfo.qStart; q<eInfo.qStop; q++)
+	{	const vector3<int>* iGarr = basis[q].iGarr.data();
+		for(size_t n=0; n<basis[q].nbasis; n++)
+			Gw = std::max(Gw, ((eInfo.qnums[q].k + iGarr[n]) * gInfo.G).length());
+	}
+	mpiUtil->allReduce(Gw, MPIUtil::ReduceMax);
+	const GridInfo& gInfoBasis = gInfoWfns ? *gInfoWfns : gInfo;
+	for(auto sp: iInfo.species)
+		sp->setupRealSpaceProjectors(gInfoBasis, Gw);
+}
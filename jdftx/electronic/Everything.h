@@ -76,6 +76,7 @@ public:
 	//! Call the setup/initialize routines of all the above in the necessray order
 	void setup();
 	void updateSupercell(bool force=false); //!< (re-)initialize coulombParams.supercell if necessary (or if forced)
+	void setupRealSpaceProjectors(); //!< (re-)create the real-space projectors of all species for the current lattice (if cntrl.realSpaceProjectors, after basis setup)
 };
 
 //! @}
@@ -95,6 +95,41 @@ void FunctionalLDA::evaluate(int N, std::vector<const double*> n, std::vector<co
 	callPref(LDA)(variant, N, n, E, E_n, scaleFac);
 }
 
+template<LDA_Variant variantX, LDA_Variant variantC, int nCount> void LDA_fused_supported(bool& supported) { supported = true; }
+std::shared_ptr<Functional> FunctionalLDAfused::create(const FunctionalLDA& X, const FunctionalLDA& C)
+{	bool supported = false;
+	SwitchTemplate_LDAfused(X.variant, C.variant, 1, LDA_fused_supported, (supported))
+	if(!supported) return 0;
+	return std::make_shared<FunctionalLDAfused>(X.variant, C.variant, X.scaleFac, C.scaleFac);
+}
+
+FunctionalLDAfused::FunctionalLDAfused(LDA_Variant variantX, LDA_Variant variantC, double scaleX, double scaleC)
+: variantX(variantX), variantC(variantC), scaleX(scaleX), scaleC(scaleC)
+{	logPrintf("Fused LDA exchange and correlation into a single pass.\n");
+}
+
+template<LDA_Variant variantX, LDA_Variant variantC, int nCount>
+void LDA_fused_sub(size_t iStart, size_t iStop, array<const double*,nCount> n, double* E, array<double*,nCount> E_n, double scaleX, double scaleC)
+{	for(size_t i=iStart; i<iStop; i++)
+		LDA_fused_calc<variantX,variantC,nCount>::compute(i, n, E, E_n, scaleX, scaleC);
+}
+template<LDA_Variant variantX, LDA_Variant variantC, int nCount>
+void LDA_fused(int N, array<const double*,nCount> n, double* E, array<double*,nCount> E_n, double scaleX, double scaleC)
+{	threadLaunch(LDA_fused_sub<variantX,variantC,nCount>, N, n, E, E_n, scaleX, scaleC);
+}
+
+void FunctionalLDAfused::evaluate(int N, std::vector<const double*> n, std::vector<const double*> sigma,
+	std::vector<const double*> lap, std::vector<const double*> tau,
+	double* E, std::vector<double*> E_n, std::vector<double*> E_sigma,
+	std::vector<double*> E_lap, std::vector<double*> E_tau) const
+{	assert(!isGpuEnabled());
+	switch(n.size())
+	{	case 1: { SwitchTemplate_LDAfused(variantX, variantC, 1, LDA_fused, (N, n, E, E_n, scaleX, scaleC)) break; }
+		case 2: { SwitchTemplate_LDAfused(variantX, variantC, 2, LDA_fused, (N, n, E, E_n, scaleX, scaleC)) break; }
+		default: assert(!"Invalid spin count");
+	}
+}
+
 //---------------- GGA thread launcher / gpu switch --------------------
 
 FunctionalGGA::FunctionalGGA(GGA_Variant variant, double scaleFac) : Functional(scaleFac), variant(variant)
@@ -137,6 +172,44 @@ void FunctionalGGA::evaluate(int N, std::vector<const double*> n, std::vector<co
 }
 
 
+template<GGA_Variant variantX, GGA_Variant variantC, int nCount> void GGA_fused_supported(bool& supported) { supported = true; }
+std::shared_ptr<Functional> FunctionalGGAfused::create(const FunctionalGGA& X, const FunctionalGGA& C)
+{	bool supported = false;
+	SwitchTemplate_GGAfused(X.variant, C.variant, 1, GGA_fused_supported, (supported))
+	if(!supported) return 0;
+	return std::make_shared<FunctionalGGAfused>(X.variant, C.variant, X.scaleFac, C.scaleFac);
+}
+
+FunctionalGGAfused::FunctionalGGAfused(GGA_Variant variantX, GGA_Variant variantC, double scaleX, double scaleC)
+: variantX(variantX), variantC(variantC), scaleX(scaleX), scaleC(scaleC)
+{	logPrintf("Fused GGA exchange and correlation into a single pass.\n");
+}
+
+template<GGA_Variant variantX, GGA_Variant variantC, int nCount>
+void GGA_fused_sub(size_t iStart, size_t iStop, array<const double*,nCount> n, array<const double*,2*nCount-1> sigma,
+	double* E, array<double*,nCount> E_n, array<double*,2*nCount-1> E_sigma, double scaleX, double scaleC)
+{	for(size_t i=iStart; i<iStop; i++)
+		GGA_fused_calc<variantX,variantC,nCount>::compute(i, n, sigma, E, E_n, E_sigma, scaleX, scaleC);
+}
+template<GGA_Variant variantX, GGA_Variant variantC, int nCount>
+void GGA_fused(int N, array<const double*,nCount> n, array<const double*,2*nCount-1> sigma,
+	double* E, array<double*,nCount> E_n, array<double*,2*nCount-1> E_sigma, double scaleX, double scaleC)
+{	threadLaunch(GGA_fused_sub<variantX,variantC,nCount>, N, n, sigma, E, E_n, E_sigma, scaleX, scaleC);
+}
+
+void FunctionalGGAfused::evaluate(int N, std::vector<const double*> n, std::vector<const double*> sigma,
+	std::vector<const double*> lap, std::vector<const double*> tau,
+	double* E, std::vector<double*> E_n, std::vector<double*> E_sigma,
+	std::vector<double*> E_lap, std::vector<double*> E_tau) const
+{	assert(!isGpuEnabled());
+	switch(n.size())
+	{	case 1: { SwitchTemplate_GGAfused(variantX, variantC, 1, GGA_fused, (N, n, sigma, E, E_n, E_sigma, scaleX, scaleC)) break; }
+		case 2: { SwitchTemplate_GGAfused(variantX, variantC, 2, GGA_fused, (N, n, sigma, E, E_n, E_sigma, scaleX, scaleC)) break; }
+		default: assert(!"Invalid spin count");
+	}
+}
+
+
 //---------------- metaGGA thread launcher / gpu switch --------------------
 
 FunctionalMGGA::FunctionalMGGA(mGGA_Variant variant, double scaleFac) : Functional(scaleFac), variant(variant)
@@ -322,6 +395,44 @@ struct FunctionalList
 	{	internal.push_back(std::make_shared<FunctionalMGGA>(variant, scaleFac));
 	}
 	
+	std::shared_ptr<Functional> fused; //!< single-pass evaluator for the internal exchange-correlation pair (CPU only)
+	std::shared_ptr<Functional> fusedX, fusedC; //!< members of internal replaced by fused
+	
+	//! Set fused if internal contains exactly one pure exchange and one pure correlation functional (ignoring kinetic ones)
+	//! forming a pair supported by FunctionalLDAfused or FunctionalGGAfused
+	void fuse()
+	{	if(isGpuEnabled()) return;
+		std::vector<std::shared_ptr<Functional> > X, C;
+		for(auto func: internal)
+		{	if(func->hasKinetic()) continue;
+			if(func->hasExchange() && !func->hasCorrelation()) X.push_back(func);
+			else if(func->hasCorrelation() && !func->hasExchange()) C.push_back(func);
+			else return; //combined exchange-correlation functional
+		}
+		if(X.size()!=1 || C.size()!=1) return;
+		auto ldaX = std::dynamic_pointer_cast<FunctionalLDA>(X[0]);
+		auto ldaC = std::dynamic_pointer_cast<FunctionalLDA>(C[0]);
+		if(ldaX && ldaC) fused = FunctionalLDAfused::create(*ldaX, *ldaC);
+		auto ggaX = std::dynamic_pointer_cast<FunctionalGGA>(X[0]);
+		auto ggaC = std::dynamic_pointer_cast<FunctionalGGA>(C[0]);
+		if(ggaX && ggaC) fused = FunctionalGGAfused::create(*ggaX, *ggaC);
+		if(fused)
+		{	fusedX = X[0];
+			fusedC = C[0];
+		}
+	}
+	
+	//! Internal functionals selected by include(func), with fusedX and fusedC replaced by fused if both are selected
+	template<typename Include> std::vector<std::shared_ptr<Functional> > getInternal(const Include& include) const
+	{	bool useFused = fused && include(fusedX) && include(fusedC);
+		std::vector<std::shared_ptr<Functional> > result;
+		if(useFused) result.push_back(fused);
+		for(auto func: internal)
+			if(include(func) && !(useFused && (func==fusedX || func==fusedC)))
+				result.push_back(func);
+		return result;
+	}
+	
 	#ifdef LIBXC_ENABLED
 	std::vector<std::shared_ptr<FunctionalLibXC> > libXC; //!<Functionals which use LibXC for evaluation
 	void add(int xcCode, const char* name)
@@ -505,6 +616,8 @@ void ExCorr::setup(const Everything& everything)
 			break;
 		#endif //LIBXC_ENABLED
 	}
+	
+	functionals->fuse();
 }
 
 
@@ -579,7 +692,7 @@ template<typename Func> bool shouldInclude(const std::shared_ptr<Func>& function
 }
 
 double ExCorr::operator()(const ScalarFieldArray& n, ScalarFieldArray* Vxc, IncludeTXC includeTXC,
-		const ScalarFieldArray* tauPtr, ScalarFieldArray* Vtau) const
+		const ScalarFieldArray* tauPtr, ScalarFieldArray* Vtau, matrix3<>* Exc_RRT) const
 {
 	static StopWatch watch("ExCorrTotal"), watchComm("ExCorrCommunication"), watchFunc("ExCorrFunctional");
 	watch.start();
@@ -594,6 +707,13 @@ double ExCorr::operator()(const ScalarFieldArray& n, ScalarFieldArray* Vxc, Incl
 	//Energy density per volume:
 	ScalarField E; nullToZero(E, gInfo);
 	
+	//Lattice derivative requires the potential (compute internally if not requested):
+	ScalarFieldArray VxcInternal;
+	if(Exc_RRT)
+	{	assert(nCount == nInCount); //not supported for noncollinear magnetism
+		if(!Vxc) Vxc = &VxcInternal;
+	}
+	
 	//Gradient w.r.t spin densities:
 	ScalarFieldArray E_n(nCount);
 	if(Vxc)
@@ -628,6 +748,10 @@ double ExCorr::operator()(const ScalarFieldArray& n, ScalarFieldArray* Vxc, Incl
 		{	const ScalarFieldTilde Jn = J(n[s]);
 			for(int i=iDirStart; i<iDirStop; i++)
 				Dn[s][i] = I(D(Jn,i));
+			if(Exc_RRT) //lattice derivative needs all directions on each process
+				for(int i=0; i<3; i++)
+					if(i<iDirStart || i>=iDirStop)
+						Dn[s][i] = I(D(Jn,i));
 		}
 	}
 	
@@ -765,11 +889,10 @@ double ExCorr::operator()(const ScalarFieldArray& n, ScalarFieldArray* Vxc, Incl
 	
 	//---------------- Compute internal functionals ----------------
 	watchFunc.start();
-	for(auto func: functionals->internal)
-		if(shouldInclude(func, includeTXC))
-			func->evaluateSub(gInfo.irStart, gInfo.irStop,
-				constDataPref(nCapped), constDataPref(sigma), constDataPref(lap), constDataPref(tau),
-				E->dataPref(), dataPref(E_n), dataPref(E_sigma), dataPref(E_lap), dataPref(E_tau));
+	for(auto func: functionals->getInternal([&](const std::shared_ptr<Functional>& f) { return shouldInclude(f, includeTXC); }))
+		func->evaluateSub(gInfo.irStart, gInfo.irStop,
+			constDataPref(nCapped), constDataPref(sigma), constDataPref(lap), constDataPref(tau),
+			E->dataPref(), dataPref(E_n), dataPref(E_sigma), dataPref(E_lap), dataPref(E_tau));
 	watchFunc.stop();
 	
 	//Cleanup unneeded derived quantities (free memory before starting communications and gradient propagation)
@@ -855,6 +978,26 @@ double ExCorr::operator()(const ScalarFieldArray& n, ScalarFieldArray* Vxc, Incl
 		}
 	}
 	
+	//--------------- Lattice derivative ---------------------
+	if(Exc_RRT)
+	{	assert(!needsLap && !needsTau); //not supported for meta-GGAs
+		//Volume and density scaling (E_n includes the gradient contributions at this point):
+		double diagTerm = Exc;
+		for(int s=0; s<nCount; s++)
+			diagTerm -= integral(n[s] * E_n[s]);
+		*Exc_RRT = matrix3<>(diagTerm, diagTerm, diagTerm);
+		//Change in direction of gradients:
+		if(needsSigma)
+			for(int s1=0; s1<nCount; s1++)
+				for(int s2=s1; s2<nCount; s2++)
+					for(int i=0; i<3; i++)
+						for(int j=0; j<=i; j++)
+						{	double term = -integral(E_sigma[s1+s2] * (Dn[s1][i] * Dn[s2][j] + Dn[s2][i] * Dn[s1][j]));
+							(*Exc_RRT)(i,j) += term;
+							if(i != j) (*Exc_RRT)(j,i) += term;
+						}
+	}
+	
 	if(Vxc) *Vxc = E_n;
 	if(Vtau) *Vtau = E_tau;
 	watch.stop();
@@ -863,11 +1006,11 @@ double ExCorr::operator()(const ScalarFieldArray& n, ScalarFieldArray* Vxc, Incl
 
 //Unpolarized wrapper to above function:
 double ExCorr::operator()(const ScalarField& n, ScalarField* Vxc, IncludeTXC includeTXC,
-		const ScalarField* tau, ScalarField* Vtau) const
+		const ScalarField* tau, ScalarField* Vtau, matrix3<>* Exc_RRT) const
 {	ScalarFieldArray VxcArr(1), tauArr(1), VtauArr(1);
 	if(tau) tauArr[0] = *tau;
 	double Exc =  (*this)(ScalarFieldArray(1, n), Vxc ? &VxcArr : 0, includeTXC,
-		tau ? &tauArr :0, Vtau ? &VtauArr : 0);
+		tau ? &tauArr :0, Vtau ? &VtauArr : 0, Exc_RRT);
 	if(Vxc) *Vxc = VxcArr[0];
 	if(Vtau) *Vtau = VtauArr[0];
 	return Exc;
@@ -952,10 +1095,9 @@ void ExCorr::getSecondDerivatives(const ScalarField& n, ScalarField& e_nn, Scala
 					eData, e_nData[0], e_sigmaData[0], e_lapData[0], e_tauData[0]);
 		#endif
 		//Compute internal functionals:
-		for(auto func: functionals->internal)
-			if(!func->hasKinetic())
-				func->evaluate(gInfo.nr, nData, sigmaData, lapData, tauData,
-					eData, e_nData, e_sigmaData, e_lapData, e_tauData);
+		for(auto func: functionals->getInternal([](const std::shared_ptr<Functional>& f) { return !f->hasKinetic(); }))
+			func->evaluate(gInfo.nr, nData, sigmaData, lapData, tauData,
+				eData, e_nData, e_sigmaData, e_lapData, e_tauData);
 	}
 	
 	//Compute finite difference derivatives:
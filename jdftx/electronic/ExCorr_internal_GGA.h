@@ -100,6 +100,33 @@ public:
 
 private:
 	GGA_Variant variant;
+	friend class FunctionalGGAfused;
+};
+
+//! Exchange and correlation GGA pair evaluated together in a single pass over the grid (CPU only)
+class FunctionalGGAfused : public Functional
+{
+public:
+	//! Return a fused evaluator for exchange X and correlation C, or null if this pair is not supported
+	static std::shared_ptr<Functional> create(const FunctionalGGA& X, const FunctionalGGA& C);
+	FunctionalGGAfused(GGA_Variant variantX, GGA_Variant variantC, double scaleX, double scaleC);
+	bool needsSigma() const { return true; }
+	bool needsLap() const { return false; }
+	bool needsTau() const { return false; }
+	bool hasExchange() const { return true; }
+	bool hasCorrelation() const { return true; }
+	bool hasKinetic() const { return false; }
+	bool hasEnergy() const { return true; }
+	
+	//! Evaluate both functionals in one threaded loop that inlines their GGA_calc's (see GGA_fused_calc)
+	void evaluate(int N, std::vector<const double*> n, std::vector<const double*> sigma,
+		std::vector<const double*> lap, std::vector<const double*> tau,
+		double* E, std::vector<double*> E_n, std::vector<double*> E_sigma,
+		std::vector<double*> E_lap, std::vector<double*> E_tau) const;
+
+private:
+	GGA_Variant variantX, variantC;
+	double scaleX, scaleC;
 };
 
 //! Switch a function fTemplate templated over GGA variant, spin scaling behavior and spin count,
@@ -654,5 +681,28 @@ template<> __hostanddev__ double GGA_eval<GGA_KE_PW91>(double rs, double s2, dou
 	return eTF * F;
 }
 
+//! Switch a function fTemplate templated over the (exchange, correlation) variant pair and spin count,
+//! over all pairs supported by FunctionalGGAfused (used by its thread launcher)
+#define SwitchTemplate_GGAfused(variantX,variantC,nCount, fTemplate,argList) \
+	switch(variantX) \
+	{	case GGA_X_PBE:    if(variantC==GGA_C_PBE)    fTemplate< GGA_X_PBE,    GGA_C_PBE,    nCount> argList; break; \
+		case GGA_X_PBEsol: if(variantC==GGA_C_PBEsol) fTemplate< GGA_X_PBEsol, GGA_C_PBEsol, nCount> argList; break; \
+		case GGA_X_PW91:   if(variantC==GGA_C_PW91)   fTemplate< GGA_X_PW91,   GGA_C_PW91,   nCount> argList; break; \
+		default: break; \
+	}
+
+//! Evaluate an exchange and correlation GGA pair at one grid point, sharing the low-density check.
+//! The point is skipped only if every spin density is below the cutoff that either functional would apply.
+template<GGA_Variant variantX, GGA_Variant variantC, int nCount> struct GGA_fused_calc
+{	static void compute(int i, array<const double*,nCount> n, array<const double*,2*nCount-1> sigma,
+		double* E, array<double*,nCount> E_n, array<double*,2*nCount-1> E_sigma, double scaleX, double scaleC)
+	{	bool skip = true;
+		for(int s=0; s<nCount; s++) skip &= (n[s][i]*nCount < nCutoff);
+		if(skip) return;
+		GGA_calc<variantX,true,nCount>::compute(i, n, sigma, E, E_n, E_sigma, scaleX);
+		GGA_calc<variantC,false,nCount>::compute(i, n, sigma, E, E_n, E_sigma, scaleC);
+	}
+};
+
 //! @}
 #endif // JDFTX_ELECTRONIC_EXCORR_INTERNAL_GGA_H
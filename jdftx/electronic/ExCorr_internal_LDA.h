@@ -21,6 +21,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #define JDFTX_ELECTRONIC_EXCORR_INTERNAL_LDA_H
 
 #include <electronic/ExCorr_internal.h>
+#include <memory>
 
 //! @addtogroup ExchangeCorrelation
 //! @{
@@ -86,6 +87,33 @@ public:
 
 private:
 	LDA_Variant variant;
+	friend class FunctionalLDAfused;
+};
+
+//! Exchange and correlation LDA pair evaluated together in a single pass over the grid (CPU only)
+class FunctionalLDAfused : public Functional
+{
+public:
+	//! Return a fused evaluator for exchange X and correlation C, or null if this pair is not supported
+	static std::shared_ptr<Functional> create(const FunctionalLDA& X, const FunctionalLDA& C);
+	FunctionalLDAfused(LDA_Variant variantX, LDA_Variant variantC, double scaleX, double scaleC);
+	bool needsSigma() const { return false; }
+	bool needsLap() const { return false; }
+	bool needsTau() const { return false; }
+	bool hasExchange() const { return true; }
+	bool hasCorrelation() const { return true; }
+	bool hasKinetic() const { return false; }
+	bool hasEnergy() const { return true; }
+	
+	//! Evaluate both functionals in one threaded loop that inlines their LDA_calc's (see LDA_fused_calc)
+	void evaluate(int N, std::vector<const double*> n, std::vector<const double*> sigma,
+		std::vector<const double*> lap, std::vector<const double*> tau,
+		double* E, std::vector<double*> E_n, std::vector<double*> E_sigma,
+		std::vector<double*> E_lap, std::vector<double*> E_tau) const;
+
+private:
+	LDA_Variant variantX, variantC;
+	double scaleX, scaleC;
 };
 
 //! Switch a function fTemplate templated over LDA variant and spin count,
@@ -305,5 +333,29 @@ double LDA_eval<LDA_XC_Teter>(double rs, double zeta, double& e_rs, double& e_ze
 	return -num/den;
 };
 
+//! Switch a function fTemplate templated over the (exchange, correlation) variant pair and spin count,
+//! over all pairs supported by FunctionalLDAfused (used by its thread launcher)
+#define SwitchTemplate_LDAfused(variantX,variantC,nCount, fTemplate,argList) \
+	if(variantX == LDA_X_Slater) \
+		switch(variantC) \
+		{	case LDA_C_PZ:      fTemplate< LDA_X_Slater, LDA_C_PZ,      nCount> argList; break; \
+			case LDA_C_PW:      fTemplate< LDA_X_Slater, LDA_C_PW,      nCount> argList; break; \
+			case LDA_C_PW_prec: fTemplate< LDA_X_Slater, LDA_C_PW_prec, nCount> argList; break; \
+			case LDA_C_VWN:     fTemplate< LDA_X_Slater, LDA_C_VWN,     nCount> argList; break; \
+			default: break; \
+		}
+
+//! Evaluate an exchange and correlation LDA pair at one grid point, sharing the low-density check.
+//! The point is skipped only if every spin density is below the cutoff that either functional would apply.
+template<LDA_Variant variantX, LDA_Variant variantC, int nCount> struct LDA_fused_calc
+{	static void compute(int i, array<const double*,nCount> n, double* E, array<double*,nCount> E_n, double scaleX, double scaleC)
+	{	bool skip = true;
+		for(int s=0; s<nCount; s++) skip &= (n[s][i]*nCount < nCutoff);
+		if(skip) return;
+		LDA_calc<variantX,nCount>::compute(i, n, E, E_n, scaleX);
+		LDA_calc<variantC,nCount>::compute(i, n, E, E_n, scaleC);
+	}
+};
+
 //! @}
 #endif // JDFTX_ELECTRONIC_EXCORR_INTERNAL_LDA_H
@@ -25,7 +25,85 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <core/GpuUtil.h>
 #include <core/Operators.h>
 #include <core/LatticeUtils.h>
+#include <core/Thread.h>
 #include <list>
+#include <atomic>
+
+//! Band-pair loop for one pair of k-points (in blocks of bands cached in real space), shared between threads
+struct ExactExchangePairs
+{	const int nSpinor;
+	const double prefac, omega; //!< overall energy prefactor and screening range
+	const bool needGrad; //!< whether to accumulate gradients
+	const Coulomb* coulomb;
+	vector3<> dk; //!< k-point difference (q - k)
+	double wk, wq; //!< state weights
+	const diagMatrix *Fk, *Fq; //!< fillings
+	std::vector<int> bkList, bqList; //!< band indices in current blocks
+	std::vector<complexScalarField> Ipsik, Ipsiq; //!< real-space orbitals of current blocks (index b*nSpinor+s)
+	std::vector<complexScalarField> grad_Ipsik, grad_Ipsiq; //!< corresponding real-space gradients
+	double EXX; //!< accumulated energy
+	
+	ExactExchangePairs(int nSpinor, double prefac, double omega, bool needGrad)
+	: nSpinor(nSpinor), prefac(prefac), omega(omega), needGrad(needGrad), EXX(0.) {}
+	
+	//! Transform block [bStart,bStop) of bands to real space
+	void setBlock(const ColumnBundle& C, const std::vector<int>& bands, size_t bStart, size_t bStop,
+		std::vector<int>& bList, std::vector<complexScalarField>& Ipsi, std::vector<complexScalarField>& grad_Ipsi)
+	{	bList.assign(bands.begin()+bStart, bands.begin()+bStop);
+		Ipsi.resize(bList.size()*nSpinor);
+		for(size_t ib=0; ib<bList.size(); ib++)
+			for(int s=0; s<nSpinor; s++)
+				Ipsi[ib*nSpinor+s] = I(C.getColumn(bList[ib],s));
+		grad_Ipsi.assign(Ipsi.size(), complexScalarField());
+	}
+	void setBlockK(const ColumnBundle& C, const std::vector<int>& bands, size_t bStart, size_t bStop) { setBlock(C, bands, bStart, bStop, bkList, Ipsik, grad_Ipsik); }
+	void setBlockQ(const ColumnBundle& C, const std::vector<int>& bands, size_t bStart, size_t bStop) { setBlock(C, bands, bStart, bStop, bqList, Ipsiq, grad_Ipsiq); }
+	
+	//! Process all pairs between current blocks (multi-threaded over k-bands on the CPU)
+	void run()
+	{	nextBk = 0;
+		std::vector<std::mutex> lockQ(bqList.size());
+		this->lockQ = lockQ.data();
+		threadLaunch(isGpuEnabled() ? 1 : 0, thread, 0, this);
+	}
+	
+private:
+	std::atomic<int> nextBk; //!< next k-band (within block) to be processed
+	std::mutex* lockQ; //!< locks for gradients w.r.t q-bands
+	std::mutex lockEXX; //!< lock for energy accumulation
+	
+	static void thread(int iThread, int nThreads, ExactExchangePairs* pairs) { pairs->process(); }
+	
+	void process()
+	{	int nBk = bkList.size(), nBq = bqList.size();
+		double EXXsub = 0.;
+		for(int ik=nextBk++; ik<nBk; ik=nextBk++) //dynamically balance k-bands between threads
+		{	double wFk = wk * Fk->at(bkList[ik]);
+			for(int jq=0; jq<nBq; jq++)
+			{	int iq = (ik + jq) % nBq; //stagger starting q-band between threads to reduce contention
+				double wFq = wq * Fq->at(bqList[iq]);
+				if(!wFk && !wFq) continue; //at least one of the orbitals must be occupied
+				
+				complexScalarField In; //state pair density
+				for(int s=0; s<nSpinor; s++)
+					In += conj(Ipsik[ik*nSpinor+s]) * Ipsiq[iq*nSpinor+s];
+				complexScalarField E_In = Jdag(O((*coulomb)(J(In), dk, omega))); //Electrostatic potential due to In
+				EXXsub += (prefac*wFk*wFq) * dot(In, E_In).real();
+				
+				if(needGrad)
+				{	for(int s=0; s<nSpinor; s++)
+						grad_Ipsik[ik*nSpinor+s] += (prefac*wFq) * conj(E_In) * Ipsiq[iq*nSpinor+s];
+					lockQ[iq].lock();
+					for(int s=0; s<nSpinor; s++)
+						grad_Ipsiq[iq*nSpinor+s] += (prefac*wFk) * E_In * Ipsik[ik*nSpinor+s];
+					lockQ[iq].unlock();
+				}
+			}
+		}
+		lockEXX.lock(); EXX += EXXsub; lockEXX.unlock();
+	}
+};
+
 
 //! Internal computation object for ExactExchange
 class ExactExchangeEval
@@ -52,7 +130,23 @@ private:
 		std::shared_ptr<ColumnBundleTransform> transform; //wavefunction transformation from reduced set
 	};
 	std::vector<KmapEntry> kmap;
+	std::vector<ColumnBundle> xiACE; //!< projectors of the ACE operator -xi xi^ for each local state (if constructed)
 	inline int kmapIndex(int iReduced, int iInvert, int iSym) const { return (iReduced*invertList.size() + iInvert)*sym.size() + iSym; }
+	
+	//! Bands that contribute to exchange: occupied ones for the energy alone, and all bands when gradients are needed
+	static std::vector<int> activeBands(const diagMatrix& F, bool needGrad)
+	{	std::vector<int> bands;
+		for(int b=0; b<F.nRows(); b++)
+			if(needGrad || F[b]) bands.push_back(b);
+		return bands;
+	}
+	
+	//! Number of bands per block cached in real space (all bands, unless that exceeds the memory budget)
+	int blockSize() const
+	{	const size_t cacheBytes = size_t(1)<<30; //budget for real-space orbitals and their gradients in blocks of k and q
+		size_t bytesPerBand = 4 * nSpinor * e.gInfo.nr * sizeof(complex);
+		return std::max(1, std::min(e.eInfo.nBands, int(cacheBytes/bytesPerBand)));
+	}
 };
 
 
@@ -91,6 +185,40 @@ double ExactExchange::operator()(double aXX, double omega,
 	return EXX;
 }
 
+void ExactExchange::setACE(const std::vector<ColumnBundle>& C, const std::vector<ColumnBundle>& HC)
+{	static StopWatch watch("ExactExchange::setACE"); watch.start();
+	eval->xiACE.resize(e.eInfo.nStates);
+	for(int q=e.eInfo.qStart; q<e.eInfo.qStop; q++)
+	{	//Diagonalize M = C^Vx C, which is negative (semi-)definite:
+		matrix M = dagger_symmetrize(C[q] ^ HC[q]);
+		matrix Mevecs; diagMatrix Meigs;
+		M.diagonalize(Mevecs, Meigs);
+		//Vx ~ HC M^-1 HC^ = -xi xi^ with xi = HC Mevecs |Meigs|^-1/2 (dropping null directions):
+		const double eigTol = 1e-12 * std::max(1., fabs(Meigs.front()));
+		diagMatrix MinvSqrt(Meigs.nRows());
+		for(int b=0; b<Meigs.nRows(); b++)
+			MinvSqrt[b] = (Meigs[b] < -eigTol) ? 1./sqrt(-Meigs[b]) : 0.;
+		eval->xiACE[q] = HC[q] * (Mevecs * MinvSqrt);
+	}
+	watch.stop();
+}
+
+bool ExactExchange::hasACE(int q) const
+{	return eval->xiACE.size() && eval->xiACE[q];
+}
+
+double ExactExchange::applyACE(int q, const diagMatrix& Fq, const ColumnBundle& Cq, ColumnBundle& HCq) const
+{	static StopWatch watch("ExactExchange::applyACE"); watch.start();
+	const ColumnBundle& xi = eval->xiACE[q];
+	assert(xi);
+	matrix xiDagC = xi ^ Cq;
+	if(!HCq) { HCq = Cq.similar(); HCq.zero(); }
+	HCq -= xi * xiDagC;
+	double EXXq = -0.5 * trace(Fq * (dagger(xiDagC) * xiDagC)).real();
+	watch.stop();
+	return EXXq;
+}
+
 //--------------- class ExactExchangeEval implementation ----------------------
 
 
@@ -115,6 +243,12 @@ ExactExchangeEval::ExactExchangeEval(const Everything& e)
 	logPrintf("Per-iteration cost relative to semi-local calculation ~ %lg\n", relativeCost);
 	if(qCount==1 && sym.size()>1)
 		logPrintf("HINT: For gamma-point only calculations, turn off symmetries to speed up exact exchange.\n");
+	if(e.cntrl.scf)
+	{	logPrintf("SCF band minimization will apply exact exchange using the adaptively compressed (ACE) operator,\n"
+			"which is reconstructed from the full exchange operator whenever the density is updated.\n");
+		Citations::add("Adaptively compressed exchange operator",
+			"L. Lin, J. Chem. Theory Comput. 12, 2242 (2016)");
+	}
 	
 	//Initialize kmap:
 	logSuspend();
@@ -152,47 +286,48 @@ double ExactExchangeEval::calc(int iSpin, unsigned iReduced, unsigned iInvert, u
 	
 	//Calculate energy (and gradient):
 	const double prefac = -0.5*aXX / (sym.size()*invertList.size()*e.eInfo.spinWeight);
-	double EXX = 0.;
-	for(int bk=0; bk<e.eInfo.nBands; bk++)
-	{	//Put this state in real space:
-		std::vector<complexScalarField> Ipsik(nSpinor), grad_Ipsik(nSpinor);
-		for(int s=0; s<nSpinor; s++)
-			Ipsik[s] = I(Ck.getColumn(bk,s));
-		double wFk = qnum_k.weight * Fk[bk];
+	std::vector<int> bandsK = activeBands(Fk, HC); //bands of k participating in exchange
+	int nBlock = blockSize();
+	ExactExchangePairs pairs(nSpinor, prefac, omega, HC);
+	pairs.coulomb = e.coulomb.get();
+	pairs.wk = qnum_k.weight;
+	pairs.Fk = &Fk;
+	for(size_t kStart=0; kStart<bandsK.size(); kStart+=nBlock)
+	{	//Put current block of k-states in real space:
+		size_t kStop = std::min(kStart+nBlock, bandsK.size());
+		pairs.setBlockK(Ck, bandsK, kStart, kStop);
 		
 		//Loop over states of same spin belonging to this MPI process:
 		for(int q=e.eInfo.qStart; q<e.eInfo.qStop; q++)
 		{	const QuantumNumber& qnum_q = e.eInfo.qnums[q];
 			if(qnum_k.spin != qnum_q.spin) continue;
-			for(int bq=0; bq<e.eInfo.nBands; bq++)
-			{	double wFq = qnum_q.weight * F[q][bq];
-				if(!wFk && !wFq) continue; //at least one of the orbitals must be occupied
-				
-				std::vector<complexScalarField> Ipsiq(nSpinor);
-				complexScalarField In; //state pair density
-				for(int s=0; s<nSpinor; s++)
-				{	Ipsiq[s] = I(C[q].getColumn(bq,s));
-					In += conj(Ipsik[s]) * Ipsiq[s];
-				}
-				complexScalarFieldTilde n = J(In);
-				complexScalarFieldTilde Kn = O((*e.coulomb)(n, qnum_q.k-qnum_k.k, omega)); //Electrostatic potential due to n
-				EXX += (prefac*wFk*wFq) * dot(n,Kn).real();
-				
+			std::vector<int> bandsQ = activeBands(F[q], HC); //bands of q participating in exchange
+			pairs.dk = qnum_q.k - qnum_k.k;
+			pairs.wq = qnum_q.weight;
+			pairs.Fq = &F[q];
+			for(size_t qStart=0; qStart<bandsQ.size(); qStart+=nBlock)
+			{	//Put current block of q-states in real space and process all band pairs:
+				size_t qStop = std::min(qStart+nBlock, bandsQ.size());
+				pairs.setBlockQ(C[q], bandsQ, qStart, qStop);
+				pairs.run();
+				//Collect gradient w.r.t q-states:
 				if(HC)
-				{	complexScalarField E_In = Jdag(Kn);
-					for(int s=0; s<nSpinor; s++)
-					{	grad_Ipsik[s] += (prefac*wFq) * conj(E_In) * Ipsiq[s];
-						(*HC)[q].accumColumn(bq,s, Idag((prefac*wFk) * E_In * Ipsik[s]));
-					}
-				}
+					for(size_t iq=0; iq<pairs.bqList.size(); iq++)
+						for(int s=0; s<nSpinor; s++)
+						{	complexScalarField& grad_Ipsiq = pairs.grad_Ipsiq[iq*nSpinor+s];
+							if(grad_Ipsiq) (*HC)[q].accumColumn(pairs.bqList[iq],s, Idag(grad_Ipsiq));
+						}
 			}
 		}
+		//Collect gradient w.r.t k-states:
 		if(HC)
-		{	for(int s=0; s<nSpinor; s++)
-				if(grad_Ipsik[s])
-					HCk.accumColumn(bk,s, Idag(grad_Ipsik[s]));
-		}
+			for(size_t ik=0; ik<pairs.bkList.size(); ik++)
+				for(int s=0; s<nSpinor; s++)
+				{	complexScalarField& grad_Ipsik = pairs.grad_Ipsik[ik*nSpinor+s];
+					if(grad_Ipsik) HCk.accumColumn(pairs.bkList[ik],s, Idag(grad_Ipsik));
+				}
 	}
+	double EXX = pairs.EXX;
 	mpiUtil->allReduce(EXX, MPIUtil::ReduceSum, true);
 	
 	//Move ik state gradient back to host process (if necessary):
@@ -40,6 +40,16 @@ public:
 	double operator()(double aXX, double omega,
 		const std::vector<diagMatrix>& F, const std::vector<ColumnBundle>& C,
 		std::vector<ColumnBundle>* HC = 0) const;
+	
+	//! Construct the adaptively compressed exchange (ACE) operator for the local states,
+	//! given wavefunctions C and the exchange operator applied to them, HC (as computed by operator()).
+	//! The compressed operator -xi xi^ reproduces HC exactly within the span of C.
+	void setACE(const std::vector<ColumnBundle>& C, const std::vector<ColumnBundle>& HC);
+	bool hasACE(int q) const; //!< whether the ACE operator is available for state q
+	
+	//! Apply the ACE operator for state q to Cq, accumulate to HCq and return the exchange
+	//! energy for fillings Fq (excluding k-point weight); cost is that of two ZGEMMs
+	double applyACE(int q, const diagMatrix& Fq, const ColumnBundle& Cq, ColumnBundle& HCq) const;
 private:
 	const Everything& e;
 	class ExactExchangeEval* eval; //!< opaque pointer to an internal computation class
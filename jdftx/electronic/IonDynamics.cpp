@@ -25,6 +25,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <electronic/Dump.h>
 #include <electronic/LatticeMinimizer.h>
 #include <electronic/IonDynamics.h>
+#include <electronic/WfnsExtrapolator.h>
 #include <core/Random.h>
 #include <core/BlasExtra.h>
 
@@ -113,6 +114,7 @@ double IonDynamics::computeAcceleration(IonicGradient& accel)
 
 	//Minimize the system:
 	elecFluidMinimize(e);
+	if(imin.wfnsExtrapolator) imin.wfnsExtrapolator->push();
 	
 	//Calculate forces
 	e.iInfo.ionicEnergyAndGrad(e.iInfo.forces); //compute forces in lattice coordinates
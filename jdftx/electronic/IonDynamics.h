@@ -31,7 +31,7 @@ class IonDynamics
 {
 public:
 	void run(); //!< Run the simulation
-	IonDynamics(Everything& e) : e(e), totalMass(0.0), numberOfAtoms(0), imin(IonicMinimizer(e)){};
+	IonDynamics(Everything& e) : e(e), totalMass(0.0), numberOfAtoms(0), imin(IonicMinimizer(e, true)){};
 private:
 	Everything& e;
 	double initialPotentialEnergy;
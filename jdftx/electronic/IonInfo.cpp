@@ -24,6 +24,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <electronic/ExCorr.h>
 #include <electronic/ColumnBundle.h>
 #include <electronic/VanDerWaals.h>
+#include <electronic/RealSpaceProjectors.h>
 #include <fluid/FluidSolver.h>
 #include <cstdio>
 #include <cmath>
@@ -33,6 +34,8 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 
 IonInfo::IonInfo()
 {	shouldPrintForceComponents = false;
+	shouldPrintStressComponents = false;
+	shouldUseFiniteDifferenceStress = false;
 	vdWenable = false;
 	vdWscale = 0.;
 }
@@ -70,6 +73,7 @@ void IonInfo::setup(const Everything &everything)
 		sp->setup(*e);
 	}
 	if(!nAtomsTot) logPrintf("Warning: no atoms in the calculation.\n");
+	projectorCache.setMaxBytes(size_t(e->cntrl.projectorCacheMB * 1048576.));
 	
 	if(not checkPositions())
 		die("\nAtoms are too close, have overlapping pseudopotential cores.\n\n");
@@ -154,15 +158,8 @@ void IonInfo::update(Energies& ener)
 	pairPotentialsAndGrad(&ener);
 	
 	//Pulay corrections:
-	double dEtot_dnG = 0.0; //derivative of Etot w.r.t nG  (G-vectors/unit volume)
-	for(auto sp: species)
-		dEtot_dnG += sp->atpos.size() * sp->dE_dnG;
-	
-	double nbasisAvg = 0.0;
-	for(int q=e->eInfo.qStart; q<e->eInfo.qStop; q++)
-		nbasisAvg += 0.5*e->eInfo.qnums[q].weight * e->basis[q].nbasis;
-	mpiUtil->allReduce(nbasisAvg, MPIUtil::ReduceSum);
-	
+	double dEtot_dnG, nbasisAvg;
+	getPulayParams(dEtot_dnG, nbasisAvg);
 	ener.E["Epulay"] = dEtot_dnG * 
 		( sqrt(2.0)*pow(e->cntrl.Ecut,1.5)/(3.0*M_PI*M_PI) //ideal nG
 		-  nbasisAvg/e->gInfo.detR ); //actual nG
@@ -244,6 +241,118 @@ double IonInfo::ionicEnergyAndGrad(IonicGradient& forces) const
 	return relevantFreeEnergy(*e);
 }
 
+bool IonInfo::hasAnalyticStress() const
+{	const ElecVars& eVars = e->eVars;
+	if(shouldUseFiniteDifferenceStress) return false; //explicitly requested finite differences
+	if(e->coulombParams.geometry != CoulombParams::Periodic || e->coulombParams.embed
+		|| e->coulombParams.Efield.length_squared()) return false; //truncated / field-dependent electrostatics
+	if(eVars.fluidParams.fluidType != FluidNone || eVars.rhoExternal || eVars.Vexternal.size()) return false; //external interactions
+	if(e->exCorr.exxFactor() || e->exCorr.orbitalDep || e->exCorr.needsKEdensity()) return false; //beyond (semi-)local functionals
+	if(e->eInfo.hasU || eVars.n.size() > 2) return false; //DFT+U or noncollinear magnetism
+	for(auto sp: species)
+		if(sp->isUltrasoft() || sp->isRelativistic()) return false; //ultrasoft or relativistic pseudopotentials
+	return true;
+}
+
+matrix3<> IonInfo::latticeGradient() const
+{	assert(hasAnalyticStress());
+	const ElecInfo &eInfo = e->eInfo;
+	const ElecVars &eVars = e->eVars;
+	const GridInfo &gInfo = e->gInfo;
+	
+	//---------- Pair potential terms (Ewald etc.) ---------
+	matrix3<> E_RRTpairPot;
+	pairPotentialsAndGrad(0, 0, &E_RRTpairPot);
+	
+	//---------- Electrostatic terms: Hartree and local pseudopotential --------------
+	const ScalarFieldTilde nTilde = J(eVars.get_nTot());
+	//--- Hartree:
+	matrix3<> E_RRThartree = 0.5 * e->coulomb->latticeGradient(nTilde, nTilde);
+	//--- Long-range part of local pseudopotential (point nuclear charges interacting via the Coulomb kernel):
+	ScalarFieldTilde VlocShort, rhoIonPoint, nChargeballUnused, nCoreUnused, tauCoreUnused;
+	nullToZero(VlocShort, gInfo);
+	nullToZero(rhoIonPoint, gInfo);
+	for(auto sp: species)
+		sp->updateLocal(VlocShort, rhoIonPoint, nChargeballUnused, nCoreUnused, tauCoreUnused);
+	matrix3<> E_RRTloc = e->coulomb->latticeGradient(nTilde, rhoIonPoint);
+	
+	//---------- Exchange-correlation (including partial cores) -------------
+	ScalarFieldArray Vxc(eVars.n.size());
+	matrix3<> E_RRTxc;
+	e->exCorr(eVars.get_nXC(), &Vxc, false, 0, 0, &E_RRTxc);
+	ScalarFieldTilde ccgrad_nCore;
+	if(nCore)
+	{	ScalarField VxcCore;
+		matrix3<> E_RRTxcCore;
+		e->exCorr(nCore, &VxcCore, false, 0, 0, &E_RRTxcCore);
+		E_RRTxc -= E_RRTxcCore;
+		ScalarField VxcAvg = (Vxc.size()==1) ? Vxc[0] : 0.5*(Vxc[0]+Vxc[1]); //spin-avgd potential
+		ccgrad_nCore = J(VxcAvg - VxcCore);
+	}
+	//--- Short-ranged part of local pseudopotential and partial-core form factors:
+	for(auto sp: species)
+		E_RRTloc += sp->getLocalStress(nTilde, ccgrad_nCore);
+	
+	//---------- Kinetic and nonlocal terms --------------
+	matrix3<> E_RRTke, E_RRTnl;
+	double Enl = 0.;
+	for(int q=eInfo.qStart; q<eInfo.qStop; q++)
+	{	const QuantumNumber& qnum = eInfo.qnums[q];
+		const ColumnBundle& Cq = eVars.C[q];
+		//Kinetic:
+		for(int iDir=0; iDir<3; iDir++)
+			for(int jDir=0; jDir<=iDir; jDir++)
+			{	double term = qnum.weight * gInfo.detR * traceinner(eVars.F[q], Cq, DD(Cq,iDir,jDir)).real();
+				E_RRTke(iDir,jDir) += term;
+				if(iDir != jDir) E_RRTke(jDir,iDir) += term;
+			}
+		//Nonlocal (change of projectors; normalization accounted below):
+		std::vector<matrix> HVdagCq(species.size()); 
+		Enl += qnum.weight * EnlAndGrad(qnum, eVars.F[q], eVars.VdagC[q], HVdagCq);
+		for(unsigned sp=0; sp<species.size(); sp++) if(HVdagCq[sp])
+			species[sp]->accumNonlocalStress(Cq, HVdagCq[sp]*eVars.F[q], E_RRTnl);
+	}
+	mpiUtil->allReduce(&E_RRTke(0,0), 9, MPIUtil::ReduceSum);
+	mpiUtil->allReduce(&E_RRTnl(0,0), 9, MPIUtil::ReduceSum);
+	mpiUtil->allReduce(Enl, MPIUtil::ReduceSum);
+	//Wavefunction normalization ~ 1/sqrt(detR) at fixed lattice-coordinate shape, and projectors are volume-independent:
+	E_RRTnl -= matrix3<>(Enl, Enl, Enl);
+	
+	//---------- Pulay correction (number of basis functions fixed during strain) -----------
+	double dEtot_dnG, nbasisAvg;
+	getPulayParams(dEtot_dnG, nbasisAvg);
+	double EpulayDiag = dEtot_dnG * nbasisAvg/gInfo.detR;
+	matrix3<> E_RRTpulay(EpulayDiag, EpulayDiag, EpulayDiag);
+	
+	//Print components if requested:
+	if(shouldPrintStressComponents)
+	{	double unitScale = 1./gInfo.detR; //report as stress in Eh/a0^3
+		#define PRINT_STRESS_COMPONENT(name, E_RRT) \
+			logPrintf("# Stress component " name " (Eh/a0^3):\n"); \
+			(unitScale*(E_RRT)).print(globalLog, " %15.6le ");
+		PRINT_STRESS_COMPONENT("KE", E_RRTke)
+		PRINT_STRESS_COMPONENT("Enl", E_RRTnl)
+		PRINT_STRESS_COMPONENT("Eloc", E_RRTloc)
+		PRINT_STRESS_COMPONENT("EH", E_RRThartree)
+		PRINT_STRESS_COMPONENT("Exc", E_RRTxc)
+		PRINT_STRESS_COMPONENT("PairPot", E_RRTpairPot)
+		PRINT_STRESS_COMPONENT("Epulay", E_RRTpulay)
+		#undef PRINT_STRESS_COMPONENT
+	}
+	return E_RRTke + E_RRTnl + E_RRTloc + E_RRThartree + E_RRTxc + E_RRTpairPot + E_RRTpulay;
+}
+
+void IonInfo::getPulayParams(double& dEtot_dnG, double& nbasisAvg) const
+{	dEtot_dnG = 0.0;
+	for(auto sp: species)
+		dEtot_dnG += sp->atpos.size() * sp->dE_dnG;
+	
+	nbasisAvg = 0.0;
+	for(int q=e->eInfo.qStart; q<e->eInfo.qStop; q++)
+		nbasisAvg += 0.5*e->eInfo.qnums[q].weight * e->basis[q].nbasis;
+	mpiUtil->allReduce(nbasisAvg, MPIUtil::ReduceSum);
+}
+
 double IonInfo::EnlAndGrad(const QuantumNumber& qnum, const diagMatrix& Fq, const std::vector<matrix>& VdagCq, std::vector<matrix>& HVdagCq) const
 {	double Enlq = 0.0;
 	for(unsigned sp=0; sp<species.size(); sp++)
@@ -278,18 +387,29 @@ void IonInfo::augmentDensitySphericalGrad(const QuantumNumber& qnum, const diagM
 
 void IonInfo::project(const ColumnBundle& Cq, std::vector<matrix>& VdagCq, matrix* rotExisting) const
 {	VdagCq.resize(species.size());
+	std::vector<const RealSpaceProjectors*> rsp; std::vector<matrix*> rspVdagCq; //species with real-space projectors
 	for(unsigned sp=0; sp<e->iInfo.species.size(); sp++)
 	{	if(rotExisting && VdagCq[sp]) VdagCq[sp] = VdagCq[sp] * (*rotExisting); //rotate and keep the existing projections
-		else
-		{	auto V = e->iInfo.species[sp]->getV(Cq);
-			if(V) VdagCq[sp] = (*V) ^ Cq;
+		else if(const RealSpaceProjectors* rspCur = species[sp]->getRealSpaceProjectors(Cq))
+		{	rsp.push_back(rspCur);
+			rspVdagCq.push_back(&VdagCq[sp]);
 		}
+		else species[sp]->project(Cq, VdagCq[sp]);
 	}
+	if(rsp.size()) RealSpaceProjectors::project(rsp, Cq, rspVdagCq); //share real-space transforms of Cq between species
 }
 
 void IonInfo::projectGrad(const std::vector<matrix>& HVdagCq, const ColumnBundle& Cq, ColumnBundle& HCq) const
-{	for(unsigned sp=0; sp<species.size(); sp++)
-		if(HVdagCq[sp]) HCq += *(species[sp]->getV(Cq)) * HVdagCq[sp];
+{	std::vector<const RealSpaceProjectors*> rsp; std::vector<const matrix*> rspHVdagCq; //species with real-space projectors
+	for(unsigned sp=0; sp<species.size(); sp++)
+		if(HVdagCq[sp])
+		{	if(const RealSpaceProjectors* rspCur = species[sp]->getRealSpaceProjectors(Cq))
+			{	rsp.push_back(rspCur);
+				rspHVdagCq.push_back(&HVdagCq[sp]);
+			}
+			else species[sp]->projectGrad(HVdagCq[sp], Cq, HCq);
+		}
+	if(rsp.size()) RealSpaceProjectors::projectGrad(rsp, rspHVdagCq, HCq);
 }
 
 //----- DFT+U functions --------
@@ -434,7 +554,7 @@ ColumnBundle IonInfo::getAtomicOrbitals(int q, bool applyO, int extraCols) const
 }
 
 
-void IonInfo::pairPotentialsAndGrad(Energies* ener, IonicGradient* forces) const
+void IonInfo::pairPotentialsAndGrad(Energies* ener, IonicGradient* forces, matrix3<>* E_RRT) const
 {
 	//Obtain the list of atomic positions and charges:
 	std::vector<Atom> atoms;
@@ -444,12 +564,12 @@ void IonInfo::pairPotentialsAndGrad(Energies* ener, IonicGradient* forces) const
 			atoms.push_back(Atom(sp.Z, pos, vector3<>(0.,0.,0.), sp.atomicNumber, spIndex));
 	}
 	//Compute Ewald sum and gradients (this also moves each Atom::pos into fundamental zone)
-	double Eewald = e->coulomb->energyAndGrad(atoms);
+	double Eewald = e->coulomb->energyAndGrad(atoms, E_RRT);
 	//Compute optional pair-potential terms:
 	double EvdW = 0.;
 	if(vdWenable)
 	{	double scaleFac = e->vanDerWaals->getScaleFactor(e->exCorr.getName(), vdWscale);
-		EvdW = e->vanDerWaals->energyAndGrad(atoms, scaleFac); //vanDerWaals energy+force
+		EvdW = e->vanDerWaals->energyAndGrad(atoms, scaleFac, E_RRT); //vanDerWaals energy+force
 	}
 	//Store energies and/or forces if requested:
 	if(ener)
@@ -80,6 +80,14 @@ public:
 	//! Return the total (free) energy and calculate the ionic gradient (forces)
 	double ionicEnergyAndGrad(IonicGradient& forces) const;
 
+	//! Whether the lattice derivative of the energy is available analytically for the current calculation
+	//! (otherwise, LatticeMinimizer falls back to finite differences)
+	bool hasAnalyticStress() const;
+	
+	//! Return the lattice derivative of the total (free) energy, dE/dR.R^T, at fixed wavefunctions and
+	//! fractional atomic positions (requires hasAnalyticStress())
+	matrix3<> latticeGradient() const;
+
 	//! Return the non-local pseudopotential energy due to a single state.
 	//! Optionally accumulate the corresponding electronic gradient in HCq and ionic gradient in forces
 	double EnlAndGrad(const QuantumNumber& qnum, const diagMatrix& Fq, const std::vector<matrix>& VdagCq, std::vector<matrix>& HVdagCq) const;
@@ -121,12 +129,20 @@ public:
 	ionWidthMethod; //!< method for determining ion charge width
 	double ionWidth; //!< width for gaussian representation of nuclei
 	bool shouldPrintForceComponents;
+	bool shouldPrintStressComponents;
+	bool shouldUseFiniteDifferenceStress; //!< use finite differences for the stress even when hasAnalyticStress() (for testing)
+	
+	mutable ProjectorCache projectorCache; //!< atom-independent nonlocal projectors of all species (see SpeciesInfo::getAtomProjectors)
 
 private:
 	const Everything* e;
 	
 	//! Compute all pair-potential terms in the energy or forces (electrostatic, and optionally vdW)
-	void pairPotentialsAndGrad(class Energies* ener=0, IonicGradient* forces=0) const;
+	void pairPotentialsAndGrad(class Energies* ener=0, IonicGradient* forces=0, matrix3<>* E_RRT=0) const;
+	
+	//! Get the quantities entering the Pulay correction: derivative of Etot w.r.t nG (G-vectors/unit volume),
+	//! and the weighted average number of basis functions per k-point
+	void getPulayParams(double& dEtot_dnG, double& nbasisAvg) const;
 };
 
 //! @}
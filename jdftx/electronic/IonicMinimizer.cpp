@@ -24,6 +24,8 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <electronic/ElecMinimizer.h>
 #include <electronic/ColumnBundle.h>
 #include <electronic/Dump.h>
+#include <electronic/WfnsExtrapolator.h>
+#include <core/NeighborList.h>
 #include <core/Random.h>
 #include <core/BlasExtra.h>
 
@@ -156,8 +158,12 @@ IonicGradient operator*(const matrix3<>& mat, const IonicGradient& x)
 }
 
 
-IonicMinimizer::IonicMinimizer(Everything& e) : e(e), populationAnalysisPending(false), skipWfnsDrag(false)
-{	//Check if any atoms constrained:
+IonicMinimizer::IonicMinimizer(Everything& e, bool dynamicsMode) : e(e), populationAnalysisPending(false), skipWfnsDrag(false), preconditioner(MinimizeParams::PreconditionerDefault), expRnn(0.)
+{	if(e.cntrl.wfnsHistory)
+		wfnsExtrapolator = std::make_shared<WfnsExtrapolator>(e, e.cntrl.wfnsHistory,
+			dynamicsMode ? WfnsExtrapolator::ASPC : WfnsExtrapolator::PositionFit);
+	
+	//Check if any atoms constrained:
 	anyConstrained = false;
 	for(const auto sp: e.iInfo.species)
 		for(const auto& constraint: sp->constraints)
@@ -184,6 +190,9 @@ void IonicMinimizer::step(const IonicGradient& dir, double alpha)
 	
 	IonicGradient dpos = alpha * e.gInfo.invR * dir; //dir is in cartesian, atpos in lattice
 	
+	//Check whether wavefunctions can be extrapolated from history (replaces drag below):
+	bool extrapolate = alpha && wfnsExtrapolator && wfnsExtrapolator->canPredict(dpos);
+	
 	if(e.cntrl.dragWavefunctions || populationAnalysisPending)
 	{	//Check if atomic orbitals available and compile list of displacements for each orbital:
 		std::vector< vector3<> > drColumns;
@@ -218,7 +227,7 @@ void IonicMinimizer::step(const IonicGradient& dir, double alpha)
 					Rho[eInfo.qnums[q].index()] += eInfo.qnums[q].weight * (lowdin * eVars.F[q] * dagger(lowdin)); //density matrix contribution
 				}
 				
-				if(alpha && e.cntrl.dragWavefunctions && (!skipWfnsDrag)) //needed only if actually dragging wavefunctions
+				if(alpha && e.cntrl.dragWavefunctions && (!skipWfnsDrag) && (!extrapolate)) //needed only if actually dragging wavefunctions
 				{	matrix coeff = inv(psiDagOpsi) * psiDagOC;  //LCAO coefficients for best fit (minimize C0^OC0 where C0 is the remainder)
 					eVars.C[q] -= psi * coeff; //now contains the residual C0 mentioned above
 				
@@ -254,6 +263,9 @@ void IonicMinimizer::step(const IonicGradient& dir, double alpha)
 	{	watch.stop(); return; 
 	}
 	
+	//Extrapolate wavefunctions (after population analysis above, which needs the current orthonormal ones):
+	if(extrapolate) wfnsExtrapolator->predict(dpos, eVars.C);
+	
 	//Move the atoms:
 	for(unsigned sp=0; sp < iInfo.species.size(); sp++)
 	{	SpeciesInfo& spInfo = *(iInfo.species[sp]);
@@ -282,6 +294,7 @@ double IonicMinimizer::compute(IonicGradient* grad, IonicGradient* Kgrad)
 
 	//Minimize the electronic system:
 	elecFluidMinimize(e);
+	if(wfnsExtrapolator) wfnsExtrapolator->push();
 	
 	//Calculate forces if needed:
 	if(grad)
@@ -291,11 +304,22 @@ double IonicMinimizer::compute(IonicGradient* grad, IonicGradient* Kgrad)
 		//Preconditioned gradient:
 		if(Kgrad)
 		{	*Kgrad = *grad;
-			//Apply scale factors:
-			for(unsigned sp=0; sp<Kgrad->size(); sp++)
-			{	const SpeciesInfo& spInfo = *(e.iInfo.species[sp]);
-				for(unsigned atom=0; atom<Kgrad->at(sp).size(); atom++)
-					Kgrad->at(sp)[atom] *= spInfo.constraints[atom].moveScale;
+			//Apply scale factors (split symmetrically on either side of the Exp preconditioner, if any):
+			bool expPreconditioner = (preconditioner == MinimizeParams::PreconditionerExp);
+			auto applyMoveScale = [&](IonicGradient& x)
+			{	for(unsigned sp=0; sp<x.size(); sp++)
+				{	const SpeciesInfo& spInfo = *(e.iInfo.species[sp]);
+					for(unsigned atom=0; atom<x[sp].size(); atom++)
+					{	double moveScale = spInfo.constraints[atom].moveScale;
+						x[sp][atom] *= (expPreconditioner ? sqrt(moveScale) : moveScale);
+					}
+				}
+			};
+			applyMoveScale(*Kgrad);
+			if(expPreconditioner)
+			{	constrain(*Kgrad);
+				applyExpPreconditioner(*Kgrad);
+				applyMoveScale(*Kgrad);
 			}
 			constrain(*Kgrad); //Apply constraints
 		}
@@ -359,6 +383,95 @@ void IonicMinimizer::constrain(IonicGradient& x)
 	#undef SymmetrizeCartesian
 }
 
+void IonicMinimizer::applyExpPreconditioner(IonicGradient& x) const
+{	const double A = 3.; //decay rate of connectivity with distance (relative to nearest-neighbour distance)
+	const double rCutFactor = 2.; //connectivity cutoff in units of nearest-neighbour distance
+	const double cStab = 0.1; //stabilization of rigid translations (relative to unit connectivity)
+	const double rebuildFraction = 0.1; //rebuild once any atom moves by this fraction of the nearest-neighbour distance
+	const GridInfo& gInfo = e.gInfo;
+	
+	//Collect atom positions (lattice coordinates) across species:
+	std::vector< vector3<> > pos;
+	for(const auto& sp: e.iInfo.species)
+		pos.insert(pos.end(), sp->atpos.begin(), sp->atpos.end());
+	int nAtoms = pos.size();
+	if(!nAtoms) return;
+	
+	//Check whether the cached inverse is still applicable:
+	bool rebuild = (expPinv.nRows() != nAtoms) || !(gInfo.R == expR);
+	for(int i=0; i<nAtoms && !rebuild; i++)
+		if((gInfo.R * (pos[i] - expPos[i])).length() > rebuildFraction * expRnn)
+			rebuild = true;
+	if(rebuild)
+	{	const vector3<bool> isTruncated = e.coulombParams.isTruncated();
+		vector3<bool> isPeriodic;
+		for(int k=0; k<3; k++) isPeriodic[k] = !isTruncated[k];
+		const matrix3<> RTR = (~gInfo.R) * gInfo.R;
+		
+		//Estimate nearest-neighbour distance as the median over atoms:
+		//(search within twice the mean inter-atomic spacing; atoms without neighbours in that range are treated as isolated)
+		std::vector<double> rNNatom(nAtoms, DBL_MAX);
+		NeighborList nlSearch(2.*cbrt(fabs(gInfo.detR)/nAtoms), 0., isPeriodic);
+		nlSearch.update(gInfo.R, pos);
+		double rSqSearch = pow(nlSearch.getCutoff(), 2);
+		for(int i=0; i<nAtoms; i++)
+			nlSearch.forNeighbors(i, [&](int j, const vector3<int>& iR)
+			{	double rSq = RTR.metric_length_squared(iR + (pos[i] - pos[j]));
+				if(rSq < rSqSearch) rNNatom[i] = std::min(rNNatom[i], sqrt(rSq));
+			});
+		std::nth_element(rNNatom.begin(), rNNatom.begin()+nAtoms/2, rNNatom.end());
+		expRnn = rNNatom[nAtoms/2];
+		
+		//Construct the preconditioner from pairs within rCutFactor * rNN:
+		matrix P = zeroes(nAtoms, nAtoms);
+		complex* Pdata = P.data();
+		if(expRnn < DBL_MAX)
+		{	NeighborList nlConnect(rCutFactor*expRnn, 0., isPeriodic);
+			nlConnect.update(gInfo.R, pos);
+			double rSqCut = pow(nlConnect.getCutoff(), 2);
+			for(int i=0; i<nAtoms; i++)
+				nlConnect.forNeighbors(i, [&](int j, const vector3<int>& iR)
+				{	double rSq = RTR.metric_length_squared(iR + (pos[i] - pos[j]));
+					if(rSq > rSqCut) return;
+					double Pij = exp(-A*(sqrt(rSq)/expRnn - 1.));
+					Pdata[P.index(i,j)] -= Pij;
+					Pdata[P.index(i,i)] += Pij;
+				});
+		}
+		double diagMean = 0.;
+		for(int i=0; i<nAtoms; i++)
+		{	Pdata[P.index(i,i)] += cStab;
+			diagMean += Pdata[P.index(i,i)].real() / nAtoms;
+		}
+		P *= 1./diagMean; //normalize so that step sizes are comparable to the identity (default) preconditioner
+		
+		//Cache inverse along with the geometry it corresponds to:
+		expPinv = inv(P);
+		expPos = pos;
+		expR = gInfo.R;
+	}
+	
+	//Apply inverse to each Cartesian component:
+	matrix xMat(nAtoms, 3);
+	complex* xData = xMat.data();
+	int iAtom = 0;
+	for(const auto& x_sp: x)
+		for(const vector3<>& x_sp_at: x_sp)
+		{	for(int k=0; k<3; k++)
+				xData[xMat.index(iAtom,k)] = x_sp_at[k];
+			iAtom++;
+		}
+	xMat = expPinv * xMat;
+	xData = xMat.data();
+	iAtom = 0;
+	for(auto& x_sp: x)
+		for(vector3<>& x_sp_at: x_sp)
+		{	for(int k=0; k<3; k++)
+				x_sp_at[k] = xData[xMat.index(iAtom,k)].real();
+			iAtom++;
+		}
+}
+
 double IonicMinimizer::safeStepSize(const IonicGradient& dir) const
 {	//Determine mx displacement in dir:
 	double dMax = 0.;
@@ -374,7 +487,8 @@ double IonicMinimizer::sync(double x) const
 }
 
 double IonicMinimizer::minimize(const MinimizeParams& params)
-{	double result = Minimizable<IonicGradient>::minimize(params);
+{	preconditioner = params.preconditioner;
+	double result = Minimizable<IonicGradient>::minimize(params);
 	step(e.iInfo.forces, 0.); //so that population analysis may be performed at final positions
 	return result;
 }
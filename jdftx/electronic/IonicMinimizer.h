@@ -56,7 +56,7 @@ class IonicMinimizer : public Minimizable<IonicGradient>
 {	Everything& e;
 	
 public:
-	IonicMinimizer(Everything& e);
+	IonicMinimizer(Everything& e, bool dynamicsMode=false); //!< dynamicsMode selects wavefunction extrapolation appropriate for uniform MD steps
 	//Virtual functions from Minimizable:
 	void step(const IonicGradient& dir, double alpha);
 	double compute(IonicGradient* grad, IonicGradient* Kgrad);
@@ -68,10 +68,18 @@ public:
 	double sync(double x) const; //!< All processes minimize together; make sure scalars are in sync to round-off error
 	
 	double minimize(const MinimizeParams& params); //!< minor addition to Minimizable::minimize to invoke charge analysis at final positions
+	
+	std::shared_ptr<class WfnsExtrapolator> wfnsExtrapolator; //!< history of converged wavefunctions for extrapolation in step() (if enabled)
 private:
 	bool populationAnalysisPending; //!< report() has requested a charge analysis output that is yet to be done
 	bool skipWfnsDrag; //!< whether to temprarily skip wavefunction dragging due to large steps
 	bool anyConstrained; //!< whether any atoms are constrained
+	MinimizeParams::Preconditioner preconditioner; //!< preconditioner selected in the parameters of minimize()
+	void applyExpPreconditioner(IonicGradient& x) const; //!< apply inverse of the Exp preconditioner for the current atom positions to x (in Cartesian coordinates)
+	mutable matrix expPinv; //!< cached inverse of the Exp preconditioner (rebuilt when the lattice changes or atoms move significantly)
+	mutable std::vector< vector3<> > expPos; //!< atom positions (lattice coordinates) for which expPinv was built
+	mutable matrix3<> expR; //!< lattice vectors for which expPinv was built
+	mutable double expRnn; //!< nearest-neighbour distance estimated when expPinv was built
 };
 
 //! @}
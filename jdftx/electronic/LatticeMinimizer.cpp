@@ -201,10 +201,20 @@ double LatticeMinimizer::compute(LatticeGradient* grad, LatticeGradient* Kgrad)
 
 void LatticeMinimizer::calculateStress()
 {	matrix3<> E_strain;
-	for(size_t i=0; i<strainBasis.size(); i++)
-		E_strain += strainBasis[i]*centralDifference(strainBasis[i]);
-	e.gInfo.R = Rorig + Rorig*strain;
-	updateLatticeDependent(e);
+	if(e.iInfo.hasAnalyticStress())
+	{	//Convert cartesian lattice derivative to derivative w.r.t strain (R = Rorig*(1+strain)):
+		matrix3<> E_RRT = e.iInfo.latticeGradient();
+		matrix3<> E_strainFull = (~Rorig) * E_RRT * e.gInfo.invRT;
+		for(size_t i=0; i<strainBasis.size(); i++)
+			E_strain += strainBasis[i]*dot(strainBasis[i], E_strainFull);
+	}
+	else
+	{	//Finite difference fallback for unsupported cases:
+		for(size_t i=0; i<strainBasis.size(); i++)
+			E_strain += strainBasis[i]*centralDifference(strainBasis[i]);
+		e.gInfo.R = Rorig + Rorig*strain;
+		updateLatticeDependent(e);
+	}
 	e.iInfo.stress = E_strain * (1./e.gInfo.detR);
 }
 
@@ -283,6 +293,7 @@ void LatticeMinimizer::updateLatticeDependent(Everything& e, bool ignoreElectron
 	e.updateSupercell();
 	e.coulomb = e.coulombParams.createCoulomb(e.gInfo);
 	e.iInfo.update(e.ener);
+	e.setupRealSpaceProjectors(); //rebuild for the new lattice (discarded by SpeciesInfo::updateLatticeDependent above)
 	if(!ignoreElectronic)
 	{	for(int q=e.eInfo.qStart; q<e.eInfo.qStop; q++)
 			e.eVars.orthonormalize(q);
@@ -0,0 +1,101 @@
+/*-------------------------------------------------------------------
+Copyright 2026 agent
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+
+#include <electronic/ProjectorCache.h>
+#include <core/Util.h>
+
+ProjectorCacheEntry::ProjectorCacheEntry(int nProj, size_t nbasis, bool onGpu) : nProj(nProj), nbasis(nbasis)
+{	memInit("ProjectorCache", nProj*nbasis, onGpu);
+}
+
+
+ProjectorCache::ProjectorCache() : maxBytes(0), nBytesCur(0), nBytesPeak(0), nHits(0), nMisses(0), nEvictions(0)
+{
+}
+
+void ProjectorCache::setMaxBytes(size_t maxBytes)
+{	std::lock_guard<std::mutex> guard(lock);
+	this->maxBytes = maxBytes;
+	if(maxBytes) evict(maxBytes);
+}
+
+bool ProjectorCache::Key::operator<(const Key& other) const
+{	if(owner != other.owner) return owner < other.owner;
+	if(basis != other.basis) return basis < other.basis;
+	return k < other.k;
+}
+
+std::shared_ptr<ProjectorCacheEntry> ProjectorCache::find(const void* owner, const vector3<>& k, const Basis* basis)
+{	std::lock_guard<std::mutex> guard(lock);
+	auto iter = index.find(Key{owner, k, basis});
+	if(iter == index.end())
+	{	nMisses++;
+		return 0;
+	}
+	nHits++;
+	lru.splice(lru.begin(), lru, iter->second); //move to front (iterators remain valid)
+	return iter->second->second;
+}
+
+void ProjectorCache::add(const void* owner, const vector3<>& k, const Basis* basis, const std::shared_ptr<ProjectorCacheEntry>& entry)
+{	std::lock_guard<std::mutex> guard(lock);
+	size_t nBytesEntry = entry->nBytes();
+	if(maxBytes && nBytesEntry > maxBytes) return; //would never fit
+	Key key{owner, k, basis};
+	auto iter = index.find(key);
+	if(iter != index.end()) //replace existing entry
+	{	nBytesCur -= iter->second->second->nBytes();
+		lru.erase(iter->second);
+		index.erase(iter);
+	}
+	if(maxBytes) evict(maxBytes - nBytesEntry);
+	lru.push_front(std::make_pair(key, entry));
+	index[key] = lru.begin();
+	nBytesCur += nBytesEntry;
+	nBytesPeak = std::max(nBytesPeak, nBytesCur);
+}
+
+void ProjectorCache::clear(const void* owner)
+{	std::lock_guard<std::mutex> guard(lock);
+	for(auto iter=lru.begin(); iter!=lru.end();)
+	{	if(owner && iter->first.owner!=owner) { iter++; continue; }
+		nBytesCur -= iter->second->nBytes();
+		index.erase(iter->first);
+		iter = lru.erase(iter);
+	}
+}
+
+void ProjectorCache::evict(size_t nBytesTarget)
+{	while(nBytesCur > nBytesTarget && lru.size())
+	{	const Item& item = lru.back();
+		nBytesCur -= item.second->nBytes();
+		index.erase(item.first);
+		lru.pop_back();
+		nEvictions++;
+	}
+}
+
+void ProjectorCache::printStats() const
+{	if(!(nHits+nMisses)) return;
+	logPrintf("Projector cache: %lu hits, %lu misses, %lu evictions, peak size %.1lf MB",
+		nHits, nMisses, nEvictions, nBytesPeak/1048576.);
+	if(maxBytes) logPrintf(" (budget %.1lf MB)", maxBytes/1048576.);
+	logPrintf("\n");
+}
@@ -0,0 +1,83 @@
+/*-------------------------------------------------------------------
+Copyright 2026 agent
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+
+#ifndef JDFTX_ELECTRONIC_PROJECTORCACHE_H
+#define JDFTX_ELECTRONIC_PROJECTORCACHE_H
+
+#include <core/ManagedMemory.h>
+#include <core/vector3.h>
+#include <list>
+#include <map>
+#include <mutex>
+#include <memory>
+
+class Basis;
+
+//! @addtogroup IonicSystem
+//! @{
+
+//! Atom-independent nonlocal projectors (radial function x spherical harmonic) of one species at one k-point and basis.
+//! Stored as nProj contiguous columns of length nbasis, in the order of l, projector and then m (as in SpeciesInfo::getV).
+//! The projectors of each atom are obtained by multiplying in the structure factor exp(-i(k+G).r_atom) on the fly.
+struct ProjectorCacheEntry : public ManagedMemory<complex>
+{	int nProj; //!< number of projectors (per atom)
+	size_t nbasis; //!< number of basis functions
+	
+	ProjectorCacheEntry(int nProj, size_t nbasis, bool onGpu=false);
+	size_t nBytes() const { return nProj * nbasis * sizeof(complex); }
+};
+
+//! Memory-bounded cache of atom-independent projectors shared by all species,
+//! keyed by species, k-point and basis, with least-recently-used eviction.
+//! Cached data is reported under the category "ProjectorCache" in the memory usage report.
+class ProjectorCache
+{
+public:
+	ProjectorCache();
+	void setMaxBytes(size_t maxBytes); //!< set byte budget (0 = unlimited) and evict entries beyond it
+	
+	//! Return cached projectors for specified key if available (and mark as most recently used), and null otherwise
+	std::shared_ptr<ProjectorCacheEntry> find(const void* owner, const vector3<>& k, const Basis* basis);
+	
+	//! Add projectors for specified key, evicting least-recently-used entries as needed to stay within budget.
+	//! Entries larger than the entire budget are not cached (the caller retains ownership regardless).
+	void add(const void* owner, const vector3<>& k, const Basis* basis, const std::shared_ptr<ProjectorCacheEntry>& entry);
+	
+	void clear(const void* owner=0); //!< remove all entries (optionally only those of a specified owner)
+	size_t nBytes() const { return nBytesCur; } //!< total size of cached projectors
+	void printStats() const; //!< log hit rate, evictions and peak size
+	
+private:
+	struct Key
+	{	const void* owner; vector3<> k; const Basis* basis;
+		bool operator<(const Key& other) const;
+	};
+	typedef std::pair<Key, std::shared_ptr<ProjectorCacheEntry> > Item;
+	std::list<Item> lru; //!< entries ordered from most to least recently used
+	std::map<Key, std::list<Item>::iterator> index; //!< lookup into lru list
+	size_t maxBytes, nBytesCur, nBytesPeak;
+	size_t nHits, nMisses, nEvictions;
+	std::mutex lock;
+	
+	void evict(size_t nBytesTarget); //!< evict least-recently-used entries till total size <= nBytesTarget
+};
+
+//! @}
+#endif // JDFTX_ELECTRONIC_PROJECTORCACHE_H
@@ -0,0 +1,292 @@
+/*-------------------------------------------------------------------
+Copyright 2026 agent
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+
+#include <electronic/RealSpaceProjectors.h>
+#include <electronic/ColumnBundle.h>
+#include <electronic/ElecInfo.h>
+#include <electronic/Basis.h>
+#include <core/SphericalHarmonics.h>
+#include <core/Operators.h>
+#include <core/BlasExtra.h>
+#include <core/Thread.h>
+#include <core/Spline.h>
+
+//Smooth (infinitely differentiable) step from 1 at t<=0 to 0 at t>=1
+inline double filterStep(double t)
+{	if(t <= 0.) return 1.;
+	if(t >= 1.) return 0.;
+	double a = exp(-1./(1.-t)), b = exp(-1./t);
+	return a/(a+b);
+}
+
+//Real-space radial function of a filtered projector: (1/2pi^2) int dq q^2 f(q) w(q) j_l(qr) (using Simpson's rule)
+void filteredRadial_sub(size_t iStart, size_t iStop, int l, double dr, int nq, const double* qfw, double dq, double* rho)
+{	for(size_t i=iStart; i<iStop; i++)
+	{	double r = i*dr, sum = 0.;
+		for(int iq=0; iq<=nq; iq++)
+			sum += qfw[iq] * bessel_jl(l, iq*dq*r) * ((iq==0 || iq==nq) ? 1 : 2*((iq%2)+1));
+		rho[i] = sum * dq/(3*2*M_PI*M_PI);
+	}
+}
+
+RealSpaceProjectors::RealSpaceProjectors(const std::vector< std::vector<RadialFunctionG> >& VnlRadial, const GridInfo& gInfo, double Gw, double tol)
+: gInfo(gInfo), rCut(0.), dr(0.02), nProj(0)
+{	//Determine the filter range:
+	double Gend = DBL_MAX;
+	//--- limited by extent of radial functions:
+	for(const auto& VnlRadial_l: VnlRadial)
+		for(const RadialFunctionG& f: VnlRadial_l)
+			Gend = std::min(Gend, (f.nCoeff-5)/f.dGinv);
+	//--- limited by aliasing on the grid (to keep the projections of the basis exact):
+	for(int n0=-1; n0<=1; n0++)
+	for(int n1=-1; n1<=1; n1++)
+	for(int n2=-1; n2<=1; n2++)
+		if(n0 || n1 || n2)
+		{	vector3<int> nS(n0*gInfo.S[0], n1*gInfo.S[1], n2*gInfo.S[2]);
+			Gend = std::min(Gend, (nS*gInfo.G).length() - Gw);
+		}
+	if(Gend < 1.05*Gw)
+		die("Insufficient room to filter nonlocal projectors between |k+G| = %lg and %lg for real-space projectors.\n", Gw, Gend);
+	
+	//Transform filtered projectors to real space:
+	const double rMax = 20.; //maximum truncation radius
+	const int nr = int(ceil(rMax/dr));
+	const int nq = 2*int(ceil(5.*Gend*rMax)); //resolve oscillations of integrand upto rMax (even for Simpson)
+	const double dq = Gend/nq;
+	for(int l=0; l<int(VnlRadial.size()); l++)
+		for(const RadialFunctionG& f: VnlRadial[l])
+		{	std::vector<double> qfw(nq+1); double normG = 0.;
+			for(int iq=0; iq<=nq; iq++)
+			{	double q = iq*dq;
+				double fw = f(q) * filterStep((q-Gw)/(Gend-Gw));
+				qfw[iq] = q*q*fw;
+				normG += q*q*fw*fw * ((iq==0 || iq==nq) ? 1 : 2*((iq%2)+1));
+			}
+			normG *= dq/(3*8*M_PI*M_PI*M_PI); //= int dr r^2 rho^2 (Parseval)
+			std::vector<double> rho(nr+1);
+			threadLaunch(filteredRadial_sub, nr+1, l, dr, nq, qfw.data(), dq, rho.data());
+			//Find truncation radius:
+			double normR = 0.; int irCut = nr;
+			for(int i=1; i<=nr; i++)
+			{	double r = i*dr, rPrev = (i-1)*dr;
+				normR += 0.5*dr * (pow(r*rho[i],2) + pow(rPrev*rho[i-1],2));
+				if(normG - normR < tol*tol*normG) { irCut = i; break; }
+			}
+			if(irCut == nr)
+				logPrintf("WARNING: real-space projector (l=%d) not localized within %lg bohr to tolerance %lg.\n", l, rMax, tol);
+			rCut = std::max(rCut, irCut*dr);
+			//Store spline:
+			Radial radial; radial.l = l;
+			radial.coeff = QuinticSpline::getCoeff(rho, l%2);
+			radials.push_back(radial);
+			for(int m=-l; m<=l; m++) projPhase.push_back(cis(-0.5*M_PI*l));
+			nProj += 2*l+1;
+		}
+}
+
+size_t RealSpaceProjectors::nBytes() const
+{	size_t nBytes = 0;
+	for(const Sphere& sphere: spheres)
+		nBytes += sphere.index.size() * (sizeof(int) + sizeof(vector3<>) + nProj*sizeof(double));
+	return nBytes;
+}
+
+void RealSpaceProjectors::setAtoms_sub(size_t atStart, size_t atStop, RealSpaceProjectors* rsp, const vector3<>* atpos)
+{	const GridInfo& gInfo = rsp->gInfo;
+	const vector3<int>& S = gInfo.S;
+	//Extent of sphere along each lattice direction:
+	vector3<int> nMin, nMax;
+	vector3<> extent;
+	for(int k=0; k<3; k++)
+		extent[k] = rsp->rCut * gInfo.G.row(k).length() / (2*M_PI);
+	for(size_t at=atStart; at<atStop; at++)
+	{	const vector3<>& pos = atpos[at];
+		Sphere& sphere = rsp->spheres[at];
+		sphere.index.clear();
+		sphere.x.clear();
+		//Find grid points within sphere:
+		std::vector<double> rArr; std::vector< vector3<> > rHatArr;
+		for(int k=0; k<3; k++)
+		{	nMin[k] = int(ceil(S[k]*(pos[k]-extent[k])));
+			nMax[k] = int(floor(S[k]*(pos[k]+extent[k])));
+		}
+		vector3<int> n;
+		for(n[0]=nMin[0]; n[0]<=nMax[0]; n[0]++)
+		for(n[1]=nMin[1]; n[1]<=nMax[1]; n[1]++)
+		for(n[2]=nMin[2]; n[2]<=nMax[2]; n[2]++)
+		{	vector3<> x; for(int k=0; k<3; k++) x[k] = n[k]*(1./S[k]);
+			vector3<> r = gInfo.R * (x - pos);
+			double rMag = r.length();
+			if(rMag >= rsp->rCut) continue;
+			vector3<int> nWrapped; for(int k=0; k<3; k++) { nWrapped[k] = n[k] % S[k]; if(nWrapped[k]<0) nWrapped[k] += S[k]; }
+			sphere.index.push_back(gInfo.fullRindex(nWrapped));
+			sphere.x.push_back(x);
+			rArr.push_back(rMag);
+			rHatArr.push_back(rMag ? r*(1./rMag) : r);
+		}
+		//Compute projectors:
+		size_t nPts = rArr.size();
+		sphere.P.resize(nPts * rsp->nProj);
+		double* P = sphere.P.data();
+		for(const Radial& radial: rsp->radials)
+			for(int m=-radial.l; m<=radial.l; m++)
+			{	for(size_t j=0; j<nPts; j++)
+					P[j] = QuinticSpline::value(radial.coeff.data(), rArr[j]/rsp->dr) * Ylm(radial.l, m, rHatArr[j]);
+				P += nPts;
+			}
+	}
+}
+
+void RealSpaceProjectors::setAtoms(const std::vector< vector3<> >& atpos)
+{	if(atpos == atposPrev) return; //spheres already up to date
+	spheres.resize(atpos.size());
+	threadLaunch(setAtoms_sub, atpos.size(), this, atpos.data());
+	atposPrev = atpos;
+}
+
+static const int nColsBatch = 8; //number of columns processed together in each thread
+
+void RealSpaceProjectors::project_sub(size_t colStart, size_t colStop, const std::vector<const RealSpaceProjectors*>* rsp,
+	const ColumnBundle* C, const std::vector<complex*>* VdagCdata)
+{	int nSpinor = C->spinorLength();
+	const vector3<>& k = C->qnum->k;
+	std::vector<double> buf, out;
+	for(size_t colBatch=colStart; colBatch<colStop; colBatch+=nColsBatch)
+	{	int nCols = std::min(size_t(nColsBatch), colStop-colBatch);
+		//Transform columns to real space:
+		std::vector<complexScalarField> psi(nCols);
+		std::vector<const complex*> psiData(nCols);
+		for(int c=0; c<nCols; c++)
+		{	int col = colBatch+c;
+			psi[c] = I(C->getColumn(col/nSpinor, col%nSpinor));
+			psiData[c] = psi[c]->data();
+		}
+		//Project each set of projectors:
+		for(size_t iSet=0; iSet<rsp->size(); iSet++)
+		{	const RealSpaceProjectors& r = *(rsp->at(iSet));
+			int nProj = r.nProj;
+			size_t nRows = nProj * r.spheres.size();
+			double scale = r.gInfo.detR / r.gInfo.nr;
+			complex* VdagC = VdagCdata->at(iSet);
+			for(size_t at=0; at<r.spheres.size(); at++)
+			{	const Sphere& sphere = r.spheres[at];
+				int nPts = sphere.index.size();
+				out.assign(nProj * 2*nCols, 0.);
+				if(nPts)
+				{	//Gather wavefunctions with Bloch phase (real and imaginary parts in separate columns):
+					buf.resize(nPts * 2*nCols);
+					for(int j=0; j<nPts; j++)
+					{	complex phase = cis(2*M_PI*dot(k, sphere.x[j]));
+						for(int c=0; c<nCols; c++)
+						{	complex z = phase * psiData[c][sphere.index[j]];
+							buf[j + nPts*c] = z.real();
+							buf[j + nPts*(c+nCols)] = z.imag();
+						}
+					}
+					cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, nProj, 2*nCols, nPts,
+						1., sphere.P.data(), nPts, buf.data(), nPts, 0., out.data(), nProj);
+				}
+				for(int c=0; c<nCols; c++)
+					for(int p=0; p<nProj; p++)
+						VdagC[at*nProj + p + nRows*(colBatch+c)] = (scale * r.projPhase[p]) * complex(out[p + nProj*c], out[p + nProj*(c+nCols)]);
+			}
+		}
+	}
+}
+
+void RealSpaceProjectors::project(const std::vector<const RealSpaceProjectors*>& rsp, const ColumnBundle& C, const std::vector<matrix*>& VdagC)
+{	static StopWatch watch("RealSpaceProjectors::project"); watch.start();
+	assert(rsp.size() == VdagC.size());
+	size_t nCols = C.nCols() * C.spinorLength();
+	std::vector<complex*> VdagCdata;
+	for(size_t iSet=0; iSet<rsp.size(); iSet++)
+	{	*(VdagC[iSet]) = matrix(rsp[iSet]->nProj * rsp[iSet]->spheres.size(), nCols);
+		VdagCdata.push_back(VdagC[iSet]->data());
+	}
+	threadLaunch(project_sub, nCols, &rsp, &C, &VdagCdata);
+	watch.stop();
+}
+
+void RealSpaceProjectors::projectGrad_sub(size_t colStart, size_t colStop, const std::vector<const RealSpaceProjectors*>* rsp,
+	const std::vector<const complex*>* HVdagCdata, ColumnBundle* HC)
+{	int nSpinor = HC->spinorLength();
+	const vector3<>& k = HC->qnum->k;
+	const GridInfo& gInfo = *(HC->basis->gInfo);
+	std::vector<double> buf, in;
+	for(size_t colBatch=colStart; colBatch<colStop; colBatch+=nColsBatch)
+	{	int nCols = std::min(size_t(nColsBatch), colStop-colBatch);
+		std::vector<complexScalarField> h(nCols);
+		std::vector<complex*> hData(nCols);
+		for(int c=0; c<nCols; c++)
+		{	nullToZero(h[c], gInfo);
+			hData[c] = h[c]->data();
+		}
+		//Accumulate real-space contributions of each set of projectors:
+		for(size_t iSet=0; iSet<rsp->size(); iSet++)
+		{	const RealSpaceProjectors& r = *(rsp->at(iSet));
+			int nProj = r.nProj;
+			size_t nRows = nProj * r.spheres.size();
+			double scale = r.gInfo.detR / r.gInfo.nr;
+			const complex* HVdagC = HVdagCdata->at(iSet);
+			for(size_t at=0; at<r.spheres.size(); at++)
+			{	const Sphere& sphere = r.spheres[at];
+				int nPts = sphere.index.size();
+				if(!nPts) continue;
+				//Collect coefficients of projectors (real and imaginary parts in separate columns):
+				in.resize(nProj * 2*nCols);
+				for(int c=0; c<nCols; c++)
+					for(int p=0; p<nProj; p++)
+					{	complex z = (scale * r.projPhase[p].conj()) * HVdagC[at*nProj + p + nRows*(colBatch+c)];
+						in[p + nProj*c] = z.real();
+						in[p + nProj*(c+nCols)] = z.imag();
+					}
+				buf.resize(nPts * 2*nCols);
+				cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, nPts, 2*nCols, nProj,
+					1., sphere.P.data(), nPts, in.data(), nProj, 0., buf.data(), nPts);
+				//Scatter with Bloch phase:
+				for(int j=0; j<nPts; j++)
+				{	complex phase = cis(-2*M_PI*dot(k, sphere.x[j]));
+					for(int c=0; c<nCols; c++)
+						hData[c][sphere.index[j]] += phase * complex(buf[j + nPts*c], buf[j + nPts*(c+nCols)]);
+				}
+			}
+		}
+		//Transform back to the basis:
+		for(int c=0; c<nCols; c++)
+		{	int col = colBatch+c;
+			HC->accumColumn(col/nSpinor, col%nSpinor, Idag(h[c]));
+		}
+	}
+}
+
+void RealSpaceProjectors::projectGrad(const std::vector<const RealSpaceProjectors*>& rsp, const std::vector<const matrix*>& HVdagC, ColumnBundle& HC)
+{	static StopWatch watch("RealSpaceProjectors::projectGrad"); watch.start();
+	assert(rsp.size() == HVdagC.size());
+	size_t nCols = HC.nCols() * HC.spinorLength();
+	std::vector<const complex*> HVdagCdata;
+	for(size_t iSet=0; iSet<rsp.size(); iSet++)
+	{	assert(HVdagC[iSet]->nRows() == int(rsp[iSet]->nProj * rsp[iSet]->spheres.size()));
+		assert(HVdagC[iSet]->nCols() == int(nCols));
+		HVdagCdata.push_back(HVdagC[iSet]->data());
+	}
+	HC.data(); //ensure HC is up to date on the CPU before accumulating from threads
+	threadLaunch(projectGrad_sub, nCols, &rsp, &HVdagCdata, &HC);
+	watch.stop();
+}
@@ -0,0 +1,90 @@
+/*-------------------------------------------------------------------
+Copyright 2026 agent
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+
+#ifndef JDFTX_ELECTRONIC_REALSPACEPROJECTORS_H
+#define JDFTX_ELECTRONIC_REALSPACEPROJECTORS_H
+
+#include <core/RadialFunction.h>
+#include <core/GridInfo.h>
+#include <core/matrix.h>
+
+class ColumnBundle;
+
+//! @addtogroup IonicSystem
+//! @{
+
+/** @brief Nonlocal projectors of one species, stored on the real-space grid within a sphere around each atom (CPU only)
+
+The reciprocal-space projectors are exact up to the largest |k+G| in the wavefunction bases, Gw.
+Between Gw and the extent of the radial functions, they are smoothly filtered to zero, which
+leaves the projections unchanged and localizes the projectors in real space (in the spirit of King-Smith et al).
+The filtered projectors are then truncated at a radius rCut beyond which their norm is below tol^2 of the total.
+Projections are computed by gathering the real-space wavefunctions at the grid points in each sphere,
+followed by a small real GEMM per atom, so that the cost and memory scale linearly with system size.
+These are used only for the energy and Hamiltonian: forces and stresses use the exact reciprocal-space
+projectors, and are therefore consistent with the energy only to within tol.
+*/
+class RealSpaceProjectors
+{
+public:
+	//! Initialize from the radial projectors VnlRadial (indexed by l and then projector), for wavefunctions on gInfo
+	RealSpaceProjectors(const std::vector< std::vector<RadialFunctionG> >& VnlRadial, const GridInfo& gInfo, double Gw, double tol);
+	
+	void setAtoms(const std::vector< vector3<> >& atpos); //!< update the sphere around each atom (lattice coordinates), if the positions have changed
+	double getRcut() const { return rCut; } //!< truncation radius of projectors
+	size_t nBytes() const; //!< memory used by the stored projectors
+	
+	//! Compute VdagC[i] = V^C for each set of projectors rsp[i], sharing the real-space transforms of C.
+	//! The columns of VdagC are arranged as in V^C for a non-spinor V and possibly spinor C.
+	static void project(const std::vector<const RealSpaceProjectors*>& rsp, const ColumnBundle& C, const std::vector<matrix*>& VdagC);
+	
+	//! Accumulate HC += V * HVdagC[i] for each set of projectors rsp[i] (gradient propagation corresponding to project())
+	static void projectGrad(const std::vector<const RealSpaceProjectors*>& rsp, const std::vector<const matrix*>& HVdagC, ColumnBundle& HC);
+	
+private:
+	const GridInfo& gInfo;
+	double rCut; //!< truncation radius
+	double dr; //!< real-space radial grid spacing
+	struct Radial
+	{	int l;
+		std::vector<double> coeff; //!< quintic spline coefficients on the real-space radial grid
+	};
+	std::vector<Radial> radials; //!< filtered real-space radial functions (in order of l and then projector)
+	int nProj; //!< number of projectors per atom (in order of l, projector and then m, as in SpeciesInfo::getV)
+	std::vector<complex> projPhase; //!< (-i)^l for each projector
+	
+	//! Projectors on the grid points within rCut of an atom
+	struct Sphere
+	{	std::vector<int> index; //!< grid point indices
+		std::vector< vector3<> > x; //!< unwrapped lattice coordinates of the grid points (for the Bloch phases)
+		std::vector<double> P; //!< projector values (grid point index contiguous, projector index slow)
+	};
+	std::vector<Sphere> spheres; //!< one per atom
+	std::vector< vector3<> > atposPrev; //!< atom positions for which spheres are valid
+	
+	static void setAtoms_sub(size_t atStart, size_t atStop, RealSpaceProjectors* rsp, const vector3<>* atpos);
+	static void project_sub(size_t colStart, size_t colStop, const std::vector<const RealSpaceProjectors*>* rsp,
+		const ColumnBundle* C, const std::vector<complex*>* VdagCdata);
+	static void projectGrad_sub(size_t colStart, size_t colStop, const std::vector<const RealSpaceProjectors*>* rsp,
+		const std::vector<const complex*>* HVdagCdata, ColumnBundle* HC);
+};
+
+//! @}
+#endif // JDFTX_ELECTRONIC_REALSPACEPROJECTORS_H
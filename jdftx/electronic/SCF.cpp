@@ -40,7 +40,7 @@ inline ScalarFieldArray operator*(const RealKernel& K, const ScalarFieldArray& x
 	return Kx;
 }
 
-SCF::SCF(Everything& e): Pulay<SCFvariable>(e.scfParams), e(e), kerkerMix(e.gInfo), diisMetric(e.gInfo)
+SCF::SCF(Everything& e): Pulay<SCFvariable>(e.scfParams), e(e), nCycles(0), kerkerMix(e.gInfo), diisMetric(e.gInfo)
 {	SCFparams& sp = e.scfParams;
 	mixTau = e.exCorr.needsKEdensity();
 	
@@ -98,7 +98,9 @@ void SCF::minimize()
 	//Optimize using Pulay mixer:
 	std::vector<string> extraNames(1, "deigs");
 	std::vector<double> extraThresh(1, sp.eigDiffThreshold);
+	e.dump.scf = this; //dump SCF history along with State
 	Pulay<SCFvariable>::minimize(E, extraNames, extraThresh);
+	e.dump.scf = 0;
 	e.iInfo.augmentDensityGridGrad(e.eVars.Vscloc); //to make sure grid projections are compatible with final Vscloc
 	
 	//Restore electronic minimize params that were modified above:
@@ -124,7 +126,9 @@ double SCF::cycle(double dEprev, std::vector<double>& extraValues)
 	if(not sp.verbose) { logSuspend(); e.elecMinParams.fpLog = nullLog; } // Silence eigensolver output
 	e.elecMinParams.energyDiffThreshold = std::min(1e-6, 0.1*fabs(dEprev));
 	if(sp.nEigSteps) e.elecMinParams.nIterations = sp.nEigSteps;
-	bandMinimize(e);
+	bool useRMMDIIS = sp.rmmDiisStart && nCycles>=sp.rmmDiisStart; //refine bands with RMM-DIIS once the density has settled
+	bandMinimize(e, useRMMDIIS ? sp.rmmDiisSteps : 0);
+	nCycles++;
 	if(not sp.verbose) { logResume(); e.elecMinParams.fpLog = globalLog; }  // Resume output
 
 	//Compute new density and energy
@@ -143,14 +147,7 @@ void SCF::report(int iter)
 	if(e.cntrl.shouldPrintEcomponents) { logPrintf("\n"); e.ener.print(); logPrintf("\n"); }
 	logFlush();
 
-	e.dump(DumpFreq_Electronic, iter);
-	//--- write SCF history if dumping state:
-	if(e.dump.count(std::make_pair(DumpFreq_Electronic,DumpState)) && e.dump.checkInterval(DumpFreq_Electronic,iter))
-	{	string fname = e.dump.getFilename("scfHistory");
-		logPrintf("Dumping '%s' ... ", fname.c_str()); logFlush();
-		saveState(fname.c_str());
-		logPrintf("done\n"); logFlush();
-	}
+	e.dump(DumpFreq_Electronic, iter); //includes SCF history if dumping State (see Dump::scf)
 }
 
 
@@ -64,6 +64,7 @@ protected:
 private:
 	Everything& e;
 	bool mixTau; //!< whether KE needs to be mixed
+	int nCycles; //!< number of SCF cycles completed (used to switch the band update to RMM-DIIS)
 	RealKernel kerkerMix, diisMetric; //!< convolution kernels for kerker preconditioning and the DIIS overlap metric
 	
 	double eigDiffRMS(const std::vector<diagMatrix>&, const std::vector<diagMatrix>&) const; //!< weighted RMS difference between two sets of eigenvalues
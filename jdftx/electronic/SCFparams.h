@@ -31,6 +31,8 @@ struct SCFparams : public PulayParams
 {
 	int nEigSteps; //!< number of steps of the eigenvalue solver per iteration (use elecMinParams.nIterations if 0)
 	double eigDiffThreshold; //!< convergence threshold on the RMS change of eigenvalues
+	int rmmDiisStart; //!< number of SCF cycles after which the band update switches to RMM-DIIS refinement (never if 0)
+	int rmmDiisSteps; //!< number of RMM-DIIS residual-minimization steps per band in each SCF cycle
 
 	string historyFilename; //!< Read SCF history in order to resume a previous run
 	
@@ -49,6 +51,8 @@ struct SCFparams : public PulayParams
 	SCFparams()
 	{	nEigSteps = 2; //for Davidson; the default for CG is 40 (and set by the command)
 		eigDiffThreshold = 1e-8;
+		rmmDiisStart = 0;
+		rmmDiisSteps = 3;
 		mixedVariable = MV_Density;
 		qKerker = 0.8;
 		qKappa = -1.;
@@ -35,8 +35,7 @@ void SpeciesInfo::sync_atpos()
 {	if(!atpos.size()) return; //unused species
 	//Update managed version of atpos:
 	atposManaged = ManagedArray<vector3<>>(atpos); //it will get transferred to GPU if/when necessary
-	//Invalidate cached projectors:
-	cachedV.clear();
+	//Note: cached projectors are atom-independent, so they need not be invalidated here
 }
 
 inline bool isParallel(vector3<> x, vector3<> y)
@@ -423,7 +422,8 @@ void SpeciesInfo::updateLatticeDependent()
 		nCoreRadial.updateGmax(0, nGridLoc);
 		tauCoreRadial.updateGmax(0, nGridLoc);
 		for(auto& Qijl: Qradial) Qijl.second.updateGmax(Qijl.first.l, nGridLoc);
-		cachedV.clear(); //clear any cached projectors
+		e->iInfo.projectorCache.clear(this); //clear any cached projectors
+		rsProjectors.reset(); //real-space projectors depend on lattice through the filter and grid (rebuilt by Everything::setupRealSpaceProjectors)
 	}
 	
 	//Update Qradial indices, matrix and nagIndex if not previously init'd, or if R has changed:
@@ -46,6 +46,20 @@ void Vnl_gpu(int nbasis, int atomStride, int nAtoms, int l, int m, vector3<> k,
 	SwitchTemplate_lm(l,m, Vnl_gpu, (nbasis, atomStride, nAtoms, k, iGarr, G, pos, VnlRadial, V) )
 }
 
+//Apply structure factors to cached atom-independent projectors
+__global__
+void structureFactorMultiply_kernel(int nbasis, int nProj, int nAtoms, vector3<> k,
+	const vector3<int>* iGarr, const vector3<>* pos, const complex* Vq, complex* V)
+{	int n = kernelIndex1D();
+	if(n<nbasis) structureFactorMultiply_calc(n, nbasis, nProj, nAtoms, k, iGarr, pos, Vq, V);
+}
+void structureFactorMultiply_gpu(int nbasis, int nProj, int nAtoms, const vector3<> k,
+	const vector3<int>* iGarr, const vector3<>* pos, const complex* Vq, complex* V)
+{	GpuLaunchConfig1D glc(structureFactorMultiply_kernel, nbasis);
+	structureFactorMultiply_kernel<<<glc.nBlocks,glc.nPerBlock>>>(nbasis, nProj, nAtoms, k, iGarr, pos, Vq, V);
+	gpuErrorCheck();
+}
+
 
 //Augment electron density by spherical functions
 template<int Nlm> __global__ void nAugment_kernel(int zBlock, const vector3<int> S, const matrix3<> G, int iGstart, int iGstop,
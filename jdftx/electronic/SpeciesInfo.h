@@ -22,6 +22,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #define JDFTX_ELECTRONIC_SPECIESINFO_H
 
 #include <electronic/VanDerWaals.h>
+#include <electronic/ProjectorCache.h>
 #include <core/RadialFunction.h>
 #include <core/matrix.h>
 #include <core/ScalarFieldArray.h>
@@ -79,6 +80,7 @@ public:
 	void print(FILE* fp) const; //!< print ionic positions from current species
 	void populationAnalysis(const std::vector<matrix>& RhoAll) const; //!< print population analysis given the density matrix in the Lowdin basis
 	bool isRelativistic() const { return psi2j.size(); } //!< whether pseudopotential is relativistic
+	bool isUltrasoft() const { return Qint.size(); } //!< whether pseudopotential has overlap augmentation
 	
 	enum PseudopotentialFormat
 	{	Fhi, //!< FHI format with ABINIT header (.fhi files)
@@ -88,7 +90,12 @@ public:
 	//! Returns the pseudopotential format
 	PseudopotentialFormat getPSPFormat(){return pspFormat;}
 
-	std::shared_ptr<ColumnBundle> getV(const ColumnBundle& Cq, matrix* M=0) const; //!< get projectors with qnum and basis matching Cq  (optionally cached, and optionally retrieve full M repeated over atoms)
+	std::shared_ptr<ColumnBundle> getV(const ColumnBundle& Cq, matrix* M=0) const; //!< get projectors of all atoms with qnum and basis matching Cq (optionally retrieve full M repeated over atoms)
+	std::shared_ptr<ProjectorCacheEntry> getAtomProjectors(const ColumnBundle& Cq) const; //!< get atom-independent projectors (atom at origin) with qnum and basis matching Cq (optionally cached)
+	void project(const ColumnBundle& Cq, matrix& VdagCq) const; //!< compute projections of Cq on all atoms, in blocks of atoms (unchanged for purely local psp)
+	void projectGrad(const matrix& HVdagCq, const ColumnBundle& Cq, ColumnBundle& HCq) const; //!< accumulate V * HVdagCq to HCq, in blocks of atoms
+	void setupRealSpaceProjectors(const GridInfo& gInfoWfns, double Gw); //!< create real-space projectors for wavefunctions on gInfoWfns with max |k+G| = Gw (if Control::realSpaceProjectors, after basis setup)
+	const class RealSpaceProjectors* getRealSpaceProjectors(const ColumnBundle& Cq) const; //!< get real-space projectors for the grid of Cq, if enabled (null if disabled, or if species is unused or purely local)
 
 	//! Return non-local energy for this species and quantum number q and optionally accumulate
 	//! projected electronic gradient in HVdagCq (if non-null)
@@ -141,7 +148,14 @@ public:
 
 	//! Propagate gradient with respect to atomic projections (in E_VdagC, along with additional overlap contributions from grad_CdagOC) to forces:
 	void accumNonlocalForces(const ColumnBundle& Cq, const matrix& VdagC, const matrix& E_VdagC, const matrix& grad_CdagOCq, std::vector<vector3<> >& forces) const;
-	
+
+	//! Return the lattice derivative (dE/dR.R^T) due to the short-ranged local pseudopotential and the radial form factor of nCore
+	//! (the long-ranged part of Vlocps is included via Coulomb::latticeGradient, and the remaining nCore terms via ExCorr)
+	matrix3<> getLocalStress(const ScalarFieldTilde& ccgrad_Vlocps, const ScalarFieldTilde& ccgrad_nCore) const;
+
+	//! Accumulate the lattice derivative (dE/dR.R^T) due to the change in projectors (excluding normalization) given gradient w.r.t VdagC in E_VdagC (norm-conserving only)
+	void accumNonlocalStress(const ColumnBundle& Cq, const matrix& E_VdagC, matrix3<>& E_RRT) const;
+
 	//! Spin-angle helper functions:
 	static matrix getYlmToSpinAngleMatrix(int l, int j2); //!< Get the ((2l+1)*2)x(j2+1) matrix that transforms the Ylm+spin to the spin-angle functions, where j2=2*j with j = l+/-0.5
 	static matrix getYlmOverlapMatrix(int l, int j2); //!< Get the ((2l+1)*2)x((2l+1)*2) overlap matrix of the spin-spherical harmonics for total angular momentum j (note j2=2*j)
@@ -159,7 +173,7 @@ private:
 	std::vector<matrix> Qint; //!< overlap augmentation matrix (indexed by l, empty if no augmentation)
 	matrix QintAll; //!< block matrix containing Qint for all l,m 
 	
-	std::map<std::pair<vector3<>,const Basis*>, std::shared_ptr<ColumnBundle> > cachedV; //cached projectors (identified by k-point and basis pointer)
+	std::shared_ptr<class RealSpaceProjectors> rsProjectors; //!< real-space projectors (created in setupRealSpaceProjectors() if Control::realSpaceProjectors)
 	
 	struct QijIndex
 	{	int l1, p1; //!< Angular momentum and projector index for channel i
@@ -174,7 +188,7 @@ private:
 	matrix QradialMat; //!< matrix with all the radial augmentation functions in columns (ordered by index)
 	matrix nAug; //!< intermediate electron density augmentation in the basis of Qradial functions (Flat array indexed by spin, atom number and then Qradial index)
 	matrix E_nAug; //!< Gradient w.r.t nAug (same layout)
-	ManagedArray<uint64_t> nagIndex; ManagedArray<size_t> nagIndexPtr; //!< grid indices arranged by |G|, used for coordinating scattered accumulate in nAugmentGrad(_gpu)
+	ManagedArray<uint64_t> nagIndex; ManagedArray<size_t> nagIndexPtr; //!< grid indices arranged by |G|, used for coordinating scattered accumulate in nAugmentGradBatched and nAugmentGrad_gpu
 
 	std::vector<std::vector<RadialFunctionG> > psiRadial; //!< radial part of the atomic orbitals (outer index l, inner index shell)
 	std::vector<std::vector<RadialFunctionG> >* OpsiRadial; //!< O(psiRadial): includes Q contributions for ultrasoft pseudopotentials
@@ -21,6 +21,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <electronic/SpeciesInfo_internal.h>
 #include <electronic/Everything.h>
 #include <electronic/ColumnBundle.h>
+#include <electronic/RealSpaceProjectors.h>
 #include <core/matrix.h>
 
 //------- additional SpeciesInfo functions for ultrasoft pseudopotentials (density and overlap augmentation) -------
@@ -30,10 +31,18 @@ void SpeciesInfo::augmentOverlap(const ColumnBundle& Cq, ColumnBundle& OCq, matr
 {	static StopWatch watch("augmentOverlap"); watch.start();
 	if(!atpos.size()) return; //unused species
 	if(!Qint.size()) return; //no overlap augmentation
-	std::shared_ptr<ColumnBundle> V = getV(Cq);
-	matrix VdagCq = (*V) ^ Cq;
-	if(VdagCqPtr) *VdagCqPtr = VdagCq; //cache for later usage
-	OCq += (*V) * (tiledBlockMatrix(QintAll,atpos.size()) * VdagCq);
+	const RealSpaceProjectors* rsp = getRealSpaceProjectors(Cq);
+	if(rsp)
+	{	matrix VdagCq; RealSpaceProjectors::project({rsp}, Cq, {&VdagCq});
+		if(VdagCqPtr) *VdagCqPtr = VdagCq; //cache for later usage
+		matrix QVdagCq = tiledBlockMatrix(QintAll,atpos.size()) * VdagCq;
+		RealSpaceProjectors::projectGrad({rsp}, {&QVdagCq}, OCq);
+	}
+	else
+	{	matrix VdagCq; project(Cq, VdagCq);
+		if(VdagCqPtr) *VdagCqPtr = VdagCq; //cache for later usage
+		projectGrad(tiledBlockMatrix(QintAll,atpos.size()) * VdagCq, Cq, OCq);
+	}
 	watch.stop();
 }
 
@@ -136,10 +145,16 @@ void SpeciesInfo::augmentDensityGrid(ScalarFieldArray& n) const
 	double* nAugRadialData = (double*)nAugRadial.dataPref();
 	for(unsigned s=0; s<n.size(); s++)
 	{	ScalarFieldTilde nAugTilde; nullToZero(nAugTilde, gInfo);
+		#ifdef GPU_ENABLED
 		for(unsigned atom=0; atom<atpos.size(); atom++)
 		{	int atomOffs = nCoeff * Nlm * (atom + atpos.size()*s);
-			callPref(nAugment)(Nlm, gInfo.S, gInfo.G, gInfo.iGstart, gInfo.iGstop, nCoeff, dGinv, nAugRadialData+atomOffs, atpos[atom], nAugTilde->dataPref());
+			nAugment_gpu(Nlm, gInfo.S, gInfo.G, gInfo.iGstart, gInfo.iGstop, nCoeff, dGinv, nAugRadialData+atomOffs, atpos[atom], nAugTilde->dataPref());
 		}
+		#else
+		//All atoms of species in one pass over G-space:
+		nAugmentBatched(Nlm, gInfo.S, gInfo.G, gInfo.iGstart, gInfo.iGstop, nCoeff, dGinv,
+			nAugRadialData + nCoeff*Nlm*atpos.size()*s, atpos.size(), atpos.data(), nAugTilde->data());
+		#endif
 		n[s] += I(nAugTilde);
 	}
 	watch.stop();
@@ -159,17 +174,27 @@ void SpeciesInfo::augmentDensityGridGrad(const ScalarFieldArray& E_n, std::vecto
 		nAugRadial = QradialMat * nAugTot;
 		nAugRadialData = (const double*)nAugRadial.dataPref();
 	}
+	#ifdef GPU_ENABLED
 	VectorFieldTilde E_atpos; if(forces) nullToZero(E_atpos, gInfo);
 	for(unsigned s=0; s<E_n.size(); s++)
 	{	ScalarFieldTilde ccE_n = Idag(E_n[s]);
 		for(unsigned atom=0; atom<atpos.size(); atom++)
 		{	int atomOffs = nCoeff * Nlm * (atom + atpos.size()*s);
 			if(forces) initZero(E_atpos);
-			callPref(nAugmentGrad)(Nlm, gInfo.S, gInfo.G, nCoeff, dGinv, forces? (nAugRadialData+atomOffs) :0, atpos[atom],
+			nAugmentGrad_gpu(Nlm, gInfo.S, gInfo.G, nCoeff, dGinv, forces? (nAugRadialData+atomOffs) :0, atpos[atom],
 				ccE_n->dataPref(), E_nAugRadialData+atomOffs, forces ? E_atpos.dataPref() : vector3<complex*>(), nagIndex.dataPref(), nagIndexPtr.dataPref());
 			if(forces) for(int k=0; k<3; k++) (*forces)[atom][k] -= sum(E_atpos[k]);
 		}
 	}
+	#else
+	//All atoms of species in one pass over G-space, with forces accumulated directly:
+	for(unsigned s=0; s<E_n.size(); s++)
+	{	ScalarFieldTilde ccE_n = Idag(E_n[s]);
+		int spinOffs = nCoeff * Nlm * atpos.size() * s;
+		nAugmentGradBatched(Nlm, gInfo.S, gInfo.G, nCoeff, dGinv, forces ? (nAugRadialData+spinOffs) : 0, atpos.size(), atpos.data(),
+			ccE_n->data(), E_nAugRadialData+spinOffs, forces ? forces->data() : 0, nagIndex.data(), nagIndexPtr.data());
+	}
+	#endif
 	E_nAug = dagger(QradialMat) * E_nAugRadial;  //propagate from spline coeffs to radial functions
 	E_nAug.allReduce(MPIUtil::ReduceSum);
 	watch.stop();
@@ -21,6 +21,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <electronic/SpeciesInfo_internal.h>
 #include <electronic/Everything.h>
 #include <electronic/ColumnBundle.h>
+#include <electronic/RealSpaceProjectors.h>
 #include <core/matrix.h>
 
 //------- primary SpeciesInfo functions involved in simple energy and gradient calculations (with norm-conserving pseudopotentials) -------
@@ -253,6 +254,38 @@ void SpeciesInfo::accumNonlocalForces(const ColumnBundle& Cq, const matrix& Vdag
 	}
 }
 
+matrix3<> SpeciesInfo::getLocalStress(const ScalarFieldTilde& ccgrad_Vlocps, const ScalarFieldTilde& ccgrad_nCore) const
+{	if(!atpos.size()) return matrix3<>(); //unused species
+	const GridInfo& gInfo = e->gInfo;
+	const complex* ccgrad_nCoreData = (nCoreRadial && ccgrad_nCore) ? ccgrad_nCore->data() : 0;
+	return localStress(gInfo.S, gInfo.G, ccgrad_Vlocps->data(), ccgrad_nCoreData,
+		atpos.size(), atpos.data(), VlocRadial, nCoreRadial);
+}
+
+void SpeciesInfo::accumNonlocalStress(const ColumnBundle& Cq, const matrix& E_VdagC, matrix3<>& E_RRT) const
+{	const QuantumNumber& qnum = *(Cq.qnum);
+	const Basis& basis = *(Cq.basis);
+	int nProj = MnlAll.nRows() / e->eInfo.spinorLength();
+	if(!nProj) return; //purely local psp
+	//Projector derivative w.r.t strain: dV/dstrain_ij = -(k+G)_i d/d(k+G)_j V (at fixed atomic phases)
+	for(int jDir=0; jDir<3; jDir++)
+	{	ColumnBundle Vprime(nProj*atpos.size(), basis.nbasis, &basis, &qnum, false);
+		int iProj = 0;
+		for(int l=0; l<int(VnlRadial.size()); l++)
+			for(unsigned p=0; p<VnlRadial[l].size(); p++)
+				for(int m=-l; m<=l; m++)
+				{	size_t offs = iProj * basis.nbasis;
+					size_t atomStride = nProj * basis.nbasis;
+					VnlPrime(basis.nbasis, atomStride, atpos.size(), l, m, qnum.k, basis.iGarr.data(), basis.gInfo->G, atpos.data(), VnlRadial[l][p], jDir, Vprime.data()+offs);
+					iProj++;
+				}
+		for(int iDir=0; iDir<3; iDir++)
+		{	matrix dVdagC = (D(Vprime,iDir)^Cq) * complex(0,-1); //-(k+G)_i = i D_i (and conjugated by ^)
+			E_RRT(iDir,jDir) += 2.*qnum.weight * trace(E_VdagC * dagger(dVdagC)).real();
+		}
+	}
+}
+
 std::shared_ptr<ColumnBundle> SpeciesInfo::getV(const ColumnBundle& Cq, matrix* M) const
 {	const QuantumNumber& qnum = *(Cq.qnum);
 	const Basis& basis = *(Cq.basis);
@@ -264,28 +297,113 @@ std::shared_ptr<ColumnBundle> SpeciesInfo::getV(const ColumnBundle& Cq, matrix*
 				M->set(at*N,(at+1)*N, at*N,(at+1)*N, MnlAll);
 		}
 	}
-	std::pair<vector3<>,const Basis*> cacheKey = std::make_pair(qnum.k, &basis);
+	std::shared_ptr<ProjectorCacheEntry> Vq = getAtomProjectors(Cq);
+	if(!Vq) return 0; //purely local psp
+	//Apply structure factors of all atoms:
+	int nProj = Vq->nProj;
+	std::shared_ptr<ColumnBundle> V = std::make_shared<ColumnBundle>(nProj*atpos.size(), basis.nbasis, &basis, &qnum, isGpuEnabled()); //not a spinor regardless of spin type
+	callPref(structureFactorMultiply)(basis.nbasis, nProj, atpos.size(), qnum.k, basis.iGarr.dataPref(), atposManaged.dataPref(), Vq->dataPref(), V->dataPref());
+	return V;
+}
+
+std::shared_ptr<ProjectorCacheEntry> SpeciesInfo::getAtomProjectors(const ColumnBundle& Cq) const
+{	const QuantumNumber& qnum = *(Cq.qnum);
+	const Basis& basis = *(Cq.basis);
 	int nProj = MnlAll.nRows() / e->eInfo.spinorLength();
 	if(!nProj) return 0; //purely local psp
 	//First check cache
-	if(e->cntrl.cacheProjectors)
-	{	auto iter = cachedV.find(cacheKey);
-		if(iter != cachedV.end()) //found
-			return iter->second; //return cached value
+	ProjectorCache& cache = e->iInfo.projectorCache;
+	bool useCache = e->cntrl.cacheProjectors && !e->cntrl.realSpaceProjectors; //only occasionally needed with real-space projectors
+	if(useCache)
+	{	std::shared_ptr<ProjectorCacheEntry> Vq = cache.find(this, qnum.k, &basis);
+		if(Vq) return Vq; //return cached value
 	}
 	//No cache / not found in cache; compute:
-	std::shared_ptr<ColumnBundle> V = std::make_shared<ColumnBundle>(nProj*atpos.size(), basis.nbasis, &basis, &qnum, isGpuEnabled()); //not a spinor regardless of spin type
+	static StopWatch watch("getAtomProjectors"); watch.start();
+	std::shared_ptr<ProjectorCacheEntry> Vq = std::make_shared<ProjectorCacheEntry>(nProj, basis.nbasis, isGpuEnabled());
+	ManagedArray<vector3<>> origin(std::vector<vector3<>>(1)); //single atom at origin
 	int iProj = 0;
 	for(int l=0; l<int(VnlRadial.size()); l++)
 		for(unsigned p=0; p<VnlRadial[l].size(); p++)
 			for(int m=-l; m<=l; m++)
 			{	size_t offs = iProj * basis.nbasis;
-				size_t atomStride = nProj * basis.nbasis;
-				callPref(Vnl)(basis.nbasis, atomStride, atpos.size(), l, m, qnum.k, basis.iGarr.dataPref(), basis.gInfo->G, atposManaged.dataPref(), VnlRadial[l][p], V->dataPref()+offs);
+				callPref(Vnl)(basis.nbasis, 0, 1, l, m, qnum.k, basis.iGarr.dataPref(), basis.gInfo->G, origin.dataPref(), VnlRadial[l][p], Vq->dataPref()+offs);
 				iProj++;
 			}
+	watch.stop();
 	//Add to cache if necessary:
-	if(e->cntrl.cacheProjectors)
-		((SpeciesInfo*)this)->cachedV[cacheKey] = V;
-	return V;
+	if(useCache)
+		cache.add(this, qnum.k, &basis, Vq);
+	return Vq;
+}
+
+//Number of atoms per block in project and projectGrad, chosen to bound the transient projector memory
+//while keeping the ZGEMMs large enough to be efficient (all atoms in one block for small systems)
+inline int projectorAtomBlockSize(int nProj, size_t nbasis, int nAtoms)
+{	const size_t maxBlockBytes = size_t(64) << 20; //64 MB
+	size_t bytesPerAtom = nProj * nbasis * sizeof(complex);
+	return std::max(1, std::min(nAtoms, int(maxBlockBytes / std::max(bytesPerAtom,size_t(1)))));
+}
+
+void SpeciesInfo::project(const ColumnBundle& Cq, matrix& VdagCq) const
+{	static StopWatch watch("SpeciesInfo::project");
+	std::shared_ptr<ProjectorCacheEntry> Vq = getAtomProjectors(Cq);
+	if(!Vq) return; //purely local psp
+	watch.start();
+	const QuantumNumber& qnum = *(Cq.qnum);
+	const Basis& basis = *(Cq.basis);
+	int nProj = Vq->nProj;
+	int nAtoms = atpos.size();
+	int nAtomsBlock = projectorAtomBlockSize(nProj, basis.nbasis, nAtoms);
+	ColumnBundle V;
+	for(int atomStart=0; atomStart<nAtoms; atomStart+=nAtomsBlock)
+	{	int nAtomsCur = std::min(nAtomsBlock, nAtoms-atomStart);
+		V.init(nProj*nAtomsCur, basis.nbasis, &basis, &qnum, isGpuEnabled()); //not a spinor regardless of spin type
+		callPref(structureFactorMultiply)(basis.nbasis, nProj, nAtomsCur, qnum.k, basis.iGarr.dataPref(), atposManaged.dataPref()+atomStart, Vq->dataPref(), V.dataPref());
+		matrix VdagCqCur = V ^ Cq;
+		if(nAtomsCur == nAtoms) { VdagCq = VdagCqCur; break; } //single block
+		if(!atomStart) VdagCq.init(nProj*nAtoms, VdagCqCur.nCols(), isGpuEnabled());
+		VdagCq.set(nProj*atomStart,nProj*(atomStart+nAtomsCur), 0,VdagCqCur.nCols(), VdagCqCur);
+	}
+	watch.stop();
+}
+
+void SpeciesInfo::projectGrad(const matrix& HVdagCq, const ColumnBundle& Cq, ColumnBundle& HCq) const
+{	static StopWatch watch("SpeciesInfo::projectGrad");
+	std::shared_ptr<ProjectorCacheEntry> Vq = getAtomProjectors(Cq);
+	if(!Vq) return; //purely local psp
+	watch.start();
+	const QuantumNumber& qnum = *(Cq.qnum);
+	const Basis& basis = *(Cq.basis);
+	int nProj = Vq->nProj;
+	int nAtoms = atpos.size();
+	int nAtomsBlock = projectorAtomBlockSize(nProj, basis.nbasis, nAtoms);
+	ColumnBundle V;
+	for(int atomStart=0; atomStart<nAtoms; atomStart+=nAtomsBlock)
+	{	int nAtomsCur = std::min(nAtomsBlock, nAtoms-atomStart);
+		V.init(nProj*nAtomsCur, basis.nbasis, &basis, &qnum, isGpuEnabled()); //not a spinor regardless of spin type
+		callPref(structureFactorMultiply)(basis.nbasis, nProj, nAtomsCur, qnum.k, basis.iGarr.dataPref(), atposManaged.dataPref()+atomStart, Vq->dataPref(), V.dataPref());
+		if(nAtomsCur == nAtoms) HCq += V * HVdagCq; //single block
+		else HCq += V * HVdagCq(nProj*atomStart,nProj*(atomStart+nAtomsCur), 0,HVdagCq.nCols());
+	}
+	watch.stop();
+}
+
+void SpeciesInfo::setupRealSpaceProjectors(const GridInfo& gInfoWfns, double Gw)
+{	if(!atpos.size() || !MnlAll.nRows()) return; //unused species or purely local psp
+	rsProjectors = std::make_shared<RealSpaceProjectors>(VnlRadial, gInfoWfns, Gw, e->cntrl.realSpaceProjectorTol);
+	rsProjectors->setAtoms(atpos);
+	logPrintf("Real-space projectors for species %s: rCut = %lg bohr, %.1lf MB.\n",
+		name.c_str(), rsProjectors->getRcut(), rsProjectors->nBytes()/1048576.);
+}
+
+const RealSpaceProjectors* SpeciesInfo::getRealSpaceProjectors(const ColumnBundle& Cq) const
+{	if(!rsProjectors)
+	{	assert(!e->cntrl.realSpaceProjectors || !atpos.size() || !MnlAll.nRows()); //must have been rebuilt if the lattice changed
+		return 0; //disabled, unused species or purely local psp
+	}
+	const Basis* basisBegin = e->basis.data();
+	if(Cq.basis < basisBegin || Cq.basis >= basisBegin+e->basis.size()) return 0; //not a wavefunction basis (eg. supercell): use reciprocal-space projectors
+	rsProjectors->setAtoms(atpos); //update spheres if atoms have moved
+	return rsProjectors.get();
 }
@@ -24,6 +24,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <core/BlasExtra.h>
 #include <algorithm>
 #include <atomic>
+#include <mutex>
 
 //Initialize non-local projector from a radial function at a particular l,m
 template<int l, int m>
@@ -36,22 +37,21 @@ void Vnl(int nbasis, int atomStride, int nAtoms, int l, int m, const vector3<> k
 {	SwitchTemplate_lm(l,m, Vnl, (nbasis, atomStride, nAtoms, k, iGarr, G, pos, VnlRadial, V) )
 }
 
-//Augment electron density by spherical functions
-template<int Nlm> void nAugment_sub(size_t diStart, size_t diStop, const vector3<int> S, const matrix3<>& G, int iGstart,
-	int nCoeff, double dGinv, const double* nRadial, const vector3<>& atpos, complex* n)
-{	size_t iStart = iGstart + diStart;
-	size_t iStop = iGstart + diStop;
-	THREAD_halfGspaceLoop( (nAugment_calc<Nlm>)(i, iG, G, nCoeff, dGinv, nRadial, atpos, n); )
+//Apply structure factors to cached atom-independent projectors
+void structureFactorMultiply(int nbasis, int nProj, int nAtoms, const vector3<> k,
+	const vector3<int>* iGarr, const vector3<>* pos, const complex* Vq, complex* V)
+{	threadedLoop(structureFactorMultiply_calc, nbasis, nbasis, nProj, nAtoms, k, iGarr, pos, Vq, V);
 }
-template<int Nlm> void nAugment(const vector3<int> S, const matrix3<>& G, int iGstart, int iGstop,
-	int nCoeff, double dGinv, const double* nRadial, const vector3<>& atpos, complex* n)
-{
-	threadLaunch(nAugment_sub<Nlm>, iGstop-iGstart, S, G, iGstart, nCoeff, dGinv, nRadial, atpos, n);
+
+//Derivative of non-local projector w.r.t k+G (for stress)
+template<int l, int m>
+void VnlPrime(int nbasis, int atomStride, int nAtoms, const vector3<> k, const vector3<int>* iGarr,
+	const matrix3<> G, const vector3<>* pos, const RadialFunctionG& VnlRadial, int iDir, complex* V)
+{	threadedLoop(VnlPrime_calc<l,m>, nbasis, atomStride, nAtoms, k, iGarr, G, pos, VnlRadial, iDir, V);
 }
-void nAugment(int Nlm, const vector3<int> S, const matrix3<>& G, int iGstart, int iGstop,
-	int nCoeff, double dGinv, const double* nRadial, const vector3<>& atpos, complex* n)
-{	
-	SwitchTemplate_Nlm(Nlm, nAugment, (S, G, iGstart, iGstop, nCoeff, dGinv, nRadial, atpos, n) )
+void VnlPrime(int nbasis, int atomStride, int nAtoms, int l, int m, const vector3<> k, const vector3<int>* iGarr,
+	const matrix3<> G, const vector3<>* pos, const RadialFunctionG& VnlRadial, int iDir, complex* V)
+{	SwitchTemplate_lm(l,m, VnlPrime, (nbasis, atomStride, nAtoms, k, iGarr, G, pos, VnlRadial, iDir, V) )
 }
 
 //Function for initializing the index arrays used by nAugmentGrad
@@ -81,31 +81,119 @@ void setNagIndex(const vector3<int>& S, const matrix3<>& G, int iGstart, int iGs
 	threadLaunch(setNagIndexPtr_sub, nGsub, nGsub, nCoeff, nagIndex, nagIndexPtr); //Initialize pointers to boundaries between different Gindices
 }
 
-//Propagate gradients corresponding to above electron density augmentation
-template<int Nlm> void nAugmentGrad_sub(int iStart, int iStop, const vector3<int> S, const matrix3<>& G,
-	int nCoeff, double dGinv, const double* nRadial, const vector3<>& atpos,
-	const complex* ccE_n, double* E_nRadial, vector3<complex*> E_atpos,
+//Phase factors exp(-2 pi i x_k iG_k) for each atom and direction k, indexed by iG_k wrapped to [0,S_k)
+//(the structure factor at iG is then a product of three table entries per atom)
+void initAugmentPhaseTable_sub(size_t iStart, size_t iStop, const vector3<int> S, const vector3<>* atpos, complex* phaseTable)
+{	int phaseStride = S[0]+S[1]+S[2];
+	for(size_t atom=iStart; atom<iStop; atom++)
+	{	complex* phase = phaseTable + atom*phaseStride;
+		for(int k=0; k<3; k++)
+		{	for(int iv=0; iv<S[k]; iv++)
+			{	int ivSigned = (2*iv>S[k]) ? iv-S[k] : iv;
+				phase[iv] = cis((-2*M_PI)*atpos[atom][k]*ivSigned);
+			}
+			phase += S[k];
+		}
+	}
+}
+inline complex augmentStructureFactor(const complex* phase, const vector3<int>& S, const vector3<int>& iv)
+{	return phase[iv[0]] * phase[S[0]+iv[1]] * phase[S[0]+S[1]+iv[2]];
+}
+
+//Batched augmentation of electron density by spherical functions for all atoms of a species
+template<int Nlm> void nAugmentBatched_sub(size_t diStart, size_t diStop, const vector3<int> S, const matrix3<>& G, int iGstart,
+	int nCoeff, double dGinv, const double* nRadial, int nAtoms, const complex* phaseTable, complex* n)
+{	size_t iStart = iGstart + diStart;
+	size_t iStop = iGstart + diStop;
+	int phaseStride = S[0]+S[1]+S[2];
+	THREAD_halfGspaceLoop(
+		nAugmentBasis<Nlm> basis(iG*G, dGinv);
+		if(basis.j < nCoeff-5)
+		{	vector3<int> iv = iG; for(int k=0; k<3; k++) if(iv[k]<0) iv[k] += S[k];
+			complex nSum;
+			for(int atom=0; atom<nAtoms; atom++)
+			{	const double* nRadialAtom = nRadial + atom*Nlm*nCoeff;
+				complex nAtom;
+				for(int lm=0; lm<Nlm; lm++)
+					nAtom += basis.Y[lm] * basis.radial(nRadialAtom+lm*nCoeff);
+				nSum += nAtom * augmentStructureFactor(phaseTable+atom*phaseStride, S, iv);
+			}
+			n[i] += nSum;
+		}
+	)
+}
+template<int Nlm> void nAugmentBatched(const vector3<int> S, const matrix3<>& G, int iGstart, int iGstop,
+	int nCoeff, double dGinv, const double* nRadial, int nAtoms, const complex* phaseTable, complex* n)
+{
+	threadLaunch(nAugmentBatched_sub<Nlm>, iGstop-iGstart, S, G, iGstart, nCoeff, dGinv, nRadial, nAtoms, phaseTable, n);
+}
+void nAugmentBatched(int Nlm, const vector3<int> S, const matrix3<>& G, int iGstart, int iGstop,
+	int nCoeff, double dGinv, const double* nRadial, int nAtoms, const vector3<>* atpos, complex* n)
+{	std::vector<complex> phaseTable(nAtoms*(S[0]+S[1]+S[2]));
+	threadLaunch(initAugmentPhaseTable_sub, nAtoms, S, atpos, phaseTable.data());
+	SwitchTemplate_Nlm(Nlm, nAugmentBatched, (S, G, iGstart, iGstop, nCoeff, dGinv, nRadial, nAtoms, phaseTable.data(), n) )
+}
+
+//Propagate gradients corresponding to above batched augmentation
+template<int Nlm> void nAugmentGradBatched_sub(int iStart, int iStop, const vector3<int> S, const matrix3<>& G,
+	int nCoeff, double dGinv, const double* nRadial, int nAtoms, const complex* phaseTable,
+	const complex* ccE_n, double* E_nRadial, vector3<>* forces, std::mutex* forcesLock,
 	const uint64_t* nagIndex, const size_t* nagIndexPtr, int pass)
 {
-	(pass ? iStart : iStop) = (iStart+iStop)/2; //do first and second halves of range in each pass
+	(pass ? iStart : iStop) = (iStart+iStop)/2; //do first and second halves of range in each pass (see nAugmentGrad)
+	int phaseStride = S[0]+S[1]+S[2];
+	std::vector<vector3<>> forcesThread(forces ? nAtoms : 0);
 	for(int iCoeff=iStart; iCoeff<iStop; iCoeff++)
 		for(size_t ptr=nagIndexPtr[iCoeff]; ptr<nagIndexPtr[iCoeff+1]; ptr++)
-			nAugmentGrad_calc<Nlm>(nagIndex[ptr], S, G, nCoeff, dGinv, nRadial, atpos, ccE_n, E_nRadial, E_atpos, false);
+		{	//Obtain 3D index iG and array offset i for this point (similar to nAugmentGrad_calc)
+			uint64_t key = nagIndex[ptr];
+			vector3<int> iv;
+			iv[2] = int(0xFFFF & key); key >>= 16;
+			iv[1] = int(0xFFFF & key); key >>= 16;
+			iv[0] = int(0xFFFF & key);
+			size_t i = iv[2] + (S[2]/2+1)*size_t(iv[1] + S[1]*iv[0]);
+			vector3<int> iG = iv; for(int j=0; j<3; j++) if(2*iG[j]>S[j]) iG[j]-=S[j];
+			int dotPrefac = (iG[2]==0||2*iG[2]==S[2]) ? 1 : 2;
+			
+			nAugmentBasis<Nlm> basis(iG*G, dGinv);
+			if(basis.j >= nCoeff-5) continue;
+			complex E_n = ccE_n[i].conj();
+			for(int atom=0; atom<nAtoms; atom++)
+			{	complex E_nAtom = E_n * augmentStructureFactor(phaseTable+atom*phaseStride, S, iv);
+				double* E_nRadialAtom = E_nRadial + atom*Nlm*nCoeff + basis.j;
+				const double* nRadialAtom = nRadial ? nRadial + atom*Nlm*nCoeff : 0;
+				complex nE_n;
+				for(int lm=0; lm<Nlm; lm++)
+				{	complex term = basis.Y[lm] * E_nAtom;
+					double E_value = dotPrefac * term.real();
+					for(int iw=0; iw<6; iw++) E_nRadialAtom[lm*nCoeff+iw] += E_value * basis.w[iw];
+					if(nRadialAtom) nE_n += term * basis.radial(nRadialAtom+lm*nCoeff);
+				}
+				if(forces) forcesThread[atom] -= (dotPrefac * (nE_n * complex(0,-2*M_PI)).real()) * vector3<>(iG);
+			}
+		}
+	if(forces)
+	{	std::lock_guard<std::mutex> lock(*forcesLock);
+		for(int atom=0; atom<nAtoms; atom++) forces[atom] += forcesThread[atom];
+	}
 }
-template<int Nlm> void nAugmentGrad(const vector3<int> S, const matrix3<>& G,
-	int nCoeff, double dGinv, const double* nRadial, const vector3<>& atpos,
-	const complex* ccE_n, double* E_nRadial, vector3<complex*> E_atpos,
+template<int Nlm> void nAugmentGradBatched(const vector3<int> S, const matrix3<>& G,
+	int nCoeff, double dGinv, const double* nRadial, int nAtoms, const complex* phaseTable,
+	const complex* ccE_n, double* E_nRadial, vector3<>* forces,
 	const uint64_t* nagIndex, const size_t* nagIndexPtr)
 {	
-	int nThreads = std::min(nProcsAvailable, std::max(1,nCoeff/12)); //Minimum 12 tasks per thread necessary for write-collision prevention logic below
+	int nThreads = std::min(nProcsAvailable, std::max(1,nCoeff/12)); //Minimum 12 tasks per thread necessary for write-collision prevention logic (see nAugmentGrad)
+	std::mutex forcesLock;
 	for(int pass=0; pass<2; pass++) // two non-overlapping passes
-		threadLaunch(nThreads, nAugmentGrad_sub<Nlm>, nCoeff, S, G, nCoeff, dGinv, nRadial, atpos, ccE_n, E_nRadial, E_atpos, nagIndex, nagIndexPtr, pass);
+		threadLaunch(nThreads, nAugmentGradBatched_sub<Nlm>, nCoeff, S, G, nCoeff, dGinv, nRadial, nAtoms, phaseTable,
+			ccE_n, E_nRadial, forces, &forcesLock, nagIndex, nagIndexPtr, pass);
 }
-void nAugmentGrad(int Nlm, const vector3<int> S, const matrix3<>& G,
-	int nCoeff, double dGinv, const double* nRadial, const vector3<>& atpos,
-	const complex* ccE_n, double* E_nRadial, vector3<complex*> E_atpos, const uint64_t* nagIndex, const size_t* nagIndexPtr)
-{	
-	SwitchTemplate_Nlm(Nlm, nAugmentGrad, (S, G, nCoeff, dGinv, nRadial, atpos, ccE_n, E_nRadial, E_atpos, nagIndex, nagIndexPtr) )
+void nAugmentGradBatched(int Nlm, const vector3<int> S, const matrix3<>& G,
+	int nCoeff, double dGinv, const double* nRadial, int nAtoms, const vector3<>* atpos,
+	const complex* ccE_n, double* E_nRadial, vector3<>* forces, const uint64_t* nagIndex, const size_t* nagIndexPtr)
+{	std::vector<complex> phaseTable(nAtoms*(S[0]+S[1]+S[2]));
+	threadLaunch(initAugmentPhaseTable_sub, nAtoms, S, atpos, phaseTable.data());
+	SwitchTemplate_Nlm(Nlm, nAugmentGradBatched, (S, G, nCoeff, dGinv, nRadial, nAtoms, phaseTable.data(), ccE_n, E_nRadial, forces, nagIndex, nagIndexPtr) )
 }
 
 
@@ -175,3 +263,20 @@ void gradSGtoAtpos(const vector3<int> S, const vector3<> atpos,
 	const complex* ccgrad_SG, vector3<complex*> grad_atpos)
 {	threadLaunch(gradSGtoAtpos_sub, S[0]*S[1]*(S[2]/2+1), S, atpos, ccgrad_SG, grad_atpos);
 }
+
+//Lattice derivative due to local pseudopotential and partial cores
+void localStress_sub(size_t iStart, size_t iStop, const vector3<int> S, const matrix3<> G,
+	const complex* ccgrad_Vlocps, const complex* ccgrad_nCore, int nAtoms, const vector3<>* atpos,
+	const RadialFunctionG& VlocRadial, const RadialFunctionG& nCoreRadial, matrix3<>* E_RRT, std::mutex* m)
+{	matrix3<> E_RRTsub;
+	THREAD_halfGspaceLoop( E_RRTsub += localStress_calc(i, iG, S, G, ccgrad_Vlocps, ccgrad_nCore, nAtoms, atpos, VlocRadial, nCoreRadial); )
+	m->lock(); *E_RRT += E_RRTsub; m->unlock();
+}
+matrix3<> localStress(const vector3<int> S, const matrix3<> G,
+	const complex* ccgrad_Vlocps, const complex* ccgrad_nCore, int nAtoms, const vector3<>* atpos,
+	const RadialFunctionG& VlocRadial, const RadialFunctionG& nCoreRadial)
+{	matrix3<> E_RRT; std::mutex m;
+	threadLaunch(localStress_sub, S[0]*S[1]*(S[2]/2+1), S, G, ccgrad_Vlocps, ccgrad_nCore,
+		nAtoms, atpos, VlocRadial, nCoreRadial, &E_RRT, &m);
+	return E_RRT;
+}
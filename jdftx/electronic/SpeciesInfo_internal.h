@@ -51,6 +51,46 @@ void Vnl_gpu(int nbasis, int atomStride, int nAtoms, int l, int m, const vector3
 	const matrix3<> G, const vector3<>* pos, const RadialFunctionG& VnlRadial, complex* Vnl);
 #endif
 
+//! Multiply atom-independent projectors Vq (nProj columns of length nbasis) by the structure factor of each atom,
+//! producing nProj columns per atom in V (for a block of nAtoms atoms at positions pos)
+__hostanddev__ void structureFactorMultiply_calc(int n, int nbasis, int nProj, int nAtoms, const vector3<>& k,
+	const vector3<int>* iGarr, const vector3<>* pos, const complex* Vq, complex* V)
+{	vector3<> kpG = k + iGarr[n]; //k+G in reciprocal lattice coordinates
+	for(int atom=0; atom<nAtoms; atom++)
+	{	complex phase = cis((-2*M_PI)*dot(pos[atom],kpG));
+		complex* Vatom = V + atom*nProj*nbasis;
+		for(int iProj=0; iProj<nProj; iProj++)
+			Vatom[iProj*nbasis+n] = phase * Vq[iProj*nbasis+n];
+	}
+}
+void structureFactorMultiply(int nbasis, int nProj, int nAtoms, const vector3<> k,
+	const vector3<int>* iGarr, const vector3<>* pos, const complex* Vq, complex* V);
+#ifdef GPU_ENABLED
+void structureFactorMultiply_gpu(int nbasis, int nProj, int nAtoms, const vector3<> k,
+	const vector3<int>* iGarr, const vector3<>* pos, const complex* Vq, complex* V);
+#endif
+
+//! Compute the Cartesian derivative along iDir of Vnl w.r.t k+G (at fixed atomic phases), used for the stress tensor
+template<int l, int m> __hostanddev__
+void VnlPrime_calc(int n, int atomStride, int nAtoms, const vector3<>& k, const vector3<int>* iGarr,
+	const matrix3<>& G, const vector3<>* pos, const RadialFunctionG& VnlRadial, int iDir, complex* VnlPrime)
+{
+	vector3<> kpG = k + iGarr[n]; //k+G in reciprocal lattice coordinates:
+	vector3<> qvec = kpG * G; //k+G in cartesian coordinates
+	double q = qvec.length();
+	double qInv = q ? 1.0/q : 0.0;
+	vector3<> qhat = qvec * qInv; //the unit vector along qvec (set qhat to 0 for q=0 (doesn't matter))
+	//Derivative of f(q) Ylm(qhat) = [f(q)/q^l] * [q^l Ylm(qhat)]:
+	double f = VnlRadial(q);
+	double prefac = (VnlRadial.deriv(q) - l*f*qInv) * qhat[iDir] * Ylm<l,m>(qhat)
+		+ f*qInv * YlmPrime<l,m>(qhat, iDir);
+	//Loop over columns (multiple atoms at same l,m):
+	for(int atom=0; atom<nAtoms; atom++)
+		VnlPrime[atom*atomStride+n] = prefac * cis((-2*M_PI)*dot(pos[atom],kpG));
+}
+void VnlPrime(int nbasis, int atomStride, int nAtoms, int l, int m, const vector3<> k, const vector3<int>* iGarr,
+	const matrix3<> G, const vector3<>* pos, const RadialFunctionG& VnlRadial, int iDir, complex* VnlPrime);
+
 
 //! Perform the loop:
 //!   for(lm=0; lm < Nlm; lm++) (*f)(tag< lm >);
@@ -114,9 +154,6 @@ void nAugment_calc(int i, const vector3<int>& iG, const matrix3<>& G,
 	staticLoopYlm<Nlm>(&functor);
 	n[i] += functor.n * cis((-2*M_PI)*dot(atpos,iG));
 }
-void nAugment(int Nlm,
-	const vector3<int> S, const matrix3<>& G, int iGstart, int iGstop,
-	int nCoeff, double dGinv, const double* nRadial, const vector3<>& atpos, complex* n);
 #ifdef GPU_ENABLED
 void nAugment_gpu(int Nlm,
 	const vector3<int> S, const matrix3<>& G, int iGstart, int iGstop,
@@ -174,10 +211,6 @@ void nAugmentGrad_calc(uint64_t key, const vector3<int>& S, const matrix3<>& G,
 	staticLoopYlm<Nlm>(&functor);
 	if(nRadial && !dummyGpuThread) accumVector((functor.nE_n * complex(0,-2*M_PI)) * iG, E_atpos, i);
 }
-void nAugmentGrad(int Nlm, const vector3<int> S, const matrix3<>& G,
-	int nCoeff, double dGinv, const double* nRadial, const vector3<>& atpos,
-	const complex* ccE_n, double* E_nRadial, vector3<complex*> E_atpos,
-	const uint64_t* nagIndex, const size_t* nagIndexPtr);
 #ifdef GPU_ENABLED
 void nAugmentGrad_gpu(int Nlm, const vector3<int> S, const matrix3<>& G,
 	int nCoeff, double dGinv, const double* nRadial, const vector3<>& atpos,
@@ -185,6 +218,48 @@ void nAugmentGrad_gpu(int Nlm, const vector3<int> S, const matrix3<>& G,
 	const uint64_t* nagIndex, const size_t* nagIndexPtr);
 #endif
 
+//! Angular and radial interpolation weights of the augmentation functions at one G-vector,
+//! shared between all atoms of a species in the batched versions of nAugment and nAugmentGrad below
+template<int Nlm> struct nAugmentBasis
+{	vector3<> qhat; double q;
+	complex Y[Nlm]; //!< (-i)^l Y_lm(qhat)
+	double w[6]; int j; //!< spline weights and offset (see QuinticSpline::getWeights)
+	
+	__hostanddev__ nAugmentBasis(const vector3<>& qvec, double dGinv)
+	{	q = qvec.length();
+		qhat = qvec * (q ? 1.0/q : 0.0); //the unit vector along qvec (set qhat to 0 for q=0 (doesn't matter))
+		j = QuinticSpline::getWeights(q * dGinv, w);
+		staticLoopYlm<Nlm>(this);
+	}
+	
+	template<int lm> __hostanddev__ void operator()(const StaticLoopYlmTag<lm>&)
+	{	//Compute phase (-i)^l:
+		complex mIota(0,-1), phase(1,0);
+		for(int l=0; l*(l+2) < lm; l++) phase *= mIota;
+		Y[lm] = phase * Ylm<lm>(qhat);
+	}
+	
+	//! Interpolate radial function at this G (coeff points to the spline coefficients of one lm)
+	__hostanddev__ double radial(const double* coeff) const
+	{	double result = 0.;
+		for(int i=0; i<6; i++) result += w[i] * coeff[j+i];
+		return result;
+	}
+};
+
+//! Batched nAugment for all atoms of a species (CPU only): the spherical harmonics and spline weights
+//! at each G are computed once for all atoms, and structure factors are assembled from per-direction phases.
+//! nRadial contains Nlm*nCoeff spline coefficients per atom (atom outermost).
+void nAugmentBatched(int Nlm, const vector3<int> S, const matrix3<>& G, int iGstart, int iGstop,
+	int nCoeff, double dGinv, const double* nRadial, int nAtoms, const vector3<>* atpos, complex* n);
+
+//! Gradient propagation corresponding to nAugmentBatched (CPU only). Accumulates forces (lattice coordinates)
+//! directly for each atom if nRadial is non-null, instead of via a gradient on the grid as in nAugmentGrad.
+void nAugmentGradBatched(int Nlm, const vector3<int> S, const matrix3<>& G,
+	int nCoeff, double dGinv, const double* nRadial, int nAtoms, const vector3<>* atpos,
+	const complex* ccE_n, double* E_nRadial, vector3<>* forces,
+	const uint64_t* nagIndex, const size_t* nagIndexPtr);
+
 
 //!Get structure factor for a specific iG, given a list of atoms
 __hostanddev__ complex getSG_calc(const vector3<int>& iG, const int& nAtoms, const vector3<>* atpos)
@@ -299,5 +374,33 @@ void gradSGtoAtpos_gpu(const vector3<int> S, const vector3<> atpos,
 	const complex* ccgrad_SG, vector3<complex*> grad_atpos);
 #endif
 
+
+//! Contribution to the lattice derivative (dE/dR.R^T) due to the local pseudopotential and partial core at one G-vector.
+//! The Vlocps term includes the 1/volume scaling of the structure factor, whereas the nCore term only includes
+//! the change in radial form factor, since the remaining terms are included in the exchange-correlation stress
+__hostanddev__ matrix3<> localStress_calc(int i, const vector3<int>& iG, const vector3<int>& S, const matrix3<>& G,
+	const complex* ccgrad_Vlocps, const complex* ccgrad_nCore, int nAtoms, const vector3<>* atpos,
+	const RadialFunctionG& VlocRadial, const RadialFunctionG& nCoreRadial)
+{
+	vector3<> Gvec = iG * G; //cartesian G-vector
+	double Gmag = Gvec.length();
+	if(!Gmag) return matrix3<>(); //G=0 does not contribute
+	complex SG = getSG_calc(iG, nAtoms, atpos);
+	double weight = (iG[2]==0 || 2*iG[2]==S[2]) ? 1. : 2.; //weight of half G-space point
+	matrix3<> GGTbyG = outer(Gvec, Gvec) * (1./Gmag);
+	//Local potential:
+	double nSG = weight * (ccgrad_Vlocps[i].conj() * SG).real();
+	matrix3<> result = (-nSG * VlocRadial.deriv(Gmag)) * GGTbyG;
+	double diagTerm = -nSG * VlocRadial(Gmag);
+	for(int k=0; k<3; k++) result(k,k) += diagTerm;
+	//Partial core:
+	if(ccgrad_nCore)
+		result -= (weight * (ccgrad_nCore[i].conj() * SG).real() * nCoreRadial.deriv(Gmag)) * GGTbyG;
+	return result;
+}
+matrix3<> localStress(const vector3<int> S, const matrix3<> G,
+	const complex* ccgrad_Vlocps, const complex* ccgrad_nCore, int nAtoms, const vector3<>* atpos,
+	const RadialFunctionG& VlocRadial, const RadialFunctionG& nCoreRadial);
+
 //! @}
 #endif // JDFTX_ELECTRONIC_SPECIESINFO_INTERNAL_H
@@ -22,6 +22,8 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <electronic/SpeciesInfo_internal.h>
 #include <core/VectorField.h>
 #include <core/Units.h>
+#include <core/NeighborList.h>
+#include <core/Thread.h>
 
 const static int atomicNumberMaxGrimme = 54;
 const static int atomicNumberMax = 118;
@@ -121,6 +123,13 @@ VanDerWaals::VanDerWaals(const Everything& everything)
 	
 	Citations::add("Van der Waals correction pair-potentials", "S. Grimme, J. Comput. Chem. 27, 1787 (2006)");
 	
+	//Neighbor lists for pair sums (periodic only along untruncated directions):
+	//Truncate summation at 1/r^6 < 10^-16 => r ~ 100 bohrs (with a safety factor of 2)
+	vector3<bool> isTruncated = e->coulombParams.isTruncated();
+	vector3<bool> isPeriodic;
+	for(int k=0; k<3; k++) isPeriodic[k] = !isTruncated[k];
+	neighborList = std::make_shared<NeighborList>(200., 2., isPeriodic);
+	
 	//Print vdw parameter info and check atomic numbers:
 	if(!e->iInfo.vdWenable) logPrintf("\tNOTE: vdW corrections apply only for interactions with fluid.\n");
 	for(size_t spIndex=0; spIndex<e->iInfo.species.size(); spIndex++)
@@ -134,35 +143,50 @@ VanDerWaals::VanDerWaals(const Everything& everything)
 	}
 }
 
-double VanDerWaals::energyAndGrad(std::vector<Atom>& atoms, const double scaleFac) const
-{
-	//Truncate summation at 1/r^6 < 10^-16 => r ~ 100 bohrs
-	vector3<bool> isTruncated = e->coulombParams.isTruncated();
-	vector3<int> n;
-	for(int k=0; k<3; k++)
-		n[k] = isTruncated[k] ? 0 : (int)ceil(200. / e->gInfo.R.column(k).length());
-	
-	double Etot = 0.;  //Total VDW Energy
-	for(int c1=0; c1<int(atoms.size()); c1++)
-	{	const AtomParams& c1params = getParams(atoms[c1].atomicNumber, atoms[c1].sp);
-		for(int c2=0; c2<int(atoms.size()); c2++)
-		{	const AtomParams& c2params = getParams(atoms[c2].atomicNumber, atoms[c2].sp);
+//Pair-potential sum over the neighbors of atoms in [iStart,iStop)
+void vdwPairSum_sub(size_t iStart, size_t iStop, std::vector<Atom>* atoms, const std::vector<VanDerWaals::AtomParams>* params,
+	const NeighborList* neighborList, const matrix3<> R, double scaleFac, double* Etot, matrix3<>* E_RRT, std::mutex* m)
+{	matrix3<> RTR = (~R)*R;
+	double rMaxSq = pow(neighborList->getCutoff(), 2);
+	double Esub = 0.; matrix3<> E_RRTsub;
+	for(size_t c1=iStart; c1<iStop; c1++)
+	{	Atom& a1 = atoms->at(c1);
+		const VanDerWaals::AtomParams& c1params = params->at(c1);
+		neighborList->forNeighbors(c1, [&](int c2, const vector3<int>& iR)
+		{	vector3<> x = iR + (a1.pos - atoms->at(c2).pos);
+			double rSq = RTR.metric_length_squared(x);
+			if(rSq > rMaxSq) return;
+			const VanDerWaals::AtomParams& c2params = params->at(c2);
 			double C6 = sqrt(c1params.C6 * c2params.C6);
 			double R0 = c1params.R0 + c2params.R0;
-			vector3<int> iR;
-			for(iR[0] = -n[0]; iR[0]<=n[0]; iR[0]++)
-			for(iR[1] = -n[1]; iR[1]<=n[1]; iR[1]++)
-			for(iR[2] = -n[2]; iR[2]<=n[2]; iR[2]++)
-			{	vector3<> x = iR + (atoms[c1].pos - atoms[c2].pos);
-				double rSq = e->gInfo.RTR.metric_length_squared(x);
-				if(!rSq) continue; //exclude self-interaction
-				double r = sqrt(rSq);
-				double E_r, E = vdwPairEnergyAndGrad(r, C6, R0, E_r);
-				Etot -= 0.5 * scaleFac * E;
-				atoms[c1].force += scaleFac * E_r * (e->gInfo.RTR * x)/r;
+			double r = sqrt(rSq);
+			double E_r, E = vdwPairEnergyAndGrad(r, C6, R0, E_r);
+			Esub -= 0.5 * scaleFac * E;
+			a1.force += scaleFac * E_r * (RTR * x)/r;
+			if(E_RRT)
+			{	vector3<> rVec = R * x; //cartesian separation
+				E_RRTsub -= (0.5 * scaleFac * E_r / r) * outer(rVec, rVec);
 			}
-		}
+		});
 	}
+	m->lock();
+	*Etot += Esub;
+	if(E_RRT) *E_RRT += E_RRTsub;
+	m->unlock();
+}
+
+double VanDerWaals::energyAndGrad(std::vector<Atom>& atoms, const double scaleFac, matrix3<>* E_RRT) const
+{	std::vector<AtomParams> params; params.reserve(atoms.size());
+	std::vector< vector3<> > pos; pos.reserve(atoms.size());
+	for(const Atom& a: atoms)
+	{	params.push_back(getParams(a.atomicNumber, a.sp));
+		pos.push_back(a.pos);
+	}
+	neighborList->update(e->gInfo.R, pos); //rebuilt only if atoms moved beyond skin
+	double Etot = 0.;  //Total VDW Energy
+	std::mutex m;
+	threadLaunch(vdwPairSum_sub, atoms.size(), &atoms, (const std::vector<AtomParams>*)&params,
+		(const NeighborList*)neighborList.get(), e->gInfo.R, scaleFac, &Etot, E_RRT, &m);
 	return Etot;
 }
 
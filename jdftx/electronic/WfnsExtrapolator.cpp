@@ -0,0 +1,152 @@
+/*-------------------------------------------------------------------
+Copyright 2026 agent
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+
+#include <electronic/WfnsExtrapolator.h>
+#include <electronic/Everything.h>
+#include <core/LatticeUtils.h>
+
+const double WfnsExtrapolator::maxCoeffNorm1 = 5.;
+
+WfnsExtrapolator::WfnsExtrapolator(const Everything& e, int nHistory, WfnsExtrapolator::Scheme scheme)
+: e(e), nHistory(nHistory), scheme(scheme), R(e.gInfo.R)
+{	assert(nHistory >= 2);
+}
+
+void WfnsExtrapolator::push()
+{	static StopWatch watch("WfnsExtrapolator::push"); watch.start();
+	const ElecInfo& eInfo = e.eInfo;
+	const std::vector<ColumnBundle>& Cnew = e.eVars.C;
+	if(nrm2(R - e.gInfo.R) > symmThreshold * nrm2(R))
+	{	clear(); //history invalid after lattice change
+		R = e.gInfo.R;
+	}
+	//Align previous entries to the current wavefunctions:
+	for(int q=eInfo.qStart; q<eInfo.qStop; q++)
+	{	ColumnBundle OCnew = O(Cnew[q]);
+		for(Entry& entry: history)
+		{	//Optimum unitary rotation minimizing |C U - Cnew| is the unitary part of C^O Cnew:
+			matrix M = realInner(entry.C[q], OCnew);
+			entry.C[q] = entry.C[q] * (M * invsqrt(dagger(M) * M));
+		}
+	}
+	//Add current entry, reusing storage of the oldest entry if history is full:
+	Entry entry;
+	if(int(history.size()) == nHistory)
+	{	entry = std::move(history.back());
+		history.pop_back();
+	}
+	entry.C.resize(eInfo.nStates);
+	for(int q=eInfo.qStart; q<eInfo.qStop; q++)
+		entry.C[q] = Cnew[q];
+	entry.pos = getPositions();
+	history.push_front(std::move(entry));
+	watch.stop();
+}
+
+void WfnsExtrapolator::clear()
+{	history.clear();
+}
+
+std::vector<double> WfnsExtrapolator::getCoefficients(const IonicGradient& dpos) const
+{	if(history.size() < 2) return std::vector<double>();
+	if(nrm2(R - e.gInfo.R) > symmThreshold * nrm2(R)) return std::vector<double>(); //history invalid after lattice change
+	std::vector< vector3<> > posNew = getPositions();
+	auto posIter = posNew.begin();
+	for(const auto& dposSp: dpos)
+		for(const vector3<>& dposAt: dposSp)
+			*(posIter++) += dposAt;
+	return getCoefficients(posNew);
+}
+
+bool WfnsExtrapolator::predict(const IonicGradient& dpos, std::vector<ColumnBundle>& C) const
+{	std::vector<double> coeff = getCoefficients(dpos);
+	if(!coeff.size()) return false;
+	//Extrapolate:
+	static StopWatch watch("WfnsExtrapolator::predict"); watch.start();
+	for(int q=e.eInfo.qStart; q<e.eInfo.qStop; q++)
+	{	C[q] = coeff[0] * history[0].C[q];
+		for(size_t j=1; j<history.size(); j++)
+			C[q] += coeff[j] * history[j].C[q];
+	}
+	watch.stop();
+	return true;
+}
+
+std::vector< vector3<> > WfnsExtrapolator::getPositions() const
+{	std::vector< vector3<> > pos;
+	for(const auto& sp: e.iInfo.species)
+		pos.insert(pos.end(), sp->atpos.begin(), sp->atpos.end());
+	return pos;
+}
+
+std::vector<double> WfnsExtrapolator::getCoefficients(const std::vector< vector3<> >& posNew) const
+{	int m = history.size();
+	std::vector<double> coeff(m);
+	switch(scheme)
+	{	case ASPC:
+		{	//Predictor coefficients B_j = (-1)^(j+1) j binom(2k+4, k+2-j) / binom(2k+2, k+1) for j = 1 to k+2:
+			int k = m-2;
+			auto binom = [](int n, int r) { double result=1.; for(int i=1; i<=r; i++) result *= double(n-r+i)/i; return result; };
+			for(int j=1; j<=m; j++)
+				coeff[j-1] = ((j%2) ? j : -j) * binom(2*k+4, k+2-j) / binom(2*k+2, k+1);
+			return coeff;
+		}
+		case PositionFit:
+		{	//Minimize |sum_j c_j (x_j - xNew)|^2 subject to sum_j c_j = 1, whose solution is c ∝ G^-1 1 with G_ij = (x_i - xNew).(x_j - xNew):
+			std::vector< std::vector< vector3<> > > dx(m);
+			for(int j=0; j<m; j++)
+			{	assert(history[j].pos.size() == posNew.size());
+				for(size_t iAtom=0; iAtom<posNew.size(); iAtom++)
+				{	vector3<> d = history[j].pos[iAtom] - posNew[iAtom];
+					for(int iDir=0; iDir<3; iDir++) d[iDir] -= floor(0.5 + d[iDir]); //wrap to minimum image
+					dx[j].push_back(d);
+				}
+			}
+			matrix G(m, m);
+			double traceG = 0.;
+			for(int i=0; i<m; i++)
+				for(int j=0; j<=i; j++)
+				{	double Gij = 0.;
+					for(size_t iAtom=0; iAtom<posNew.size(); iAtom++)
+						Gij += dot(dx[i][iAtom], e.gInfo.RTR * dx[j][iAtom]);
+					G.set(i,j, Gij);
+					G.set(j,i, Gij);
+					if(i==j) traceG += Gij;
+				}
+			double regularization = 1e-6*traceG/m + 1e-12; //guard against ill-conditioning from collinear history
+			matrix ones(m, 1);
+			for(int i=0; i<m; i++)
+			{	G.set(i,i, G(i,i) + regularization);
+				ones.set(i,0, 1.);
+			}
+			matrix y = invApply(G, ones);
+			double ySum = 0.;
+			for(int i=0; i<m; i++) ySum += y(i,0).real();
+			double coeffNorm1 = 0.;
+			for(int i=0; i<m; i++)
+			{	coeff[i] = y(i,0).real() / ySum;
+				coeffNorm1 += fabs(coeff[i]);
+			}
+			if(coeffNorm1 > maxCoeffNorm1) coeff.clear(); //new positions too far outside the span of history
+			return coeff;
+		}
+	}
+	return std::vector<double>();
+}
@@ -0,0 +1,83 @@
+/*-------------------------------------------------------------------
+Copyright 2026 agent
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+
+#ifndef JDFTX_ELECTRONIC_WFNSEXTRAPOLATOR_H
+#define JDFTX_ELECTRONIC_WFNSEXTRAPOLATOR_H
+
+#include <electronic/ColumnBundle.h>
+#include <electronic/IonicMinimizer.h>
+#include <deque>
+
+//! @addtogroup IonicSystem
+//! @{
+//! @file WfnsExtrapolator.h Extrapolation of wavefunctions across ionic steps
+
+/** @brief Extrapolates wavefunctions to new ionic positions from a history of converged states
+
+Stores the converged wavefunctions of the last few ionic steps in a ring buffer, with each
+older entry rotated within its subspace to best match the newest one (so that the entries
+may be linearly combined despite arbitrary unitary rotations / band reordering between steps).
+The prediction is a linear combination of the history (which sums to one), with coefficients
+either from the always-stable predictor (ASPC) of Kolafa, J. Comput. Chem. 25, 335 (2004)
+for molecular dynamics with a fixed time step, or from a least-squares fit of the new atomic
+positions by those in the history, which is appropriate for variable steps in relaxations.
+The electron density follows from the extrapolated wavefunctions at the next energy evaluation.
+*/
+class WfnsExtrapolator
+{
+public:
+	enum Scheme
+	{	ASPC, //!< Kolafa's always-stable predictor (uniform steps, as in molecular dynamics)
+		PositionFit //!< least-squares fit of atomic positions (variable steps, as in relaxations)
+	};
+	
+	WfnsExtrapolator(const Everything& e, int nHistory, Scheme scheme);
+	
+	void push(); //!< add current (converged) wavefunctions and atomic positions to the history
+	void clear(); //!< discard the history
+	
+	//! Whether predict() can extrapolate to atomic positions displaced by dpos (in lattice coordinates) from the current ones
+	//! (false if the history is insufficient or the extrapolation is unreliable)
+	bool canPredict(const IonicGradient& dpos) const { return getCoefficients(dpos).size(); }
+	
+	//! Set C to wavefunctions extrapolated to atomic positions displaced by dpos (in lattice coordinates) from the current ones.
+	//! Returns false (leaving C unmodified) if canPredict(dpos) is false.
+	//! The result is not orthonormalized (which must happen after the atoms are moved).
+	bool predict(const IonicGradient& dpos, std::vector<ColumnBundle>& C) const;
+	
+private:
+	const Everything& e;
+	int nHistory; //!< maximum number of entries in history
+	Scheme scheme;
+	struct Entry
+	{	std::vector<ColumnBundle> C; //!< wavefunctions (aligned to the newest entry)
+		std::vector< vector3<> > pos; //!< atomic positions (all species, in lattice coordinates)
+	};
+	std::deque<Entry> history; //!< newest first
+	matrix3<> R; //!< lattice vectors for which history is valid
+	static const double maxCoeffNorm1; //!< maximum sum of absolute values of fitted coefficients for a reliable extrapolation
+	
+	std::vector< vector3<> > getPositions() const; //!< flattened list of current atomic positions
+	std::vector<double> getCoefficients(const std::vector< vector3<> >& posNew) const; //!< extrapolation coefficients for each history entry (empty if unreliable)
+	std::vector<double> getCoefficients(const IonicGradient& dpos) const; //!< extrapolation coefficients for displacements dpos from current positions (empty if unavailable)
+};
+
+//! @}
+#endif // JDFTX_ELECTRONIC_WFNSEXTRAPOLATOR_H
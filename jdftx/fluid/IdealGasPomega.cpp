@@ -43,6 +43,24 @@ void IdealGasPomega::convertGradients_o(int o, const matrix3<>& rot, const Scala
 }
 
 
+void IdealGasPomega::getDensities_batch(int oBatchStart, int oBatchStop, const matrix3<>* rot, const ScalarField* state, ScalarField* logPomega_o) const
+{	for(int o=oBatchStart; o<oBatchStop; o++)
+		getDensities_o(o, rot[o-oBatchStart], state, logPomega_o[o-oBatchStart]);
+}
+
+void IdealGasPomega::convertGradients_batch(int oBatchStart, int oBatchStop, const matrix3<>* rot, const ScalarField* Phi_logPomega_o, ScalarField* Phi_state) const
+{	for(int o=oBatchStart; o<oBatchStop; o++)
+		convertGradients_o(o, rot[o-oBatchStart], Phi_logPomega_o[o-oBatchStart], Phi_state);
+}
+
+std::vector<matrix3<>> IdealGasPomega::getRotations(int oBatchStart, int oBatchStop) const
+{	std::vector<matrix3<>> rot;
+	for(int o=oBatchStart; o<oBatchStop; o++)
+		rot.push_back(matrixFromEuler(quad.euler(o)));
+	return rot;
+}
+
+
 void IdealGasPomega::initState(const ScalarField* Vex, ScalarField* indep, double scale, double Elo, double Ehi) const
 {	for(int k=0; k<nIndep; k++) indep[k]=0;
 	ScalarFieldArray Veff(molecule.sites.size()); nullToZero(Veff, gInfo);
@@ -51,21 +69,29 @@ void IdealGasPomega::initState(const ScalarField* Vex, ScalarField* indep, doubl
 		Veff[i] += Vex[i];
 	}
 	double Emin=+DBL_MAX, Emax=-DBL_MAX, Emean=0.0;
-	for(int o=oStart; o<oStop; o++)
-	{	matrix3<> rot = matrixFromEuler(quad.euler(o));
-		ScalarField Emolecule;
+	//Loop over batches of orientations:
+	for(int oBatchStart=oStart; oBatchStart<oStop; oBatchStart+=oBatchSize)
+	{	int oBatchStop = std::min(oBatchStart+oBatchSize, oStop);
+		std::vector<matrix3<>> rot = getRotations(oBatchStart, oBatchStop);
 		//Sum the potentials collected over sites for each orientation:
-		for(unsigned i=0; i<molecule.sites.size(); i++)
-			for(vector3<> pos: molecule.sites[i]->positions)
-				trans.taxpy(-(rot*pos), 1., Veff[i], Emolecule);
-		//Accumulate stats and cap:
-		Emean += quad.weight(o) * sum(Emolecule)/gInfo.nr;
-		double Emin_o, Emax_o;
-		callPref(eblas_capMinMax)(gInfo.nr, Emolecule->dataPref(), Emin_o, Emax_o, Elo, Ehi);
-		if(Emin_o<Emin) Emin=Emin_o;
-		if(Emax_o>Emax) Emax=Emax_o;
-		//Set contributions to the state (with appropriate scale factor):
-		initState_o(o, rot, scale, Emolecule, indep);
+		ScalarFieldArray Emolecule(oBatchStop-oBatchStart);
+		std::vector<TranslationOperator::Term> terms;
+		for(int o=oBatchStart; o<oBatchStop; o++)
+			for(unsigned i=0; i<molecule.sites.size(); i++)
+				for(vector3<> pos: molecule.sites[i]->positions)
+					terms.push_back(TranslationOperator::Term(-(rot[o-oBatchStart]*pos), 1., Veff[i], Emolecule[o-oBatchStart]));
+		trans.taxpy(terms);
+		for(int o=oBatchStart; o<oBatchStop; o++)
+		{	ScalarField& Eo = Emolecule[o-oBatchStart];
+			//Accumulate stats and cap:
+			Emean += quad.weight(o) * sum(Eo)/gInfo.nr;
+			double Emin_o, Emax_o;
+			callPref(eblas_capMinMax)(gInfo.nr, Eo->dataPref(), Emin_o, Emax_o, Elo, Ehi);
+			if(Emin_o<Emin) Emin=Emin_o;
+			if(Emax_o>Emax) Emax=Emax_o;
+			//Set contributions to the state (with appropriate scale factor):
+			initState_o(o, rot[o-oBatchStart], scale, Eo, indep);
+		}
 	}
 	//MPI collect:
 	for(int k=0; k<nIndep; k++) { nullToZero(indep[k],gInfo); indep[k]->allReduce(MPIUtil::ReduceSum); }
@@ -82,19 +108,26 @@ void IdealGasPomega::getDensities(const ScalarField* indep, ScalarField* N, vect
 	double& S = ((IdealGasPomega*)this)->S;
 	S=0.0;
 	VectorField P;
-	//Loop over orientations:
-	for(int o=oStart; o<oStop; o++)
-	{	matrix3<> rot = matrixFromEuler(quad.euler(o));
-		ScalarField logPomega_o; getDensities_o(o, rot, indep,logPomega_o);
-		ScalarField N_o = (quad.weight(o) * Nbulk) * exp(logPomega_o); //contribution form this orientation
-		//Accumulate N_o to each site density with appropriate translations:
-		for(unsigned i=0; i<molecule.sites.size(); i++)
-			for(vector3<> pos: molecule.sites[i]->positions)
-				trans.taxpy(rot*pos, 1., N_o, N[i]);
-		//Accumulate contributions to the entropy:
-		S += gInfo.dV*dot(N_o, logPomega_o);
-		//Accumulate the polarization density:
-		if(pMol.length_squared()) P += (rot * pMol) * N_o;
+	//Loop over batches of orientations:
+	for(int oBatchStart=oStart; oBatchStart<oStop; oBatchStart+=oBatchSize)
+	{	int oBatchStop = std::min(oBatchStart+oBatchSize, oStop);
+		std::vector<matrix3<>> rot = getRotations(oBatchStart, oBatchStop);
+		ScalarFieldArray logPomega_o(oBatchStop-oBatchStart); getDensities_batch(oBatchStart, oBatchStop, rot.data(), indep, logPomega_o.data());
+		ScalarFieldArray N_o(oBatchStop-oBatchStart);
+		std::vector<TranslationOperator::Term> terms;
+		for(int o=oBatchStart; o<oBatchStop; o++)
+		{	int b = o-oBatchStart; //index within batch
+			N_o[b] = (quad.weight(o) * Nbulk) * exp(logPomega_o[b]); //contribution form this orientation
+			//Accumulate N_o to each site density with appropriate translations (all applied together below):
+			for(unsigned i=0; i<molecule.sites.size(); i++)
+				for(vector3<> pos: molecule.sites[i]->positions)
+					terms.push_back(TranslationOperator::Term(rot[b]*pos, 1., N_o[b], N[i]));
+			//Accumulate contributions to the entropy:
+			S += gInfo.dV*dot(N_o[b], logPomega_o[b]);
+			//Accumulate the polarization density:
+			if(pMol.length_squared()) P += (rot[b] * pMol) * N_o[b];
+		}
+		trans.taxpy(terms);
 	}
 	//MPI collect:
 	for(unsigned i=0; i<molecule.sites.size(); i++) { nullToZero(N[i],gInfo); N[i]->allReduce(MPIUtil::ReduceSum); }
@@ -134,23 +167,32 @@ double IdealGasPomega::compute(const ScalarField* indep, const ScalarField* N, S
 
 void IdealGasPomega::convertGradients(const ScalarField* indep, const ScalarField* N, const ScalarField* Phi_N, const vector3<>& Phi_P0, ScalarField* Phi_indep, const double Nscale) const
 {	for(int k=0; k<nIndep; k++) Phi_indep[k]=0;
-	//Loop over orientations:
-	for(int o=oStart; o<oStop; o++)
-	{	matrix3<> rot = matrixFromEuler(quad.euler(o));
-		ScalarField logPomega_o; getDensities_o(o, rot, indep, logPomega_o);
-		ScalarField N_o = (quad.weight(o) * Nbulk * Nscale) * exp(logPomega_o);
-		ScalarField Phi_N_o; //gradient w.r.t N_o (as calculated in getDensities)
+	//Loop over batches of orientations:
+	for(int oBatchStart=oStart; oBatchStart<oStop; oBatchStart+=oBatchSize)
+	{	int oBatchStop = std::min(oBatchStart+oBatchSize, oStop);
+		std::vector<matrix3<>> rot = getRotations(oBatchStart, oBatchStop);
+		ScalarFieldArray logPomega_o(oBatchStop-oBatchStart); getDensities_batch(oBatchStart, oBatchStop, rot.data(), indep, logPomega_o.data());
+		ScalarFieldArray Phi_N_o(oBatchStop-oBatchStart); //gradient w.r.t N_o (as calculated in getDensities)
 		//Collect the contributions from each Phi_N in Phi_N_o
-		for(unsigned i=0; i<molecule.sites.size(); i++)
-			for(vector3<> pos: molecule.sites[i]->positions)
-				trans.taxpy(-rot*pos, 1., Phi_N[i], Phi_N_o);
-		//Collect the contributions from the entropy:
-		Phi_N_o += T*logPomega_o;
-		//Collect the contribution from Phi_P0 and Ecorr_P:
-		if(pMol.length_squared()) Phi_N_o += dot(rot * pMol, Nscale*Ecorr_P) + dot(rot * pMol, Phi_P0);
-		//Propagate Phi_N_o to Phi_logPomega_o and then to Phi_indep:
-		convertGradients_o(o, rot, N_o*Phi_N_o, Phi_indep);
+		std::vector<TranslationOperator::Term> terms;
+		for(int o=oBatchStart; o<oBatchStop; o++)
+			for(unsigned i=0; i<molecule.sites.size(); i++)
+				for(vector3<> pos: molecule.sites[i]->positions)
+					terms.push_back(TranslationOperator::Term(-rot[o-oBatchStart]*pos, 1., Phi_N[i], Phi_N_o[o-oBatchStart]));
+		trans.taxpy(terms);
+		ScalarFieldArray Phi_logPomega_o(oBatchStop-oBatchStart);
+		for(int o=oBatchStart; o<oBatchStop; o++)
+		{	int b = o-oBatchStart; //index within batch
+			ScalarField N_o = (quad.weight(o) * Nbulk * Nscale) * exp(logPomega_o[b]);
+			//Collect the contributions from the entropy:
+			Phi_N_o[b] += T*logPomega_o[b];
+			//Collect the contribution from Phi_P0 and Ecorr_P:
+			if(pMol.length_squared()) Phi_N_o[b] += dot(rot[b] * pMol, Nscale*Ecorr_P) + dot(rot[b] * pMol, Phi_P0);
+			//Propagate Phi_N_o to Phi_logPomega_o:
+			Phi_logPomega_o[b] = N_o*Phi_N_o[b];
+		}
+		//Propagate to Phi_indep:
+		convertGradients_batch(oBatchStart, oBatchStop, rot.data(), Phi_logPomega_o.data(), Phi_indep);
 	}
 	for(int k=0; k<nIndep; k++) { nullToZero(Phi_indep[k],gInfo); Phi_indep[k]->allReduce(MPIUtil::ReduceSum); }
 }
-
@@ -55,6 +55,15 @@ protected:
 	virtual void getDensities_o(int o, const matrix3<>& rot, const ScalarField* state, ScalarField& logPomega_o) const;
 	virtual void convertGradients_o(int o, const matrix3<>& rot, const ScalarField& Phi_logPomega_o, ScalarField* Phi_state) const;
 	
+	//These functions are called once for each batch of orientations oBatchStart <= o < oBatchStop, with rotations rot[o-oBatchStart],
+	//and with logPomega_o and Phi_logPomega_o similarly indexed; the default versions call the corresponding functions above for each o.
+	//Override these to combine all the translations of a batch into a single TranslationOperator::taxpy call:
+	virtual void getDensities_batch(int oBatchStart, int oBatchStop, const matrix3<>* rot, const ScalarField* state, ScalarField* logPomega_o) const;
+	virtual void convertGradients_batch(int oBatchStart, int oBatchStop, const matrix3<>* rot, const ScalarField* Phi_logPomega_o, ScalarField* Phi_state) const;
+	
+	static const int oBatchSize = 4; //!< number of orientations processed together (bounds the memory for the per-orientation fields of a batch)
+	std::vector<matrix3<>> getRotations(int oBatchStart, int oBatchStop) const; //!< rotation matrices for a batch of orientations
+	
 private:
 	double S; //!< cache the entropy, because it is most efficiently computed during getDensities()
 	double Ecorr; VectorField Ecorr_P; //!< cache the correlation correction and its derivatives, since they are most efficiently computed during getDensities()
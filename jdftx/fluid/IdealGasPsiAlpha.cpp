@@ -47,13 +47,27 @@ void IdealGasPsiAlpha::initState(const ScalarField* Vex, ScalarField* psi, doubl
 }
 
 void IdealGasPsiAlpha::getDensities_o(int o, const matrix3<>& rot, const ScalarField* psi, ScalarField& logPomega_o) const
-{	for(unsigned i=0; i<molecule.sites.size(); i++)
-		for(vector3<> pos: molecule.sites[i]->positions)
-			trans.taxpy(-rot*pos, 1., psi[i], logPomega_o);
+{	getDensities_batch(o, o+1, &rot, psi, &logPomega_o);
 }
 
 void IdealGasPsiAlpha::convertGradients_o(int o, const matrix3<>& rot, const ScalarField& Phi_logPomega_o, ScalarField* Phi_psi) const
-{	for(unsigned i=0; i<molecule.sites.size(); i++)
-		for(vector3<> pos: molecule.sites[i]->positions)
-			trans.taxpy(rot*pos, 1., Phi_logPomega_o, Phi_psi[i]);
+{	convertGradients_batch(o, o+1, &rot, &Phi_logPomega_o, Phi_psi);
+}
+
+void IdealGasPsiAlpha::getDensities_batch(int oBatchStart, int oBatchStop, const matrix3<>* rot, const ScalarField* psi, ScalarField* logPomega_o) const
+{	std::vector<TranslationOperator::Term> terms;
+	for(int o=oBatchStart; o<oBatchStop; o++)
+		for(unsigned i=0; i<molecule.sites.size(); i++)
+			for(vector3<> pos: molecule.sites[i]->positions)
+				terms.push_back(TranslationOperator::Term(-rot[o-oBatchStart]*pos, 1., psi[i], logPomega_o[o-oBatchStart]));
+	trans.taxpy(terms);
+}
+
+void IdealGasPsiAlpha::convertGradients_batch(int oBatchStart, int oBatchStop, const matrix3<>* rot, const ScalarField* Phi_logPomega_o, ScalarField* Phi_psi) const
+{	std::vector<TranslationOperator::Term> terms;
+	for(int o=oBatchStart; o<oBatchStop; o++)
+		for(unsigned i=0; i<molecule.sites.size(); i++)
+			for(vector3<> pos: molecule.sites[i]->positions)
+				terms.push_back(TranslationOperator::Term(rot[o-oBatchStart]*pos, 1., Phi_logPomega_o[o-oBatchStart], Phi_psi[i]));
+	trans.taxpy(terms);
 }
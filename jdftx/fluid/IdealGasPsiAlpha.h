@@ -40,6 +40,8 @@ protected:
 	void initState_o(int o, const matrix3<>& rot, double scale, const ScalarField& Eo, ScalarField* psi) const;
 	void getDensities_o(int o, const matrix3<>& rot, const ScalarField* psi, ScalarField& logPomega_o) const;
 	void convertGradients_o(int o, const matrix3<>& rot, const ScalarField& Phi_logPomega_o, ScalarField* Phi_psi) const;
+	void getDensities_batch(int oBatchStart, int oBatchStop, const matrix3<>* rot, const ScalarField* psi, ScalarField* logPomega_o) const;
+	void convertGradients_batch(int oBatchStart, int oBatchStop, const matrix3<>* rot, const ScalarField* Phi_logPomega_o, ScalarField* Phi_psi) const;
 };
 
 //! @}
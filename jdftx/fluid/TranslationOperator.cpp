@@ -26,6 +26,11 @@ TranslationOperator::TranslationOperator(const GridInfo& gInfo) : gInfo(gInfo)
 {
 }
 
+void TranslationOperator::taxpy(const std::vector<Term>& terms) const
+{	for(const Term& term: terms)
+		taxpy(term.t, term.alpha, *term.x, *term.y);
+}
+
 TranslationOperatorSpline::TranslationOperatorSpline(const GridInfo& gInfo, SplineType splineType)
 : TranslationOperator(gInfo), splineType(splineType)
 {
@@ -45,13 +50,10 @@ void constantSplineTaxpy_gpu(const vector3<int> S,
 void linearSplineTaxpy_gpu(const vector3<int> S,
 	double alpha, const double* x, double* y, const vector3<int> Tint, const vector3<> Tfrac);
 #endif
-void TranslationOperatorSpline::taxpy(const vector3<>& t, double alpha, const ScalarField& x, ScalarField& y) const
+void TranslationOperatorSpline::getOffsets(const vector3<>& t, vector3<int>& Tint, vector3<>& Tfrac) const
 {	//Perform a gather with the inverse translation (hence negate t),
 	//instead of scatter which is less efficient to parallelize
-	vector3<> Tfrac = Diag(gInfo.S) * inv(gInfo.R) * (-t); //now in grid point units
-	vector3<int> Tint;
-	//Prepare output:
-	nullToZero(y, gInfo);
+	Tfrac = Diag(gInfo.S) * inv(gInfo.R) * (-t); //now in grid point units
 	switch(splineType)
 	{	case Constant:
 		{	for(int k=0; k<3; k++)
@@ -61,12 +63,6 @@ void TranslationOperatorSpline::taxpy(const vector3<>& t, double alpha, const Sc
 				Tint[k] = Tint[k] % gInfo.S[k];
 				if(Tint[k]<0) Tint[k] += gInfo.S[k];
 			}
-			//Launch threads/gpu kernels:
-			#ifdef GPU_ENABLED
-			constantSplineTaxpy_gpu(gInfo.S, alpha*x->scale, x->dataGpu(false), y->dataGpu(), Tint);
-			#else
-			threadLaunch(constantSplineTaxpy_sub, gInfo.nr, gInfo.S, alpha*x->scale, x->data(false), y->data(), Tint);
-			#endif
 			break;
 		}
 		case Linear:
@@ -79,17 +75,74 @@ void TranslationOperatorSpline::taxpy(const vector3<>& t, double alpha, const Sc
 				Tfrac[k] -= Tint[k];
 				Tint[k] = Tint[k] % gInfo.S[k];
 			}
-			//Launch threads/gpu kernels:
+			break;
+		}
+	}
+}
+
+void TranslationOperatorSpline::taxpy(const vector3<>& t, double alpha, const ScalarField& x, ScalarField& y) const
+{	vector3<int> Tint; vector3<> Tfrac;
+	getOffsets(t, Tint, Tfrac);
+	//Prepare output:
+	nullToZero(y, gInfo);
+	//Launch threads/gpu kernels:
+	switch(splineType)
+	{	case Constant:
+			#ifdef GPU_ENABLED
+			constantSplineTaxpy_gpu(gInfo.S, alpha*x->scale, x->dataGpu(false), y->dataGpu(), Tint);
+			#else
+			threadLaunch(constantSplineTaxpy_sub, gInfo.nr, gInfo.S, alpha*x->scale, x->data(false), y->data(), Tint);
+			#endif
+			break;
+		case Linear:
 			#ifdef GPU_ENABLED
 			linearSplineTaxpy_gpu(gInfo.S, alpha*x->scale, x->dataGpu(false), y->dataGpu(), Tint, Tfrac);
 			#else
 			threadLaunch(linearSplineTaxpy_sub, gInfo.nr, gInfo.S, alpha*x->scale, x->data(false), y->data(), Tint, Tfrac);
 			#endif
 			break;
-		}
 	}
 }
 
+//Term of a batched spline translation with offsets and data pointers resolved
+struct SplineTaxpyTerm
+{	double alpha; const double* x; double* y;
+	vector3<int> Tint; vector3<> Tfrac;
+};
+inline void splineTaxpyTile(size_t iStart, size_t iStop, const vector3<int>& S, bool linear, const SplineTaxpyTerm& term)
+{	if(linear) { THREAD_rLoop(linearSplineTaxpy_calc(i, iv, S, term.alpha, term.x, term.y, term.Tint, term.Tfrac);) }
+	else { THREAD_rLoop(constantSplineTaxpy_calc(i, iv, S, term.alpha, term.x, term.y, term.Tint);) }
+}
+void splineTaxpyBatch_sub(size_t iStart, size_t iStop, const vector3<int> S, bool linear, const SplineTaxpyTerm* terms, size_t nTerms)
+{	const size_t tileSize = 4096; //grid points per tile (32 kB per field), so that the output tiles of a batch stay in cache
+	for(size_t iTileStart=iStart; iTileStart<iStop; iTileStart+=tileSize)
+	{	size_t iTileStop = std::min(iTileStart+tileSize, iStop);
+		for(size_t k=0; k<nTerms; k++)
+			splineTaxpyTile(iTileStart, iTileStop, S, linear, terms[k]);
+	}
+}
+
+void TranslationOperatorSpline::taxpy(const std::vector<Term>& terms) const
+{
+	#ifdef GPU_ENABLED
+	TranslationOperator::taxpy(terms);
+	#else
+	static StopWatch watch("TranslationOperatorSpline::taxpyBatch"); watch.start();
+	std::vector<SplineTaxpyTerm> splineTerms(terms.size());
+	for(size_t k=0; k<terms.size(); k++)
+	{	const Term& term = terms[k];
+		SplineTaxpyTerm& splineTerm = splineTerms[k];
+		getOffsets(term.t, splineTerm.Tint, splineTerm.Tfrac);
+		nullToZero(*term.y, gInfo);
+		splineTerm.alpha = term.alpha * (*term.x)->scale;
+		splineTerm.x = (*term.x)->data(false);
+		splineTerm.y = (*term.y)->data();
+	}
+	threadLaunch(splineTaxpyBatch_sub, gInfo.nr, gInfo.S, splineType==Linear, splineTerms.data(), splineTerms.size());
+	watch.stop();
+	#endif
+}
+
 TranslationOperatorFourier::TranslationOperatorFourier(const GridInfo& gInfo)
 : TranslationOperator(gInfo)
 {
@@ -41,6 +41,20 @@ public:
 	//! T must conserve integral(x) and satisfy @f$ T^{\dagger}_t = T_{-t} @f$ exactly for gradient correctness
 	//! Note that @f$ T^{-1}_t = T_{-t} @f$ may only be approximately true for some implementations.
 	virtual void taxpy(const vector3<>& t, double alpha, const ScalarField& x, ScalarField& y) const=0;
+	
+	//! One term @f$ y += alpha T_t(x) @f$ of a batch of translations
+	struct Term
+	{	vector3<> t; //!< translation
+		double alpha; //!< scale factor
+		const ScalarField* x; //!< input
+		ScalarField* y; //!< output (accumulated)
+		Term(const vector3<>& t, double alpha, const ScalarField& x, ScalarField& y) : t(t), alpha(alpha), x(&x), y(&y) {}
+	};
+	
+	//! Accumulate a batch of translations, which may share inputs and outputs (but no output may also be an input).
+	//! The default implementation calls taxpy for each term in turn; derived classes may evaluate all the terms
+	//! in fewer passes over memory (see TranslationOperatorSpline).
+	virtual void taxpy(const std::vector<Term>& terms) const;
 };
 
 //! Translation operator which works in real space using interpolating splines
@@ -55,6 +69,14 @@ public:
 
 	TranslationOperatorSpline(const GridInfo& gInfo, SplineType splineType);
 	void taxpy(const vector3<>& t, double alpha, const ScalarField& x, ScalarField& y) const;
+	
+	//! Apply all terms to one cache-sized tile of the grid at a time, so that each output accumulating several terms
+	//! is streamed from memory once per batch instead of once per term (CPU only; the GPU version loops over terms)
+	void taxpy(const std::vector<Term>& terms) const;
+
+private:
+	//! Get the integer and fractional offsets in grid units for the gather that implements translation by t
+	void getOffsets(const vector3<>& t, vector3<int>& Tint, vector3<>& Tfrac) const;
 };
 
 //! The exact translation operator in PW basis, although much slower and with potential ringing issues
@@ -63,6 +85,7 @@ class TranslationOperatorFourier : public TranslationOperator
 public:
 	TranslationOperatorFourier(const GridInfo& gInfo);
 	void taxpy(const vector3<>& t, double alpha, const ScalarField& x, ScalarField& y) const;
+	using TranslationOperator::taxpy;
 };
 
 //! @}
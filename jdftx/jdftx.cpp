@@ -92,6 +92,7 @@ int main(int argc, char** argv)
 
 	//Final dump:
 	e.dump(DumpFreq_End, 0);
+	e.iInfo.projectorCache.printStats();
 	
 	finalizeSystem();
 	return 0;
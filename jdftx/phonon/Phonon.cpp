@@ -31,7 +31,7 @@ void Phonon::dump()
 	unsigned iPertStart = (iPerturbation>=0) ? iPerturbation : 0;
 	unsigned iPertStop  = (iPerturbation>=0) ? iPerturbation+1 : perturbations.size();
 	std::vector<int> nStatesPert(perturbations.size());
-	for(unsigned iPert=iPertStart; iPert<iPertStop; iPert++)
+	auto runPerturbation = [&](unsigned iPert)
 	{	logPrintf("########### Perturbed supercell calculation %u of %d #############\n", iPert+1, int(perturbations.size()));
 		ostringstream oss; oss << "phonon." << iPert+1 << ".$@#!"; //placeholder for $VAR
 		string fnamePattern = e.dump.getFilename(oss.str()); //(because dump variable name cannot contain $VAR)
@@ -39,7 +39,19 @@ void Phonon::dump()
 		processPerturbation(perturbations[iPert], fnamePattern);
 		nStatesPert[iPert] = eSup->eInfo.nStates;
 		logPrintf("\n"); logFlush();
+	};
+	if(linearResponse && dryRun)
+	{	logPrintf("\nLinear-response calculation of %d modes at %d wavevectors (skipped in dry run).\n", int(modes.size()), prodSup);
+		return;
 	}
+	int nGroupsEff = std::min(nGroups, mpiUtil->nProcesses());
+	if(linearResponse)
+		processLinearResponse();
+	else if(nGroupsEff>1 && iPerturbation<0 && !dryRun)
+		processPerturbationsConcurrent(runPerturbation, nGroupsEff);
+	else
+		for(unsigned iPert=iPertStart; iPert<iPertStop; iPert++)
+			runPerturbation(iPert);
 	if(dryRun)
 	{	logPrintf("\nParameter summary for supercell calculations:\n");
 		for(unsigned iPert=iPertStart; iPert<iPertStop; iPert++)
@@ -381,3 +393,51 @@ void Phonon::forceMatrixEnforceSumRule(std::vector<matrix>& omegaSq, const std::
 	}
 	logPrintf("\tCorrected translational invariance relative error: %lg\n", nrm2(dF0)/nrm2(F0));
 }
+
+void Phonon::processPerturbationsConcurrent(std::function<void(unsigned)> runPerturbation, int nGroupsEff)
+{	//Split processes into groups:
+	MPIUtil* mpiUtilAll = mpiUtil;
+	int iGroup = (mpiUtilAll->iProcess() * nGroupsEff) / mpiUtilAll->nProcesses();
+	MPIUtil* mpiUtilGroup = new MPIUtil(mpiUtilAll, iGroup, mpiUtilAll->iProcess());
+	logPrintf("Processing %d perturbations concurrently in %d groups of processes (output below only from group 1).\n\n",
+		int(perturbations.size()), nGroupsEff);
+	logFlush();
+	
+	//Claim and run perturbations dynamically within each group:
+	std::vector<int> pertGroup(perturbations.size(), 0); //1-based group that processed each perturbation
+	{	TaskQueue queue(perturbations.size(), mpiUtilAll, mpiUtilGroup);
+		mpiUtil = mpiUtilGroup; //each supercell calculation is parallelized only within the group
+		size_t iPert;
+		while(queue.next(iPert))
+		{	runPerturbation(iPert);
+			if(mpiUtil->isHead()) pertGroup[iPert] = iGroup+1;
+		}
+		eSup.reset(); //free last supercell calculation of this group
+		mpiUtil = mpiUtilAll;
+	}
+	
+	//Collect results from the head of each group:
+	bool isGroupHead = mpiUtilGroup->isHead();
+	delete mpiUtilGroup;
+	int nBandsSup = e.eInfo.nBands * prodSup;
+	for(size_t iMode=0; iMode<modes.size(); iMode++)
+	{	if(!isGroupHead) dgrad[iMode] *= 0.; //avoid multiple counting from other processes of each group
+		for(std::vector<vector3<>>& dgradSp: dgrad[iMode])
+			mpiUtil->allReduce((double*)dgradSp.data(), 3*dgradSp.size(), MPIUtil::ReduceSum);
+		for(matrix& M: dHsub[iMode])
+		{	if(!M || !isGroupHead) M = zeroes(nBandsSup, nBandsSup); //not accumulated on this process
+			M.allReduce(MPIUtil::ReduceSum);
+		}
+	}
+	mpiUtil->allReduce(pertGroup.data(), pertGroup.size(), MPIUtil::ReduceSum);
+	logPrintf("Perturbations processed by each group:\n");
+	for(int jGroup=1; jGroup<=nGroupsEff; jGroup++)
+	{	logPrintf("\tGroup %d:", jGroup);
+		for(size_t iPert=0; iPert<perturbations.size(); iPert++)
+			if(pertGroup[iPert]==jGroup)
+				logPrintf(" %lu", iPert+1);
+		logPrintf("\n");
+	}
+	logPrintf("\n"); logFlush();
+}
+
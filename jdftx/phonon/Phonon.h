@@ -23,6 +23,7 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 #include <electronic/Everything.h>
 #include <electronic/ColumnBundle.h>
 #include <core/LatticeUtils.h>
+#include <functional>
 
 //! @addtogroup Output
 //! @{
@@ -62,6 +63,9 @@ public:
 	
 	int iPerturbation; //!< if >=0, only run one supercell calculation
 	bool collectPerturbations; //!< if true, collect results of previously computed perturbations (skips supercell SCF/Minimize)
+	int nGroups; //!< number of process groups that run supercell calculations concurrently (1 => run each over all processes in turn)
+	bool linearResponse; //!< if true, compute dgrad and dHsub by linear response in the unit cell instead of supercell calculations
+	double responseThreshold; //!< relative residual threshold for the self-consistent linear response
 	
 	Phonon();
 	void setup(bool printDefaults); //!< setup unit cell and basis modes for perturbations
@@ -99,6 +103,14 @@ private:
 	//!Run supercell calculation for specified perturbation (using fnamePattern to load/restore required properties)
 	void processPerturbation(const Perturbation& pert, string fnamePattern);
 	
+	//!Run all perturbations with runPerturbation, distributed dynamically over nGroupsEff groups of processes,
+	//!and collect dgrad and dHsub from all groups at the end
+	void processPerturbationsConcurrent(std::function<void(unsigned)> runPerturbation, int nGroupsEff);
+	
+	//!Compute dgrad and dHsub using density-functional perturbation theory at each wavevector commensurate with the supercell
+	//!(alternative to the supercell calculations of processPerturbation, implemented in Phonon_dfpt.cpp)
+	void processLinearResponse();
+	
 	//!Set unperturbed state of supercell from unit cell and retrieve unperturbed subspace Hamiltonian at supercell Gamma point (for all bands)
 	std::vector<diagMatrix> setSupState();
 	
@@ -0,0 +1,638 @@
+/*-------------------------------------------------------------------
+Copyright 2026 agent
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#include <phonon/Phonon.h>
+#include <electronic/ColumnBundleTransform.h>
+#include <core/LoopMacros.h>
+#include <core/VectorField.h>
+#include <core/ScalarFieldIO.h>
+#include <core/Pulay.h>
+
+//-------------------- Unperturbed states and operators at arbitrary k --------------------
+
+//Unit cell Bloch states at an arbitrary (unreduced) k-point, unfolded from the symmetry-reduced states,
+//along with the nonlocal projectors of each species at that k-point
+struct ResponseState
+{	Basis basis;
+	QuantumNumber qnum;
+	ColumnBundle C; //first nBands wavefunctions
+	diagMatrix eig; //corresponding eigenvalues
+	std::vector<std::shared_ptr<ColumnBundle>> V; //nonlocal projectors of all atoms of each species (null for purely local species)
+	std::vector<matrix> M; //corresponding nonlocal matrices (block diagonal over atoms)
+	std::vector<int> nProj; //number of projectors per atom for each species
+	
+	ResponseState(const Everything& e, vector3<> k, int nBands)
+	{	//Find equivalent point on the unit cell k-mesh:
+		const Supercell& supercell = *(e.coulombParams.supercell);
+		size_t ik = 0;
+		for(ik=0; ik<supercell.kmesh.size(); ik++)
+			if(circDistanceSquared(supercell.kmesh[ik], k) < symmThresholdSq)
+				break;
+		assert(ik < supercell.kmesh.size());
+		const Supercell::KmeshTransform& kTransform = supercell.kmeshTransform[ik];
+		const ColumnBundle& Cred = e.eVars.C[kTransform.iReduced];
+		//Setup basis and quantum number:
+		logSuspend();
+		basis.setup(e.gInfo, e.iInfo, e.cntrl.Ecut, k);
+		logResume();
+		qnum.k = k;
+		qnum.spin = 0;
+		qnum.weight = e.eInfo.spinWeight / double(supercell.kmesh.size());
+		//Transform wavefunctions (same gauge as the supercell states of the frozen-phonon method):
+		C.init(nBands, basis.nbasis, &basis, &qnum, isGpuEnabled());
+		C.zero();
+		ColumnBundleTransform(Cred.qnum->k, *(Cred.basis), k, basis, 1, e.symm.getMatrices()[kTransform.iSym], kTransform.invert)
+			.scatterAxpy(1., Cred.getSub(0,nBands), C, 0, 1);
+		eig = e.eVars.Hsub_eigs[kTransform.iReduced](0,nBands);
+		//Nonlocal projectors:
+		for(const auto& sp: e.iInfo.species)
+		{	matrix Msp;
+			V.push_back(sp->getV(C, &Msp));
+			M.push_back(Msp);
+			nProj.push_back(sp->atpos.size() ? Msp.nRows()/sp->atpos.size() : 0);
+		}
+	}
+	ResponseState(const ResponseState&)=delete;
+	ResponseState& operator=(const ResponseState&)=delete;
+};
+typedef std::vector<std::shared_ptr<ResponseState>> ResponseStateArray;
+
+//Apply the unperturbed Hamiltonian at state s to X (norm-conserving, semilocal functionals only)
+ColumnBundle applyH(const Everything& e, const ResponseState& s, const ColumnBundle& X)
+{	ColumnBundle HX = Idag_DiagV_I(X, e.eVars.Vscloc);
+	HX += (-0.5) * L(X);
+	for(size_t sp=0; sp<s.V.size(); sp++)
+		if(s.V[sp])
+			HX += (*s.V[sp]) * (s.M[sp] * ((*s.V[sp]) ^ X));
+	return HX;
+}
+
+//Project out occupied states C (at the same k as Y) from Y
+void projectConduction(const ColumnBundle& C, ColumnBundle& Y)
+{	matrix CdagOY = C ^ Y;
+	CdagOY *= C.basis->gInfo->detR;
+	Y -= C * CdagOY;
+}
+
+void applyLocalPerturbation_sub(int colStart, int colStop, const ColumnBundle* C, const complexScalarField* dVscaled, ColumnBundle* out)
+{	for(int col=colStart; col<colStop; col++)
+		out->accumColumn(col,0, Idag((*dVscaled) * I(C->getColumn(col,0))));
+}
+
+//Apply the perturbation due to displacing atom 'at' of species 'sp' along Cartesian direction iDir (modulated by exp(i q.R)
+//over unit cells R) to the wavefunctions of sIn at k, resulting in wavefunctions in the basis of sOut at k+q.
+//dVscaled is the periodic part of the corresponding total local potential change (including the dV factor, as in Vscloc).
+ColumnBundle applyPerturbation(const ResponseState& sIn, const ResponseState& sOut, const complexScalarField& dVscaled, int sp, int at, int iDir)
+{	const ColumnBundle& C = sIn.C;
+	ColumnBundle out(C.nCols(), sOut.basis.nbasis, &sOut.basis, &sOut.qnum, isGpuEnabled());
+	out.zero();
+	threadLaunch(isGpuEnabled() ? 1 : 0, applyLocalPerturbation_sub, C.nCols(), &C, &dVscaled, &out);
+	//Nonlocal part: derivative of V M V^ w.r.t atom position (= -gradient of projectors)
+	if(sIn.V[sp])
+	{	int nProj = sIn.nProj[sp];
+		matrix Mat = sIn.M[sp](at*nProj,(at+1)*nProj, at*nProj,(at+1)*nProj);
+		ColumnBundle Vin = sIn.V[sp]->getSub(at*nProj, (at+1)*nProj);
+		ColumnBundle Vout = sOut.V[sp]->getSub(at*nProj, (at+1)*nProj);
+		out += Vout * (Mat * (Vin ^ D(C, iDir)));
+		out -= D(Vout * (Mat * (Vin ^ C)), iDir);
+	}
+	return out;
+}
+
+//Solve the Sternheimer equation P(H - eig O)P dC = -P dVC for the first-order wavefunctions at k+q in-place (starting from the input dC),
+//where P projects out the occupied states at k+q, using band-by-band preconditioned conjugate gradients.
+//Returns the number of iterations required to reduce the residual of each band by tol relative to the right hand side
+//(nIterationsSternheimer if not converged).
+static const int nIterationsSternheimer = 100;
+int solveSternheimer(const Everything& e, const ResponseState& sK, const ResponseState& sKQ, const diagMatrix& KEref,
+	const ColumnBundle& dVC, ColumnBundle& dC, double tol)
+{	const double detR = e.gInfo.detR;
+	int nCols = dVC.nCols();
+	auto applyA = [&](const ColumnBundle& X)
+	{	ColumnBundle AX = applyH(e, sKQ, X);
+		AX -= (detR * X) * sK.eig;
+		projectConduction(sKQ.C, AX);
+		return AX;
+	};
+	auto precondition = [&](const ColumnBundle& r)
+	{	ColumnBundle z = clone(r);
+		precond_inv_kinetic_band(z, KEref);
+		projectConduction(sKQ.C, z);
+		return z;
+	};
+	//Initial residual:
+	ColumnBundle r = (-1.) * dVC;
+	projectConduction(sKQ.C, r);
+	diagMatrix rhsNormSq = diagDot(r, r);
+	r -= applyA(dC);
+	ColumnBundle z = precondition(r), p = clone(z);
+	diagMatrix rz = diagDot(r, z);
+	int iter = 0;
+	for(iter=0; iter<nIterationsSternheimer; iter++)
+	{	//Check convergence:
+		diagMatrix rNormSq = diagDot(r, r);
+		bool converged = true;
+		for(int b=0; b<nCols; b++)
+			if(rNormSq[b] > tol*tol*rhsNormSq[b])
+				converged = false;
+		if(converged) break;
+		//Step along search direction:
+		ColumnBundle Ap = applyA(p);
+		diagMatrix pAp = diagDot(p, Ap), alpha(nCols);
+		for(int b=0; b<nCols; b++)
+			alpha[b] = pAp[b] ? rz[b]/pAp[b] : 0.;
+		dC += p * alpha;
+		r -= Ap * alpha;
+		//Update search direction:
+		z = precondition(r);
+		diagMatrix rzNew = diagDot(r, z), beta(nCols);
+		for(int b=0; b<nCols; b++)
+			beta[b] = rz[b] ? rzNew[b]/rz[b] : 0.;
+		rz = rzNew;
+		p = p * beta;
+		p += z;
+	}
+	return iter;
+}
+
+//-------------------- Local potential perturbations and response kernel --------------------
+
+//Periodic part (in reciprocal space) of the local pseudopotential change per unit displacement (modulated by exp(i q.R))
+//of an atom at lattice coordinates x, along each Cartesian direction (including the long-range point-charge part)
+void localPerturbation_sub(size_t iStart, size_t iStop, const vector3<int> S, const matrix3<> G, const vector3<> q, const vector3<> x,
+	const RadialFunctionG* VlocRadial, double Z, double invVol, complex* dV0, complex* dV1, complex* dV2)
+{	THREAD_fullGspaceLoop
+	(	vector3<> qG = q + iG;
+		vector3<> qGcart = qG * G;
+		double qGlen = qGcart.length();
+		complex prefac = 0.;
+		if(qGlen > 1e-8)
+		{	double Vq = (*VlocRadial)(qGlen) - 4*M_PI*Z/(qGlen*qGlen);
+			prefac = complex(0,-invVol*Vq) * cis(-2*M_PI*dot(qG, x));
+		}
+		dV0[i] = prefac * qGcart[0];
+		dV1[i] = prefac * qGcart[1];
+		dV2[i] = prefac * qGcart[2];
+	)
+}
+
+void hartreeKernel_sub(size_t iStart, size_t iStop, const vector3<int> S, const matrix3<> GGT, const vector3<> q, complex* data)
+{	THREAD_fullGspaceLoop
+	(	double qGsq = GGT.metric_length_squared(q + iG);
+		data[i] *= (qGsq > 1e-12) ? (4*M_PI)/qGsq : 0.;
+	)
+}
+
+void blochD_sub(size_t iStart, size_t iStop, const vector3<int> S, const matrix3<> G, const vector3<> q, int iDir, const complex* in, complex* out)
+{	THREAD_fullGspaceLoop
+	(	out[i] = in[i] * complex(0, ((q + iG) * G)[iDir]);
+	)
+}
+
+//Cartesian gradient along iDir of a field with Bloch wave-vector q, in terms of its periodic part X
+complexScalarFieldTilde blochD(const complexScalarFieldTilde& X, vector3<> q, int iDir)
+{	const GridInfo& gInfo = X->gInfo;
+	complexScalarFieldTilde out; nullToZero(out, gInfo);
+	threadLaunch(blochD_sub, gInfo.nr, gInfo.S, gInfo.G, q, iDir, X->data(), out->data());
+	return out;
+}
+
+//Hartree and exchange-correlation kernel for Bloch-periodic density changes (spin-unpolarized LDAs and GGAs)
+struct ResponseKernel
+{	const Everything& e;
+	ScalarField e_nn, e_sigma, e_nsigma, e_sigmasigma; //second derivatives of the XC energy density
+	VectorField Dn; //density gradient (GGAs only)
+	
+	ResponseKernel(const Everything& e) : e(e)
+	{	e.exCorr.getSecondDerivatives(e.eVars.n[0], e_nn, e_sigma, e_nsigma, e_sigmasigma);
+		if(e_sigma) Dn = gradient(e.eVars.n[0]);
+	}
+	
+	//Return the periodic part of the Hxc potential change (in reciprocal space) due to a density change
+	//with Bloch wave-vector q and periodic part dn (in real space)
+	complexScalarFieldTilde operator()(const complexScalarField& dn, vector3<> q) const
+	{	const GridInfo& gInfo = e.gInfo;
+		complexScalarFieldTilde dnTilde = J(dn);
+		//Hartree:
+		complexScalarFieldTilde dV = clone(dnTilde);
+		threadLaunch(hartreeKernel_sub, gInfo.nr, gInfo.S, gInfo.GGT, q, dV->data());
+		//Exchange-correlation (see exCorr_thread in Polarizability.cpp):
+		complexScalarField KV = e_nn * dn;
+		if(e_sigma)
+		{	complexScalarField DV[3];
+			for(int j=0; j<3; j++) DV[j] = I(blochD(dnTilde, q, j));
+			complexScalarField DnDV = 2. * (Dn[0]*DV[0] + Dn[1]*DV[1] + Dn[2]*DV[2]);
+			KV += e_nsigma * DnDV;
+			complexScalarField DnTerm = e_nsigma*dn + e_sigmasigma*DnDV;
+			for(int j=0; j<3; j++)
+				dV -= 2. * blochD(J(Dn[j]*DnTerm + e_sigma*DV[j]), q, j);
+		}
+		dV += J(KV);
+		return dV;
+	}
+};
+
+//-------------------- Self-consistent response at one wavevector --------------------
+
+//Self-consistent linear response of the unit cell to atom displacements modulated with wavevector q,
+//with Pulay mixing of the periodic part of the Hxc potential change
+class PhononResponse : public Pulay<complexScalarFieldTilde>
+{
+public:
+	complexScalarField dVscf; //periodic part of total local potential change (real space) corresponding to dC and dn
+	complexScalarField dn; //periodic part of electron density change
+	std::vector<ColumnBundle> dC; //first-order wavefunctions at k+q for each local k
+	
+	PhononResponse(const Everything& e, const PulayParams& pp, vector3<> q, const ResponseStateArray& statesK, const ResponseStateArray& statesKQ,
+		const ResponseKernel& kernel, const std::vector<int>& modeStart, double threshold)
+	: Pulay<complexScalarFieldTilde>(pp), e(e), q(q), statesK(statesK), statesKQ(statesKQ), kernel(kernel), modeStart(modeStart),
+		threshold(threshold), mixFraction(pp.mixFraction)
+	{	for(const auto& sK: statesK)
+			KEref.push_back((-0.5) * diagDot(sK->C, L(sK->C)));
+		dC.resize(statesK.size());
+	}
+	
+	//Solve for the response to displacing atom 'at' of species 'sp' along Cartesian direction iDir,
+	//whose bare local potential change has periodic part dVext (in reciprocal space)
+	void solve(int sp, int at, int iDir, const complexScalarFieldTilde& dVext)
+	{	this->sp = sp; this->at = at; this->iDir = iDir;
+		this->dVext = dVext;
+		dVextNorm = nrm2(dVext);
+		dVhxc = 0; nullToZero(dVhxc, e.gInfo);
+		for(size_t j=0; j<dC.size(); j++)
+		{	dC[j] = statesKQ[j]->C.similar();
+			dC[j].zero();
+		}
+		relResidual = 1.;
+		clearState();
+		minimize();
+	}
+	
+	//Contributions to the column of the dynamical matrix at q corresponding to the current perturbation that are first order
+	//in the response (second-order same-atom terms are q-independent and computed separately), given bare local potential
+	//changes dVextAll for all modes (periodic parts in real space)
+	matrix getForceMatrixColumn(const std::vector<complexScalarField>& dVextAll) const
+	{	int nModes = dVextAll.size();
+		matrix Dcol = zeroes(nModes, 1);
+		complex* DcolData = Dcol.data();
+		//Nonlocal contributions:
+		for(size_t j=0; j<statesK.size(); j++)
+		{	const ResponseState& sK = *statesK[j];
+			const ResponseState& sKQ = *statesKQ[j];
+			ColumnBundle DC[3], DdC[3];
+			for(int iDir2=0; iDir2<3; iDir2++)
+			{	DC[iDir2] = D(sK.C, iDir2);
+				DdC[iDir2] = D(dC[j], iDir2);
+			}
+			for(size_t sp2=0; sp2<sK.V.size(); sp2++) if(sK.V[sp2])
+			{	int nProj = sK.nProj[sp2];
+				int nAtoms = sK.M[sp2].nRows() / nProj;
+				matrix P = (*sK.V[sp2]) ^ sK.C, Q = (*sKQ.V[sp2]) ^ dC[j];
+				matrix Pd[3], Qd[3];
+				for(int iDir2=0; iDir2<3; iDir2++)
+				{	Pd[iDir2] = (*sK.V[sp2]) ^ DC[iDir2];
+					Qd[iDir2] = (*sKQ.V[sp2]) ^ DdC[iDir2];
+				}
+				int nCols = P.nCols();
+				for(int at2=0; at2<nAtoms; at2++)
+				{	int pStart = at2*nProj, pStop = (at2+1)*nProj;
+					matrix Mat = sK.M[sp2](pStart,pStop, pStart,pStop);
+					matrix MQ = Mat * Q(pStart,pStop, 0,nCols);
+					matrix P_at = P(pStart,pStop, 0,nCols);
+					for(int iDir2=0; iDir2<3; iDir2++)
+						DcolData[modeStart[sp2] + 3*at2 + iDir2] += (2.*sK.qnum.weight) * trace(
+							dagger(Pd[iDir2](pStart,pStop, 0,nCols)) * MQ
+							+ dagger(P_at) * Mat * Qd[iDir2](pStart,pStop, 0,nCols) );
+				}
+			}
+		}
+		Dcol.allReduce(MPIUtil::ReduceSum);
+		//Local contributions:
+		for(int iMode2=0; iMode2<nModes; iMode2++)
+			DcolData[iMode2] += e.gInfo.dV * ::dot(dVextAll[iMode2], dn);
+		return Dcol;
+	}
+
+protected:
+	//Interface for Pulay<complexScalarFieldTilde>:
+	double cycle(double dEprev, std::vector<double>& extraValues)
+	{	//Total local potential change:
+		complexScalarField dVextR = I(dVext);
+		dVscf = dVextR + I(dVhxc);
+		complexScalarField dVscaled = JdagOJ(dVscf);
+		//Solve Sternheimer equations (with tolerance adapted to current self-consistency error) and accumulate density change:
+		double tol = std::min(1e-2, std::max(0.1*threshold, 0.1*relResidual));
+		dn = 0; nullToZero(dn, e.gInfo);
+		int nUnconverged = 0;
+		for(size_t j=0; j<statesK.size(); j++)
+		{	const ResponseState& sK = *statesK[j];
+			const ResponseState& sKQ = *statesKQ[j];
+			ColumnBundle dVC = applyPerturbation(sK, sKQ, dVscaled, sp, at, iDir);
+			if(solveSternheimer(e, sK, sKQ, KEref[j], dVC, dC[j], tol) == nIterationsSternheimer)
+				nUnconverged++;
+			for(int b=0; b<sK.C.nCols(); b++)
+				dn += (2.*sK.qnum.weight) * (conj(I(sK.C.getColumn(b,0))) * I(dC[j].getColumn(b,0)));
+		}
+		dn->allReduce(MPIUtil::ReduceSum);
+		mpiUtil->allReduce(nUnconverged, MPIUtil::ReduceSum);
+		if(nUnconverged)
+			logPrintf("WARNING: Sternheimer solve did not converge within threshold in %d iterations for %d states.\n",
+				nIterationsSternheimer, nUnconverged);
+		//Update Hxc potential change:
+		complexScalarFieldTilde dVhxcOut = kernel(dn, q);
+		relResidual = nrm2(dVhxcOut - dVhxc) / dVextNorm;
+		dVhxc = dVhxcOut;
+		//Report local electronic contribution to diagonal force matrix element as the 'energy':
+		return e.gInfo.dV * ::dot(dVextR, dn).real();
+	}
+	void axpy(double alpha, const complexScalarFieldTilde& X, complexScalarFieldTilde& Y) const { ::axpy(alpha, X, Y); }
+	double dot(const complexScalarFieldTilde& X, const complexScalarFieldTilde& Y) const { return ::dot(X, Y).real(); }
+	size_t variableSize() const { return e.gInfo.nr * sizeof(complex); }
+	void readVariable(complexScalarFieldTilde& X, FILE* fp) const { nullToZero(X, e.gInfo); loadRawBinary(X, fp); }
+	void writeVariable(const complexScalarFieldTilde& X, FILE* fp) const { saveRawBinary(X, fp); }
+	complexScalarFieldTilde getVariable() const { return clone(dVhxc); }
+	void setVariable(const complexScalarFieldTilde& X) { dVhxc = clone(X); }
+	complexScalarFieldTilde precondition(const complexScalarFieldTilde& X) const { return mixFraction * X; }
+	complexScalarFieldTilde applyMetric(const complexScalarFieldTilde& X) const { return X; }
+
+private:
+	const Everything& e;
+	vector3<> q;
+	const ResponseStateArray& statesK; //unperturbed states at local k
+	const ResponseStateArray& statesKQ; //unperturbed states at corresponding k+q
+	const ResponseKernel& kernel;
+	const std::vector<int>& modeStart; //index of first mode of each species
+	double threshold; //relative residual threshold for self-consistency
+	double mixFraction;
+	std::vector<diagMatrix> KEref; //kinetic energy references for Sternheimer preconditioner
+	
+	int sp, at, iDir; //current perturbation
+	complexScalarFieldTilde dVext; //bare local potential change of current perturbation
+	double dVextNorm;
+	complexScalarFieldTilde dVhxc; //input Hxc potential change of current cycle
+	double relResidual; //self-consistency error of previous cycle relative to dVext
+};
+
+//-------------------- Phonon driver --------------------
+
+void Phonon::processLinearResponse()
+{	static StopWatch watch("phonon::linearResponse"); watch.start();
+	
+	//Check for supported features:
+	if(e.eInfo.spinType != SpinNone)
+		die("Linear-response phonons currently support only spin-unpolarized calculations.\n");
+	for(const auto& sp: e.iInfo.species)
+		if(sp->isUltrasoft())
+			die("Linear-response phonons currently require norm-conserving pseudopotentials.\n");
+	if(e.iInfo.nCore)
+		die("Linear-response phonons do not yet support partial core corrections.\n");
+	if(e.coulombParams.geometry != CoulombParams::Periodic)
+		die("Linear-response phonons currently require periodic Coulomb interactions.\n");
+	if(e.eVars.fluidParams.fluidType != FluidNone)
+		die("Linear-response phonons do not yet support fluids.\n");
+	if(e.exCorr.exxFactor() || e.exCorr.needsKEdensity() || e.exCorr.orbitalDep || e.eInfo.hasU)
+		die("Linear-response phonons currently support only LDA and GGA functionals (no exact exchange, meta-GGA, orbital-dependent or +U).\n");
+	if(e.iInfo.vdWenable)
+		die("Linear-response phonons do not yet support pair-potential dispersion corrections.\n");
+	int nOcc = 0;
+	for(int q=0; q<e.eInfo.nStates; q++)
+	{	int nOccCur = 0;
+		for(double F: e.eVars.F[q])
+		{	if(F > 1e-6 && F < 1.-1e-6)
+				die("Linear-response phonons currently require integer fillings (insulators).\n");
+			if(F > 0.5) nOccCur++;
+		}
+		if(q && nOccCur!=nOcc)
+			die("Linear-response phonons require the same number of occupied bands at all k-points (insulators).\n");
+		nOcc = nOccCur;
+	}
+	
+	const Supercell& supercell = *(e.coulombParams.supercell);
+	const std::vector<vector3<>>& kmesh = supercell.kmesh;
+	int nModes = modes.size();
+	int nBands = e.eInfo.nBands;
+	logPrintf("\n------- Linear-response phonons: %d modes, %d occupied bands -------\n", nModes, nOcc); logFlush();
+	
+	//Species properties for the local perturbations:
+	std::vector<const RadialFunctionG*> VlocRadial;
+	std::vector<int> modeStart(e.iInfo.species.size()); //index of first mode for each species
+	for(size_t sp=0; sp<e.iInfo.species.size(); sp++)
+		VlocRadial.push_back(&(e.iInfo.species[sp]->VlocRadial));
+	for(int iMode=nModes-3; iMode>=0; iMode-=3)
+		modeStart[modes[iMode].sp] = iMode - 3*modes[iMode].at;
+	auto getDVext = [&](vector3<> q)
+	{	std::vector<complexScalarFieldTilde> dVext(nModes);
+		for(int iMode=0; iMode<nModes; iMode+=3)
+		{	const Mode& mode = modes[iMode];
+			const SpeciesInfo& spInfo = *(e.iInfo.species[mode.sp]);
+			for(int iDir=0; iDir<3; iDir++) nullToZero(dVext[iMode+iDir], e.gInfo);
+			threadLaunch(localPerturbation_sub, e.gInfo.nr, e.gInfo.S, e.gInfo.G, q, spInfo.atpos[mode.at], VlocRadial[mode.sp],
+				spInfo.Z, 1./e.gInfo.detR, dVext[iMode]->data(), dVext[iMode+1]->data(), dVext[iMode+2]->data());
+		}
+		return dVext;
+	};
+	
+	//Occupied states on the local part of the unit cell k-mesh:
+	int ikStart, ikStop;
+	TaskDivision(kmesh.size(), mpiUtil).myRange(ikStart, ikStop);
+	ResponseStateArray statesK;
+	for(int ik=ikStart; ik<ikStop; ik++)
+		statesK.push_back(std::make_shared<ResponseState>(e, kmesh[ik], nOcc));
+	
+	//All bands on the local part of the k-points commensurate with the supercell (for dHsub):
+	std::vector<vector3<>> kComm; //in the same order as the supercell Gamma-point blocks of dHsub
+	for(const vector3<>& k: kmesh)
+	{	vector3<> kSup = matrix3<>(Diag(sup)) * k;
+		if(circDistanceSquared(kSup, vector3<>()) < symmThresholdSq)
+			kComm.push_back(k);
+	}
+	assert(int(kComm.size()) == prodSup);
+	auto findComm = [&](vector3<> k)
+	{	for(size_t j=0; j<kComm.size(); j++)
+			if(circDistanceSquared(kComm[j], k) < symmThresholdSq)
+				return int(j);
+		assert(!"k-point not commensurate with supercell");
+		return -1;
+	};
+	int jCommStart, jCommStop;
+	TaskDivision(prodSup, mpiUtil).myRange(jCommStart, jCommStop);
+	ResponseStateArray statesComm;
+	for(int j=jCommStart; j<jCommStop; j++)
+		statesComm.push_back(std::make_shared<ResponseState>(e, kComm[j], nBands));
+	for(int iMode=0; iMode<nModes; iMode++)
+		dHsub[iMode][0] = zeroes(nBands*prodSup, nBands*prodSup);
+	
+	//Same-atom second-order contributions (independent of q, so they contribute only within the first unit cell):
+	std::vector<vector3<>> selfGrad(nModes);
+	{	//Nonlocal:
+		for(const auto& sPtr: statesK)
+		{	const ResponseState& s = *sPtr;
+			ColumnBundle DC[3];
+			for(int iDir=0; iDir<3; iDir++) DC[iDir] = D(s.C, iDir);
+			for(size_t sp=0; sp<s.V.size(); sp++) if(s.V[sp])
+			{	const ColumnBundle& V = *s.V[sp];
+				int nProj = s.nProj[sp];
+				int nAtoms = s.M[sp].nRows() / nProj;
+				matrix P = V ^ s.C, Pd[3], Pdd[3][3];
+				for(int iDir=0; iDir<3; iDir++)
+				{	Pd[iDir] = V ^ DC[iDir];
+					for(int jDir=0; jDir<=iDir; jDir++)
+						Pdd[iDir][jDir] = Pdd[jDir][iDir] = V ^ D(DC[iDir], jDir);
+				}
+				int nCols = P.nCols();
+				for(int at=0; at<nAtoms; at++)
+				{	int pStart = at*nProj, pStop = (at+1)*nProj;
+					matrix Mat = s.M[sp](pStart,pStop, pStart,pStop);
+					matrix MP = Mat * P(pStart,pStop, 0,nCols);
+					for(int iDir=0; iDir<3; iDir++)
+					{	matrix MPd = Mat * Pd[iDir](pStart,pStop, 0,nCols);
+						for(int jDir=0; jDir<3; jDir++)
+							selfGrad[modeStart[sp]+3*at+iDir][jDir] += (2.*s.qnum.weight) * trace(
+								dagger(Pdd[iDir][jDir](pStart,pStop, 0,nCols)) * MP
+								+ dagger(Pd[jDir](pStart,pStop, 0,nCols)) * MPd ).real();
+					}
+				}
+			}
+		}
+		mpiUtil->allReduce((double*)selfGrad.data(), 3*nModes, MPIUtil::ReduceSum);
+		//Local:
+		std::vector<complexScalarFieldTilde> dVext0 = getDVext(vector3<>());
+		VectorField Dn = gradient(e.eVars.n[0]);
+		for(int iMode=0; iMode<nModes; iMode++)
+		{	complexScalarField dV0 = I(dVext0[iMode]);
+			for(int jDir=0; jDir<3; jDir++)
+				selfGrad[iMode][jDir] += e.gInfo.dV * dot(dV0, Complex(Dn[jDir])).real();
+		}
+		for(int iMode=0; iMode<nModes; iMode++)
+		{	const Mode& mode = modes[iMode];
+			dgrad[iMode][mode.sp][mode.at] += selfGrad[iMode];
+		}
+	}
+	
+	//Ion-ion contributions (finite difference of analytical Ewald forces in the supercell):
+	{	std::vector<Atom> atoms0;
+		std::vector<int> atomStart; //index of first supercell atom of each species
+		for(size_t sp=0; sp<e.iInfo.species.size(); sp++)
+		{	const SpeciesInfo& spInfo = *(e.iInfo.species[sp]);
+			atomStart.push_back(atoms0.size());
+			for(const vector3<>& pos: eSupTemplate.iInfo.species[sp]->atpos)
+				atoms0.push_back(Atom(spInfo.Z, pos, vector3<>(0,0,0), spInfo.atomicNumber, sp));
+		}
+		std::shared_ptr<Ewald> ewald = e.coulomb->getEwald(eSupTemplate.gInfo.R, atoms0.size());
+		matrix3<> invRsup = inv(eSupTemplate.gInfo.R);
+		const double h = 1e-4; //displacement in bohrs
+		for(int iMode=0; iMode<nModes; iMode++)
+		{	const Mode& mode = modes[iMode];
+			std::vector<vector3<>> dForce(atoms0.size()); //difference of lattice-coordinate forces
+			for(int sign=-1; sign<=+1; sign+=2)
+			{	std::vector<Atom> atoms = atoms0;
+				atoms[atomStart[mode.sp] + mode.at].pos += invRsup * ((sign*h) * mode.dir);
+				ewald->energyAndGrad(atoms);
+				for(size_t iAtom=0; iAtom<atoms.size(); iAtom++)
+					dForce[iAtom] += sign * atoms[iAtom].force;
+			}
+			for(size_t sp=0; sp<e.iInfo.species.size(); sp++)
+				for(size_t at=0; at<dgrad[iMode][sp].size(); at++)
+					dgrad[iMode][sp][at] += (-0.5/h) * (dForce[atomStart[sp]+at] * invRsup); //convert to Cartesian gradient
+		}
+	}
+	
+	//Pulay parameters for the self-consistent response:
+	PulayParams pp;
+	pp.fpLog = globalLog;
+	pp.linePrefix = "LinearResponse: ";
+	pp.energyLabel = "PhiLoc";
+	pp.energyFormat = "%+.15le";
+	pp.energyDiffThreshold = 0.; //converge on the potential residual alone
+	pp.mixFraction = 0.7;
+	
+	//Loop over wavevectors commensurate with supercell, handling q and -q together using time-reversal symmetry:
+	ResponseKernel kernel(e);
+	std::vector<bool> done(prodSup, false);
+	for(int iq=0; iq<prodSup; iq++)
+	{	if(done[iq]) continue;
+		vector3<int> iCell = getCell(iq), iCellMinus;
+		vector3<> q;
+		for(int j=0; j<3; j++)
+		{	q[j] = double(iCell[j]) / sup[j];
+			iCellMinus[j] = -iCell[j];
+		}
+		int iqMinus = getUnit(iCellMinus);
+		bool hasPartner = (iqMinus != iq);
+		done[iq] = done[iqMinus] = true;
+		logPrintf("\n---- Wavevector q = [ %+.6lf %+.6lf %+.6lf ]%s ----\n", q[0], q[1], q[2], hasPartner ? " (and -q)" : "");
+		
+		//Unperturbed states at k+q (and k +/- q for dHsub):
+		ResponseStateArray statesKQ, statesCommPlus, statesCommMinus;
+		for(int ik=ikStart; ik<ikStop; ik++)
+			statesKQ.push_back(std::make_shared<ResponseState>(e, kmesh[ik]+q, nOcc));
+		for(int j=jCommStart; j<jCommStop; j++)
+		{	statesCommPlus.push_back(std::make_shared<ResponseState>(e, kComm[j]+q, nBands));
+			if(hasPartner) statesCommMinus.push_back(std::make_shared<ResponseState>(e, kComm[j]-q, nBands));
+		}
+		
+		//Bare perturbations:
+		std::vector<complexScalarFieldTilde> dVext = getDVext(q);
+		std::vector<complexScalarField> dVextR(nModes);
+		for(int iMode=0; iMode<nModes; iMode++)
+			dVextR[iMode] = I(dVext[iMode]);
+		
+		//Solve for the response to each mode:
+		PhononResponse response(e, pp, q, statesK, statesKQ, kernel, modeStart, responseThreshold);
+		matrix Dq(nModes, nModes);
+		for(int iMode=0; iMode<nModes; iMode++)
+		{	const Mode& mode = modes[iMode];
+			int iDir = iMode - modeStart[mode.sp] - 3*mode.at;
+			logPrintf("Mode %d of %d (species %s, atom %d, direction %d):\n", iMode+1, nModes,
+				e.iInfo.species[mode.sp]->name.c_str(), mode.at+1, iDir);
+			pp.residualThreshold = responseThreshold * nrm2(dVext[iMode]);
+			response.solve(mode.sp, mode.at, iDir, dVext[iMode]);
+			Dq.set(0,nModes, iMode,iMode+1, response.getForceMatrixColumn(dVextR));
+			
+			//Electron-phonon matrix elements between commensurate k2 and k1 = k2 +/- q:
+			complexScalarField dVscaled = JdagOJ(response.dVscf);
+			for(int j=jCommStart; j<jCommStop; j++)
+			{	const ResponseState& s2 = *statesComm[j-jCommStart];
+				for(int sign=+1; sign>=(hasPartner ? -1 : +1); sign-=2)
+				{	const ResponseState& s1 = *(sign>0 ? statesCommPlus : statesCommMinus)[j-jCommStart];
+					int j1 = findComm(s1.qnum.k);
+					ColumnBundle dHC = applyPerturbation(s2, s1, sign>0 ? dVscaled : conj(dVscaled), mode.sp, mode.at, iDir);
+					dHsub[iMode][0].set(j1*nBands,(j1+1)*nBands, j*nBands,(j+1)*nBands, (1./prodSup) * (s1.C ^ dHC));
+				}
+			}
+		}
+		
+		//Accumulate force matrix in supercell:
+		for(int iMode=0; iMode<nModes; iMode++)
+			for(size_t sp2=0; sp2<e.iInfo.species.size(); sp2++)
+			{	int nAtoms2 = e.iInfo.species[sp2]->atpos.size();
+				for(int unit=0; unit<prodSup; unit++)
+				{	complex phase = cis(2*M_PI*dot(q, getCell(unit)));
+					for(int at2=0; at2<nAtoms2; at2++)
+						for(int iDir2=0; iDir2<3; iDir2++)
+						{	complex D = phase * Dq(modeStart[sp2]+3*at2+iDir2, iMode);
+							dgrad[iMode][sp2][unit*nAtoms2+at2][iDir2] += (hasPartner ? 2.*D.real() : D.real()) / prodSup; //-q contributes conj(D)
+						}
+				}
+			}
+	}
+	for(int iMode=0; iMode<nModes; iMode++)
+		dHsub[iMode][0].allReduce(MPIUtil::ReduceSum);
+	watch.stop();
+}
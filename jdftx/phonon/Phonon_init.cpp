@@ -28,7 +28,7 @@ PhononEverything::PhononEverything(Phonon& phonon) : phonon(phonon)
 }
 
 Phonon::Phonon()
-: dr(0.01), T(298*Kelvin), Fcut(1e-8), rSmooth(1.), iPerturbation(-1), collectPerturbations(false), e(*this), eSupTemplate(*this)
+: dr(0.01), T(298*Kelvin), Fcut(1e-8), rSmooth(1.), iPerturbation(-1), collectPerturbations(false), nGroups(1), linearResponse(false), responseThreshold(1e-7), e(*this), eSupTemplate(*this)
 {
 }
 
@@ -26,6 +26,9 @@ enum PhononMember
 	PM_dr,
 	PM_iPerturbation,
 	PM_collectPerturbations,
+	PM_nGroups,
+	PM_linearResponse,
+	PM_responseThreshold,
  	PM_T,
 	PM_Fcut,
 	PM_rSmooth,
@@ -37,6 +40,9 @@ EnumStringMap<PhononMember> phononMemberMap
 	PM_dr, "dr",
 	PM_iPerturbation,"iPerturbation",
 	PM_collectPerturbations, "collectPerturbations",
+	PM_nGroups, "nGroups",
+	PM_linearResponse, "linearResponse",
+	PM_responseThreshold, "responseThreshold",
 	PM_T, "T",
 	PM_Fcut, "Fcut",
 	PM_rSmooth, "rSmooth"
@@ -65,6 +71,26 @@ struct CommandPhonon : public Command
 			"   Collect results of previous individual supercell calculations.\n"
 			"   Note that this requires all iPerturbation calculations (listed at\n"
 			"   the end of the phonon dry run) to have already completed.\n"
+			"\n+ nGroups <nGroups>\n\n"
+			"   Divide the MPI processes into <nGroups> groups (default 1), which run\n"
+			"   supercell calculations for different perturbations concurrently.\n"
+			"   Each group claims the next pending perturbation as soon as it finishes one,\n"
+			"   and the results of all groups are collected at the end. This is much more\n"
+			"   efficient than running each supercell over all processes, when there are\n"
+			"   too few supercell k-points to keep all processes busy. Only the output of\n"
+			"   the first group appears in the log. Ignored with iPerturbation.\n"
+			"\n+ linearResponse\n\n"
+			"   Compute the force matrix and electron-phonon matrix elements using\n"
+			"   density-functional perturbation theory in the unit cell, instead of\n"
+			"   frozen-phonon supercell calculations. Each wavevector commensurate with\n"
+			"   the supercell is handled by self-consistent Sternheimer equations, and\n"
+			"   the results are Fourier transformed to the same supercell force matrix\n"
+			"   and phononHsub outputs as the frozen-phonon method. Currently supports\n"
+			"   only spin-unpolarized insulators with norm-conserving pseudopotentials,\n"
+			"   semi-local functionals and periodic boundaries (no fluids).\n"
+			"\n+ responseThreshold <thresh>\n\n"
+			"   Convergence threshold on the residual of the self-consistent potential change,\n"
+			"   relative to the bare perturbation, for linearResponse (default 1e-7).\n"
 			"\n+ T <T>\n\n"
 			"   Temperature (in Kelvins) used for vibrational free energy estimation (default 298).\n"
 			"\n+ Fcut <Fcut>\n\n"
@@ -103,11 +129,28 @@ struct CommandPhonon : public Command
 						throw string("perturbation number must be positive");
 					if(phonon.collectPerturbations)
 						throw string("cannot use iPerturbation in the same calculation as collectPerturbations");
+					if(phonon.linearResponse)
+						throw string("cannot use iPerturbation in the same calculation as linearResponse");
 					break;
 				case PM_collectPerturbations:
 					phonon.collectPerturbations = true;
 					if(phonon.iPerturbation>=0)
 						throw string("cannot use iPerturbation in the same calculation as collectPerturbations");
+					if(phonon.linearResponse)
+						throw string("cannot use collectPerturbations in the same calculation as linearResponse");
+					break;
+				case PM_nGroups:
+					pl.get(phonon.nGroups, 1, "nGroups", true);
+					if(phonon.nGroups<1) throw string("<nGroups> must be positive");
+					break;
+				case PM_linearResponse:
+					phonon.linearResponse = true;
+					if(phonon.iPerturbation>=0 || phonon.collectPerturbations)
+						throw string("linearResponse cannot be combined with iPerturbation or collectPerturbations");
+					break;
+				case PM_responseThreshold:
+					pl.get(phonon.responseThreshold, 1e-7, "thresh", true);
+					if(phonon.responseThreshold <= 0.) throw string("<thresh> must be positive");
 					break;
 				case PM_T:
 					pl.get(phonon.T, 0., "T", true);
@@ -133,6 +176,8 @@ struct CommandPhonon : public Command
 		logPrintf(" \\\n\tdr %lg", phonon.dr);
 		if(phonon.iPerturbation>=0) logPrintf(" \\\n\tiPerturbation %d", phonon.iPerturbation+1); //print 1-based index
 		if(phonon.collectPerturbations) logPrintf(" \\\n\tcollectPerturbations");
+		if(phonon.nGroups>1) logPrintf(" \\\n\tnGroups %d", phonon.nGroups);
+		if(phonon.linearResponse) logPrintf(" \\\n\tlinearResponse \\\n\tresponseThreshold %lg", phonon.responseThreshold);
 		logPrintf(" \\\n\tT %lg", phonon.T/Kelvin);
 		logPrintf(" \\\n\tFcut %lg", phonon.Fcut);
 		logPrintf(" \\\n\trSmooth %lg", phonon.rSmooth);
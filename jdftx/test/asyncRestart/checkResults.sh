@@ -0,0 +1,10 @@
+#!/bin/bash
+
+echo "3"  #number of checks
+
+#Restart from the State files written in the background must continue the interrupted SCF:
+Eref=$(awk '/IonicMinimize: Iter/ { E = $5 } END { print E }' reference.out)
+awk -v Eref=$Eref '/IonicMinimize: Iter/ { E = $5 } END { print E, Eref, "1e-7 restart vs reference Si energy [Eh]" }' restart.out
+nCyclesRef=$(grep -c "SCF: Cycle:" reference.out)
+grep -c "SCF: Cycle:" restart.out | awk -v nRef=$nCyclesRef '{ print $1, 0, nRef-1, "restart SCF cycles (fewer than reference)" }'
+echo "$(ls interrupted.*.part 2>/dev/null | wc -l) 0 0 leftover temporary files"
@@ -0,0 +1,3 @@
+#!/bin/bash
+export runs="reference interrupted restart"
+export nProcs="2"
@@ -0,0 +1,14 @@
+#!/bin/bash
+
+echo "8"  #number of checks
+
+#Sharing the wavefunction transforms within band groups must not change the results
+#(exercises the group protocol when launched with nProcs processes, see JDFTX_LAUNCH in README):
+Eref=$(awk '/IonicMinimize: Iter/ { E = $5 } END { print E }' single.out)
+awk -v Eref=$Eref '/IonicMinimize: Iter/ { E = $5 } END { print E, Eref, "1e-7 grouped vs single Si energy [Eh]" }' grouped.out
+Eref=$(awk '$1=="HOMO:" { print $2 }' single.eigStats)
+awk -v Eref=$Eref '$1=="HOMO:" { print $2, Eref, "1e-6 grouped vs single Si HOMO [Eh]" }' grouped.eigStats
+paste <(awk '$1=="force"' grouped.force) <(awk '$1=="force"' single.force) | awk '
+	{	for(j=3; j<=5; j++)
+			printf("%.12e %.12e 1e-6 Si atom %d force component %d [Eh/a0]\n", $j, $(j+6), NR, j-2);
+	}'
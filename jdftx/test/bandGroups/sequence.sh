@@ -0,0 +1,4 @@
+#!/bin/bash
+export runs="single grouped"
+export grouped_args="-G 2"
+export nProcs="4"
@@ -0,0 +1,11 @@
+#!/bin/bash
+
+echo "3"  #number of checks
+
+#Restart from chunked wavefunctions with a changed band count must reproduce the initial state:
+Eref=$(awk '/IonicMinimize: Iter/ { E = $5 } END { print E }' initial.out)
+awk -v Eref=$Eref '/IonicMinimize: Iter/ { E = $5 } END { print E, Eref, "1e-7 moreBands vs initial Si energy [Eh]" }' moreBands.out
+Eref=$(awk '$1=="HOMO:" { print $2 }' initial.eigStats)
+awk -v Eref=$Eref '$1=="HOMO:" { print $2, Eref, "1e-5 moreBands vs initial Si HOMO [Eh]" }' moreBands.eigStats
+Eref=$(awk '$1=="LUMO:" { print $2 }' initial.eigStats)
+awk -v Eref=$Eref '$1=="LUMO:" { print $2, Eref, "1e-5 moreBands vs initial Si LUMO [Eh]" }' moreBands.eigStats
@@ -0,0 +1,3 @@
+#!/bin/bash
+export runs="initial moreBands"
+export nProcs="2"
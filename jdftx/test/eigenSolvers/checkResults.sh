@@ -0,0 +1,13 @@
+#!/bin/bash
+
+echo "6"  #number of checks
+
+#Each eigensolver must converge to the same SCF state as the default Davidson solver:
+Eref=$(awk '/IonicMinimize: Iter/ { E = $5 } END { print E }' Davidson.out)
+HOMOref=$(awk '$1=="HOMO:" { print $2 }' Davidson.eigStats)
+LUMOref=$(awk '$1=="LUMO:" { print $2 }' Davidson.eigStats)
+for algo in LOBPCG RMMDIIS; do
+	awk -v Eref=$Eref -v algo=$algo '/IonicMinimize: Iter/ { E = $5 } END { print E, Eref, "1e-7", algo, "vs Davidson Si energy [Eh]" }' $algo.out
+	awk -v Eref=$HOMOref -v algo=$algo '$1=="HOMO:" { print $2, Eref, "1e-5", algo, "vs Davidson Si HOMO [Eh]" }' $algo.eigStats
+	awk -v Eref=$LUMOref -v algo=$algo '$1=="LUMO:" { print $2, Eref, "1e-5", algo, "vs Davidson Si LUMO [Eh]" }' $algo.eigStats
+done
@@ -0,0 +1,3 @@
+#!/bin/bash
+export runs="Davidson LOBPCG RMMDIIS"
+export nProcs="1"
@@ -0,0 +1,16 @@
+#!/bin/bash
+
+echo "13"  #number of checks
+
+#Ewald energy, forces and stress from SPME against the direct reciprocal-space sum:
+Eref=$(awk '$1=="Eewald" { print $3 }' Direct.Ecomponents)
+awk -v Eref=$Eref '$1=="Eewald" { print $3, Eref, "1e-10 Si Ewald energy [Eh]" }' Mesh.Ecomponents
+paste <(awk '$1=="force" && $2=="Si"' Mesh.force) <(awk '$1=="force" && $2=="Si"' Direct.force) | awk '
+	{	for(j=3; j<=5; j++)
+			printf("%.12e %.12e 1e-8 Si atom %d force component %d [Eh/a0]\n", $j, $(j+6), NR, j-2);
+	}'
+paste <(awk 'NR>1' Mesh.stress) <(awk 'NR>1' Direct.stress) | awk '
+	{	i = NR;
+		for(j=i; j<=3; j++)
+			printf("%.9e %.9e 1e-10 Si stress component %d%d [Eh/a0^3]\n", $j, $(j+3), i, j);
+	}'
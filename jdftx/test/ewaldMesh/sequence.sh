@@ -0,0 +1,3 @@
+#!/bin/bash
+export runs="Direct Mesh"
+export nProcs="1"
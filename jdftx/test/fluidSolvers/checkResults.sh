@@ -0,0 +1,10 @@
+#!/bin/bash
+
+echo "2"  #number of checks
+
+#Solver options must not change the converged energies:
+for pair in "LinearPCM LinearPCMrecycle" "NonlinearPCM NonlinearPCMnewton"; do
+	set -- $pair
+	Eref=$(awk '/IonicMinimize: Iter/ { E = $5 } END { print E }' $1.out)
+	awk -v Eref=$Eref -v run=$2 -v ref=$1 '/IonicMinimize: Iter/ { E = $5 } END { print E, Eref, "1e-6", run, "vs", ref, "energy [Eh]" }' $2.out
+done
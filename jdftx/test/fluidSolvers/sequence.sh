@@ -0,0 +1,3 @@
+#!/bin/bash
+export runs="LinearPCM LinearPCMrecycle NonlinearPCM NonlinearPCMnewton"
+export nProcs="1"
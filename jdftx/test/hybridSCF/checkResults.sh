@@ -0,0 +1,9 @@
+#!/bin/bash
+
+echo "2"  #number of checks
+
+#SCF with the ACE exchange operator must converge to the same state as direct minimization with the exact operator:
+Eref=$(awk '/IonicMinimize: Iter/ { E = $5 } END { print E }' totalE.out)
+awk -v Eref=$Eref '/IonicMinimize: Iter/ { E = $5 } END { print E, Eref, "1e-6 SCF vs totalE N2 energy [Eh]" }' SCF.out
+Eref=$(awk '$1=="HOMO:" { print $2 }' totalE.eigStats)
+awk -v Eref=$Eref '$1=="HOMO:" { print $2, Eref, "1e-5 SCF vs totalE N2 HOMO [Eh]" }' SCF.eigStats
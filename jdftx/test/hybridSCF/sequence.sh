@@ -0,0 +1,3 @@
+#!/bin/bash
+export runs="totalE SCF"
+export nProcs="1"
@@ -0,0 +1,17 @@
+#!/bin/bash
+
+echo "5"  #number of checks
+
+#All minimizers must reach the same relaxed energy:
+Eref=$(awk '/IonicMinimize: Iter/ { E = $5 } END { print E }' LBFGS.out)
+for run in FIRE Exp; do
+	awk -v Eref=$Eref -v run=$run '/IonicMinimize: Iter/ { E = $5 } END { print E, Eref, "1e-5", run, "vs L-BFGS relaxed H2O energy [Eh]" }' $run.out
+done
+
+#Step counts must remain comparable to L-BFGS (FIRE is expected to take more, but not excessively more):
+nRef=$(awk '/IonicMinimize: Iter/ { n = $3 } END { print n }' LBFGS.out)
+awk -v nRef=$nRef '/IonicMinimize: Iter/ { n = $3 } END { print n, 0, 3*nRef, "FIRE ionic steps (under 3x L-BFGS)" }' FIRE.out
+awk -v nRef=$nRef '/IonicMinimize: Iter/ { n = $3 } END { print n, 0, int(1.5*nRef)+2, "Exp-preconditioned ionic steps (comparable to L-BFGS)" }' Exp.out
+
+#All three must actually converge (rather than exhaust nIterations):
+cat LBFGS.out FIRE.out Exp.out | grep -c "IonicMinimize: Converged" | awk '{ print $1, 3, 0.5, "number of converged relaxations" }'
@@ -0,0 +1,3 @@
+#!/bin/bash
+export runs="LBFGS FIRE Exp"
+export nProcs="1"
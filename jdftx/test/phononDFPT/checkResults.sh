@@ -0,0 +1,14 @@
+#!/bin/bash
+
+echo "2"  #number of checks
+
+#Maximum deviation (relative to the largest entry) of binary double-precision outputs of linearResponse from frozen phonons:
+function relativeDeviation()
+{	paste <(od -A n -t f8 -v -w8 linearResponse.$1) <(od -A n -t f8 -v -w8 frozen.$1) | awk '
+		{	d = $1 - $2; if(d < 0) d = -d; if(d > dMax) dMax = d;
+			x = $2; if(x < 0) x = -x; if(x > xMax) xMax = x;
+		}
+		END { print dMax/xMax }'
+}
+echo "$(relativeDeviation phononOmegaSq) 0 2e-3 Si DFPT vs frozen phononOmegaSq"
+echo "$(relativeDeviation phononHsub) 0 5e-3 Si DFPT vs frozen phononHsub"
@@ -0,0 +1,3 @@
+#!/bin/bash
+export runs="totalE phonon:frozen phonon:linearResponse"
+export nProcs="4"
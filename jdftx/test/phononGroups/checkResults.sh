@@ -0,0 +1,14 @@
+#!/bin/bash
+
+echo "2"  #number of checks
+
+#Maximum deviation (relative to the largest entry) of binary double-precision outputs of grouped from serial:
+function relativeDeviation()
+{	paste <(od -A n -t f8 -v -w8 grouped.$1) <(od -A n -t f8 -v -w8 serial.$1) | awk '
+		{	d = $1 - $2; if(d < 0) d = -d; if(d > dMax) dMax = d;
+			x = $2; if(x < 0) x = -x; if(x > xMax) xMax = x;
+		}
+		END { print dMax/xMax }'
+}
+echo "$(relativeDeviation phononOmegaSq) 0 1e-5 Si nGroups 2 vs serial phononOmegaSq"
+echo "$(relativeDeviation phononHsub) 0 1e-5 Si nGroups 2 vs serial phononHsub"
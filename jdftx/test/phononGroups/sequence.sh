@@ -0,0 +1,3 @@
+#!/bin/bash
+export runs="totalE phonon:serial phonon:grouped"
+export nProcs="4"
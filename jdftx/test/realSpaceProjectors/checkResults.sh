@@ -0,0 +1,11 @@
+#!/bin/bash
+
+echo "3"  #number of checks
+
+#Real-space projectors (filtered and truncated) against the exact reciprocal-space projectors:
+Eref=$(awk '/IonicMinimize: Iter/ { E = $5 } END { print E }' reciprocal.out)
+awk -v Eref=$Eref '/IonicMinimize: Iter/ { E = $5 } END { print E, Eref, "1e-6 realSpace vs reciprocal Si energy [Eh]" }' realSpace.out
+Eref=$(awk '$1=="HOMO:" { print $2 }' reciprocal.eigStats)
+awk -v Eref=$Eref '$1=="HOMO:" { print $2, Eref, "1e-6 realSpace vs reciprocal Si HOMO [Eh]" }' realSpace.eigStats
+Eref=$(awk '/LatticeMinimize: Iter/ { E = $5 } END { print E }' latticeReciprocal.out)
+awk -v Eref=$Eref '/LatticeMinimize: Iter/ { E = $5 } END { print E, Eref, "1e-5 realSpace vs reciprocal lattice-minimized Si energy [Eh]" }' latticeRealSpace.out
@@ -0,0 +1,3 @@
+#!/bin/bash
+export runs="reciprocal realSpace latticeReciprocal latticeRealSpace"
+export nProcs="1"
@@ -0,0 +1,11 @@
+#!/bin/bash
+
+echo "10"  #number of checks
+
+#Real-wavefunction mode must reproduce the default complex wavefunctions at the Gamma point:
+Eref=$(awk '/IonicMinimize: Iter/ { E = $5 } END { print E }' complex.out)
+awk -v Eref=$Eref '/IonicMinimize: Iter/ { E = $5 } END { print E, Eref, "1e-7 real vs complex H2O energy [Eh]" }' real.out
+paste <(awk '$1=="force"' real.force) <(awk '$1=="force"' complex.force) | awk '
+	{	for(j=3; j<=5; j++)
+			printf("%.12e %.12e 1e-6 %s atom %d force component %d [Eh/a0]\n", $j, $(j+6), $2, NR, j-2);
+	}'
@@ -0,0 +1,3 @@
+#!/bin/bash
+export runs="complex real"
+export nProcs="1"
@@ -20,9 +20,12 @@ else
 	LAUNCH="$JDFTX_LAUNCH"
 fi
 echo "launch=\"$LAUNCH\""
-for run in $runs; do
+for runSpec in $runs; do
+	run="${runSpec#*:}" #optional executable prefix, as in "phonon:run" (jdftx by default)
+	if [[ "$runSpec" == *:* ]]; then executable="${runSpec%%:*}"; else executable="jdftx"; fi
+	runArgs="${run}_args"; runArgs="${!runArgs}" #optional extra command-line options, as in "export run_args=..." in sequence.sh
 	if [[ ! ( ( -f $run.out ) && ( "$(awk '/End date and time:/ {endLine=NR+1} NR==endLine {print}' $run.out)" == "Done!" ) ) ]]; then
-		$LAUNCH $jdftxBuildDir/jdftx$JDFTX_SUFFIX -i $testSrcDir/$run.in -d -o $run.out
+		$LAUNCH $jdftxBuildDir/$executable$JDFTX_SUFFIX $runArgs -i $testSrcDir/$run.in -d -o $run.out
 		if [ "$?" -ne "0" ]; then
 			echo "" > results
 			echo "FAILED: error running $run" > summary
@@ -0,0 +1,10 @@
+#!/bin/bash
+
+echo "6"  #number of checks
+
+#Each independent component of the analytic stress against the finite-difference stress:
+paste <(awk 'NR>1' analytic.stress) <(awk 'NR>1' finiteDifference.stress) | awk '
+	{	i = NR;
+		for(j=i; j<=3; j++)
+			printf("%.9e %.9e 2e-7 Si stress component %d%d [Eh/a0^3]\n", $j, $(j+3), i, j);
+	}'
@@ -0,0 +1,9 @@
+#!/bin/bash
+
+echo "1"  #number of checks
+
+#Force from the batched augmentation gradient against the central difference of the batched augmented energy:
+Eplus=$(awk '/IonicMinimize: Iter/ { E = $5 } END { printf("%.12f", E) }' plus.out)
+Eminus=$(awk '/IonicMinimize: Iter/ { E = $5 } END { printf("%.12f", E) }' minus.out)
+awk -v Eplus=$Eplus -v Eminus=$Eminus '$1=="force" && $2=="H" { F = $5 }
+	END { printf("%.9e %.9e 5e-5 H2O second H force along z [Eh/a0]\n", F, -(Eplus-Eminus)/0.02) }' center.force
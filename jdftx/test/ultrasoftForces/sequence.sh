@@ -0,0 +1,3 @@
+#!/bin/bash
+export runs="center plus minus"
+export nProcs="1"
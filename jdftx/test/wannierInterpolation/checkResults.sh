@@ -0,0 +1,9 @@
+#!/bin/bash
+
+echo "1"  #number of checks
+
+#Maximum deviation of Wannier-interpolated eigenvalues from DFT eigenvalues at points of the original k-mesh:
+paste <(od -A n -t f8 -v -w8 wannier.mlwfBandstruct) <(od -A n -t f8 -v -w8 bandstruct.eigenvals) | awk '
+	{	d = $1 - $2; if(d < 0) d = -d; if(d > dMax) dMax = d;
+	}
+	END { print dMax, "0 1e-6 Si interpolated vs DFT valence eigenvalues [Eh]" }'
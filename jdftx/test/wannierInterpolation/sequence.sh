@@ -0,0 +1,3 @@
+#!/bin/bash
+export runs="totalE wannier:wannier bandstruct"
+export nProcs="2"
@@ -0,0 +1,9 @@
+#!/bin/bash
+
+echo "2"  #number of checks
+
+#Extrapolation must not change the relaxed energy, but must reduce the total SCF cycles over the relaxation:
+Eref=$(awk '/IonicMinimize: Iter/ { E = $5 } END { print E }' drag.out)
+awk -v Eref=$Eref '/IonicMinimize: Iter/ { E = $5 } END { print E, Eref, "1e-7 extrapolate vs drag relaxed Si energy [Eh]" }' extrapolate.out
+nCyclesRef=$(grep -c "SCF: Cycle:" drag.out)
+grep -c "SCF: Cycle:" extrapolate.out | awk -v nRef=$nCyclesRef '{ print $1, 0, int(0.9*nRef), "extrapolate SCF cycles (under 90% of drag)" }'
@@ -0,0 +1,3 @@
+#!/bin/bash
+export runs="drag extrapolate"
+export nProcs="2"
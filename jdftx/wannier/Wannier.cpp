@@ -24,7 +24,8 @@ along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
 Wannier::Wannier() : needAtomicOrbitals(false), localizationMeasure(LM_FiniteDifference), precond(false),
 	bStart(0), outerWindow(false), innerWindow(false), nFrozen(0),
 	saveWfns(false), saveWfnsRealSpace(false), saveMomenta(false),
-	loadRotations(false), numericalOrbitalsOffset(0.5,0.5,0.5), rSmooth(1.), wrapWS(false)
+	loadRotations(false), numericalOrbitalsOffset(0.5,0.5,0.5), rSmooth(1.), wrapWS(false),
+	interpKmesh(0,0,0), interpMu(NAN), interpEsigma(0.)
 {
 }
 
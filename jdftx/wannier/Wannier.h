@@ -80,7 +80,13 @@ public:
 	double rSmooth; //!< supercell boundary width over which matrix elements are smoothed
 	bool wrapWS; //!< whether to wrap Wannier centers (and phonon atom perturbations) to a Wigner-Seitz cell
 	
+	vector3<int> interpKmesh; //!< uniform k-mesh for Wannier-interpolated DOS and Fermi surface (none if zero)
+	string interpKpointsFilename; //!< file of kpoint commands for the Wannier-interpolated band structure (none if empty)
+	double interpMu; //!< Fermi level for the interpolated Fermi surface output on interpKmesh (none if NaN)
+	double interpEsigma; //!< gaussian width for the interpolated DOS
+	
 	void saveMLWF(); //!< Output the Maximally-Localized Wannier Functions from current wavefunctions
+	void interpolate(); //!< Output band structure, DOS and Fermi surface by Fourier interpolation of the Wannier Hamiltonian written by saveMLWF
 	
 	enum FilenameType
 	{	FilenameInit,
@@ -0,0 +1,184 @@
+/*-------------------------------------------------------------------
+Copyright 2026 agent
+
+This file is part of JDFTx.
+
+JDFTx is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+JDFTx is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with JDFTx.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------*/
+
+#include <wannier/Wannier.h>
+#include <commands/parser.h>
+#include <core/matrix.h>
+#include <core/Thread.h>
+
+extern "C"
+{	void zheev_(char* JOBZ, char* UPLO, int* N, complex* A, int* LDA, double* W,
+		complex* WORK, int* LWORK, double* RWORK, int* INFO);
+}
+
+//Eigenvalues of a batch of hermitian N x N matrices stored consecutively in H (destroyed on output)
+void diagonalizeBatch_sub(size_t iStart, size_t iStop, int N, complex* H, double* eigs)
+{	char jobz = 'N'; //eigenvalues only
+	char uplo = 'U';
+	int lwork = (64+1)*N; std::vector<complex> work(lwork);
+	std::vector<double> rwork(std::max(1, 3*N-2));
+	for(size_t i=iStart; i<iStop; i++)
+	{	int info = 0;
+		zheev_(&jobz, &uplo, &N, H+i*N*N, &N, eigs+i*N, work.data(), &lwork, rwork.data(), &info);
+		if(info) die("Error code %d in LAPACK eigenvalue routine ZHEEV.\n", info);
+	}
+}
+
+//Fourier interpolation of the Wannier Hamiltonian output by Wannier::saveMLWF
+class WannierInterpolator
+{
+public:
+	WannierInterpolator(const Wannier& wannier, const Everything& e, int iSpin) : nCenters(wannier.nCenters)
+	{	//Read cell map:
+		string fname = wannier.getFilename(Wannier::FilenameDump, "mlwfCellMap");
+		ifstream ifs(fname);
+		if(!ifs.is_open()) die("Could not open '%s' for reading.\n", fname.c_str());
+		string line;
+		while(getline(ifs, line))
+		{	if(!line.length() || line[0]=='#') continue;
+			vector3<int> iCell;
+			istringstream(line) >> iCell[0] >> iCell[1] >> iCell[2];
+			cells.push_back(iCell);
+		}
+		ifs.close();
+		if(!cells.size()) die("No cells found in '%s'.\n", fname.c_str());
+		//Read Hamiltonian (written as real parts alone, except in noncollinear calculations):
+		fname = wannier.getFilename(Wannier::FilenameDump, "mlwfH", &iSpin);
+		logPrintf("Reading '%s' (%d centers, %lu cells) ... ", fname.c_str(), nCenters, cells.size()); logFlush();
+		Hwannier.init(nCenters*nCenters, cells.size());
+		if(e.eInfo.isNoncollinear()) Hwannier.read(fname.c_str());
+		else Hwannier.read_real(fname.c_str());
+		logPrintf("done.\n"); logFlush();
+	}
+	
+	//! Get band energies at k-points kArr (in lattice coordinates), as a flat array with outer index k and inner index band.
+	//! The k-points are divided over MPI processes and processed in batches, with the Fourier transform
+	//! of each batch carried out as a single matrix multiply, followed by diagonalization threaded over k.
+	std::vector<double> getEigs(const std::vector<vector3<>>& kArr) const
+	{	static StopWatch watch("WannierInterpolator::getEigs"); watch.start();
+		const int nBatch = 128; //number of k-points transformed together
+		TaskDivision kDivision(kArr.size(), mpiUtil);
+		std::vector<double> eigs(kArr.size()*nCenters, 0.);
+		for(size_t kStart=kDivision.start(); kStart<kDivision.stop(); kStart+=nBatch)
+		{	size_t kStop = std::min(kStart+nBatch, kDivision.stop());
+			//Fourier transform H to current batch of k:
+			matrix phase(cells.size(), kStop-kStart);
+			complex* phaseData = phase.data();
+			for(size_t ik=kStart; ik<kStop; ik++)
+				for(const vector3<int>& iCell: cells)
+					*(phaseData++) = cis(-2*M_PI*dot(kArr[ik], iCell));
+			matrix Hk = Hwannier * phase;
+			//Diagonalize:
+			threadLaunch(diagonalizeBatch_sub, kStop-kStart, nCenters, Hk.data(), eigs.data()+kStart*nCenters);
+		}
+		mpiUtil->allReduce(eigs.data(), eigs.size(), MPIUtil::ReduceSum);
+		watch.stop();
+		return eigs;
+	}
+	
+private:
+	int nCenters;
+	std::vector<vector3<int>> cells; //!< unit cells in lattice coordinates (in order of mlwfCellMap)
+	matrix Hwannier; //!< Wannier Hamiltonian (nCenters x nCenters matrix per cell in columns, including cell weights)
+};
+
+void Wannier::interpolate()
+{	if(!(interpKpointsFilename.length() || interpKmesh.length_squared())) return; //nothing requested
+	logPrintf("\n---------- Wannier interpolation ----------\n"); logFlush();
+	const matrix3<>& GT = e->gInfo.GT;
+	
+	//Read band structure k-points, if any:
+	std::vector<vector3<>> kBandstruct;
+	if(interpKpointsFilename.length())
+	{	for(const auto& cmd: readInputFile(interpKpointsFilename))
+			if(cmd.first == "kpoint")
+			{	vector3<> k;
+				istringstream(cmd.second) >> k[0] >> k[1] >> k[2];
+				kBandstruct.push_back(k);
+			}
+		if(!kBandstruct.size()) die("No k-points found in '%s'.\n", interpKpointsFilename.c_str());
+		logPrintf("Read %lu band-structure k-points from '%s'.\n", kBandstruct.size(), interpKpointsFilename.c_str());
+	}
+	
+	//Initialize uniform Gamma-centered mesh, if any (with index order required by DOS::dumpUniform):
+	std::vector<vector3<>> kMesh;
+	if(interpKmesh.length_squared())
+	{	vector3<int> i;
+		for(i[0]=0; i[0]<interpKmesh[0]; i[0]++)
+		for(i[1]=0; i[1]<interpKmesh[1]; i[1]++)
+		for(i[2]=0; i[2]<interpKmesh[2]; i[2]++)
+			kMesh.push_back(vector3<>(double(i[0])/interpKmesh[0], double(i[1])/interpKmesh[1], double(i[2])/interpKmesh[2]));
+		logPrintf("Interpolating on a %d x %d x %d uniform k-mesh.\n", interpKmesh[0], interpKmesh[1], interpKmesh[2]);
+	}
+	
+	for(int iSpin=0; iSpin<e->eInfo.nSpins(); iSpin++)
+	{	WannierInterpolator interp(*this, *e, iSpin);
+		
+		//Band structure:
+		if(kBandstruct.size())
+		{	std::vector<double> eigs = interp.getEigs(kBandstruct);
+			string fname = getFilename(FilenameDump, "mlwfBandstruct", &iSpin);
+			if(mpiUtil->isHead())
+			{	logPrintf("Dumping '%s' ... ", fname.c_str()); logFlush();
+				FILE* fp = fopen(fname.c_str(), "wb");
+				if(!fp) die("Failed to open file '%s' for binary write.\n", fname.c_str());
+				fwriteLE(eigs.data(), sizeof(double), eigs.size(), fp);
+				fclose(fp);
+				logPrintf("done.\n"); logFlush();
+			}
+		}
+		
+		if(!kMesh.size()) continue;
+		std::vector<double> eigs = interp.getEigs(kMesh);
+		
+		//Density of states:
+		DOS::dumpUniform(GT, interpKmesh, nCenters, eigs, e->eInfo.spinWeight,
+			1e-6, interpEsigma, getFilename(FilenameDump, "mlwfDOS", &iSpin));
+		
+		//Fermi surface in the XCrySDen BXSF format (general grid including periodic end points):
+		if(!std::isnan(interpMu) && mpiUtil->isHead())
+		{	string fname = getFilename(FilenameDump, "mlwfFermiSurface", &iSpin);
+			logPrintf("Dumping '%s' ... ", fname.c_str()); logFlush();
+			FILE* fp = fopen(fname.c_str(), "w");
+			if(!fp) die("Failed to open file '%s' for writing.\n", fname.c_str());
+			fprintf(fp, "BEGIN_INFO\n  Fermi Energy: %.15lf\nEND_INFO\n", interpMu);
+			fprintf(fp, "BEGIN_BLOCK_BANDGRID_3D\n  jdftx_wannier_interpolation\n  BEGIN_BANDGRID_3D\n");
+			fprintf(fp, "  %d\n  %d %d %d\n  0. 0. 0.\n", nCenters, interpKmesh[0]+1, interpKmesh[1]+1, interpKmesh[2]+1);
+			for(int iDir=0; iDir<3; iDir++)
+			{	vector3<> G = GT.column(iDir);
+				fprintf(fp, "  %.15lf %.15lf %.15lf\n", G[0], G[1], G[2]);
+			}
+			for(int b=0; b<nCenters; b++)
+			{	fprintf(fp, "  BAND: %d\n", b+1);
+				vector3<int> i;
+				for(i[0]=0; i[0]<=interpKmesh[0]; i[0]++)
+				for(i[1]=0; i[1]<=interpKmesh[1]; i[1]++)
+				{	for(i[2]=0; i[2]<=interpKmesh[2]; i[2]++)
+					{	int ik = ((i[0]%interpKmesh[0])*interpKmesh[1] + (i[1]%interpKmesh[1]))*interpKmesh[2] + (i[2]%interpKmesh[2]);
+						fprintf(fp, " %.10lf", eigs[ik*nCenters+b]);
+					}
+					fprintf(fp, "\n");
+				}
+			}
+			fprintf(fp, "  END_BANDGRID_3D\nEND_BLOCK_BANDGRID_3D\n");
+			fclose(fp);
+			logPrintf("done.\n"); logFlush();
+		}
+	}
+}
@@ -403,6 +403,90 @@ struct CommandWannierCenterPinned : public CommandWannierCenter
 commandWannierCenterPinned;
 
 
+enum WannierInterpolateMember
+{	WIM_kMesh,
+	WIM_bandstruct,
+	WIM_fermiSurface,
+	WIM_Esigma,
+	WIM_delim
+};
+
+EnumStringMap<WannierInterpolateMember> wannierInterpolateMemberMap
+(	WIM_kMesh, "kMesh",
+	WIM_bandstruct, "bandstruct",
+	WIM_fermiSurface, "fermiSurface",
+	WIM_Esigma, "Esigma"
+);
+
+struct CommandWannierInterpolate : public Command
+{
+	CommandWannierInterpolate() : Command("wannier-interpolate", "wannier")
+	{
+		format = "<key1> <args1...>  <key2> <args2...>  ...";
+		comments =
+			"Evaluate band energies by Fourier interpolation of the %Wannier Hamiltonian (mlwfH and mlwfCellMap)\n"
+			"after it is written out, on arbitrary k-points and dense uniform k-meshes.\n"
+			"The possible <key>'s and their corresponding arguments are:\n"
+			"\n+ kMesh <N0> <N1> <N2>\n\n"
+			"   Uniform Gamma-centered k-mesh on which to interpolate band energies, and output\n"
+			"   the tetrahedron-method density of states (mlwfDOS, in the same format as dos).\n"
+			"\n+ bandstruct <filename>\n\n"
+			"   File containing kpoint commands (such as bandstruct.kpoints generated by the\n"
+			"   bandstructKpoints script) at which to output interpolated band energies (mlwfBandstruct,\n"
+			"   in the same binary format as eigenvals with nCenters bands).\n"
+			"\n+ fermiSurface <mu>\n\n"
+			"   Output interpolated band energies on kMesh as an XCrySDen band grid (mlwfFermiSurface,\n"
+			"   in BXSF format with reciprocal lattice vectors in inverse bohrs) with Fermi level <mu>.\n"
+			"   Requires kMesh.\n"
+			"\n+ Esigma <Esigma>\n\n"
+			"   Gaussian width in Hartrees for smoothing the interpolated density of states (default: 0).";
+	}
+
+	void process(ParamList& pl, Everything& e)
+	{	Wannier& wannier = ((WannierEverything&)e).wannier;
+		while(true)
+		{	WannierInterpolateMember key; pl.get(key, WIM_delim, wannierInterpolateMemberMap, "key");
+			if(key==WIM_delim) break;
+			switch(key)
+			{	case WIM_kMesh:
+					pl.get(wannier.interpKmesh[0], 0, "N0", true);
+					pl.get(wannier.interpKmesh[1], 0, "N1", true);
+					pl.get(wannier.interpKmesh[2], 0, "N2", true);
+					for(int k=0; k<3; k++)
+						if(wannier.interpKmesh[k] <= 0) throw string("k-mesh dimensions must be positive");
+					break;
+				case WIM_bandstruct:
+					pl.get(wannier.interpKpointsFilename, string(), "filename", true);
+					break;
+				case WIM_fermiSurface:
+					pl.get(wannier.interpMu, 0., "mu", true);
+					break;
+				case WIM_Esigma:
+					pl.get(wannier.interpEsigma, 0., "Esigma", true);
+					if(wannier.interpEsigma < 0.) throw string("<Esigma> must be non-negative");
+					break;
+				case WIM_delim: //should never be encountered
+					break;
+			}
+		}
+		if(!std::isnan(wannier.interpMu) && !wannier.interpKmesh.length_squared())
+			throw string("fermiSurface requires kMesh");
+	}
+
+	void printStatus(Everything& e, int iRep)
+	{	const Wannier& wannier = ((const WannierEverything&)e).wannier;
+		if(wannier.interpKmesh.length_squared())
+			logPrintf(" \\\n\tkMesh %d %d %d", wannier.interpKmesh[0], wannier.interpKmesh[1], wannier.interpKmesh[2]);
+		if(wannier.interpKpointsFilename.length())
+			logPrintf(" \\\n\tbandstruct %s", wannier.interpKpointsFilename.c_str());
+		if(!std::isnan(wannier.interpMu))
+			logPrintf(" \\\n\tfermiSurface %lg", wannier.interpMu);
+		logPrintf(" \\\n\tEsigma %lg", wannier.interpEsigma);
+	}
+}
+commandWannierInterpolate;
+
+
 struct CommandWannierMinimize : public CommandMinimize
 {	CommandWannierMinimize() : CommandMinimize("wannier", "wannier") {}
     MinimizeParams& target(Everything& e)
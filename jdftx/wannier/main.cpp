@@ -60,6 +60,7 @@ int main(int argc, char** argv)
 	}
 	
 	e.wannier.saveMLWF();
+	e.wannier.interpolate();
 	
 	finalizeSystem();
 	return 0;